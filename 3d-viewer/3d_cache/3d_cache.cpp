@@ -23,16 +23,23 @@
 
 #define GLM_FORCE_RADIANS
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <set>
+#include <thread>
 #include <utility>
 #include <iterator>
 
+#include <wx/app.h>
 #include <wx/datetime.h>
 #include <wx/filename.h>
 #include <wx/log.h>
 #include <wx/stdpaths.h>
+#include <wx/utils.h>
 
 #include <boost/uuid/sha1.hpp>
 
@@ -40,6 +47,7 @@
 #include <glm/ext.hpp>
 
 #include "common.h"
+#include "reporter.h"
 #include "3d_cache.h"
 #include "3d_info.h"
 #include "sg/scenegraph.h"
@@ -52,6 +60,10 @@
 
 static wxCriticalSection lock3D_cache;
 
+// the node names are renumbered while writing a cache file, and the entries of files
+// with the same content write the same cache files
+static wxCriticalSection lock3D_cacheFile;
+
 static bool isSHA1Same( const unsigned char* shaA, const unsigned char* shaB )
 {
     for( int i = 0; i < 20; ++i )
@@ -164,6 +176,7 @@ void S3D_CACHE_ENTRY::SetSHA1( const unsigned char* aSHA1Sum )
     }
 
     memcpy( sha1sum, aSHA1Sum, 20 );
+    m_CacheBaseName.clear();
     return;
 }
 
@@ -200,7 +213,8 @@ S3D_CACHE::~S3D_CACHE()
 }
 
 
-SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr )
+SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr,
+                             bool aRenderData )
 {
     if( aCachePtr )
         *aCachePtr = NULL;
@@ -222,6 +236,7 @@ SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCach
 
     if( mi != m_CacheMap.end() )
     {
+        S3D_CACHE_ENTRY* ep = mi->second;
         wxFileName fname( full3Dpath );
 
         if( fname.FileExists() )    // Only check if file exists. If not, it will
@@ -229,42 +244,50 @@ SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCach
             bool reload = false;
             wxDateTime fmdate = fname.GetModificationTime();
 
-            if( fmdate != mi->second->modTime )
+            if( fmdate != ep->modTime )
             {
                 unsigned char hashSum[20];
                 getSHA1( full3Dpath, hashSum );
-                mi->second->modTime = fmdate;
+                ep->modTime = fmdate;
 
-                if( !isSHA1Same( hashSum, mi->second->sha1sum ) )
+                if( !isSHA1Same( hashSum, ep->sha1sum ) )
                 {
-                    mi->second->SetSHA1( hashSum );
+                    ep->SetSHA1( hashSum );
                     reload = true;
                 }
             }
 
             if( reload )
             {
-                if( NULL != mi->second->sceneData )
+                if( NULL != ep->sceneData )
                 {
-                    S3D::DestroyNode( mi->second->sceneData );
-                    mi->second->sceneData = NULL;
+                    S3D::DestroyNode( ep->sceneData );
+                    ep->sceneData = NULL;
                 }
 
-                if( NULL != mi->second->renderData )
-                    S3D::Destroy3DModel( &mi->second->renderData );
+                if( NULL != ep->renderData )
+                    S3D::Destroy3DModel( &ep->renderData );
 
-                mi->second->sceneData = m_Plugins->Load3DModel( full3Dpath, mi->second->pluginInfo );
+                ep->pluginInfo.clear();
             }
+
+            // an entry loaded for the renderers may have its render data only, and
+            // an entry loaded by Load() its scene data only
+            bool missing = aRenderData ? ( NULL == ep->renderData && NULL != ep->sceneData )
+                                       : ( NULL == ep->sceneData && NULL != ep->renderData );
+
+            if( reload || missing )
+                loadEntry( full3Dpath, ep, aRenderData );
         }
 
         if( NULL != aCachePtr )
-            *aCachePtr = mi->second;
+            *aCachePtr = ep;
 
-        return mi->second->sceneData;
+        return ep->sceneData;
     }
 
     // a cache item does not exist; search the Filename->Cachename map
-    return checkCache( full3Dpath, aCachePtr );
+    return checkCache( full3Dpath, aCachePtr, aRenderData );
 }
 
 
@@ -274,7 +297,8 @@ SCENEGRAPH* S3D_CACHE::Load( const wxString& aModelFile )
 }
 
 
-SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr )
+SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr,
+                                   bool aRenderData )
 {
     if( aCachePtr )
         *aCachePtr = NULL;
@@ -344,19 +368,40 @@ SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY**
         *aCachePtr = ep;
 
     ep->SetSHA1( sha1sum );
+    loadEntry( aFileName, ep, aRenderData );
 
-    wxString bname = ep->GetCacheBaseName();
-    wxString cachename = m_CacheDir + bname + wxT( ".3dc" );
+    return ep->sceneData;
+}
 
-    if( wxFileName::FileExists( cachename ) && loadCacheData( ep ) )
-        return ep->sceneData;
 
-    ep->sceneData = m_Plugins->Load3DModel( aFileName, ep->pluginInfo );
+void S3D_CACHE::loadEntry( const wxString& aFileName, S3D_CACHE_ENTRY* aCacheItem,
+                           bool aRenderData )
+{
+    // the renderers only need the render data, which is read as is from its cache file
+    if( aRenderData && NULL == aCacheItem->renderData && loadModelCacheData( aCacheItem ) )
+        return;
 
-    if( NULL != ep->sceneData )
-        saveCacheData( ep );
+    if( NULL == aCacheItem->sceneData )
+    {
+        wxString bname = aCacheItem->GetCacheBaseName();
+        wxString cachename = m_CacheDir + bname + wxT( ".3dc" );
 
-    return ep->sceneData;
+        if( !wxFileName::FileExists( cachename ) || !loadCacheData( aCacheItem ) )
+        {
+            aCacheItem->sceneData = m_Plugins->Load3DModel( aFileName, aCacheItem->pluginInfo );
+
+            if( NULL != aCacheItem->sceneData )
+                saveCacheData( aCacheItem );
+        }
+    }
+
+    if( aRenderData && NULL == aCacheItem->renderData && NULL != aCacheItem->sceneData )
+    {
+        aCacheItem->renderData = S3D::GetModel( aCacheItem->sceneData );
+
+        if( NULL != aCacheItem->renderData )
+            saveModelCacheData( aCacheItem );
+    }
 }
 
 
@@ -462,7 +507,9 @@ bool S3D_CACHE::loadCacheData( S3D_CACHE_ENTRY* aCacheItem )
     if( NULL != aCacheItem->sceneData )
         S3D::DestroyNode( (SGNODE*) aCacheItem->sceneData );
 
-    aCacheItem->sceneData = (SCENEGRAPH*)S3D::ReadCache( fname.ToUTF8(), m_Plugins, checkTag );
+    // the plugin tag of the scene data is kept for its render data cache file
+    aCacheItem->sceneData = (SCENEGRAPH*)S3D::ReadCache( fname.ToUTF8(), m_Plugins, checkTag,
+                                                         &aCacheItem->pluginInfo );
 
     if( NULL == aCacheItem->sceneData )
         return false;
@@ -471,6 +518,53 @@ bool S3D_CACHE::loadCacheData( S3D_CACHE_ENTRY* aCacheItem )
 }
 
 
+bool S3D_CACHE::loadModelCacheData( S3D_CACHE_ENTRY* aCacheItem )
+{
+    if( m_CacheDir.empty() )
+        return false;
+
+    wxString fname = m_CacheDir + aCacheItem->GetCacheBaseName() + wxT( ".3dr" );
+
+    if( !wxFileName::FileExists( fname ) )
+        return false;
+
+    aCacheItem->renderData = S3D::ReadModelCache( fname.ToUTF8(), m_Plugins, checkTag );
+
+    if( NULL == aCacheItem->renderData )
+    {
+        wxLogTrace( MASK_3D_CACHE, " * [3D model] ignoring render data cache file '%s'\n",
+            fname.GetData() );
+        return false;
+    }
+
+    return true;
+}
+
+
+bool S3D_CACHE::saveModelCacheData( S3D_CACHE_ENTRY* aCacheItem )
+{
+    // without the plugin tag, the file could not be invalidated by a newer plugin
+    if( m_CacheDir.empty() || NULL == aCacheItem->renderData || aCacheItem->pluginInfo.empty() )
+        return false;
+
+    wxString fname = m_CacheDir + aCacheItem->GetCacheBaseName() + wxT( ".3dr" );
+
+    if( wxFileName::Exists( fname ) && !wxFileName::FileExists( fname ) )
+    {
+        wxString errmsg = _( "path exists but is not a regular file" );
+        wxLogTrace( MASK_3D_CACHE, " * [3D model] %s '%s'\n", errmsg.GetData(),
+            fname.ToUTF8() );
+
+        return false;
+    }
+
+    wxCriticalSectionLocker lock( lock3D_cacheFile );
+
+    return S3D::WriteModelCache( fname.ToUTF8(), aCacheItem->renderData,
+        aCacheItem->pluginInfo.c_str() );
+}
+
+
 bool S3D_CACHE::saveCacheData( S3D_CACHE_ENTRY* aCacheItem )
 {
     if( NULL == aCacheItem )
@@ -534,6 +628,8 @@ bool S3D_CACHE::saveCacheData( S3D_CACHE_ENTRY* aCacheItem )
         }
     }
 
+    wxCriticalSectionLocker lock( lock3D_cacheFile );
+
     return S3D::WriteCache( fname.ToUTF8(), true, (SGNODE*)aCacheItem->sceneData,
         aCacheItem->pluginInfo.c_str() );
 }
@@ -781,7 +877,11 @@ void S3D_CACHE::ClosePlugins( void )
 S3DMODEL* S3D_CACHE::GetModel( const wxString& aModelFileName )
 {
     S3D_CACHE_ENTRY* cp = NULL;
-    SCENEGRAPH* sp = load( aModelFileName, &cp );
+    SCENEGRAPH* sp = load( aModelFileName, &cp, true );
+
+    // the render data may have been read from its cache file, without scene data
+    if( cp && cp->renderData )
+        return cp->renderData;
 
     if( !sp )
         return NULL;
@@ -810,6 +910,151 @@ S3DMODEL* S3D_CACHE::GetModel( const wxString& aModelFileName )
 }
 
 
+/**
+ * Runs aWork( i ) for each i in [0, aCount) on a pool of threads; meanwhile the calling
+ * thread reports the progress with aMessage (formatted with the number of items done and
+ * aCount).  When it is the thread of the user interface, the latter keeps processing its
+ * events, except the user input, between the reports.
+ */
+static void runParallel( size_t aCount, const std::function< void( size_t ) >& aWork,
+                         REPORTER* aReporter, const wxString& aMessage )
+{
+    if( aCount == 0 )
+        return;
+
+    std::atomic< size_t > next( 0 );
+    std::atomic< size_t > done( 0 );
+    size_t threadCount = std::min< size_t >( std::max( std::thread::hardware_concurrency(), 1u ),
+                                             aCount );
+    std::vector< std::thread > threads;
+
+    for( size_t i = 0; i < threadCount; ++i )
+    {
+        threads.push_back( std::thread( [&]()
+        {
+            for( size_t item = next++; item < aCount; item = next++ )
+            {
+                aWork( item );
+                ++done;
+            }
+        } ) );
+    }
+
+    bool yield = aReporter && wxTheApp && wxIsMainThread();
+    size_t reported = aCount + 1;
+
+    while( aReporter && reported != aCount )
+    {
+        size_t count = done;
+
+        if( count != reported )
+        {
+            aReporter->Report( wxString::Format( aMessage, (unsigned int) count,
+                                                 (unsigned int) aCount ) );
+            reported = count;
+        }
+
+        // wxSafeYield() disables the user input, so nothing can close the frame or
+        // change the board while the threads run
+        if( yield )
+            wxSafeYield( NULL, true );
+
+        if( reported != aCount )
+            std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    }
+
+    for( std::thread& thread : threads )
+        thread.join();
+}
+
+
+void S3D_CACHE::PreloadModels( const std::vector< wxString >& aModelFileNames,
+                               REPORTER* aReporter )
+{
+    // without a cache directory the models are not loaded (see checkCache())
+    if( m_CacheDir.empty() )
+        return;
+
+    struct PRELOAD_ITEM
+    {
+        wxString         fileName;
+        unsigned char    sha1sum[20];
+        bool             hashed;
+        S3D_CACHE_ENTRY* entry;
+    };
+
+    // the distinct files which are not in the cache yet
+    std::vector< PRELOAD_ITEM > items;
+    std::set< wxString > files;
+
+    for( const wxString& modelFileName : aModelFileNames )
+    {
+        wxString full3Dpath = m_FNResolver->ResolvePath( modelFileName );
+
+        if( full3Dpath.empty() || !files.insert( full3Dpath ).second )
+            continue;
+
+        wxCriticalSectionLocker lock( lock3D_cache );
+
+        if( m_CacheMap.find( full3Dpath ) != m_CacheMap.end() )
+            continue;
+
+        PRELOAD_ITEM item;
+        item.fileName = full3Dpath;
+        item.hashed = false;
+        item.entry = NULL;
+        items.push_back( item );
+    }
+
+    if( items.empty() )
+        return;
+
+    runParallel( items.size(), [&]( size_t aItem )
+    {
+        items[aItem].hashed = getSHA1( items[aItem].fileName, items[aItem].sha1sum );
+    }, aReporter, _( "Checking 3D models %u/%u" ) );
+
+    // the files which could not be hashed, or with the same content as a previous one,
+    // are left to GetModel(): the latter will find the cache file of the first one
+    std::vector< size_t > loads;
+    std::set< wxString > hashes;
+
+    for( size_t i = 0; i < items.size(); ++i )
+    {
+        if( items[i].hashed && hashes.insert( sha1ToWXString( items[i].sha1sum ) ).second )
+            loads.push_back( i );
+    }
+
+    runParallel( loads.size(), [&]( size_t aLoad )
+    {
+        PRELOAD_ITEM& item = items[loads[aLoad]];
+        S3D_CACHE_ENTRY* ep = new S3D_CACHE_ENTRY;
+
+        ep->modTime = wxFileName( item.fileName ).GetModificationTime();
+        ep->SetSHA1( item.sha1sum );
+        loadEntry( item.fileName, ep, true );
+        item.entry = ep;
+    }, aReporter, _( "Loading 3D models %u/%u" ) );
+
+    wxCriticalSectionLocker lock( lock3D_cache );
+
+    for( size_t i : loads )
+    {
+        S3D_CACHE_ENTRY* ep = items[i].entry;
+
+        if( m_CacheMap.insert( std::pair< wxString, S3D_CACHE_ENTRY* >
+                                   ( items[i].fileName, ep ) ).second == false )
+        {
+            // loaded meanwhile by another thread
+            delete ep;
+            continue;
+        }
+
+        m_CacheList.push_back( ep );
+    }
+}
+
+
 wxString S3D_CACHE::GetModelHash( const wxString& aModelFileName )
 {
     wxString full3Dpath = m_FNResolver->ResolvePath( aModelFileName );
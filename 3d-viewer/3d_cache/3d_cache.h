@@ -31,6 +31,7 @@
 
 #include <list>
 #include <map>
+#include <vector>
 #include <wx/string.h>
 #include "str_rsort.h"
 #include "3d_filename_resolver.h"
@@ -39,6 +40,7 @@
 
 
 class  PGM_BASE;
+class  REPORTER;
 class  S3D_CACHE;
 class  S3D_CACHE_ENTRY;
 class  SCENEGRAPH;
@@ -81,10 +83,12 @@ private:
      *
      * @param[in]   aFileName   file name (full or partial path)
      * @param[out]  aCachePtr   optional return address for cache entry pointer
+     * @param[in]   aRenderData true to load the render data of the entry, see loadEntry()
      * @return      SCENEGRAPH object associated with file name
-     * @retval      NULL    on error
+     * @retval      NULL    on error, or if only the render data was loaded
      */
-    SCENEGRAPH* checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr = NULL );
+    SCENEGRAPH* checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr = NULL,
+                            bool aRenderData = false );
 
     /**
      * Function getSHA1
@@ -103,8 +107,29 @@ private:
     // save scene data to a cache file
     bool saveCacheData( S3D_CACHE_ENTRY* aCacheItem );
 
+    // load render data from a render data cache file
+    bool loadModelCacheData( S3D_CACHE_ENTRY* aCacheItem );
+
+    // save render data to a render data cache file
+    bool saveModelCacheData( S3D_CACHE_ENTRY* aCacheItem );
+
+    /**
+     * Function loadEntry
+     * loads the scene data of a cache entry with a SHA1 hash, from its cache file
+     * if it exists, else with the plugins, and saves it to the cache. It does not
+     * use the cache map, and may be run by several threads on different entries.
+     *
+     * @param[in]   aFileName   file name (full path)
+     * @param[in]   aRenderData true to load the render data instead: it is read from
+     * its own cache file if it exists, without building the scene data, else it is
+     * made from the scene data and saved to that file
+     */
+    void loadEntry( const wxString& aFileName, S3D_CACHE_ENTRY* aCacheItem,
+                    bool aRenderData = false );
+
     // the real load function (can supply a cache entry pointer to member functions)
-    SCENEGRAPH* load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr = NULL );
+    SCENEGRAPH* load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr = NULL,
+                      bool aRenderData = false );
 
 public:
     S3D_CACHE();
@@ -200,6 +225,25 @@ public:
      */
     S3DMODEL* GetModel( const wxString& aModelFileName );
 
+    /**
+     * Function PreloadModels
+     * loads the render data of the models not in the cache yet, so that
+     * the following calls to GetModel() find them.  A pool of threads hashes the
+     * distinct files and reads their cache files; a file is loaded once, even if it is
+     * listed several times or has the same content as another file.  The files without a
+     * cache file are parsed by their plugins one at a time (the plugin manager serializes
+     * them with its m_PluginLock), so only the hashing and the cache reads are concurrent.
+     *
+     * @param aModelFileNames is the list of models (full or partial paths)
+     * @param aReporter is an optional reporter of the progress; it is only
+     * called by the calling thread.  When the latter is the thread of the user interface,
+     * the pending events (except the user input) are processed between the reports, so
+     * the caller must not hold a lock that a paint handler takes, such as the OpenGL
+     * context.
+     */
+    void PreloadModels( const std::vector< wxString >& aModelFileNames,
+                        REPORTER* aReporter = NULL );
+
     wxString GetModelHash( const wxString& aModelFileName );
 };
 
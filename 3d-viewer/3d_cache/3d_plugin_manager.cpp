@@ -499,6 +499,8 @@ SCENEGRAPH* S3D_PLUGIN_MANAGER::Load3DModel( const wxString& aFileName, std::str
     std::pair < std::multimap< const wxString, KICAD_PLUGIN_LDR_3D* >::iterator,
         std::multimap< const wxString, KICAD_PLUGIN_LDR_3D* >::iterator > items;
 
+    wxCriticalSectionLocker lock( m_PluginLock );
+
     items = m_ExtMap.equal_range( ext );
     std::multimap< const wxString, KICAD_PLUGIN_LDR_3D* >::iterator sL = items.first;
 
@@ -536,6 +538,8 @@ void S3D_PLUGIN_MANAGER::ClosePlugins( void )
     } while( 0 );
     #endif
 
+    wxCriticalSectionLocker lock( m_PluginLock );
+
     while( sP != eP )
     {
         (*sP)->Close();
@@ -563,6 +567,8 @@ bool S3D_PLUGIN_MANAGER::CheckTag( const char* aTag )
     pname = tname.substr( 0, cpos );
     std::string ptag;   // tag from the plugin
 
+    wxCriticalSectionLocker lock( m_PluginLock );
+
     std::list< KICAD_PLUGIN_LDR_3D* >::iterator pS = m_Plugins.begin();
     std::list< KICAD_PLUGIN_LDR_3D* >::iterator pE = m_Plugins.end();
 
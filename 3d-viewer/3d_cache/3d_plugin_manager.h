@@ -33,6 +33,7 @@
 #include <list>
 #include <string>
 #include <wx/string.h>
+#include <wx/thread.h>
 
 class wxWindow;
 class KICAD_PLUGIN_LDR_3D;
@@ -50,6 +51,10 @@ private:
     /// list of file filters
     std::list< wxString > m_FileFilters;
 
+    /// the plugins are used by one thread at a time: they are not reentrant and
+    /// change the process locale while parsing a model
+    wxCriticalSection m_PluginLock;
+
     /// load plugins
     void loadPlugins( void );
 
@@ -82,6 +87,12 @@ public:
      */
     std::list< wxString > const* GetFileFilters( void ) const;
 
+    /**
+     * Function Load3DModel
+     * loads a model with the first plugin supporting its extension which can
+     * render it; it may be called from any thread, the models are parsed one
+     * at a time
+     */
     SCENEGRAPH* Load3DModel( const wxString& aFileName, std::string& aPluginInfo );
 
     /**
@@ -21,9 +21,12 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <vector>
 #include <wx/filename.h>
 #include <wx/log.h>
 #include "plugins/3dapi/ifsg_api.h"
@@ -43,6 +46,80 @@ static char BadNode[] = " * [BUG] NULL pointer passed for aNode\n";
 // version format of the cache file
 #define SG_VERSION_TAG "VERSION:2"
 
+// identification and version format of the render data cache file
+#define SG_MODEL_CACHE_MAGIC "KI3DMDL"
+#define SG_MODEL_CACHE_VERSION 1
+
+// written in the native byte order; a file from a machine with another one is rejected
+static const uint32_t MODEL_CACHE_BYTE_ORDER = 0x01020304;
+
+// alignment of each section and array in the render data cache file
+static const uint64_t MODEL_CACHE_ALIGN = 16;
+
+// a SMATERIAL is stored as 4 colors, the shininess and the transparency
+static const size_t MODEL_CACHE_MATERIAL_FLOATS = 14;
+
+// flags of the optional arrays of a mesh
+static const uint32_t MODEL_CACHE_NORMALS = 1;
+static const uint32_t MODEL_CACHE_TEXCOORDS = 2;
+static const uint32_t MODEL_CACHE_COLORS = 4;
+
+
+/**
+ * Render data cache file layout: the header, the plugin info string, the materials, the
+ * mesh table, then the arrays of each mesh.  All the offsets are from the start of the
+ * file, and each section and array starts at a multiple of MODEL_CACHE_ALIGN, so the
+ * file can be used as is once read or mapped in memory.
+ */
+struct MODEL_CACHE_HEADER
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t fileSize;          ///< catches the truncated files
+    uint32_t pluginInfoSize;    ///< the string follows the header, without terminating NUL
+    uint32_t materialsCount;
+    uint32_t meshesCount;
+    uint32_t reserved;
+    uint64_t materialsOffset;
+    uint64_t meshesOffset;      ///< table of MODEL_CACHE_MESH
+};
+
+
+struct MODEL_CACHE_MESH
+{
+    uint32_t vertexSize;
+    uint32_t faceIdxSize;
+    uint32_t materialIdx;
+    uint32_t flags;             ///< MODEL_CACHE_NORMALS, MODEL_CACHE_TEXCOORDS, ...
+    uint64_t positions;
+    uint64_t normals;
+    uint64_t texcoords;
+    uint64_t colors;
+    uint64_t faceIdx;
+};
+
+
+static_assert( sizeof( MODEL_CACHE_HEADER ) == 56, "unexpected MODEL_CACHE_HEADER padding" );
+static_assert( sizeof( MODEL_CACHE_MESH ) == 56, "unexpected MODEL_CACHE_MESH padding" );
+static_assert( sizeof( SFVEC3F ) == 3 * sizeof( float ), "SFVEC3F is not 3 floats" );
+static_assert( sizeof( SFVEC2F ) == 2 * sizeof( float ), "SFVEC2F is not 2 floats" );
+
+
+static uint64_t alignCacheOffset( uint64_t aOffset )
+{
+    return ( aOffset + MODEL_CACHE_ALIGN - 1 ) & ~( MODEL_CACHE_ALIGN - 1 );
+}
+
+
+// returns true if aCount items of aItemSize bytes at aOffset are within the file
+static bool inCacheFile( uint64_t aOffset, uint64_t aCount, uint64_t aItemSize,
+    uint64_t aFileSize )
+{
+    return aOffset % MODEL_CACHE_ALIGN == 0 && aOffset <= aFileSize
+           && aCount <= ( aFileSize - aOffset ) / aItemSize;
+}
+
 
 static void formatMaterial( SMATERIAL& mat, SGAPPEARANCE const* app )
 {
@@ -319,7 +396,7 @@ bool S3D::WriteCache( const char* aFileName, bool overwrite, SGNODE* aNode,
 
 
 SGNODE* S3D::ReadCache( const char* aFileName, void* aPluginMgr,
-        bool (*aTagCheck)( const char*, void* ) )
+        bool (*aTagCheck)( const char*, void* ), std::string* aPluginInfo )
 {
     if( NULL == aFileName || aFileName[0] == 0 )
         return NULL;
@@ -447,6 +524,9 @@ SGNODE* S3D::ReadCache( const char* aFileName, void* aPluginMgr,
             return NULL;
         }
 
+        if( NULL != aPluginInfo )
+            *aPluginInfo = name;
+
     } while( 0 );
 
     bool rval = np->ReadCache( file, NULL );
@@ -468,6 +548,326 @@ SGNODE* S3D::ReadCache( const char* aFileName, void* aPluginMgr,
 }
 
 
+bool S3D::WriteModelCache( const char* aFileName, const S3DMODEL* aModel,
+    const char* aPluginInfo )
+{
+    // the plugin tag is checked on reading, so a file without it could never be read back
+    if( NULL == aFileName || aFileName[0] == 0 || NULL == aModel
+        || NULL == aPluginInfo || aPluginInfo[0] == 0 )
+        return false;
+
+    std::string pluginInfo( aPluginInfo );
+
+    MODEL_CACHE_HEADER header;
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.magic, SG_MODEL_CACHE_MAGIC, sizeof( header.magic ) );
+    header.version = SG_MODEL_CACHE_VERSION;
+    header.byteOrder = MODEL_CACHE_BYTE_ORDER;
+    header.pluginInfoSize = pluginInfo.size();
+    header.materialsCount = aModel->m_MaterialsSize;
+    header.meshesCount = aModel->m_MeshesSize;
+
+    // lay out the file
+    uint64_t offset = alignCacheOffset( sizeof( header ) + pluginInfo.size() );
+    header.materialsOffset = offset;
+    offset = alignCacheOffset( offset + header.materialsCount * MODEL_CACHE_MATERIAL_FLOATS
+                                        * sizeof( float ) );
+    header.meshesOffset = offset;
+    offset = alignCacheOffset( offset + header.meshesCount * sizeof( MODEL_CACHE_MESH ) );
+
+    std::vector< MODEL_CACHE_MESH > meshes( aModel->m_MeshesSize );
+
+    for( unsigned int i = 0; i < aModel->m_MeshesSize; ++i )
+    {
+        const SMESH& mesh = aModel->m_Meshes[i];
+        MODEL_CACHE_MESH& rec = meshes[i];
+
+        if( NULL == mesh.m_Positions || NULL == mesh.m_FaceIdx )
+            return false;
+
+        memset( &rec, 0, sizeof( rec ) );
+        rec.vertexSize = mesh.m_VertexSize;
+        rec.faceIdxSize = mesh.m_FaceIdxSize;
+        rec.materialIdx = mesh.m_MaterialIdx;
+
+        rec.positions = offset;
+        offset = alignCacheOffset( offset + (uint64_t) mesh.m_VertexSize * sizeof( SFVEC3F ) );
+
+        if( NULL != mesh.m_Normals )
+        {
+            rec.flags |= MODEL_CACHE_NORMALS;
+            rec.normals = offset;
+            offset = alignCacheOffset( offset + (uint64_t) mesh.m_VertexSize * sizeof( SFVEC3F ) );
+        }
+
+        if( NULL != mesh.m_Texcoords )
+        {
+            rec.flags |= MODEL_CACHE_TEXCOORDS;
+            rec.texcoords = offset;
+            offset = alignCacheOffset( offset + (uint64_t) mesh.m_VertexSize * sizeof( SFVEC2F ) );
+        }
+
+        if( NULL != mesh.m_Color )
+        {
+            rec.flags |= MODEL_CACHE_COLORS;
+            rec.colors = offset;
+            offset = alignCacheOffset( offset + (uint64_t) mesh.m_VertexSize * sizeof( SFVEC3F ) );
+        }
+
+        rec.faceIdx = offset;
+        offset = alignCacheOffset( offset
+                                   + (uint64_t) mesh.m_FaceIdxSize * sizeof( unsigned int ) );
+    }
+
+    header.fileSize = offset;
+
+    // fill the file image, and write it at once
+    std::vector< char > data( offset, 0 );
+
+    memcpy( &data[0], &header, sizeof( header ) );
+    memcpy( &data[sizeof( header )], pluginInfo.data(), pluginInfo.size() );
+
+    for( unsigned int i = 0; i < aModel->m_MaterialsSize; ++i )
+    {
+        const SMATERIAL& mat = aModel->m_Materials[i];
+        float v[MODEL_CACHE_MATERIAL_FLOATS] =
+        {
+            mat.m_Ambient.x, mat.m_Ambient.y, mat.m_Ambient.z,
+            mat.m_Diffuse.x, mat.m_Diffuse.y, mat.m_Diffuse.z,
+            mat.m_Emissive.x, mat.m_Emissive.y, mat.m_Emissive.z,
+            mat.m_Specular.x, mat.m_Specular.y, mat.m_Specular.z,
+            mat.m_Shininess, mat.m_Transparency
+        };
+
+        memcpy( &data[header.materialsOffset + i * sizeof( v )], v, sizeof( v ) );
+    }
+
+    if( !meshes.empty() )
+    {
+        memcpy( &data[header.meshesOffset], &meshes[0],
+                meshes.size() * sizeof( MODEL_CACHE_MESH ) );
+    }
+
+    for( unsigned int i = 0; i < aModel->m_MeshesSize; ++i )
+    {
+        const SMESH& mesh = aModel->m_Meshes[i];
+        const MODEL_CACHE_MESH& rec = meshes[i];
+
+        memcpy( &data[rec.positions], mesh.m_Positions, mesh.m_VertexSize * sizeof( SFVEC3F ) );
+
+        if( rec.flags & MODEL_CACHE_NORMALS )
+            memcpy( &data[rec.normals], mesh.m_Normals, mesh.m_VertexSize * sizeof( SFVEC3F ) );
+
+        if( rec.flags & MODEL_CACHE_TEXCOORDS )
+            memcpy( &data[rec.texcoords], mesh.m_Texcoords, mesh.m_VertexSize * sizeof( SFVEC2F ) );
+
+        if( rec.flags & MODEL_CACHE_COLORS )
+            memcpy( &data[rec.colors], mesh.m_Color, mesh.m_VertexSize * sizeof( SFVEC3F ) );
+
+        memcpy( &data[rec.faceIdx], mesh.m_FaceIdx, mesh.m_FaceIdxSize * sizeof( unsigned int ) );
+    }
+
+    OPEN_OSTREAM( output, aFileName );
+
+    if( output.fail() )
+    {
+        wxString errmsg;
+        errmsg << __FILE__ << ": " << __FUNCTION__ << ": " << __LINE__ << "\n";
+        errmsg << " * [INFO] " << "failed to open file" << " '" << aFileName << "'";
+        wxLogTrace( MASK_3D_SG, errmsg );
+        return false;
+    }
+
+    output.write( &data[0], data.size() );
+    bool rval = !output.fail();
+    CLOSE_STREAM( output );
+
+    if( !rval )
+    {
+        #ifdef DEBUG
+        do {
+            std::ostringstream ostr;
+            ostr << __FILE__ << ": " << __FUNCTION__ << ": " << __LINE__ << "\n";
+            ostr << " * [INFO] problems encountered writing cache file '";
+            ostr << aFileName << "'";
+            wxLogTrace( MASK_3D_SG, "%s\n", ostr.str().c_str() );
+        } while( 0 );
+        #endif
+
+        // delete the defective file
+        wxRemoveFile( wxString::FromUTF8Unchecked( aFileName ) );
+    }
+
+    return rval;
+}
+
+
+S3DMODEL* S3D::ReadModelCache( const char* aFileName, void* aPluginMgr,
+        bool (*aTagCheck)( const char*, void* ) )
+{
+    if( NULL == aFileName || aFileName[0] == 0 )
+        return NULL;
+
+    if( !wxFileName::FileExists( aFileName ) )
+        return NULL;
+
+    OPEN_ISTREAM( file, aFileName );
+
+    if( file.fail() )
+    {
+        std::ostringstream ostr;
+        ostr << __FILE__ << ": " << __FUNCTION__ << ": " << __LINE__ << "\n";
+        wxString errmsg = _( "failed to open file" );
+        ostr << " * [INFO] " << errmsg.ToUTF8() << " '";
+        ostr << aFileName << "'";
+        wxLogTrace( MASK_3D_SG, "%s\n", ostr.str().c_str() );
+        return NULL;
+    }
+
+    // check the header against the actual size of the file before reading the rest
+    MODEL_CACHE_HEADER header;
+    file.seekg( 0, std::ios_base::end );
+    uint64_t fileSize = file.tellg();
+    file.seekg( 0, std::ios_base::beg );
+    file.read( (char*) &header, sizeof( header ) );
+
+    if( file.fail() || memcmp( header.magic, SG_MODEL_CACHE_MAGIC, sizeof( header.magic ) )
+        || header.version != SG_MODEL_CACHE_VERSION
+        || header.byteOrder != MODEL_CACHE_BYTE_ORDER
+        || header.fileSize != fileSize )
+    {
+        CLOSE_STREAM( file );
+        return NULL;
+    }
+
+    std::vector< char > data( fileSize );
+    memcpy( &data[0], &header, sizeof( header ) );
+    file.read( &data[0] + sizeof( header ), fileSize - sizeof( header ) );
+    bool readFailed = file.fail();
+    CLOSE_STREAM( file );
+
+    if( readFailed
+        || header.pluginInfoSize > fileSize - sizeof( header )
+        || !inCacheFile( header.materialsOffset, header.materialsCount,
+                         MODEL_CACHE_MATERIAL_FLOATS * sizeof( float ), fileSize )
+        || !inCacheFile( header.meshesOffset, header.meshesCount,
+                         sizeof( MODEL_CACHE_MESH ), fileSize )
+        || header.meshesCount == 0 )
+    {
+        wxLogTrace( MASK_3D_SG, "%s:%s:%d * [INFO] corrupt render data cache file '%s'\n",
+                    __FILE__, __FUNCTION__, __LINE__, aFileName );
+        return NULL;
+    }
+
+    // check the plugin tag
+    std::string pluginInfo( &data[0] + sizeof( header ), header.pluginInfoSize );
+
+    if( NULL != aTagCheck && NULL != aPluginMgr && !aTagCheck( pluginInfo.c_str(), aPluginMgr ) )
+        return NULL;
+
+    S3DMODEL* model = S3D::New3DModel();
+
+    model->m_MaterialsSize = header.materialsCount;
+    model->m_Materials = new SMATERIAL[header.materialsCount];
+
+    for( unsigned int i = 0; i < header.materialsCount; ++i )
+    {
+        SMATERIAL& mat = model->m_Materials[i];
+        float v[MODEL_CACHE_MATERIAL_FLOATS];
+
+        memcpy( v, &data[header.materialsOffset + i * sizeof( v )], sizeof( v ) );
+        mat.m_Ambient = SFVEC3F( v[0], v[1], v[2] );
+        mat.m_Diffuse = SFVEC3F( v[3], v[4], v[5] );
+        mat.m_Emissive = SFVEC3F( v[6], v[7], v[8] );
+        mat.m_Specular = SFVEC3F( v[9], v[10], v[11] );
+        mat.m_Shininess = v[12];
+        mat.m_Transparency = v[13];
+    }
+
+    // the meshes are all initialized first, so a partially read model can be destroyed
+    model->m_MeshesSize = header.meshesCount;
+    model->m_Meshes = new SMESH[header.meshesCount];
+
+    for( unsigned int i = 0; i < header.meshesCount; ++i )
+        S3D::INIT_SMESH( model->m_Meshes[i] );
+
+    for( unsigned int i = 0; i < header.meshesCount; ++i )
+    {
+        MODEL_CACHE_MESH rec;
+        memcpy( &rec, &data[header.meshesOffset + i * sizeof( rec )], sizeof( rec ) );
+
+        uint32_t vs = rec.vertexSize;
+        bool valid = vs > 0 && rec.faceIdxSize > 0 && rec.faceIdxSize % 3 == 0
+                     && rec.materialIdx < header.materialsCount
+                     && inCacheFile( rec.positions, vs, sizeof( SFVEC3F ), fileSize )
+                     && inCacheFile( rec.faceIdx, rec.faceIdxSize, sizeof( unsigned int ),
+                                     fileSize );
+
+        if( valid && ( rec.flags & MODEL_CACHE_NORMALS ) )
+            valid = inCacheFile( rec.normals, vs, sizeof( SFVEC3F ), fileSize );
+
+        if( valid && ( rec.flags & MODEL_CACHE_TEXCOORDS ) )
+            valid = inCacheFile( rec.texcoords, vs, sizeof( SFVEC2F ), fileSize );
+
+        if( valid && ( rec.flags & MODEL_CACHE_COLORS ) )
+            valid = inCacheFile( rec.colors, vs, sizeof( SFVEC3F ), fileSize );
+
+        if( !valid )
+        {
+            wxLogTrace( MASK_3D_SG, "%s:%s:%d * [INFO] corrupt mesh in render data cache '%s'\n",
+                        __FILE__, __FUNCTION__, __LINE__, aFileName );
+            S3D::Destroy3DModel( &model );
+            return NULL;
+        }
+
+        // S3DMODEL owns its arrays, so they are copied out of the file image
+        SMESH& mesh = model->m_Meshes[i];
+        mesh.m_VertexSize = vs;
+        mesh.m_MaterialIdx = rec.materialIdx;
+        mesh.m_FaceIdxSize = rec.faceIdxSize;
+
+        mesh.m_Positions = new SFVEC3F[vs];
+        memcpy( mesh.m_Positions, &data[rec.positions], vs * sizeof( SFVEC3F ) );
+
+        if( rec.flags & MODEL_CACHE_NORMALS )
+        {
+            mesh.m_Normals = new SFVEC3F[vs];
+            memcpy( mesh.m_Normals, &data[rec.normals], vs * sizeof( SFVEC3F ) );
+        }
+
+        if( rec.flags & MODEL_CACHE_TEXCOORDS )
+        {
+            mesh.m_Texcoords = new SFVEC2F[vs];
+            memcpy( mesh.m_Texcoords, &data[rec.texcoords], vs * sizeof( SFVEC2F ) );
+        }
+
+        if( rec.flags & MODEL_CACHE_COLORS )
+        {
+            mesh.m_Color = new SFVEC3F[vs];
+            memcpy( mesh.m_Color, &data[rec.colors], vs * sizeof( SFVEC3F ) );
+        }
+
+        mesh.m_FaceIdx = new unsigned int[rec.faceIdxSize];
+        memcpy( mesh.m_FaceIdx, &data[rec.faceIdx], rec.faceIdxSize * sizeof( unsigned int ) );
+
+        // the renderers index the arrays without checking
+        for( unsigned int j = 0; j < rec.faceIdxSize; ++j )
+        {
+            if( mesh.m_FaceIdx[j] >= vs )
+            {
+                wxLogTrace( MASK_3D_SG,
+                            "%s:%s:%d * [INFO] bad index in render data cache file '%s'\n",
+                            __FILE__, __FUNCTION__, __LINE__, aFileName );
+                S3D::Destroy3DModel( &model );
+                return NULL;
+            }
+        }
+    }
+
+    return model;
+}
+
+
 S3DMODEL* S3D::GetModel( SCENEGRAPH* aNode )
 {
     if( NULL == aNode )
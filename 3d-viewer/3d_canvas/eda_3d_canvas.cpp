@@ -128,6 +128,7 @@ EDA_3D_CANVAS::EDA_3D_CANVAS( wxWindow *aParent,
     m_strtime_camera_movement = 0;
 
     m_is_opengl_initialized = false;
+    m_is_currently_painting = false;
 
     m_render_raytracing_was_requested = false;
 
@@ -295,6 +296,12 @@ void EDA_3D_CANVAS::OnPaint( wxPaintEvent &event )
     if( !GetParent()->GetParent()->IsShown() )
         return; // The parent board editor frame is no more alive
 
+    // The events processed while the 3D models load can include a paint event
+    if( m_is_currently_painting )
+        return;
+
+    m_is_currently_painting = true;
+
     wxString err_messages;
 
     // !TODO: implement error reporter
@@ -304,6 +311,9 @@ void EDA_3D_CANVAS::OnPaint( wxPaintEvent &event )
 
     unsigned strtime = GetRunningMicroSecs();
 
+    if( m_3d_render && m_3d_render->IsReloadRequestPending() )
+        preload3DModels( &activityReporter );
+
     // "Makes the OpenGL state that is represented by the OpenGL rendering
     //  context context current, i.e. it will be used by all subsequent OpenGL calls.
     //  This function may only be called when the window is shown on screen"
@@ -332,6 +342,7 @@ void EDA_3D_CANVAS::OnPaint( wxPaintEvent &event )
         if( !initializeOpenGL() )
         {
             GL_CONTEXT_MANAGER::Get().UnlockCtx( m_glRC );
+            m_is_currently_painting = false;
 
             return;
         }
@@ -420,6 +431,8 @@ void EDA_3D_CANVAS::OnPaint( wxPaintEvent &event )
     // This will reset the flag of camera parameters changed
     m_settings.CameraGet().ParametersChanged();
 
+    m_is_currently_painting = false;
+
     if( !err_messages.IsEmpty() )
         wxLogMessage( err_messages );
 
@@ -431,6 +444,32 @@ void EDA_3D_CANVAS::OnPaint( wxPaintEvent &event )
 }
 
 
+void EDA_3D_CANVAS::preload3DModels( REPORTER *aStatusTextReporter )
+{
+    S3D_CACHE *cacheManager = m_settings.Get3DCacheManager();
+
+    if( !cacheManager || !m_settings.GetBoard() )
+        return;
+
+    // The models of all the modules, a superset of the ones each render loads: the
+    // render finds them in the cache, and its own preload returns at once
+    std::vector< wxString > modelFiles;
+
+    for( const MODULE* module = m_settings.GetBoard()->m_Modules;
+         module;
+         module = module->Next() )
+    {
+        for( const auto& model : module->Models() )
+        {
+            if( !model.m_Filename.empty() )
+                modelFiles.push_back( model.m_Filename );
+        }
+    }
+
+    cacheManager->PreloadModels( modelFiles, aStatusTextReporter );
+}
+
+
 void EDA_3D_CANVAS::OnEraseBackground( wxEraseEvent &event )
 {
     wxLogTrace( m_logTrace, wxT( "EDA_3D_CANVAS::OnEraseBackground" ) );
@@ -213,6 +213,14 @@ class EDA_3D_CANVAS : public HIDPI_GL_CANVAS
      */
     void releaseOpenGL();
 
+    /**
+     * @brief preload3DModels - load the 3D models of the board into the cache before
+     * a reload, while the OpenGL context is not locked: the cache processes the pending
+     * events during the load, and the other canvases lock the context to paint
+     * @param aStatusTextReporter: the reporter of the progress
+     */
+    void preload3DModels( REPORTER *aStatusTextReporter );
+
  private:
 
     /// current OpenGL context
@@ -262,6 +270,9 @@ class EDA_3D_CANVAS : public HIDPI_GL_CANVAS
     /// Flag to store if opengl was initialized already
     bool m_is_opengl_initialized;
 
+    /// true while OnPaint() runs, which may process the pending events (see preload3DModels())
+    bool m_is_currently_painting;
+
     /// Step factor to used with cursor on relation to the current zoom
     static const float m_delta_move_step_factor;
 
@@ -642,7 +642,7 @@ void C3D_RENDER_OGL_LEGACY::reload( REPORTER *aStatusTextReporter )
     if( aStatusTextReporter )
         aStatusTextReporter->Report( _( "Loading 3D models" ) );
 
-    load_3D_models();
+    load_3D_models( aStatusTextReporter );
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_end_models_Load_Time = GetRunningMicroSecs();
@@ -921,13 +921,31 @@ void C3D_RENDER_OGL_LEGACY::generate_3D_Vias_and_Pads()
  * cache for this render. (cache based on C_OGL_3DMODEL with associated
  * openGL lists in GPU memory)
  */
-void C3D_RENDER_OGL_LEGACY::load_3D_models()
+void C3D_RENDER_OGL_LEGACY::load_3D_models( REPORTER *aStatusTextReporter )
 {
     if( (!m_settings.GetFlag( FL_MODULE_ATTRIBUTES_NORMAL )) &&
         (!m_settings.GetFlag( FL_MODULE_ATTRIBUTES_NORMAL_INSERT )) &&
         (!m_settings.GetFlag( FL_MODULE_ATTRIBUTES_VIRTUAL )) )
         return;
 
+    // Load the models missing in our map at once, so distinct files are loaded
+    // concurrently by the cache
+    std::vector< wxString > modelFiles;
+
+    for( const MODULE* module = m_settings.GetBoard()->m_Modules;
+         module;
+         module = module->Next() )
+    {
+        for( const auto& model : module->Models() )
+        {
+            if( !model.m_Filename.empty() &&
+                ( m_3dmodel_map.find( model.m_Filename ) == m_3dmodel_map.end() ) )
+                modelFiles.push_back( model.m_Filename );
+        }
+    }
+
+    m_settings.Get3DCacheManager()->PreloadModels( modelFiles, aStatusTextReporter );
+
     // Go for all modules
     for( const MODULE* module = m_settings.GetBoard()->m_Modules;
          module;
@@ -28,11 +28,13 @@
  */
 
 #include "cbvh_pbrt.h"
+#include "../shapes3D/ctriangle.h"
+#include <cfloat>
 #include <wx/debug.h>
 
-
-#define BVH_RANGED_TRAVERSAL
-//#define BVH_PARTITION_TRAVERSAL
+#ifdef RAYPACKET_SSE2
+#include <emmintrin.h>
+#endif
 
 
 #define MAX_TODOS 64
@@ -45,242 +47,263 @@ struct StackNode
 };
 
 
-static inline unsigned int getFirstHit( const RAYPACKET &aRayPacket,
-                                        const CBBOX &aBBox,
-                                        unsigned int ia,
-                                        HITINFO_PACKET *aHitInfoPacket )
+/**
+ * Tests the 4 rays of aRays from aFirst against the aChild-th child of aNode, with the
+ * same padded slab test as the single ray traversal.
+ * @return the mask of the rays hitting the child closer than their aTHit
+ */
+static inline unsigned int intersectRays4( const LinearBVH4Node &aNode,
+                                           unsigned int aChild,
+                                           const RAYPACKET_SOA &aRays,
+                                           unsigned int aFirst,
+                                           const float *aTHit )
 {
-    float hitT;
+    const float *org[3] = { &aRays.m_orgX[aFirst], &aRays.m_orgY[aFirst],
+                            &aRays.m_orgZ[aFirst] };
+    const float *invDir[3] = { &aRays.m_invDirX[aFirst], &aRays.m_invDirY[aFirst],
+                               &aRays.m_invDirZ[aFirst] };
 
-    if( aBBox.Intersect( aRayPacket.m_ray[ia], &hitT ) )
-        if( hitT < aHitInfoPacket[ia].m_HitInfo.m_tHit )
-            return ia;
-
-    if( !aRayPacket.m_Frustum.Intersect( aBBox ) )
-        return RAYPACKET_RAYS_PER_PACKET;
+#ifdef RAYPACKET_SSE2
+    __m128 tEntry = _mm_set1_ps( -FLT_MAX );
+    __m128 tFar = _mm_set1_ps( FLT_MAX );
 
-    for( unsigned int i = ia + 1; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+    for( unsigned int axis = 0; axis < 3; ++axis )
     {
-        if( aBBox.Intersect( aRayPacket.m_ray[i], &hitT ) )
-            if( hitT < aHitInfoPacket[i].m_HitInfo.m_tHit )
-                return i;
+        const __m128 o = _mm_load_ps( org[axis] );
+        const __m128 inv = _mm_load_ps( invDir[axis] );
+        const __m128 t0 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( aNode.bounds[axis][aChild] ),
+                                                  o ),
+                                      inv );
+        const __m128 t1 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( aNode.bounds[axis + 3][aChild] ),
+                                                  o ),
+                                      inv );
+
+        tEntry = _mm_max_ps( tEntry, _mm_min_ps( t0, t1 ) );
+        tFar = _mm_min_ps( tFar, _mm_max_ps( t0, t1 ) );
     }
 
-    return RAYPACKET_RAYS_PER_PACKET;
-}
+    const __m128 tNear = _mm_max_ps( tEntry, _mm_setzero_ps() );
 
+    tFar = _mm_mul_ps( tFar, _mm_set1_ps( 1.0000004f ) );
 
-#ifdef BVH_RANGED_TRAVERSAL
+    const __m128 hit = _mm_and_ps( _mm_cmpge_ps( tFar, tNear ),
+                                   _mm_cmplt_ps( tEntry, _mm_load_ps( &aTHit[aFirst] ) ) );
 
-static inline unsigned int getLastHit( const RAYPACKET &aRayPacket,
-                                       const CBBOX &aBBox,
-                                       unsigned int ia,
-                                       HITINFO_PACKET *aHitInfoPacket )
-{
-    for( unsigned int ie = (RAYPACKET_RAYS_PER_PACKET - 1); ie > ia; --ie )
+    return _mm_movemask_ps( hit );
+#else
+    unsigned int mask = 0;
+
+    for( unsigned int i = 0; i < 4; ++i )
     {
-        float hitT;
+        float tEntry = -FLT_MAX;
+        float tFar = FLT_MAX;
+
+        for( unsigned int axis = 0; axis < 3; ++axis )
+        {
+            const float t0 = (aNode.bounds[axis][aChild] - org[axis][i]) * invDir[axis][i];
+            const float t1 = (aNode.bounds[axis + 3][aChild] - org[axis][i]) * invDir[axis][i];
 
-        if( aBBox.Intersect( aRayPacket.m_ray[ie], &hitT ) )
-            if( hitT < aHitInfoPacket[ie].m_HitInfo.m_tHit )
-                return ie + 1;
+            tEntry = glm::max( tEntry, glm::min( t0, t1 ) );
+            tFar = glm::min( tFar, glm::max( t0, t1 ) );
+        }
+
+        if( ( tFar * 1.0000004f >= glm::max( tEntry, 0.0f ) ) && ( tEntry < aTHit[aFirst + i] ) )
+            mask |= 1 << i;
     }
 
-    return ia + 1;
+    return mask;
+#endif
 }
 
 
-// "Large Ray Packets for Real-time Whitted Ray Tracing"
-// http://cseweb.ucsd.edu/~ravir/whitted.pdf
-
-// Ranged Traversal
-bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
-                           HITINFO_PACKET *aHitInfoPacket ) const
+///> Returns the index of the lowest bit set in a 4 bits mask, which must not be 0
+static inline unsigned int firstLane( unsigned int aMask )
 {
-    if( m_nodes == NULL )
-        return false;
-
-    if( (&m_nodes[0]) == NULL )
-        return false;
-
-    bool anyHitted = false;
-    int todoOffset = 0, nodeNum = 0;
-    StackNode todo[MAX_TODOS];
+    return ( aMask & 1 ) ? 0 : ( aMask & 2 ) ? 1 : ( aMask & 4 ) ? 2 : 3;
+}
 
-    unsigned int ia = 0;
 
-    while( true )
-    {
-        const LinearBVHNode *curCell = &m_nodes[nodeNum];
+///> Returns the index of the highest bit set in a 4 bits mask, which must not be 0
+static inline unsigned int lastLane( unsigned int aMask )
+{
+    return ( aMask & 8 ) ? 3 : ( aMask & 4 ) ? 2 : ( aMask & 2 ) ? 1 : 0;
+}
 
-        ia = getFirstHit( aRayPacket, curCell->bounds, ia, aHitInfoPacket );
 
-        if( ia < RAYPACKET_RAYS_PER_PACKET )
-        {
-            if( curCell->nPrimitives == 0 )
-            {
-                StackNode &node = todo[todoOffset++];
-                node.cell = curCell->secondChildOffset;
-                node.ia = ia;
-                nodeNum = nodeNum + 1;
-                continue;
-            }
-            else
-            {
-                const unsigned int ie = getLastHit( aRayPacket,
-                                                    curCell->bounds,
-                                                    ia,
-                                                    aHitInfoPacket );
+static inline CBBOX childBBox( const LinearBVH4Node &aNode, unsigned int aChild )
+{
+    return CBBOX( SFVEC3F( aNode.bounds[0][aChild],
+                           aNode.bounds[1][aChild],
+                           aNode.bounds[2][aChild] ),
+                  SFVEC3F( aNode.bounds[3][aChild],
+                           aNode.bounds[4][aChild],
+                           aNode.bounds[5][aChild] ) );
+}
 
-                for( int j = 0; j < curCell->nPrimitives; ++j )
-                {
-                    const COBJECT *obj = m_primitives[curCell->primitivesOffset + j];
 
-                    if( aRayPacket.m_Frustum.Intersect( obj->GetBBox() ) )
-                    {
-                        for( unsigned int i = ia; i < ie; ++i )
-                        {
-                            const bool hitted = obj->Intersect( aRayPacket.m_ray[i],
-                                                                aHitInfoPacket[i].m_HitInfo );
+static inline unsigned int getFirstHit( const RAYPACKET &aRayPacket,
+                                        const RAYPACKET_SOA &aRays,
+                                        const LinearBVH4Node &aNode,
+                                        unsigned int aChild,
+                                        unsigned int ia,
+                                        const float *aTHit )
+{
+    unsigned int first = ia & ~3u;
+    unsigned int mask = intersectRays4( aNode, aChild, aRays, first, aTHit ) &
+                        ( 0xF << (ia & 3) );
 
-                            if( hitted )
-                            {
-                                anyHitted |= hitted;
-                                aHitInfoPacket[i].m_hitresult |= hitted;
-                                aHitInfoPacket[i].m_HitInfo.m_acc_node_info = nodeNum;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+    if( mask )
+        return first + firstLane( mask );
 
-        if( todoOffset == 0 )
-            break;
+    if( !aRayPacket.m_Frustum.Intersect( childBBox( aNode, aChild ) ) )
+        return RAYPACKET_RAYS_PER_PACKET;
 
-        const StackNode &node = todo[--todoOffset];
+    for( first += 4; first < RAYPACKET_RAYS_PER_PACKET; first += 4 )
+    {
+        mask = intersectRays4( aNode, aChild, aRays, first, aTHit );
 
-        nodeNum = node.cell;
-        ia = node.ia;
+        if( mask )
+            return first + firstLane( mask );
     }
 
-    return anyHitted;
-
-}// Ranged Traversal
-#endif
-
-
-// "Ray Tracing Deformable Scenes Using Dynamic Bounding Volume Hierarchies"
-// http://www.cs.cmu.edu/afs/cs/academic/class/15869-f11/www/readings/wald07_packetbvh.pdf
+    return RAYPACKET_RAYS_PER_PACKET;
+}
 
-#ifdef BVH_PARTITION_TRAVERSAL
 
-static inline unsigned int getLastHit( const RAYPACKET &aRayPacket,
-                                       const CBBOX &aBBox,
+static inline unsigned int getLastHit( const RAYPACKET_SOA &aRays,
+                                       const LinearBVH4Node &aNode,
+                                       unsigned int aChild,
                                        unsigned int ia,
-                                       const unsigned int *aRayIndex,
-                                       HITINFO_PACKET *aHitInfoPacket )
+                                       const float *aTHit )
 {
-    for( unsigned int ie = (RAYPACKET_RAYS_PER_PACKET - 1); ie > ia; --ie )
+    for( unsigned int first = RAYPACKET_RAYS_PER_PACKET - 4; first > ia; first -= 4 )
     {
-        float hitT;
+        const unsigned int mask = intersectRays4( aNode, aChild, aRays, first, aTHit );
 
-        if( aBBox.Intersect( aRayPacket.m_ray[ aRayIndex[ie] ], &hitT ) )
-            if( hitT < aHitInfoPacket[ aRayIndex[ie] ].m_HitInfo.m_tHit )
-                return ie + 1;
+        if( mask )
+            return first + lastLane( mask ) + 1;
     }
 
-    return ia + 1;
-}
+    // The group of ia: ia is hit
+    const unsigned int first = ia & ~3u;
+    const unsigned int mask = intersectRays4( aNode, aChild, aRays, first, aTHit ) &
+                              ( 0xF << (ia & 3) );
 
+    return mask ? ( first + lastLane( mask ) + 1 ) : ( ia + 1 );
+}
 
-static inline unsigned int partRays( const RAYPACKET &aRayPacket,
-                                     const CBBOX &aBBox,
-                                     unsigned int ia,
-                                     unsigned int *aRayIndex,
-                                     HITINFO_PACKET *aHitInfoPacket )
-{
 
-    if( !aRayPacket.m_Frustum.Intersect( aBBox ) )
-        return RAYPACKET_RAYS_PER_PACKET;
+// "Large Ray Packets for Real-time Whitted Ray Tracing"
+// http://cseweb.ucsd.edu/~ravir/whitted.pdf
 
-    unsigned int ie = 0;
+// Ranged Traversal, of the 4 children of the nodes, with 4 rays of the packet at once
+bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
+                           HITINFO_PACKET *aHitInfoPacket ) const
+{
+    if( m_nodes == NULL )
+        return false;
 
-    for( unsigned int i = 0; i < ia; ++i )
-    {
-        float hitT;
-        if( aBBox.Intersect( aRayPacket.m_ray[ aRayIndex[i] ], &hitT ) )
-            if( hitT < aHitInfoPacket[ aRayIndex[i] ].m_HitInfo.m_tHit )
-                std::swap( aRayIndex[ie++], aRayIndex[i] );
-    }
+    const RAYPACKET_SOA rays( aRayPacket );
 
-    return ie;
-}
+    // The hit distances in a SoA array too, kept equal to the ones of aHitInfoPacket
+    alignas( 16 ) float tHit[RAYPACKET_RAYS_PER_PACKET];
 
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+        tHit[i] = aHitInfoPacket[i].m_HitInfo.m_tHit;
 
-bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
-                           HITINFO_PACKET *aHitInfoPacket ) const
-{
     bool anyHitted = false;
     int todoOffset = 0, nodeNum = 0;
-    StackNode todo[MAX_TODOS];
-
-    unsigned int I[RAYPACKET_RAYS_PER_PACKET];
-
-    memcpy( I, m_I, RAYPACKET_RAYS_PER_PACKET * sizeof( unsigned int ) );
+    StackNode todo[3 * MAX_TODOS + 1];
 
     unsigned int ia = 0;
 
     while( true )
     {
-        const LinearBVHNode *curCell = &m_nodes[nodeNum];
+        const LinearBVH4Node &curCell = m_nodes[nodeNum];
 
-        ia = partRays( aRayPacket, curCell->bounds, ia, I, aHitInfoPacket );
+        unsigned int childIa[4];
+        unsigned int interior[4];
+        unsigned int interiorCount = 0;
 
-        if( ia < RAYPACKET_RAYS_PER_PACKET )
+        for( unsigned int c = 0; c < curCell.nChildren; ++c )
         {
-            if( curCell->nPrimitives == 0 )
+            childIa[c] = getFirstHit( aRayPacket, rays, curCell, c, ia, tHit );
+
+            if( childIa[c] >= RAYPACKET_RAYS_PER_PACKET )
+                continue;
+
+            if( curCell.nPrimitives[c] == 0 )
             {
-                StackNode &node = todo[todoOffset++];
-                node.cell = curCell->secondChildOffset;
-                node.ia = ia;
-                nodeNum = nodeNum + 1;
+                interior[interiorCount++] = c;
                 continue;
             }
-            else
+
+            const unsigned int childFirst = childIa[c];
+            const unsigned int ie = getLastHit( rays, curCell, c, childFirst, tHit );
+
+            for( int j = 0; j < curCell.nPrimitives[c]; ++j )
             {
-                unsigned int ie = getLastHit( aRayPacket,
-                                              curCell->bounds,
-                                              ia,
-                                              I,
-                                              aHitInfoPacket );
+                const COBJECT *obj = m_primitives[curCell.offset[c] + j];
 
-                for( int j = 0; j < curCell->nPrimitives; ++j )
+                if( !aRayPacket.m_Frustum.Intersect( obj->GetBBox() ) )
+                    continue;
+
+                if( obj->GetObjectType() == OBJ3D_TRIANGLE )
                 {
-                    const COBJECT *obj = m_primitives[curCell->primitivesOffset + j];
+                    // The rays found by the SIMD test are confirmed by the exact one,
+                    // which computes the hit information
+                    const CTRIANGLE *triangle = static_cast<const CTRIANGLE *>( obj );
 
-                    if( aRayPacket.m_Frustum.Intersect( obj->GetBBox() ) )
+                    for( unsigned int first = childFirst & ~3u; first < ie; first += 4 )
                     {
-                        for( unsigned int i = 0; i < ie; ++i )
+                        unsigned int mask = triangle->IntersectRays4( rays, first, tHit );
+
+                        for( unsigned int lane = 0; mask; ++lane, mask >>= 1 )
                         {
-                            unsigned int idx = I[i];
+                            const unsigned int i = first + lane;
 
-                            bool hitted = obj->Intersect(
-                                        aRayPacket.m_ray[idx],
-                                        aHitInfoPacket[idx].m_HitInfo );
+                            if( !( mask & 1 ) || (i < childFirst) || (i >= ie) )
+                                continue;
 
-                            if( hitted )
+                            if( obj->Intersect( aRayPacket.m_ray[i],
+                                                aHitInfoPacket[i].m_HitInfo ) )
                             {
-                                anyHitted |= hitted;
-                                aHitInfoPacket[idx].m_hitresult |= hitted;
-                                aHitInfoPacket[idx].m_HitInfo.m_acc_node_info = nodeNum;
+                                anyHitted = true;
+                                aHitInfoPacket[i].m_hitresult = true;
+                                aHitInfoPacket[i].m_HitInfo.m_acc_node_info = nodeNum;
+                                tHit[i] = aHitInfoPacket[i].m_HitInfo.m_tHit;
                             }
                         }
                     }
                 }
+                else
+                {
+                    for( unsigned int i = childFirst; i < ie; ++i )
+                    {
+                        if( obj->Intersect( aRayPacket.m_ray[i], aHitInfoPacket[i].m_HitInfo ) )
+                        {
+                            anyHitted = true;
+                            aHitInfoPacket[i].m_hitresult = true;
+                            aHitInfoPacket[i].m_HitInfo.m_acc_node_info = nodeNum;
+                            tHit[i] = aHitInfoPacket[i].m_HitInfo.m_tHit;
+                        }
+                    }
+                }
             }
         }
 
+        // Push the interior children in reverse order, so the first one is traversed first
+        for( unsigned int k = interiorCount; k > 0; --k )
+        {
+            const unsigned int c = interior[k - 1];
+
+            wxASSERT( todoOffset < (3 * MAX_TODOS + 1) );
+
+            StackNode &node = todo[todoOffset++];
+            node.cell = curCell.offset[c];
+            node.ia = childIa[c];
+        }
+
         if( todoOffset == 0 )
             break;
 
@@ -291,5 +314,5 @@ bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
     }
 
     return anyHitted;
-}// Partition Traversal
-#endif
+
+}// Ranged Traversal
@@ -74,8 +74,14 @@
 #include <stdlib.h>
 
 #include <stack>
+#include <cfloat>
+#include <cstring>
 #include <wx/debug.h>
 
+#ifdef RAYPACKET_SSE2
+#include <emmintrin.h>
+#endif
+
 #ifdef PRINT_STATISTICS_3D_VIEWER
 #include <stdio.h>
 #endif
@@ -243,12 +249,6 @@ CBVH_PBRT::CBVH_PBRT( const CGENERICCONTAINER &aObjectContainer,
         return;
     }
 
-    // Initialize the indexes of ray packet for partition traversal
-    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
-    {
-        m_I[i] = i;
-    }
-
     // Convert the objects list to vector of objects
     // /////////////////////////////////////////////////////////////////////////
     aObjectContainer.ConvertTo( m_primitives );
@@ -285,27 +285,20 @@ CBVH_PBRT::CBVH_PBRT( const CGENERICCONTAINER &aObjectContainer,
 
     m_primitives.swap( orderedPrims );
 
-    // Compute representation of depth-first traversal of BVH tree
-    m_nodes = static_cast<LinearBVHNode *>( malloc( sizeof( LinearBVHNode ) *
-                                                    totalNodes ) );
-    m_addresses_pointer_to_mm_free.push_back( m_nodes );
+    // Compute representation of depth-first traversal of the 4-wide BVH
+    std::vector<LinearBVH4Node> nodes;
+    nodes.reserve( totalNodes / 2 + 1 );
 
-    for( int i = 0; i < totalNodes; ++i )
-    {
-        m_nodes[i].bounds.Reset();
-        m_nodes[i].primitivesOffset = 0;
-        m_nodes[i].nPrimitives = 0;
-        m_nodes[i].axis = 0;
-    }
-
-    uint32_t offset = 0;
+    flattenBVH4Tree( root, nodes );
 
-    flattenBVHTree( root, &offset );
+    m_nodes = static_cast<LinearBVH4Node *>( malloc( sizeof( LinearBVH4Node ) *
+                                                     nodes.size() ) );
+    m_addresses_pointer_to_mm_free.push_back( m_nodes );
 
-    wxASSERT( offset == (unsigned int)totalNodes );
+    memcpy( m_nodes, nodes.data(), sizeof( LinearBVH4Node ) * nodes.size() );
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
-    uint32_t treeBytes = totalNodes * sizeof( LinearBVHNode ) + sizeof( *this ) +
+    uint32_t treeBytes = nodes.size() * sizeof( LinearBVH4Node ) + sizeof( *this ) +
                          m_primitives.size() * sizeof( m_primitives[0] ) +
                          m_addresses_pointer_to_mm_free.size() * sizeof( void * );
 
@@ -320,8 +313,8 @@ CBVH_PBRT::CBVH_PBRT( const CGENERICCONTAINER &aObjectContainer,
     case SPLIT_HLBVH:       printf( "using SPLIT_HLBVH\n" ); break;
     }
 
-    printf( "  BVH created with %d nodes (%.2f MB)\n",
-            totalNodes, float(treeBytes) / (1024.f * 1024.f) );
+    printf( "  BVH created with %d nodes, %u BVH4 nodes (%.2f MB)\n",
+            totalNodes, (unsigned int)nodes.size(), float(treeBytes) / (1024.f * 1024.f) );
     printf( "////////////////////////////////////////////////////////////////////////////////\n\n" );
 #endif
 }
@@ -1095,29 +1088,91 @@ BVHBuildNode *CBVH_PBRT::buildUpperSAH(
 }
 
 
-int CBVH_PBRT::flattenBVHTree( BVHBuildNode *node, uint32_t *offset )
+int CBVH_PBRT::flattenBVH4Tree( const BVHBuildNode *aNode,
+                                std::vector<LinearBVH4Node> &aNodes )
 {
-    LinearBVHNode *linearNode = &m_nodes[*offset];
+    const BVHBuildNode *children[4];
+    unsigned int nChildren = 0;
+
+    if( aNode->nPrimitives > 0 )
+    {
+        // The root is a leaf: it is the only child of the root node
+        children[nChildren++] = aNode;
+    }
+    else
+    {
+        children[nChildren++] = aNode->children[0];
+        children[nChildren++] = aNode->children[1];
 
-    linearNode->bounds = node->bounds;
+        // Replace the interior child of the largest area by its children, until the
+        // node has 4 children or only leaves
+        while( nChildren < 4 )
+        {
+            int largest = -1;
+            float largestArea = -1.0f;
 
-    int myOffset = (*offset)++;
+            for( unsigned int i = 0; i < nChildren; ++i )
+            {
+                if( children[i]->nPrimitives == 0 )
+                {
+                    const float area = children[i]->bounds.SurfaceArea();
 
-    if( node->nPrimitives > 0 )
+                    if( area > largestArea )
+                    {
+                        largest = i;
+                        largestArea = area;
+                    }
+                }
+            }
+
+            if( largest < 0 )
+                break;
+
+            const BVHBuildNode *opened = children[largest];
+
+            children[largest] = opened->children[0];
+            children[nChildren++] = opened->children[1];
+        }
+    }
+
+    // The vector may be reallocated by the recursion: the node is accessed by its index
+    const int myOffset = aNodes.size();
+
+    LinearBVH4Node node;
+
+    memset( &node, 0, sizeof( node ) );
+    node.nChildren = nChildren;
+
+    for( unsigned int i = 0; i < nChildren; ++i )
     {
-        wxASSERT( (!node->children[0]) && (!node->children[1]) );
-        wxASSERT( node->nPrimitives < 65536 );
+        const CBBOX &bounds = children[i]->bounds;
 
-        linearNode->primitivesOffset = node->firstPrimOffset;
-        linearNode->nPrimitives = node->nPrimitives;
+        for( unsigned int axis = 0; axis < 3; ++axis )
+        {
+            node.bounds[axis][i]     = bounds.Min()[axis];
+            node.bounds[axis + 3][i] = bounds.Max()[axis];
+        }
     }
-    else
+
+    aNodes.push_back( node );
+
+    for( unsigned int i = 0; i < nChildren; ++i )
     {
-        // Creater interior flattened BVH node
-        linearNode->axis = node->splitAxis;
-        linearNode->nPrimitives = 0;
-        flattenBVHTree( node->children[0], offset );
-        linearNode->secondChildOffset = flattenBVHTree( node->children[1], offset );
+        if( children[i]->nPrimitives > 0 )
+        {
+            wxASSERT( (!children[i]->children[0]) && (!children[i]->children[1]) );
+            wxASSERT( children[i]->nPrimitives < 65536 );
+
+            aNodes[myOffset].offset[i] = children[i]->firstPrimOffset;
+            aNodes[myOffset].nPrimitives[i] = children[i]->nPrimitives;
+        }
+        else
+        {
+            const int childOffset = flattenBVH4Tree( children[i], aNodes );
+
+            aNodes[myOffset].offset[i] = childOffset;
+            aNodes[myOffset].nPrimitives[i] = 0;
+        }
     }
 
     return myOffset;
@@ -1126,166 +1181,257 @@ int CBVH_PBRT::flattenBVHTree( BVHBuildNode *node, uint32_t *offset )
 
 #define MAX_TODOS 64
 
-bool CBVH_PBRT::Intersect( const RAY &aRay, HITINFO &aHitInfo ) const
+
+/**
+ * A ray prepared for the test of the children of the BVH4 nodes: the inverse direction
+ * is clamped to finite values, so the slab test never computes 0 * infinity.
+ */
+struct BVH4_RAY
 {
-    if( !m_nodes )
-        return false;
+    explicit BVH4_RAY( const RAY &aRay )
+    {
+        for( unsigned int axis = 0; axis < 3; ++axis )
+        {
+            m_org[axis] = aRay.m_Origin[axis];
+            m_invDir[axis] = glm::clamp( aRay.m_InvDir[axis], -FLT_MAX, FLT_MAX );
+        }
+    }
 
-    bool hit = false;
+    float m_org[3];
+    float m_invDir[3];
+};
 
-    // Follow ray through BVH nodes to find primitive intersections
-    int todoOffset = 0, nodeNum = 0;
-    int todo[MAX_TODOS];
 
-    while( true )
+/**
+ * Tests aRay against the children of aNode, with a slab test padded so no box hit by the
+ * exact test is missed.
+ * @param aTNear receives the entry distance of the ray in each child
+ * @return the mask of the children hit closer than aTHit
+ */
+static inline unsigned int intersectChildren( const LinearBVH4Node &aNode,
+                                              const BVH4_RAY &aRay,
+                                              float aTHit,
+                                              float *aTNear )
+{
+#ifdef RAYPACKET_SSE2
+    __m128 tNear = _mm_setzero_ps();
+    __m128 tFar = _mm_set1_ps( FLT_MAX );
+    __m128 tEntry = _mm_set1_ps( -FLT_MAX );
+
+    for( unsigned int axis = 0; axis < 3; ++axis )
     {
-        const LinearBVHNode *node = &m_nodes[nodeNum];
+        const __m128 org = _mm_set1_ps( aRay.m_org[axis] );
+        const __m128 invDir = _mm_set1_ps( aRay.m_invDir[axis] );
+        const __m128 t0 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( aNode.bounds[axis] ), org ),
+                                      invDir );
+        const __m128 t1 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( aNode.bounds[axis + 3] ), org ),
+                                      invDir );
+
+        tEntry = _mm_max_ps( tEntry, _mm_min_ps( t0, t1 ) );
+        tFar = _mm_min_ps( tFar, _mm_max_ps( t0, t1 ) );
+    }
+
+    tNear = _mm_max_ps( tEntry, tNear );
+    tFar = _mm_mul_ps( tFar, _mm_set1_ps( 1.0000004f ) );
 
-        wxASSERT( todoOffset < MAX_TODOS );
+    const __m128 hit = _mm_and_ps( _mm_cmpge_ps( tFar, tNear ),
+                                   _mm_cmplt_ps( tEntry, _mm_set1_ps( aTHit ) ) );
 
-        // Check ray against BVH node
-        float hitBox = 0.0f;
+    _mm_storeu_ps( aTNear, tEntry );
 
-        const bool hitted = node->bounds.Intersect( aRay, &hitBox );
+    return _mm_movemask_ps( hit ) & ( (1 << aNode.nChildren) - 1 );
+#else
+    unsigned int mask = 0;
 
-        if( hitted && (hitBox < aHitInfo.m_tHit) )
+    for( unsigned int i = 0; i < aNode.nChildren; ++i )
+    {
+        float tEntry = -FLT_MAX;
+        float tFar = FLT_MAX;
+
+        for( unsigned int axis = 0; axis < 3; ++axis )
         {
-            if( node->nPrimitives > 0 )
-            {
-                // Intersect ray with primitives in leaf BVH node
-                for( int i = 0; i < node->nPrimitives; ++i )
-                {
-                    if( m_primitives[node->primitivesOffset + i]->Intersect( aRay,
-                                                                             aHitInfo ) )
-                    {
-                        aHitInfo.m_acc_node_info = nodeNum;
-                        hit = true;
-                    }
-                }
-            }
-            else
-            {
-                // Put far BVH node on _todo_ stack, advance to near node
-                if( aRay.m_dirIsNeg[node->axis] )
-                {
-                    todo[todoOffset++] = nodeNum + 1;
-                    nodeNum = node->secondChildOffset;
-                }
-                else
-                {
-                    todo[todoOffset++] = node->secondChildOffset;
-                    nodeNum = nodeNum + 1;
-                }
+            const float t0 = (aNode.bounds[axis][i] - aRay.m_org[axis]) * aRay.m_invDir[axis];
+            const float t1 = (aNode.bounds[axis + 3][i] - aRay.m_org[axis]) *
+                             aRay.m_invDir[axis];
 
-                continue;
-            }
+            tEntry = glm::max( tEntry, glm::min( t0, t1 ) );
+            tFar = glm::min( tFar, glm::max( t0, t1 ) );
         }
 
-        if( todoOffset == 0 )
-            break;
+        aTNear[i] = tEntry;
 
-        nodeNum = todo[--todoOffset];
+        if( ( tFar * 1.0000004f >= glm::max( tEntry, 0.0f ) ) && ( tEntry < aTHit ) )
+            mask |= 1 << i;
     }
 
-    return hit;
+    return mask;
+#endif
 }
 
-// !TODO: this may be optimized
-bool CBVH_PBRT::Intersect( const RAY &aRay,
+
+/**
+ * Sorts the children of aMask by increasing entry distance.
+ * @return the number of children stored in aOrder
+ */
+static inline unsigned int sortChildren( unsigned int aMask,
+                                         const float *aTNear,
+                                         unsigned int *aOrder )
+{
+    unsigned int count = 0;
+
+    for( unsigned int i = 0; i < 4; ++i )
+    {
+        if( !( aMask & (1 << i) ) )
+            continue;
+
+        unsigned int j = count++;
+
+        for( ; (j > 0) && (aTNear[aOrder[j - 1]] > aTNear[i]); --j )
+            aOrder[j] = aOrder[j - 1];
+
+        aOrder[j] = i;
+    }
+
+    return count;
+}
+
+
+struct BVH4_TODO
+{
+    int   node;
+    float tNear;
+};
+
+
+/**
+ * Follows aRay through the nodes from aStartNode, nearest children first.
+ * @param aSetNodeInfo true to store in aHitInfo the node of the primitive hit
+ */
+static bool intersectBVH4( const LinearBVH4Node *aNodes,
+                           const CONST_VECTOR_OBJECT &aPrimitives,
+                           const RAY &aRay,
                            HITINFO &aHitInfo,
-                           unsigned int aAccNodeInfo ) const
+                           int aStartNode,
+                           bool aSetNodeInfo )
 {
-    if( !m_nodes )
-        return false;
+    const BVH4_RAY ray( aRay );
 
     bool hit = false;
 
-    // Follow ray through BVH nodes to find primitive intersections
-    int todoOffset = 0, nodeNum = aAccNodeInfo;
-    int todo[MAX_TODOS];
+    int todoOffset = 0;
+    BVH4_TODO todo[3 * MAX_TODOS + 1];
 
-    while( true )
+    todo[todoOffset].node = aStartNode;
+    todo[todoOffset++].tNear = -FLT_MAX;
+
+    while( todoOffset > 0 )
     {
-        const LinearBVHNode *node = &m_nodes[nodeNum];
+        const BVH4_TODO &entry = todo[--todoOffset];
 
-        wxASSERT( todoOffset < MAX_TODOS );
+        // The node may be farther than a hit found since it was pushed
+        if( entry.tNear >= aHitInfo.m_tHit )
+            continue;
 
-        // Check ray against BVH node
-        float hitBox = 0.0f;
+        const int nodeNum = entry.node;
+        const LinearBVH4Node &node = aNodes[nodeNum];
 
-        const bool hitted = node->bounds.Intersect( aRay, &hitBox );
+        float tNear[4];
+        unsigned int order[4];
 
-        if( hitted && (hitBox < aHitInfo.m_tHit) )
+        const unsigned int count = sortChildren( intersectChildren( node, ray,
+                                                                    aHitInfo.m_tHit, tNear ),
+                                                 tNear, order );
+
+        // Intersect the leaves from the nearest one, and put the interior children on the
+        // _todo_ stack so the nearest one is popped first
+        for( unsigned int k = 0; k < count; ++k )
         {
-            if( node->nPrimitives > 0 )
+            const unsigned int c = order[k];
+
+            if( node.nPrimitives[c] == 0 || tNear[c] >= aHitInfo.m_tHit )
+                continue;
+
+            for( int i = 0; i < node.nPrimitives[c]; ++i )
             {
-                // Intersect ray with primitives in leaf BVH node
-                for( int i = 0; i < node->nPrimitives; ++i )
+                if( aPrimitives[node.offset[c] + i]->Intersect( aRay, aHitInfo ) )
                 {
-                    if( m_primitives[node->primitivesOffset + i]->Intersect( aRay,
-                                                                             aHitInfo ) )
-                    {
-                        //aHitInfo.m_acc_node_info = nodeNum;
-                        hit = true;
-                    }
+                    if( aSetNodeInfo )
+                        aHitInfo.m_acc_node_info = nodeNum;
+
+                    hit = true;
                 }
             }
-            else
+        }
+
+        for( unsigned int k = count; k > 0; --k )
+        {
+            const unsigned int c = order[k - 1];
+
+            if( node.nPrimitives[c] == 0 )
             {
-                // Put far BVH node on _todo_ stack, advance to near node
-                if( aRay.m_dirIsNeg[node->axis] )
-                {
-                    todo[todoOffset++] = nodeNum + 1;
-                    nodeNum = node->secondChildOffset;
-                }
-                else
-                {
-                    todo[todoOffset++] = node->secondChildOffset;
-                    nodeNum = nodeNum + 1;
-                }
+                wxASSERT( todoOffset < (3 * MAX_TODOS + 1) );
 
-                continue;
+                todo[todoOffset].node = node.offset[c];
+                todo[todoOffset++].tNear = tNear[c];
             }
         }
-
-        if( todoOffset == 0 )
-            break;
-
-        nodeNum = todo[--todoOffset];
     }
 
     return hit;
 }
 
 
+bool CBVH_PBRT::Intersect( const RAY &aRay, HITINFO &aHitInfo ) const
+{
+    if( !m_nodes )
+        return false;
+
+    return intersectBVH4( m_nodes, m_primitives, aRay, aHitInfo, 0, true );
+}
+
+
+// !TODO: this may be optimized
+bool CBVH_PBRT::Intersect( const RAY &aRay,
+                           HITINFO &aHitInfo,
+                           unsigned int aAccNodeInfo ) const
+{
+    if( !m_nodes )
+        return false;
+
+    return intersectBVH4( m_nodes, m_primitives, aRay, aHitInfo, aAccNodeInfo, false );
+}
+
+
 bool CBVH_PBRT::IntersectP( const RAY &aRay, float aMaxDistance ) const
 {
     if( !m_nodes )
         return false;
 
-    // Follow ray through BVH nodes to find primitive intersections
+    const BVH4_RAY ray( aRay );
+
+    // Follow ray through BVH nodes to find primitive intersections, any of them stops it
     int todoOffset = 0, nodeNum = 0;
-    int todo[MAX_TODOS];
+    int todo[3 * MAX_TODOS];
 
     while( true )
     {
-        const LinearBVHNode *node = &m_nodes[nodeNum];
-
-        wxASSERT( todoOffset < MAX_TODOS );
+        const LinearBVH4Node &node = m_nodes[nodeNum];
 
-        // Check ray against BVH node
-        float hitBox = 0.0f;
+        float tNear[4];
 
-        const bool hitted = node->bounds.Intersect( aRay, &hitBox );
+        const unsigned int mask = intersectChildren( node, ray, aMaxDistance, tNear );
 
-        if( hitted && (hitBox < aMaxDistance) )
+        for( unsigned int c = 0; c < node.nChildren; ++c )
         {
-            if( node->nPrimitives > 0 )
+            if( !( mask & (1 << c) ) )
+                continue;
+
+            if( node.nPrimitives[c] > 0 )
             {
                 // Intersect ray with primitives in leaf BVH node
-                for( int i = 0; i < node->nPrimitives; ++i )
+                for( int i = 0; i < node.nPrimitives[c]; ++i )
                 {
-                    const COBJECT *obj = m_primitives[node->primitivesOffset + i];
+                    const COBJECT *obj = m_primitives[node.offset[c] + i];
 
                     if( obj->GetMaterial()->GetCastShadows() )
                         if( obj->IntersectP( aRay, aMaxDistance ) )
@@ -1294,19 +1440,9 @@ bool CBVH_PBRT::IntersectP( const RAY &aRay, float aMaxDistance ) const
             }
             else
             {
-                // Put far BVH node on _todo_ stack, advance to near node
-                if( aRay.m_dirIsNeg[node->axis] )
-                {
-                    todo[todoOffset++] = nodeNum + 1;
-                    nodeNum = node->secondChildOffset;
-                }
-                else
-                {
-                    todo[todoOffset++] = node->secondChildOffset;
-                    nodeNum = nodeNum + 1;
-                }
+                wxASSERT( todoOffset < (3 * MAX_TODOS) );
 
-                continue;
+                todo[todoOffset++] = node.offset[c];
             }
         }
 
@@ -72,6 +72,7 @@
 
 #include "caccelerator.h"
 #include <list>
+#include <vector>
 #include <stdint.h>
 
 // Forward Declarations
@@ -79,22 +80,23 @@ struct BVHBuildNode;
 struct BVHPrimitiveInfo;
 struct MortonPrimitive;
 
-struct LinearBVHNode
+/**
+ * A node of the 4-wide BVH: the binary tree built is collapsed so each node holds up to
+ * 4 children, and their bounds are stored by coordinate, so a ray (or 4 rays of a packet)
+ * is tested against the boxes at once.
+ */
+struct LinearBVH4Node
 {
-    // 24 bytes
-    CBBOX bounds;
-
-    // 4 bytes
-    union
-    {
-        int primitivesOffset;   ///< leaf
-        int secondChildOffset;  ///< interior
-    };
-
-    // 4 bytes
-    uint16_t nPrimitives;  ///< 0 -> interior node
-    uint8_t  axis;         ///< interior node: xyz
-    uint8_t  pad[1];       ///< ensure 32 byte total size
+    // 96 bytes
+    float bounds[6][4];         ///< min x, y, z then max x, y, z of each child
+
+    // 16 bytes
+    int offset[4];              ///< interior child: its node, leaf child: its first primitive
+
+    // 16 bytes
+    uint16_t nPrimitives[4];    ///< 0 -> interior child
+    uint32_t nChildren;
+    uint32_t pad[1];            ///< ensure 128 byte total size
 };
 
 
@@ -150,19 +152,16 @@ private:
                                  int end,
                                  int *totalNodes );
 
-    int flattenBVHTree( BVHBuildNode *node,
-                        uint32_t *offset );
+    int flattenBVH4Tree( const BVHBuildNode *aNode,
+                         std::vector<LinearBVH4Node> &aNodes );
 
     // BVH Private Data
     const int           m_maxPrimsInNode;
     SPLITMETHOD         m_splitMethod;
     CONST_VECTOR_OBJECT m_primitives;
-    LinearBVHNode       *m_nodes;
+    LinearBVH4Node      *m_nodes;
 
     std::list<void *> m_addresses_pointer_to_mm_free;
-
-    // Partition traversal
-    unsigned int m_I[RAYPACKET_RAYS_PER_PACKET];
 };
 
 #endif  // _CBVH_PBRT_H_
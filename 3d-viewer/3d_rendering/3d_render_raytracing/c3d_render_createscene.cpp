@@ -777,7 +777,7 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER *aStatusTextReporter )
 #endif
 
 
-    load_3D_models();
+    load_3D_models( aStatusTextReporter );
 
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
@@ -1197,8 +1197,28 @@ void C3D_RENDER_RAYTRACING::add_3D_vias_and_pads_to_container()
 }
 
 
-void C3D_RENDER_RAYTRACING::load_3D_models()
+void C3D_RENDER_RAYTRACING::load_3D_models( REPORTER *aStatusTextReporter )
 {
+    // Headless renders have no cache manager, and render the board without the models
+    if( !m_settings.Get3DCacheManager() )
+        return;
+
+    // Load the models of all the modules at once, so distinct files are loaded concurrently
+    std::vector< wxString > modelFiles;
+
+    for( const MODULE* module = m_settings.GetBoard()->m_Modules;
+         module;
+         module = module->Next() )
+    {
+        if( m_settings.ShouldModuleBeDisplayed( (MODULE_ATTR_T)module->GetAttributes() ) )
+        {
+            for( const auto& model : module->Models() )
+                modelFiles.push_back( model.m_Filename );
+        }
+    }
+
+    m_settings.Get3DCacheManager()->PreloadModels( modelFiles, aStatusTextReporter );
+
     // Go for all modules
     for( const MODULE* module = m_settings.GetBoard()->m_Modules;
          module;
@@ -69,9 +69,12 @@ C3D_RENDER_RAYTRACING::C3D_RENDER_RAYTRACING( CINFO3D_VISU &aSettings ) :
     m_yoffset = 0;
 
     m_isPreview = false;
+    m_isOffscreen = false;
     m_rt_render_state = RT_RENDER_STATE_MAX; // Set to an initial invalid state
     m_stats_start_rendering_time = 0;
+    m_stats_tracing_time = 0;
     m_nrBlocksRenderProgress = 0;
+    m_nextBlockToRender = 0;
 }
 
 
@@ -127,17 +130,28 @@ void C3D_RENDER_RAYTRACING::restart_render_state()
 {
     m_stats_start_rendering_time = GetRunningMicroSecs();
 
+    m_stats_tracing_time = 0;
+
     m_rt_render_state = RT_RENDER_STATE_TRACING;
     m_nrBlocksRenderProgress = 0;
+    m_nextBlockToRender = 0;
 
     m_postshader_ssao.InitFrame();
+}
+
 
-    m_blockPositionsWasProcessed.resize( m_blockPositions.size() );
+float C3D_RENDER_RAYTRACING::stats_rays_per_second() const
+{
+    if( m_stats_tracing_time == 0 )
+        return 0.0f;
+
+    // Camera rays only: one packet per block, and a second one for the anti aliasing
+    const unsigned int raysPerBlock =
+            m_settings.GetFlag( FL_RENDER_RAYTRACING_ANTI_ALIASING ) ?
+            2 * RAYPACKET_RAYS_PER_PACKET : RAYPACKET_RAYS_PER_PACKET;
 
-    // Mark the blocks not processed yet
-    std::fill( m_blockPositionsWasProcessed.begin(),
-               m_blockPositionsWasProcessed.end(),
-               false );
+    return (float)m_nrBlocksRenderProgress * raysPerBlock /
+           ( (float)m_stats_tracing_time / 1e6f );
 }
 
 
@@ -326,6 +340,12 @@ void C3D_RENDER_RAYTRACING::render( GLubyte *ptrPBO , REPORTER *aStatusTextRepor
 
         m_BgColorTop_LinearRGB = ConvertSRGBToLinear( (SFVEC3F)m_settings.m_BgColorTop );
         m_BgColorBot_LinearRGB = ConvertSRGBToLinear( (SFVEC3F)m_settings.m_BgColorBot );
+
+        // Progressive refinement: display a low resolution pass first (unless the preview
+        // of this view is already displayed), then the traced blocks replace it
+        if( !m_isPreview && !m_isOffscreen &&
+            (m_settings.RenderEngineGet() != RENDER_ENGINE_OPENGL_LEGACY) )
+            render_preview( ptrPBO );
     }
 
     switch( m_rt_render_state )
@@ -354,12 +374,91 @@ void C3D_RENDER_RAYTRACING::render( GLubyte *ptrPBO , REPORTER *aStatusTextRepor
         const double calculation_time = (double)( GetRunningMicroSecs() -
                                                   m_stats_start_rendering_time ) / 1e6;
 
-        aStatusTextReporter->Report( wxString::Format( _( "Rendering time %.3f s" ),
-                                                       calculation_time ) );
+        aStatusTextReporter->Report(
+                wxString::Format( _( "Rendering time %.3f s (%.2f Mrays/s)" ),
+                                  calculation_time,
+                                  stats_rays_per_second() / 1e6f ) );
     }
 }
 
 
+bool C3D_RENDER_RAYTRACING::RenderToImage( const wxSize &aSize, wxImage &aImage,
+                                           REPORTER *aStatusTextReporter )
+{
+    if( (aSize.x <= 0) || (aSize.y <= 0) )
+        return false;
+
+    if( m_reloadRequested || !m_accelerator )
+    {
+        if( aStatusTextReporter )
+            aStatusTextReporter->Report( _( "Loading..." ) );
+
+        reload( aStatusTextReporter );
+    }
+
+    const wxSize windowSize = m_windowSize;
+
+    initialize_offscreen_buffer( aSize );
+
+    // The buffer has the layout of the PBO: RGBA, from the bottom line to the top one
+    std::vector<GLubyte> buffer( m_realBufferSize.x * m_realBufferSize.y * 4 );
+
+    m_isOffscreen = true;
+    m_rt_render_state = RT_RENDER_STATE_MAX;
+
+    do
+    {
+        render( buffer.data(), aStatusTextReporter );
+    } while( m_rt_render_state != RT_RENDER_STATE_FINISH );
+
+    m_isOffscreen = false;
+
+    // The buffer is made of whole ray packets, the image is taken from its center
+    const unsigned int x0 = (m_realBufferSize.x - aSize.x) / 2;
+    const unsigned int y0 = (m_realBufferSize.y - aSize.y) / 2;
+
+    aImage.Create( aSize.x, aSize.y, false );
+    unsigned char *dst = aImage.GetData();
+
+    for( int y = 0; y < aSize.y; ++y )
+    {
+        const GLubyte *src = &buffer[ ( (y0 + aSize.y - 1 - y) * m_realBufferSize.x + x0 ) * 4 ];
+
+        for( int x = 0; x < aSize.x; ++x )
+        {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst += 3;
+            src += 4;
+        }
+    }
+
+    // Restore the window size, the buffers will be rebuilt on the next Redraw
+    m_windowSize = windowSize;
+    m_oldWindowsSize = wxSize( -1, -1 );
+    m_settings.CameraGet().SetCurWindowSize( windowSize );
+    m_rt_render_state = RT_RENDER_STATE_MAX;
+
+    return true;
+}
+
+
+bool C3D_RENDER_RAYTRACING::RenderToPNG( const wxSize &aSize, const wxString &aFileName,
+                                         REPORTER *aStatusTextReporter )
+{
+    wxImage image;
+
+    if( !RenderToImage( aSize, image, aStatusTextReporter ) )
+        return false;
+
+    if( wxImage::FindHandler( wxBITMAP_TYPE_PNG ) == NULL )
+        wxImage::AddHandler( new wxPNGHandler );
+
+    return image.SaveFile( aFileName, wxBITMAP_TYPE_PNG );
+}
+
+
 void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
                                                REPORTER *aStatusTextReporter )
 {
@@ -368,53 +467,39 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
 
     const long nrBlocks = (long) m_blockPositions.size();
     const unsigned startTime = GetRunningMicroSecs();
-    bool breakLoop = false;
-    int numBlocksRendered = 0;
+    std::atomic<bool> breakLoop( false );
 
-    #pragma omp parallel for schedule(dynamic) shared(breakLoop) \
-        firstprivate(ptrPBO, nrBlocks, startTime) reduction(+:numBlocksRendered) default(none)
-    for( long iBlock = 0; iBlock < nrBlocks; iBlock++ )
+    // The threads take the blocks in Morton order from a shared counter, so the blocks
+    // rendered are always the first ones, even when the loop is stopped to display them
+    #pragma omp parallel
     {
-
-        #pragma omp flush(breakLoop)
-        if( !breakLoop )
+        while( !breakLoop.load( std::memory_order_relaxed ) )
         {
-            bool process_block;
-
-            // std::vector<bool> stuffs eight bools to each byte, so access to
-            // them can never be natively atomic.
-            #pragma omp critical(checkProcessBlock)
-            {
-                process_block = !m_blockPositionsWasProcessed[iBlock];
-                m_blockPositionsWasProcessed[iBlock] = true;
-            }
+            const long iBlock = m_nextBlockToRender.fetch_add( 1 );
 
-            if( process_block )
-            {
-                rt_render_trace_block( ptrPBO, iBlock );
-                numBlocksRendered++;
+            if( iBlock >= nrBlocks )
+                break;
 
+            rt_render_trace_block( ptrPBO, iBlock );
 
-                // Check if it spend already some time render and request to exit
-                // to display the progress
-                #ifdef _OPENMP
-                if( omp_get_thread_num() == 0 )
-                #endif
-                    if( (GetRunningMicroSecs() - startTime) > 150000 )
-                    {
-                        breakLoop = true;
-                        #pragma omp flush(breakLoop)
-                    }
-            }
+            // Check if it spend already some time render and request to exit
+            // to display the progress
+            #ifdef _OPENMP
+            if( omp_get_thread_num() == 0 )
+            #endif
+                if( !m_isOffscreen && (GetRunningMicroSecs() - startTime) > 150000 )
+                    breakLoop.store( true, std::memory_order_relaxed );
         }
     }
 
-    m_nrBlocksRenderProgress += numBlocksRendered;
+    m_stats_tracing_time += GetRunningMicroSecs() - startTime;
+    m_nrBlocksRenderProgress = std::min( m_nextBlockToRender.load(), nrBlocks );
 
     if( aStatusTextReporter )
-        aStatusTextReporter->Report( wxString::Format( _( "Rendering: %.0f %%" ),
-                                                       (float)(m_nrBlocksRenderProgress * 100) /
-                                                       (float)nrBlocks ) );
+        aStatusTextReporter->Report(
+                wxString::Format( _( "Rendering: %.0f %% (%.2f Mrays/s)" ),
+                                  (float)(m_nrBlocksRenderProgress * 100) / (float)nrBlocks,
+                                  stats_rays_per_second() / 1e6f ) );
 
     // Check if it finish the rendering and if should continue to a post processing
     // or mark it as finished
@@ -554,7 +639,10 @@ void C3D_RENDER_RAYTRACING::rt_trace_AA_packet( const SFVEC3F *aBgColorY,
             const unsigned int idx0y1 = ( x + 0 ) + RAYPACKET_DIM * ( y + 1 );
             const unsigned int idx1y1 = ( x + 1 ) + RAYPACKET_DIM * ( y + 1 );
 
-            // Gets the node info from the hit.
+            // Gets the node info from the hit.  It names the BVH4 node with the leaf child
+            // that was hit: Intersect() with a node info traverses the whole subtree of that
+            // node, its interior children included, so the AA ray is tested against all the
+            // primitives near the hit, not only those of the leaf.  0 means no node.
             const unsigned int nodex0y0 = aHitPck_X0Y0[ i ].m_HitInfo.m_acc_node_info;
             const unsigned int node_AA_x0y0 = aHitPck_AA_X1Y1[ i ].m_HitInfo.m_acc_node_info;
 
@@ -2140,3 +2228,43 @@ void C3D_RENDER_RAYTRACING::initialize_block_positions()
 
     opengl_init_pbo();
 }
+
+
+void C3D_RENDER_RAYTRACING::initialize_offscreen_buffer( const wxSize &aSize )
+{
+    // The buffer is made of whole ray packets, and the window has a margin of half a packet
+    // around it so the jittered rays stay inside the camera window
+    m_realBufferSize = SFVEC2UI( (aSize.x + RAYPACKET_DIM - 1) & RAYPACKET_INVMASK,
+                                 (aSize.y + RAYPACKET_DIM - 1) & RAYPACKET_INVMASK );
+
+    m_windowSize = wxSize( m_realBufferSize.x + RAYPACKET_DIM,
+                           m_realBufferSize.y + RAYPACKET_DIM );
+
+    m_xoffset = RAYPACKET_DIM / 2;
+    m_yoffset = RAYPACKET_DIM / 2;
+
+    m_settings.CameraGet().SetCurWindowSize( m_windowSize );
+    m_postshader_ssao.UpdateSize( m_realBufferSize );
+
+    m_blockPositions.clear();
+    m_blockPositions.reserve( (m_realBufferSize.x / RAYPACKET_DIM) *
+                              (m_realBufferSize.y / RAYPACKET_DIM) );
+
+    unsigned int i = 0;
+
+    while(1)
+    {
+        SFVEC2UI blockPos( DecodeMorton2X(i) * RAYPACKET_DIM,
+                           DecodeMorton2Y(i) * RAYPACKET_DIM );
+        i++;
+
+        if( (blockPos.x >= m_realBufferSize.x) && (blockPos.y >= m_realBufferSize.y) )
+            break;
+
+        if( (blockPos.x < m_realBufferSize.x) && (blockPos.y < m_realBufferSize.y) )
+            m_blockPositions.push_back( blockPos );
+    }
+
+    delete[] m_shaderBuffer;
+    m_shaderBuffer = new SFVEC3F[m_realBufferSize.x * m_realBufferSize.y];
+}
@@ -39,7 +39,9 @@
 #include "cmaterial.h"
 #include <plugins/3dapi/c3dmodel.h>
 
+#include <atomic>
 #include <map>
+#include <wx/image.h>
 
 /// Vector of materials
 typedef std::vector< CBLINN_PHONG_MATERIAL > MODEL_MATERIALS;
@@ -69,6 +71,27 @@ public:
 
     int GetWaitForEditingTimeOut() override;
 
+    /**
+     * Function RenderToImage
+     * renders the board with the raytracing quality settings into aImage, at aSize pixels,
+     * with the current camera view.  It does not need an OpenGL context: the blocks are
+     * traced on all the cores into a CPU buffer, without stopping to display the progress.
+     * The next Redraw() rebuilds the buffers of the window.
+     * @param aSize is the size of the image, which can be larger than the screen
+     * @param aImage receives the rendered image
+     * @return false if the size is not valid
+     */
+    bool RenderToImage( const wxSize &aSize, wxImage &aImage,
+                        REPORTER *aStatusTextReporter = NULL );
+
+    /**
+     * Function RenderToPNG
+     * renders the board as RenderToImage() does, and saves the image as a PNG file.
+     * @return false if the image cannot be rendered or saved
+     */
+    bool RenderToPNG( const wxSize &aSize, const wxString &aFileName,
+                      REPORTER *aStatusTextReporter = NULL );
+
 private:
     bool initializeOpenGL();
     void initializeNewWindowSize();
@@ -117,6 +140,9 @@ private:
 
     bool m_isPreview;
 
+    /// True when rendering to an image: the tracing is not interrupted to display the progress
+    bool m_isOffscreen;
+
     SFVEC3F shadeHit( const SFVEC3F &aBgColor,
                       const RAY &aRay,
                       HITINFO &aHitInfo,
@@ -130,9 +156,18 @@ private:
     /// Time that the render starts
     unsigned long int m_stats_start_rendering_time;
 
+    /// Time spent tracing the blocks, without the display of the progress
+    unsigned long int m_stats_tracing_time;
+
     /// Save the number of blocks progress of the render
     long m_nrBlocksRenderProgress;
 
+    /// Next block to render, shared by the tracing threads
+    std::atomic<long> m_nextBlockToRender;
+
+    /// Returns the camera rays traced per second by the tracing
+    float stats_rays_per_second() const;
+
     CPOSTSHADER_SSAO m_postshader_ssao;
 
     CLIGHTCONTAINER m_lights;
@@ -164,9 +199,6 @@ private:
     /// this encodes the Morton code positions
     std::vector< SFVEC2UI > m_blockPositions;
 
-    /// this flags if a position was already processed (cleared each new render)
-    std::vector< bool > m_blockPositionsWasProcessed;
-
     /// this encodes the Morton code positions (on fast preview mode)
     std::vector< SFVEC2UI > m_blockPositionsFast;
 
@@ -194,7 +226,7 @@ private:
     void add_3D_vias_and_pads_to_container();
     void insert3DViaHole( const VIA* aVia );
     void insert3DPadHole( const D_PAD* aPad );
-    void load_3D_models();
+    void load_3D_models( REPORTER *aStatusTextReporter );
     void add_3D_models( const S3DMODEL *a3DModel,
                         const glm::mat4 &aModelMatrix );
 
@@ -202,6 +234,7 @@ private:
     MAP_MODEL_MATERIALS m_model_materials;
 
     void initialize_block_positions();
+    void initialize_offscreen_buffer( const wxSize &aSize );
 
     void render( GLubyte *ptrPBO, REPORTER *aStatusTextReporter );
     void render_preview( GLubyte *ptrPBO );
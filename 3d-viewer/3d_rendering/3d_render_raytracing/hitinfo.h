@@ -44,7 +44,7 @@ struct HITINFO
 
     const COBJECT *pHitObject;          ///< ( 4) Object that was hitted
     SFVEC2F m_UV;                       ///< ( 8) 2-D texture coordinates
-    unsigned int m_acc_node_info;       ///< ( 4) The acc stores here the node that it hits
+    unsigned int m_acc_node_info;       ///< ( 4) The acc stores here the BVH4 node that it hits
 
     SFVEC3F m_HitPoint;                 ///< (12) hit position
     float m_ShadowFactor;               ///< ( 4) Shadow attenuation (1.0 no shadow, 0.0f darkness)
@@ -30,6 +30,7 @@
 #include "raypacket.h"
 #include "../3d_fastmath.h"
 #include <wx/debug.h>
+#include <cfloat>
 
 
 static void RAYPACKET_GenerateFrustum( CFRUSTUM *m_Frustum, RAY *m_ray )
@@ -69,6 +70,15 @@ RAYPACKET::RAYPACKET( const CCAMERA &aCamera, const SFVEC2I &aWindowsPosition )
 }
 
 
+RAYPACKET::RAYPACKET( const RAY *aRays )
+{
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+        m_ray[i] = aRays[i];
+
+    RAYPACKET_GenerateFrustum( &m_Frustum, m_ray );
+}
+
+
 RAYPACKET::RAYPACKET( const CCAMERA &aCamera,
                       const SFVEC2F &aWindowsPosition )
 {
@@ -151,6 +161,27 @@ RAYPACKET::RAYPACKET( const CCAMERA &aCamera,
 }
 
 
+RAYPACKET_SOA::RAYPACKET_SOA( const RAYPACKET &aRayPacket )
+{
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+    {
+        const RAY &ray = aRayPacket.m_ray[i];
+
+        m_orgX[i] = ray.m_Origin.x;
+        m_orgY[i] = ray.m_Origin.y;
+        m_orgZ[i] = ray.m_Origin.z;
+
+        m_dirX[i] = ray.m_Dir.x;
+        m_dirY[i] = ray.m_Dir.y;
+        m_dirZ[i] = ray.m_Dir.z;
+
+        m_invDirX[i] = glm::clamp( ray.m_InvDir.x, -FLT_MAX, FLT_MAX );
+        m_invDirY[i] = glm::clamp( ray.m_InvDir.y, -FLT_MAX, FLT_MAX );
+        m_invDirZ[i] = glm::clamp( ray.m_InvDir.z, -FLT_MAX, FLT_MAX );
+    }
+}
+
+
 void RAYPACKET_InitRays( const CCAMERA &aCamera,
                          const SFVEC2F &aWindowsPosition,
                          RAY *aRayPck )
@@ -39,6 +39,13 @@
 #define RAYPACKET_INVMASK (unsigned int)(~(RAYPACKET_DIM - 1))
 #define RAYPACKET_RAYS_PER_PACKET (RAYPACKET_DIM * RAYPACKET_DIM)
 
+// SSE2 is used by the SIMD tests of the accelerator when the target always has it.  Defining
+// RAYPACKET_NO_SSE2 selects the scalar tests, which the QA tests compare with the SIMD ones.
+#if !defined( RAYPACKET_NO_SSE2 ) && ( defined( __SSE2__ ) || defined( _M_X64 ) || \
+                                       ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) ) )
+#define RAYPACKET_SSE2
+#endif
+
 
 struct RAYPACKET
 {
@@ -62,6 +69,32 @@ struct RAYPACKET
     RAYPACKET( const CCAMERA &aCamera,
                const SFVEC2F &aWindowsPosition,
                const SFVEC2F &a2DWindowsPosDisplacementFactor );
+
+    /**
+     * Copies the RAYPACKET_RAYS_PER_PACKET rays of aRays, by rows of RAYPACKET_DIM rays.
+     * They have to be as coherent as the rays of a camera for the frustum to hold them.
+     */
+    explicit RAYPACKET( const RAY *aRays );
+};
+
+/**
+ * The rays of a RAYPACKET in SoA layout (an array by coordinate), so four consecutive rays
+ * are tested at once by the SIMD tests.  The inverse directions are clamped to finite
+ * values, so the slab tests never compute 0 * infinity.
+ */
+struct RAYPACKET_SOA
+{
+    alignas( 16 ) float m_orgX[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_orgY[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_orgZ[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_dirX[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_dirY[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_dirZ[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_invDirX[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_invDirY[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_invDirZ[RAYPACKET_RAYS_PER_PACKET];
+
+    explicit RAYPACKET_SOA( const RAYPACKET &aRayPacket );
 };
 
 void RAYPACKET_InitRays( const CCAMERA &aCamera,
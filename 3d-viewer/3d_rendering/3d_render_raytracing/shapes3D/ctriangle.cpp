@@ -33,6 +33,10 @@
 
 #include "ctriangle.h"
 
+#ifdef RAYPACKET_SSE2
+#include <emmintrin.h>
+#endif
+
 
 void CTRIANGLE::pre_calc_const()
 {
@@ -313,6 +317,88 @@ bool CTRIANGLE::IntersectP( const RAY &aRay,
 }
 
 
+unsigned int CTRIANGLE::IntersectRays4( const RAYPACKET_SOA &aRays,
+                                        unsigned int aFirst,
+                                        const float *aTHit ) const
+{
+    const float *org[3] = { &aRays.m_orgX[aFirst], &aRays.m_orgY[aFirst],
+                            &aRays.m_orgZ[aFirst] };
+    const float *dir[3] = { &aRays.m_dirX[aFirst], &aRays.m_dirY[aFirst],
+                            &aRays.m_dirZ[aFirst] };
+
+    const unsigned int ku = s_modulo[m_k + 1];
+    const unsigned int kv = s_modulo[m_k + 2];
+
+    // Same operations, in the same order, as in Intersect(), so the rays found are those
+    // that Intersect() accepts (the normal test is left to Intersect())
+#ifdef RAYPACKET_SSE2
+    const __m128 Ok  = _mm_load_ps( org[m_k] );
+    const __m128 Oku = _mm_load_ps( org[ku] );
+    const __m128 Okv = _mm_load_ps( org[kv] );
+    const __m128 Dk  = _mm_load_ps( dir[m_k] );
+    const __m128 Dku = _mm_load_ps( dir[ku] );
+    const __m128 Dkv = _mm_load_ps( dir[kv] );
+
+    const __m128 nu = _mm_set1_ps( m_nu );
+    const __m128 nv = _mm_set1_ps( m_nv );
+    const __m128 zero = _mm_setzero_ps();
+
+    const __m128 lnd = _mm_div_ps( _mm_set1_ps( 1.0f ),
+                                   _mm_add_ps( _mm_add_ps( Dk, _mm_mul_ps( nu, Dku ) ),
+                                               _mm_mul_ps( nv, Dkv ) ) );
+
+    const __m128 t = _mm_mul_ps( _mm_sub_ps( _mm_sub_ps( _mm_sub_ps( _mm_set1_ps( m_nd ), Ok ),
+                                                         _mm_mul_ps( nu, Oku ) ),
+                                             _mm_mul_ps( nv, Okv ) ),
+                                 lnd );
+
+    __m128 hit = _mm_and_ps( _mm_cmpgt_ps( _mm_load_ps( &aTHit[aFirst] ), t ),
+                             _mm_cmpgt_ps( t, zero ) );
+
+    if( _mm_movemask_ps( hit ) == 0 )
+        return 0;
+
+    const __m128 hu = _mm_sub_ps( _mm_add_ps( Oku, _mm_mul_ps( t, Dku ) ),
+                                  _mm_set1_ps( m_vertex[0][ku] ) );
+    const __m128 hv = _mm_sub_ps( _mm_add_ps( Okv, _mm_mul_ps( t, Dkv ) ),
+                                  _mm_set1_ps( m_vertex[0][kv] ) );
+
+    const __m128 beta = _mm_add_ps( _mm_mul_ps( hv, _mm_set1_ps( m_bnu ) ),
+                                    _mm_mul_ps( hu, _mm_set1_ps( m_bnv ) ) );
+    const __m128 gamma = _mm_add_ps( _mm_mul_ps( hu, _mm_set1_ps( m_cnu ) ),
+                                     _mm_mul_ps( hv, _mm_set1_ps( m_cnv ) ) );
+
+    hit = _mm_and_ps( hit, _mm_cmpge_ps( beta, zero ) );
+    hit = _mm_and_ps( hit, _mm_cmpge_ps( gamma, zero ) );
+    hit = _mm_and_ps( hit, _mm_cmple_ps( _mm_add_ps( beta, gamma ), _mm_set1_ps( 1.0f ) ) );
+
+    return _mm_movemask_ps( hit );
+#else
+    const SFVEC3F &A = m_vertex[0];
+    unsigned int mask = 0;
+
+    for( unsigned int i = 0; i < 4; ++i )
+    {
+        const float lnd = 1.0f / (dir[m_k][i] + m_nu * dir[ku][i] + m_nv * dir[kv][i]);
+        const float t = (m_nd - org[m_k][i] - m_nu * org[ku][i] - m_nv * org[kv][i]) * lnd;
+
+        if( !( (aTHit[aFirst + i] > t) && (t > 0.0f) ) )
+            continue;
+
+        const float hu = org[ku][i] + t * dir[ku][i] - A[ku];
+        const float hv = org[kv][i] + t * dir[kv][i] - A[kv];
+        const float beta = hv * m_bnu + hu * m_bnv;
+        const float gamma = hu * m_cnu + hv * m_cnv;
+
+        if( (beta >= 0.0f) && (gamma >= 0.0f) && ((beta + gamma) <= 1.0f) )
+            mask |= 1 << i;
+    }
+
+    return mask;
+#endif
+}
+
+
 bool CTRIANGLE::Intersects( const CBBOX &aBBox ) const
 {
     //!TODO: improove
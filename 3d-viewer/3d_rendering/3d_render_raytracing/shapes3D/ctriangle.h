@@ -69,6 +69,17 @@ public:
     bool Intersects( const CBBOX &aBBox ) const override;
     SFVEC3F GetDiffuseColor( const HITINFO &aHitInfo ) const override;
 
+    /**
+     * Function IntersectRays4
+     * tests the four rays of aRays starting at aFirst (a multiple of 4) against the
+     * triangle, with the computations of Intersect() made on the four rays at once.
+     * @param aTHit is the distance of the closest hit of each ray of aRays
+     * @return the mask of the rays hitting the triangle (bit i for the ray aFirst + i),
+     *         whose hit information is then computed by Intersect()
+     */
+    unsigned int IntersectRays4( const RAYPACKET_SOA &aRays, unsigned int aFirst,
+                                 const float *aTHit ) const;
+
 private:
     void pre_calc_const();
 
@@ -623,7 +623,7 @@ L_read:
         // a quoted string, will return DSN_STRING
         if( *cur == stringDelimiter )
         {
-            // copy the token, character by character so we can remove doubled up quotes.
+            // copy the token, handling the escape sequences.
             curText.clear();
 
             ++cur;  // skip over the leading delimiter, which is always " in non-specctraMode
@@ -697,7 +697,15 @@ L_read:
                 }
 
                 else
-                    curText += *head++;
+                {
+                    // copy the run of plain characters up to the next escape or quote
+                    const char* run = head;
+
+                    while( head<limit && *head != '\\' && *head != '"' )
+                        ++head;
+
+                    curText.append( run, head );
+                }
 
             }   // while
 
@@ -777,11 +785,11 @@ L_read:
     }           // specctraMode
 
     // non-quoted token, read it into curText.
-    curText.clear();
-
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
+
+    curText.assign( cur, head );
 
     if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
     {
@@ -808,6 +816,63 @@ exit:   // single point of exit, no returns elsewhere please.
 }
 
 
+int DSNLEXER::ReadRawList( std::string& aText )
+{
+    const char* cur     = next;
+    int         depth   = 0;
+    bool        inQuote = false;
+
+    aText.clear();
+
+    prevTok = curTok;
+
+    for(;;)
+    {
+        if( cur >= limit )
+        {
+            if( readLine() == 0 )
+            {
+                curTok = DSN_EOF;
+                Expecting( DSN_RIGHT );
+            }
+
+            cur = start;
+        }
+
+        const char* run = cur;
+
+        for( ; cur < limit; ++cur )
+        {
+            if( inQuote )
+            {
+                if( *cur == '\\' && cur + 1 < limit )
+                    ++cur;
+                else if( *cur == '"' )
+                    inQuote = false;
+            }
+            else if( *cur == '"' )
+                inQuote = true;
+            else if( *cur == '(' )
+                ++depth;
+            else if( *cur == ')' && depth-- == 0 )
+                break;
+        }
+
+        aText.append( run, cur );
+
+        if( cur < limit )
+            break;
+    }
+
+    curText   = *cur;
+    curTok    = DSN_RIGHT;
+    curOffset = cur - start;
+    next      = cur + 1;
+
+    return curTok;
+}
+
+
 wxArrayString* DSNLEXER::ReadCommentLines()
 {
     wxArrayString*  ret = 0;
@@ -22,6 +22,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <cstring>
 #include <wx/wx.h>
 #include <ki_exception.h>
 
@@ -74,7 +75,20 @@ void PARSE_ERROR::init( const wxString& aProblem, const char* aThrowersFile,
 {
     problem.Printf( PARSE_PROBLEM, aProblem.GetData(), aSource.GetData(), aLineNumber, aByteIndex );
 
-    inputLine  = aInputLine;
+    // Some LINE_READERs return lines which are not nul terminated (they point directly in
+    // the file buffer), so only keep up to the end of the line.
+    if( aInputLine )
+    {
+        size_t len = strcspn( aInputLine, "\n" );
+
+        if( aInputLine[len] == '\n' )
+            ++len;
+
+        inputLine.assign( aInputLine, len );
+    }
+    else
+        inputLine.clear();
+
     lineNumber = aLineNumber;
     byteIndex  = aByteIndex;
 
@@ -185,7 +185,7 @@ TRIANGULATION::~TRIANGULATION()
 
 
 void TRIANGULATION::CreateDelaunay( NODES_CONTAINER::iterator aFirst,
-                                    NODES_CONTAINER::iterator aLast )
+                                    NODES_CONTAINER::iterator aLast, bool aRemoveBoundary )
 {
     cleanAll();
 
@@ -208,7 +208,52 @@ void TRIANGULATION::CreateDelaunay( NODES_CONTAINER::iterator aFirst,
     // triangle "outside" the triangulation.)
 
     // Assumes rectangular domain
-    m_helper->RemoveRectangularBoundary<TTLtraits>( dc );
+    if( aRemoveBoundary )
+        m_helper->RemoveRectangularBoundary<TTLtraits>( dc );
+}
+
+
+bool TRIANGULATION::InsertNode( const NODE_PTR& aNode )
+{
+    if( m_leadingEdges.empty() )
+        return false;
+
+    // The most recent triangles are at the front of the leading edges list, so the search
+    // starts close to the last modification
+    DART dart = CreateDart();
+    NODE_PTR node = aNode;
+
+    return m_helper->InsertNode<TTLtraits>( dart, node );
+}
+
+
+bool TRIANGULATION::RemoveNode( const NODE_PTR& aNode )
+{
+    if( m_leadingEdges.empty() )
+        return false;
+
+    DART dart = CreateDart();
+
+    if( !ttl::TRIANGULATION_HELPER::LocateTriangle<TTLtraits>( aNode, dart ) )
+        return false;
+
+    // The node is one of the corners of the located triangle
+    for( int i = 0; i < 3; ++i )
+    {
+        if( dart.GetNode() == aNode )
+        {
+            // Nodes inside the enclosing triangles are never on the boundary
+            if( ttl::TRIANGULATION_HELPER::IsBoundaryNode( dart ) )
+                return false;
+
+            m_helper->RemoveInteriorNode<TTLtraits>( dart );
+            return true;
+        }
+
+        dart.Alpha0().Alpha1();
+    }
+
+    return false;
 }
 
 
@@ -0,0 +1,324 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <climits>
+
+#include <geometry/seg.h>
+#include <geometry/poly_kernels.h>
+#include <geometry/poly_edge_index.h>
+
+///> Maximum number of bands of a polygon
+static const int64_t MAX_BANDS = 1 << 20;
+
+///> Maximum average number of bands overlapped by an edge, which limits the memory used
+///> by the long edges (fracture slits, board outline) when there are many bands
+static const int64_t MAX_BANDS_PER_EDGE = 4;
+
+///> SEG::Distance() truncates the distance to a rounded nearest point: it can be up to one
+///> unit shorter than the true distance, so the edges are searched with this margin
+static const int DISTANCE_MARGIN = 2;
+
+
+POLY_EDGE_INDEX::POLY_EDGE_INDEX( const SHAPE_POLY_SET& aSet )
+{
+    m_polygons.resize( aSet.OutlineCount() );
+
+    for( int i = 0; i < aSet.OutlineCount(); i++ )
+        buildPolygon( aSet.CPolygon( i ), m_polygons[i] );
+}
+
+
+void POLY_EDGE_INDEX::buildPolygon( const SHAPE_POLY_SET::POLYGON& aPolygon,
+                                    POLYGON_BANDS& aBands )
+{
+    aBands.m_valid = !aPolygon.empty() && aPolygon[0].PointCount() >= 3;
+    aBands.m_minX = aBands.m_minY = aBands.m_outlineMinX = aBands.m_outlineMinY = INT_MAX;
+    aBands.m_maxX = aBands.m_maxY = aBands.m_outlineMaxX = aBands.m_outlineMaxY = INT_MIN;
+    aBands.m_bandHeight = 1;
+    aBands.m_bandCount = 0;
+
+    for( int contour = 0; contour < (int) aPolygon.size(); contour++ )
+    {
+        const SHAPE_LINE_CHAIN& chain = aPolygon[contour];
+        int pointCount = chain.PointCount();
+
+        // The crossing number test always closes the contour, the segments only if the
+        // line chain is closed
+        int crossingCount = pointCount >= 3 ? pointCount : 0;
+        int segmentCount = chain.SegmentCount();
+
+        for( int i = 0; i < std::max( crossingCount, segmentCount ); i++ )
+        {
+            EDGE edge;
+
+            edge.m_a = chain.CPoint( i );
+            edge.m_b = chain.CPoint( ( i + 1 ) % pointCount );
+            edge.m_contour = contour;
+            edge.m_vertex = i;
+            edge.m_crossing = i < crossingCount;
+            edge.m_segment = i < segmentCount;
+
+            aBands.m_minX = std::min( aBands.m_minX, std::min( edge.m_a.x, edge.m_b.x ) );
+            aBands.m_minY = std::min( aBands.m_minY, std::min( edge.m_a.y, edge.m_b.y ) );
+            aBands.m_maxX = std::max( aBands.m_maxX, std::max( edge.m_a.x, edge.m_b.x ) );
+            aBands.m_maxY = std::max( aBands.m_maxY, std::max( edge.m_a.y, edge.m_b.y ) );
+
+            aBands.m_edges.push_back( edge );
+        }
+
+        if( contour == 0 )
+        {
+            aBands.m_outlineMinX = aBands.m_minX;
+            aBands.m_outlineMinY = aBands.m_minY;
+            aBands.m_outlineMaxX = aBands.m_maxX;
+            aBands.m_outlineMaxY = aBands.m_maxY;
+        }
+    }
+
+    if( aBands.m_edges.empty() )
+        return;
+
+    // Start with a band for two edges, and use less bands if the long edges would be
+    // stored in too many of them
+    int64_t edgeCount = aBands.m_edges.size();
+    int64_t height = (int64_t) aBands.m_maxY - aBands.m_minY + 1;
+    int64_t bandCount = std::min( std::min( std::max<int64_t>( edgeCount / 2, 1 ), height ),
+                                  MAX_BANDS );
+    int64_t entryCount;
+
+    while( true )
+    {
+        aBands.m_bandHeight = ( height + bandCount - 1 ) / bandCount;
+        aBands.m_bandCount = ( height + aBands.m_bandHeight - 1 ) / aBands.m_bandHeight;
+
+        entryCount = 0;
+
+        for( const EDGE& edge : aBands.m_edges )
+        {
+            entryCount += band( aBands, std::max( edge.m_a.y, edge.m_b.y ) )
+                          - band( aBands, std::min( edge.m_a.y, edge.m_b.y ) ) + 1;
+        }
+
+        if( aBands.m_bandCount == 1 || entryCount <= MAX_BANDS_PER_EDGE * edgeCount )
+            break;
+
+        bandCount = aBands.m_bandCount / 2;
+    }
+
+    // Bucket the edges, in increasing order in each band
+    aBands.m_bandStart.assign( aBands.m_bandCount + 1, 0 );
+
+    for( const EDGE& edge : aBands.m_edges )
+    {
+        int first = band( aBands, std::min( edge.m_a.y, edge.m_b.y ) );
+        int last = band( aBands, std::max( edge.m_a.y, edge.m_b.y ) );
+
+        for( int k = first; k <= last; k++ )
+            aBands.m_bandStart[k + 1]++;
+    }
+
+    for( int k = 0; k < aBands.m_bandCount; k++ )
+        aBands.m_bandStart[k + 1] += aBands.m_bandStart[k];
+
+    std::vector<int> fill( aBands.m_bandStart.begin(), aBands.m_bandStart.end() - 1 );
+    aBands.m_bandEdges.resize( entryCount );
+
+    for( int i = 0; i < (int) aBands.m_edges.size(); i++ )
+    {
+        const EDGE& edge = aBands.m_edges[i];
+        int first = band( aBands, std::min( edge.m_a.y, edge.m_b.y ) );
+        int last = band( aBands, std::max( edge.m_a.y, edge.m_b.y ) );
+
+        for( int k = first; k <= last; k++ )
+            aBands.m_bandEdges[fill[k]++] = i;
+    }
+}
+
+
+int POLY_EDGE_INDEX::band( const POLYGON_BANDS& aBands, int64_t aY )
+{
+    int64_t k = ( aY - aBands.m_minY ) / aBands.m_bandHeight;
+
+    if( aY < aBands.m_minY || aBands.m_bandCount == 0 )
+        return 0;
+
+    return std::min<int64_t>( k, aBands.m_bandCount - 1 );
+}
+
+
+bool POLY_EDGE_INDEX::Contains( const VECTOR2I& aP, int aPolygon, bool aIgnoreHoles ) const
+{
+    const POLYGON_BANDS& bands = m_polygons[aPolygon];
+
+    // The outline contains its edges, so no point outside of its bounding box is inside
+    if( !bands.m_valid
+            || aP.x < bands.m_outlineMinX || aP.x > bands.m_outlineMaxX
+            || aP.y < bands.m_outlineMinY || aP.y > bands.m_outlineMaxY )
+        return false;
+
+    // All the edges crossing the horizontal line of aP are in its band.  They are sorted
+    // by contour, the outline first: each contour is tested when its last edge is found.
+    int k = band( bands, aP.y );
+    int begin = bands.m_bandStart[k];
+    int end = bands.m_bandStart[k + 1];
+    int contour = 0;
+    int result = 0;     // crossing parity, or -1 if aP is on the contour
+
+    for( int i = begin; i <= end; i++ )
+    {
+        const EDGE* edge = ( i < end ) ? &bands.m_edges[bands.m_bandEdges[i]] : nullptr;
+
+        if( edge && !edge->m_crossing )
+            continue;
+
+        if( !edge || edge->m_contour != contour )
+        {
+            if( contour == 0 )
+            {
+                if( !result )
+                    return false;
+
+                if( aIgnoreHoles )
+                    return true;
+            }
+            else if( result && !onEdge( bands, aP, contour ) )
+            {
+                // Inside a hole, and not on its edge
+                return false;
+            }
+
+            if( !edge )
+                break;
+
+            contour = edge->m_contour;
+            result = 0;
+        }
+
+        if( result < 0 )
+            continue;
+
+        switch( POLY_KERNELS::CrossEdge( edge->m_a, edge->m_b, aP ) )
+        {
+        case POLY_KERNELS::EC_BOUNDARY:
+            result = -1;
+            break;
+
+        case POLY_KERNELS::EC_TOGGLE:
+            result = 1 - result;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+
+bool POLY_EDGE_INDEX::onEdge( const POLYGON_BANDS& aBands, const VECTOR2I& aP, int aContour )
+{
+    const int margin = 1 + DISTANCE_MARGIN;
+    int first = band( aBands, (int64_t) aP.y - margin );
+    int last = band( aBands, (int64_t) aP.y + margin );
+
+    for( int k = first; k <= last; k++ )
+    {
+        for( int i = aBands.m_bandStart[k]; i < aBands.m_bandStart[k + 1]; i++ )
+        {
+            const EDGE& edge = aBands.m_edges[aBands.m_bandEdges[i]];
+
+            if( edge.m_contour != aContour || !edge.m_segment )
+                continue;
+
+            if( SEG( edge.m_a, edge.m_b ).Distance( aP ) <= 1 )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+void POLY_EDGE_INDEX::EdgesNear( const VECTOR2I& aP, int aDistance,
+                                 std::vector<SHAPE_POLY_SET::VERTEX_INDEX>& aEdges ) const
+{
+    if( aDistance < 0 )
+        return;
+
+    int64_t limit = (int64_t) aDistance + DISTANCE_MARGIN;
+    std::vector<int> found;
+
+    for( int polygon = 0; polygon < (int) m_polygons.size(); polygon++ )
+    {
+        const POLYGON_BANDS& bands = m_polygons[polygon];
+
+        if( bands.m_edges.empty()
+                || aP.x + limit < bands.m_minX || aP.x - limit > bands.m_maxX
+                || aP.y + limit < bands.m_minY || aP.y - limit > bands.m_maxY )
+            continue;
+
+        int first = band( bands, aP.y - limit );
+        int last = band( bands, aP.y + limit );
+
+        found.clear();
+
+        for( int k = first; k <= last; k++ )
+        {
+            for( int i = bands.m_bandStart[k]; i < bands.m_bandStart[k + 1]; i++ )
+            {
+                const EDGE& edge = bands.m_edges[bands.m_bandEdges[i]];
+
+                if( !edge.m_segment )
+                    continue;
+
+                // An edge overlapping several bands is reported by the first one searched
+                if( std::max( band( bands, std::min( edge.m_a.y, edge.m_b.y ) ), first ) != k )
+                    continue;
+
+                if( aP.x + limit < std::min( edge.m_a.x, edge.m_b.x )
+                        || aP.x - limit > std::max( edge.m_a.x, edge.m_b.x )
+                        || aP.y + limit < std::min( edge.m_a.y, edge.m_b.y )
+                        || aP.y - limit > std::max( edge.m_a.y, edge.m_b.y ) )
+                    continue;
+
+                found.push_back( bands.m_bandEdges[i] );
+            }
+        }
+
+        if( last > first )
+            std::sort( found.begin(), found.end() );
+
+        for( int i : found )
+        {
+            SHAPE_POLY_SET::VERTEX_INDEX index;
+
+            index.m_polygon = polygon;
+            index.m_contour = bands.m_edges[i].m_contour;
+            index.m_vertex = bands.m_edges[i].m_vertex;
+
+            aEdges.push_back( index );
+        }
+    }
+}
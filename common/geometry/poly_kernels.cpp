@@ -0,0 +1,451 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include <geometry/poly_kernels.h>
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define POLY_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+// The kernels read the points as an array of ints
+static_assert( sizeof( VECTOR2I ) == 2 * sizeof( int ), "VECTOR2I is not two packed ints" );
+
+
+/**
+ * Classifies the edge aA-aB for the crossing number test of aP.  This is the loop body
+ * of the original SHAPE_POLY_SET::pointInPolygon(), which all the kernels reproduce.
+ */
+static inline POLY_KERNELS::EDGE_CROSSING crossEdge( const VECTOR2I& aA, const VECTOR2I& aB,
+                                                     const VECTOR2I& aP )
+{
+    if( aB.y == aP.y )
+    {
+        if( ( aB.x == aP.x ) || ( aA.y == aP.y && ( ( aB.x > aP.x ) == ( aA.x < aP.x ) ) ) )
+            return POLY_KERNELS::EC_BOUNDARY;
+    }
+
+    if( ( aA.y < aP.y ) != ( aB.y < aP.y ) )
+    {
+        if( aA.x >= aP.x && aB.x > aP.x )
+            return POLY_KERNELS::EC_TOGGLE;
+
+        if( aA.x < aP.x && aB.x <= aP.x )
+            return POLY_KERNELS::EC_NONE;
+
+        int64_t d = (int64_t) ( aA.x - aP.x ) * (int64_t) ( aB.y - aP.y ) -
+                    (int64_t) ( aB.x - aP.x ) * (int64_t) ( aA.y - aP.y );
+
+        if( !d )
+            return POLY_KERNELS::EC_BOUNDARY;
+
+        if( ( d > 0 ) == ( aB.y > aA.y ) )
+            return POLY_KERNELS::EC_TOGGLE;
+    }
+
+    return POLY_KERNELS::EC_NONE;
+}
+
+
+/**
+ * Tests the edges aFirst to aCount - 1 (the last one closing the polygon).
+ * @return -1 if aP is on an edge, the parity of the crossings otherwise
+ */
+static int crossEdgesScalar( const VECTOR2I* aPoints, int aCount, int aFirst, const VECTOR2I& aP )
+{
+    int result = 0;
+
+    for( int i = aFirst; i < aCount; ++i )
+    {
+        const VECTOR2I& next = ( i + 1 == aCount ? aPoints[0] : aPoints[i + 1] );
+
+        switch( crossEdge( aPoints[i], next, aP ) )
+        {
+        case POLY_KERNELS::EC_BOUNDARY:
+            return -1;
+
+        case POLY_KERNELS::EC_TOGGLE:
+            result = 1 - result;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return result;
+}
+
+
+/**
+ * Tests if aP is within aDistance of the edges aFirst to aEdgeCount - 1, in floating
+ * point.  The margin covers the rounding of SEG::NearestPoint() and SEG::Distance().
+ */
+static void edgesNearScalar( const VECTOR2I* aPoints, int aCount, int aFirst, int aEdgeCount,
+                             const VECTOR2I& aP, double aLimit2, std::vector<int>& aEdges )
+{
+    for( int i = aFirst; i < aEdgeCount; ++i )
+    {
+        const VECTOR2I& a = aPoints[i];
+        const VECTOR2I& b = ( i + 1 == aCount ? aPoints[0] : aPoints[i + 1] );
+
+        double dx = (double) b.x - a.x;
+        double dy = (double) b.y - a.y;
+        double wx = (double) aP.x - a.x;
+        double wy = (double) aP.y - a.y;
+
+        double t = ( wx * dx + wy * dy ) / std::max( dx * dx + dy * dy, 1.0 );
+        t = std::min( std::max( t, 0.0 ), 1.0 );
+
+        double ex = wx - t * dx;
+        double ey = wy - t * dy;
+
+        if( ex * ex + ey * ey <= aLimit2 )
+            aEdges.push_back( i );
+    }
+}
+
+
+#ifdef POLY_KERNELS_X86
+
+__attribute__(( target( "sse2" ) ))
+static inline void loadPoints4( const VECTOR2I* aPoints, __m128i& aX, __m128i& aY )
+{
+    // x0 y0 x1 y1, x2 y2 x3 y3 -> x0 x1 y0 y1, x2 x3 y2 y3 -> x0 x1 x2 x3, y0 y1 y2 y3
+    __m128i lo = _mm_loadu_si128( (const __m128i*) aPoints );
+    __m128i hi = _mm_loadu_si128( (const __m128i*) ( aPoints + 2 ) );
+
+    lo = _mm_shuffle_epi32( lo, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+    hi = _mm_shuffle_epi32( hi, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+
+    aX = _mm_unpacklo_epi64( lo, hi );
+    aY = _mm_unpackhi_epi64( lo, hi );
+}
+
+
+__attribute__(( target( "sse2" ) ))
+static int crossEdgesSse2( const VECTOR2I* aPoints, int aCount, const VECTOR2I& aP )
+{
+    const __m128i px = _mm_set1_epi32( aP.x );
+    const __m128i py = _mm_set1_epi32( aP.y );
+    const __m128i ones = _mm_set1_epi32( -1 );
+
+    int parity = 0;
+    int i = 0;
+
+    // Edge i needs the point i + 1: the blocks stop before the closing edge
+    for( ; i + 4 < aCount; i += 4 )
+    {
+        __m128i ax, ay, bx, by;
+
+        loadPoints4( aPoints + i, ax, ay );
+        loadPoints4( aPoints + i + 1, bx, by );
+
+        __m128i bXgt = _mm_cmpgt_epi32( bx, px );
+        __m128i aXlt = _mm_cmpgt_epi32( px, ax );
+        __m128i sameX = _mm_xor_si128( _mm_xor_si128( bXgt, aXlt ), ones );
+
+        __m128i boundary = _mm_and_si128( _mm_cmpeq_epi32( by, py ),
+                                          _mm_or_si128( _mm_cmpeq_epi32( bx, px ),
+                                                        _mm_and_si128( _mm_cmpeq_epi32( ay, py ),
+                                                                       sameX ) ) );
+
+        if( _mm_movemask_ps( _mm_castsi128_ps( boundary ) ) )
+            return -1;
+
+        __m128i straddle = _mm_xor_si128( _mm_cmpgt_epi32( py, ay ), _mm_cmpgt_epi32( py, by ) );
+        __m128i toggle = _mm_andnot_si128( aXlt, _mm_and_si128( straddle, bXgt ) );
+        __m128i ambiguous = _mm_and_si128( straddle, sameX );
+
+        parity ^= __builtin_popcount( _mm_movemask_ps( _mm_castsi128_ps( toggle ) ) ) & 1;
+
+        // Edges whose ends are on both sides of the point need the exact cross product
+        for( int bits = _mm_movemask_ps( _mm_castsi128_ps( ambiguous ) ); bits; bits &= bits - 1 )
+        {
+            int k = i + __builtin_ctz( bits );
+
+            switch( crossEdge( aPoints[k], aPoints[k + 1], aP ) )
+            {
+            case POLY_KERNELS::EC_BOUNDARY: return -1;
+            case POLY_KERNELS::EC_TOGGLE:   parity ^= 1; break;
+            default:          break;
+            }
+        }
+    }
+
+    int tail = crossEdgesScalar( aPoints, aCount, i, aP );
+
+    return tail < 0 ? -1 : parity ^ tail;
+}
+
+
+__attribute__(( target( "sse2" ) ))
+static void edgesNearSse2( const VECTOR2I* aPoints, int aCount, int aEdgeCount,
+                           const VECTOR2I& aP, double aLimit2, std::vector<int>& aEdges )
+{
+    const __m128d px = _mm_set1_pd( aP.x );
+    const __m128d py = _mm_set1_pd( aP.y );
+    const __m128d limit = _mm_set1_pd( aLimit2 );
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd( 1.0 );
+
+    int i = 0;
+
+    for( ; i + 2 < aCount && i + 2 <= aEdgeCount; i += 2 )
+    {
+        // x0 y0 x1 y1 -> x0 x1 y0 y1
+        __m128i a = _mm_shuffle_epi32( _mm_loadu_si128( (const __m128i*) ( aPoints + i ) ),
+                                       _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        __m128i b = _mm_shuffle_epi32( _mm_loadu_si128( (const __m128i*) ( aPoints + i + 1 ) ),
+                                       _MM_SHUFFLE( 3, 1, 2, 0 ) );
+
+        __m128d ax = _mm_cvtepi32_pd( a );
+        __m128d ay = _mm_cvtepi32_pd( _mm_srli_si128( a, 8 ) );
+        __m128d dx = _mm_sub_pd( _mm_cvtepi32_pd( b ), ax );
+        __m128d dy = _mm_sub_pd( _mm_cvtepi32_pd( _mm_srli_si128( b, 8 ) ), ay );
+        __m128d wx = _mm_sub_pd( px, ax );
+        __m128d wy = _mm_sub_pd( py, ay );
+
+        __m128d len2 = _mm_max_pd( _mm_add_pd( _mm_mul_pd( dx, dx ), _mm_mul_pd( dy, dy ) ), one );
+        __m128d t = _mm_div_pd( _mm_add_pd( _mm_mul_pd( wx, dx ), _mm_mul_pd( wy, dy ) ), len2 );
+        t = _mm_min_pd( _mm_max_pd( t, zero ), one );
+
+        __m128d ex = _mm_sub_pd( wx, _mm_mul_pd( t, dx ) );
+        __m128d ey = _mm_sub_pd( wy, _mm_mul_pd( t, dy ) );
+        __m128d d2 = _mm_add_pd( _mm_mul_pd( ex, ex ), _mm_mul_pd( ey, ey ) );
+
+        for( int bits = _mm_movemask_pd( _mm_cmple_pd( d2, limit ) ); bits; bits &= bits - 1 )
+            aEdges.push_back( i + __builtin_ctz( bits ) );
+    }
+
+    edgesNearScalar( aPoints, aCount, i, aEdgeCount, aP, aLimit2, aEdges );
+}
+
+
+__attribute__(( target( "avx2,fma" ) ))
+static inline void loadPoints8( const VECTOR2I* aPoints, __m256i& aX, __m256i& aY )
+{
+    const __m256i split = _mm256_setr_epi32( 0, 2, 4, 6, 1, 3, 5, 7 );
+
+    // x0 y0 .. x3 y3, x4 y4 .. x7 y7 -> x0..x3 y0..y3, x4..x7 y4..y7
+    __m256i lo = _mm256_permutevar8x32_epi32(
+            _mm256_loadu_si256( (const __m256i*) aPoints ), split );
+    __m256i hi = _mm256_permutevar8x32_epi32(
+            _mm256_loadu_si256( (const __m256i*) ( aPoints + 4 ) ), split );
+
+    aX = _mm256_permute2x128_si256( lo, hi, 0x20 );
+    aY = _mm256_permute2x128_si256( lo, hi, 0x31 );
+}
+
+
+__attribute__(( target( "avx2,fma" ) ))
+static int crossEdgesAvx2( const VECTOR2I* aPoints, int aCount, const VECTOR2I& aP )
+{
+    const __m256i px = _mm256_set1_epi32( aP.x );
+    const __m256i py = _mm256_set1_epi32( aP.y );
+    const __m256i ones = _mm256_set1_epi32( -1 );
+
+    int parity = 0;
+    int i = 0;
+
+    for( ; i + 8 < aCount; i += 8 )
+    {
+        __m256i ax, ay, bx, by;
+
+        loadPoints8( aPoints + i, ax, ay );
+        loadPoints8( aPoints + i + 1, bx, by );
+
+        __m256i bXgt = _mm256_cmpgt_epi32( bx, px );
+        __m256i aXlt = _mm256_cmpgt_epi32( px, ax );
+        __m256i sameX = _mm256_xor_si256( _mm256_xor_si256( bXgt, aXlt ), ones );
+
+        __m256i boundary = _mm256_and_si256( _mm256_cmpeq_epi32( by, py ),
+                _mm256_or_si256( _mm256_cmpeq_epi32( bx, px ),
+                                 _mm256_and_si256( _mm256_cmpeq_epi32( ay, py ), sameX ) ) );
+
+        if( !_mm256_testz_si256( boundary, boundary ) )
+            return -1;
+
+        __m256i straddle = _mm256_xor_si256( _mm256_cmpgt_epi32( py, ay ),
+                                             _mm256_cmpgt_epi32( py, by ) );
+
+        if( _mm256_testz_si256( straddle, straddle ) )
+            continue;
+
+        __m256i toggle = _mm256_andnot_si256( aXlt, _mm256_and_si256( straddle, bXgt ) );
+        __m256i ambiguous = _mm256_and_si256( straddle, sameX );
+
+        parity ^= __builtin_popcount( _mm256_movemask_ps( _mm256_castsi256_ps( toggle ) ) ) & 1;
+
+        for( int bits = _mm256_movemask_ps( _mm256_castsi256_ps( ambiguous ) ); bits;
+             bits &= bits - 1 )
+        {
+            int k = i + __builtin_ctz( bits );
+
+            switch( crossEdge( aPoints[k], aPoints[k + 1], aP ) )
+            {
+            case POLY_KERNELS::EC_BOUNDARY: return -1;
+            case POLY_KERNELS::EC_TOGGLE:   parity ^= 1; break;
+            default:          break;
+            }
+        }
+    }
+
+    int tail = crossEdgesScalar( aPoints, aCount, i, aP );
+
+    return tail < 0 ? -1 : parity ^ tail;
+}
+
+
+__attribute__(( target( "avx2,fma" ) ))
+static void edgesNearAvx2( const VECTOR2I* aPoints, int aCount, int aEdgeCount,
+                           const VECTOR2I& aP, double aLimit2, std::vector<int>& aEdges )
+{
+    const __m256d px = _mm256_set1_pd( aP.x );
+    const __m256d py = _mm256_set1_pd( aP.y );
+    const __m256d limit = _mm256_set1_pd( aLimit2 );
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd( 1.0 );
+
+    int i = 0;
+
+    for( ; i + 4 < aCount && i + 4 <= aEdgeCount; i += 4 )
+    {
+        __m128i axi, ayi, bxi, byi;
+
+        loadPoints4( aPoints + i, axi, ayi );
+        loadPoints4( aPoints + i + 1, bxi, byi );
+
+        __m256d ax = _mm256_cvtepi32_pd( axi );
+        __m256d ay = _mm256_cvtepi32_pd( ayi );
+        __m256d dx = _mm256_sub_pd( _mm256_cvtepi32_pd( bxi ), ax );
+        __m256d dy = _mm256_sub_pd( _mm256_cvtepi32_pd( byi ), ay );
+        __m256d wx = _mm256_sub_pd( px, ax );
+        __m256d wy = _mm256_sub_pd( py, ay );
+
+        __m256d len2 = _mm256_max_pd( _mm256_fmadd_pd( dx, dx, _mm256_mul_pd( dy, dy ) ), one );
+        __m256d t = _mm256_div_pd( _mm256_fmadd_pd( wx, dx, _mm256_mul_pd( wy, dy ) ), len2 );
+        t = _mm256_min_pd( _mm256_max_pd( t, zero ), one );
+
+        __m256d ex = _mm256_fnmadd_pd( t, dx, wx );
+        __m256d ey = _mm256_fnmadd_pd( t, dy, wy );
+        __m256d d2 = _mm256_fmadd_pd( ex, ex, _mm256_mul_pd( ey, ey ) );
+
+        for( int bits = _mm256_movemask_pd( _mm256_cmp_pd( d2, limit, _CMP_LE_OQ ) ); bits;
+             bits &= bits - 1 )
+        {
+            aEdges.push_back( i + __builtin_ctz( bits ) );
+        }
+    }
+
+    edgesNearScalar( aPoints, aCount, i, aEdgeCount, aP, aLimit2, aEdges );
+}
+
+#endif  // POLY_KERNELS_X86
+
+
+POLY_KERNELS::ISA POLY_KERNELS::BestIsa()
+{
+#ifdef POLY_KERNELS_X86
+    // AVX2 code uses FMA too; every AVX2 processor has it, but check anyway
+    static const ISA best = __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" )
+                                    ? AVX2
+                                    : __builtin_cpu_supports( "sse2" ) ? SSE2 : SCALAR;
+    return best;
+#else
+    return SCALAR;
+#endif
+}
+
+
+static std::atomic<int>& isaSetting()
+{
+    static std::atomic<int> isa( POLY_KERNELS::BestIsa() );
+    return isa;
+}
+
+
+POLY_KERNELS::ISA POLY_KERNELS::Isa()
+{
+    return (ISA) isaSetting().load( std::memory_order_relaxed );
+}
+
+
+void POLY_KERNELS::SetIsa( ISA aIsa )
+{
+    isaSetting().store( std::min( aIsa, BestIsa() ), std::memory_order_relaxed );
+}
+
+
+bool POLY_KERNELS::PointInPolygon( const VECTOR2I* aPoints, int aCount, const VECTOR2I& aP )
+{
+    if( aCount < 3 )
+        return false;
+
+    int result;
+
+    switch( Isa() )
+    {
+#ifdef POLY_KERNELS_X86
+    case AVX2: result = crossEdgesAvx2( aPoints, aCount, aP ); break;
+    case SSE2: result = crossEdgesSse2( aPoints, aCount, aP ); break;
+#endif
+    default:   result = crossEdgesScalar( aPoints, aCount, 0, aP ); break;
+    }
+
+    return result != 0;
+}
+
+
+POLY_KERNELS::EDGE_CROSSING POLY_KERNELS::CrossEdge( const VECTOR2I& aA, const VECTOR2I& aB,
+                                                    const VECTOR2I& aP )
+{
+    return crossEdge( aA, aB, aP );
+}
+
+
+void POLY_KERNELS::EdgesNear( const VECTOR2I* aPoints, int aCount, int aEdgeCount,
+                              const VECTOR2I& aP, int aDistance, std::vector<int>& aEdges )
+{
+    if( aDistance < 0 || aEdgeCount <= 0 )
+        return;
+
+    // SEG::Distance() truncates the distance to a rounded nearest point: it can be up to
+    // one unit shorter than the true distance
+    double limit = (double) aDistance + 2.0;
+    double limit2 = limit * limit;
+
+    switch( Isa() )
+    {
+#ifdef POLY_KERNELS_X86
+    case AVX2: edgesNearAvx2( aPoints, aCount, aEdgeCount, aP, limit2, aEdges ); break;
+    case SSE2: edgesNearSse2( aPoints, aCount, aEdgeCount, aP, limit2, aEdges ); break;
+#endif
+    default:   edgesNearScalar( aPoints, aCount, 0, aEdgeCount, aP, limit2, aEdges ); break;
+    }
+}
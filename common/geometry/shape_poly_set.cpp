@@ -32,6 +32,11 @@
 #include <set>
 #include <list>
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <thread>
 #include <unordered_set>
 
 #include <common.h>
@@ -41,6 +46,8 @@
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_poly_set.h>
+#include <geometry/poly_kernels.h>
+#include <geometry/poly_edge_index.h>
 
 #include "poly2tri/poly2tri.h"
 
@@ -53,7 +60,8 @@ SHAPE_POLY_SET::SHAPE_POLY_SET() :
 
 
 SHAPE_POLY_SET::SHAPE_POLY_SET( const SHAPE_POLY_SET& aOther ) :
-    SHAPE( SH_POLY_SET ), m_polys( aOther.m_polys )
+    SHAPE( SH_POLY_SET ), m_polys( aOther.m_polys ),
+    m_edgeIndex( std::atomic_load( &aOther.m_edgeIndex ) )
 {
 }
 
@@ -154,6 +162,8 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
 
 int SHAPE_POLY_SET::NewOutline()
 {
+    m_edgeIndex.reset();
+
     SHAPE_LINE_CHAIN empty_path;
     POLYGON poly;
 
@@ -166,6 +176,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    m_edgeIndex.reset();
+
     SHAPE_LINE_CHAIN empty_path;
 
     empty_path.SetClosed( true );
@@ -183,6 +195,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDuplication )
 {
+    m_edgeIndex.reset();
+
     if( aOutline < 0 )
         aOutline += m_polys.size();
 
@@ -204,6 +218,8 @@ int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDu
 
 void SHAPE_POLY_SET::InsertVertex( int aGlobalIndex, VECTOR2I aNewVertex )
 {
+    m_edgeIndex.reset();
+
     VERTEX_INDEX index;
 
     if( aGlobalIndex < 0 )
@@ -426,6 +442,8 @@ bool SHAPE_POLY_SET::IsSelfIntersecting()
 
 int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 {
+    m_edgeIndex.reset();
+
     assert( aOutline.IsClosed() );
 
     POLYGON poly;
@@ -440,6 +458,8 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
 int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 {
+    m_edgeIndex.reset();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -486,31 +506,326 @@ const SHAPE_LINE_CHAIN SHAPE_POLY_SET::convertFromClipper( const Path& aPath )
 }
 
 
-void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aOtherShape,
-        POLYGON_MODE aFastMode )
+///> Minimum number of points of the contours given to a Clipper run, when the input is split
+static const size_t MIN_CLIPPER_JOB_POINTS = 4096;
+
+
+/**
+ * Class CLIPPER_JOB
+ * A Clipper run on some of the contours of a boolean operation.  Clipper rounds the
+ * intersections to its scanlines, which are the Y of all the vertices, so a run on some of
+ * the contours gives the same polygons as a run on all of them only with the scanlines of
+ * all the contours.  The run is split in two steps: Prepare() loads the contours and
+ * returns the scanlines of the job, Execute() runs Clipper with the scanlines of the other
+ * jobs in the Y range of the job.  A job on all the contours needs no other scanlines, and
+ * is run in a single step by Run().
+ */
+class CLIPPER_JOB
 {
-    Clipper c;
+public:
+    virtual ~CLIPPER_JOB() {}
+
+    virtual void Prepare( std::vector<cInt>& aScanlines ) = 0;
+    virtual void Execute( const std::vector<cInt>& aScanlines, PolyTree& aSolution ) = 0;
+    virtual void Run( PolyTree& aSolution ) = 0;
+};
 
-    if( aFastMode == PM_STRICTLY_SIMPLE )
-        c.StrictlySimple( true );
 
-    for( const POLYGON& poly : m_polys )
+typedef std::function<CLIPPER_JOB*( const std::vector<int>& aPaths )> CLIPPER_JOB_FACTORY;
+
+
+class BOOLEAN_JOB : public CLIPPER_JOB
+{
+public:
+    BOOLEAN_JOB( const std::vector<Path>& aPaths, const std::vector<PolyType>& aTypes,
+                 const std::vector<int>& aSelection, ClipType aType, bool aStrictlySimple ) :
+        m_type( aType )
     {
-        for( unsigned int i = 0; i < poly.size(); i++ )
-            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), ptSubject, true );
+        m_clipper.StrictlySimple( aStrictlySimple );
+
+        for( int i : aSelection )
+            m_clipper.AddPath( aPaths[i], aTypes[i], true );
     }
 
-    for( const POLYGON& poly : aOtherShape.m_polys )
+    void Prepare( std::vector<cInt>& aScanlines ) override
     {
-        for( unsigned int i = 0; i < poly.size(); i++ )
-            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), ptClip, true );
+        m_clipper.GetScanlines( aScanlines );
+    }
+
+    void Execute( const std::vector<cInt>& aScanlines, PolyTree& aSolution ) override
+    {
+        m_clipper.AddScanlines( aScanlines );
+        m_clipper.Execute( m_type, aSolution, pftNonZero, pftNonZero );
+    }
+
+    void Run( PolyTree& aSolution ) override
+    {
+        m_clipper.Execute( m_type, aSolution, pftNonZero, pftNonZero );
+    }
+
+private:
+    Clipper  m_clipper;
+    ClipType m_type;
+};
+
+
+class OFFSET_JOB : public CLIPPER_JOB
+{
+public:
+    OFFSET_JOB( const std::vector<Path>& aPaths, const std::vector<int>& aSelection,
+                double aDelta, double aArcTolerance ) :
+        m_delta( aDelta )
+    {
+        for( int i : aSelection )
+            m_offset.AddPath( aPaths[i], jtRound, etClosedPolygon );
+
+        m_offset.ArcTolerance = aArcTolerance;
+    }
+
+    void Prepare( std::vector<cInt>& aScanlines ) override
+    {
+        m_offset.PrepareExecute( m_delta, aScanlines );
+    }
+
+    void Execute( const std::vector<cInt>& aScanlines, PolyTree& aSolution ) override
+    {
+        m_offset.FinishExecute( aSolution, m_delta, aScanlines );
+    }
+
+    void Run( PolyTree& aSolution ) override
+    {
+        m_offset.Execute( aSolution, m_delta );
+    }
+
+private:
+    ClipperOffset m_offset;
+    double        m_delta;
+};
+
+
+/**
+ * Splits the contours aPaths in jobs for separate Clipper runs.  The contours are first
+ * grouped in clusters, two contours whose bounding boxes (inflated by aMargin) overlap
+ * being in the same cluster.  The contours of two clusters never interact.  The small
+ * clusters are then grouped from top to bottom, so each job covers a narrow range of
+ * scanlines, in jobs of at least MIN_CLIPPER_JOB_POINTS points.
+ */
+static std::vector<std::vector<int>> splitClipperJobs( const std::vector<Path>& aPaths,
+                                                       cInt aMargin )
+{
+    std::vector<IntRect> boxes( aPaths.size() );
+
+    for( size_t i = 0; i < aPaths.size(); i++ )
+    {
+        IntRect& box = boxes[i];
+
+        box.left = box.top = std::numeric_limits<cInt>::max();
+        box.right = box.bottom = std::numeric_limits<cInt>::min();
+
+        for( const IntPoint& pt : aPaths[i] )
+        {
+            box.left = std::min( box.left, pt.X - aMargin );
+            box.top = std::min( box.top, pt.Y - aMargin );
+            box.right = std::max( box.right, pt.X + aMargin );
+            box.bottom = std::max( box.bottom, pt.Y + aMargin );
+        }
+    }
+
+    // Union-find of the contours, sweeping the boxes from left to right
+    std::vector<int> parent( aPaths.size() );
+    std::iota( parent.begin(), parent.end(), 0 );
+
+    auto find = [&]( int aIdx )
+    {
+        while( parent[aIdx] != aIdx )
+            aIdx = parent[aIdx] = parent[parent[aIdx]];
+
+        return aIdx;
+    };
+
+    std::vector<int> order( aPaths.size() );
+    std::iota( order.begin(), order.end(), 0 );
+    std::sort( order.begin(), order.end(), [&]( int a, int b )
+    {
+        return boxes[a].left < boxes[b].left;
+    } );
+
+    std::vector<int> active;
+
+    for( int i : order )
+    {
+        const IntRect& box = boxes[i];
+
+        if( aPaths[i].empty() )
+            continue;
+
+        active.erase( std::remove_if( active.begin(), active.end(), [&]( int j )
+        {
+            return boxes[j].right < box.left;
+        } ), active.end() );
+
+        for( int j : active )
+        {
+            if( boxes[j].top <= box.bottom && box.top <= boxes[j].bottom )
+            {
+                int ri = find( i );
+                int rj = find( j );
+
+                // The cluster is named after its first contour
+                parent[std::max( ri, rj )] = std::min( ri, rj );
+            }
+        }
+
+        active.push_back( i );
     }
 
-    PolyTree solution;
+    std::vector<std::vector<int>> clusters;
+    std::vector<cInt> clusterTop;
+    std::vector<int> clusterOf( aPaths.size(), -1 );
 
-    c.Execute( aType, solution, pftNonZero, pftNonZero );
+    for( int i = 0; i < (int) aPaths.size(); i++ )
+    {
+        int root = find( i );
+
+        if( clusterOf[root] < 0 )
+        {
+            clusterOf[root] = clusters.size();
+            clusters.emplace_back();
+            clusterTop.push_back( boxes[i].top );
+        }
+
+        clusters[clusterOf[root]].push_back( i );
+        clusterTop[clusterOf[root]] = std::min( clusterTop[clusterOf[root]], boxes[i].top );
+    }
+
+    std::vector<int> clusterOrder( clusters.size() );
+    std::iota( clusterOrder.begin(), clusterOrder.end(), 0 );
+    std::stable_sort( clusterOrder.begin(), clusterOrder.end(), [&]( int a, int b )
+    {
+        return clusterTop[a] < clusterTop[b];
+    } );
+
+    std::vector<std::vector<int>> jobs;
+    size_t jobPoints = 0;
+
+    for( int c : clusterOrder )
+    {
+        if( jobs.empty() || jobPoints >= MIN_CLIPPER_JOB_POINTS )
+        {
+            jobs.emplace_back();
+            jobPoints = 0;
+        }
+
+        for( int i : clusters[c] )
+        {
+            jobs.back().push_back( i );
+            jobPoints += aPaths[i].size();
+        }
+    }
 
-    importTree( &solution );
+    return jobs;
+}
+
+
+///> Runs aFunc( 0 ) to aFunc( aCount - 1 ) on aThreadCount threads
+static void parallelFor( size_t aCount, size_t aThreadCount,
+                         const std::function<void( size_t )>& aFunc )
+{
+    std::atomic<size_t> next( 0 );
+    std::vector<std::thread> threads;
+
+    for( size_t i = 0; i < std::min( aThreadCount, aCount ); i++ )
+    {
+        threads.emplace_back( [&]()
+        {
+            for( size_t k = next++; k < aCount; k = next++ )
+                aFunc( k );
+        } );
+    }
+
+    for( std::thread& thread : threads )
+        thread.join();
+}
+
+
+/**
+ * Runs the Clipper jobs made by aNewJob on the contours aPaths, and returns their
+ * solutions.  With a single boolean thread, or a single cluster of contours, there is a
+ * single job on all the contours.
+ * @param aMargin is the distance up to which two contours can interact
+ */
+static std::vector<std::unique_ptr<PolyTree>> runClipperJobs( const std::vector<Path>& aPaths,
+                                                              cInt aMargin,
+                                                              const CLIPPER_JOB_FACTORY& aNewJob )
+{
+    size_t threadCount = SHAPE_POLY_SET::BooleanThreadCount();
+
+    if( threadCount == 0 )
+        threadCount = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+
+    std::vector<std::vector<int>> selections;
+
+    if( threadCount > 1 )
+        selections = splitClipperJobs( aPaths, aMargin );
+
+    std::vector<std::unique_ptr<PolyTree>> solutions;
+
+    if( selections.size() < 2 )
+    {
+        std::vector<int> all( aPaths.size() );
+        std::iota( all.begin(), all.end(), 0 );
+
+        std::unique_ptr<CLIPPER_JOB> job( aNewJob( all ) );
+
+        solutions.emplace_back( new PolyTree );
+        job->Run( *solutions.back() );
+        return solutions;
+    }
+
+    size_t count = selections.size();
+    std::vector<std::unique_ptr<CLIPPER_JOB>> jobs( count );
+    std::vector<std::vector<cInt>> scanlines( count );
+
+    parallelFor( count, threadCount, [&]( size_t k )
+    {
+        jobs[k].reset( aNewJob( selections[k] ) );
+        jobs[k]->Prepare( scanlines[k] );
+    } );
+
+    std::vector<cInt> all;
+
+    for( const std::vector<cInt>& jobScanlines : scanlines )
+        all.insert( all.end(), jobScanlines.begin(), jobScanlines.end() );
+
+    std::sort( all.begin(), all.end() );
+    all.erase( std::unique( all.begin(), all.end() ), all.end() );
+
+    for( size_t k = 0; k < count; k++ )
+        solutions.emplace_back( new PolyTree );
+
+    parallelFor( count, threadCount, [&]( size_t k )
+    {
+        std::vector<cInt> extra;
+
+        if( !scanlines[k].empty() )
+        {
+            auto range = std::minmax_element( scanlines[k].begin(), scanlines[k].end() );
+            extra.assign( std::lower_bound( all.begin(), all.end(), *range.first ),
+                          std::upper_bound( all.begin(), all.end(), *range.second ) );
+        }
+
+        jobs[k]->Execute( extra, *solutions[k] );
+        jobs[k].reset();
+    } );
+
+    return solutions;
+}
+
+
+void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aOtherShape,
+        POLYGON_MODE aFastMode )
+{
+    booleanOp( aType, *this, aOtherShape, aFastMode );
 }
 
 
@@ -519,28 +834,36 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType,
         const SHAPE_POLY_SET& aOtherShape,
         POLYGON_MODE aFastMode )
 {
-    Clipper c;
+    m_edgeIndex.reset();
 
-    if( aFastMode == PM_STRICTLY_SIMPLE )
-        c.StrictlySimple( true );
+    std::vector<Path> paths;
+    std::vector<PolyType> types;
 
     for( const POLYGON& poly : aShape.m_polys )
     {
         for( unsigned int i = 0; i < poly.size(); i++ )
-            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), ptSubject, true );
+        {
+            paths.push_back( convertToClipper( poly[i], i > 0 ? false : true ) );
+            types.push_back( ptSubject );
+        }
     }
 
     for( const POLYGON& poly : aOtherShape.m_polys )
     {
         for( unsigned int i = 0; i < poly.size(); i++ )
-            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), ptClip, true );
+        {
+            paths.push_back( convertToClipper( poly[i], i > 0 ? false : true ) );
+            types.push_back( ptClip );
+        }
     }
 
-    PolyTree solution;
-
-    c.Execute( aType, solution, pftNonZero, pftNonZero );
+    auto solutions = runClipperJobs( paths, 0, [&]( const std::vector<int>& aSelection )
+    {
+        return new BOOLEAN_JOB( paths, types, aSelection, aType,
+                                aFastMode == PM_STRICTLY_SIMPLE );
+    } );
 
-    importTree( &solution );
+    importTrees( solutions );
 }
 
 
@@ -588,23 +911,22 @@ void SHAPE_POLY_SET::BooleanIntersection( const SHAPE_POLY_SET& a,
 
 void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
 {
+    m_edgeIndex.reset();
+
     // A static table to avoid repetitive calculations of the coefficient
     // 1.0 - cos( M_PI/aCircleSegmentsCount)
     // aCircleSegmentsCount is most of time <= 64 and usually 8, 12, 16, 32
     #define SEG_CNT_MAX 64
     static double arc_tolerance_factor[SEG_CNT_MAX + 1];
 
-    ClipperOffset c;
+    std::vector<Path> paths;
 
     for( const POLYGON& poly : m_polys )
     {
         for( unsigned int i = 0; i < poly.size(); i++ )
-            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), jtRound,
-                    etClosedPolygon );
+            paths.push_back( convertToClipper( poly[i], i > 0 ? false : true ) );
     }
 
-    PolyTree solution;
-
     // Calculate the arc tolerance (arc error) from the seg count by circle.
     // the seg count is nn = M_PI / acos(1.0 - c.ArcTolerance / abs(aFactor))
     // see:
@@ -625,18 +947,36 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
     else
         coeff = arc_tolerance_factor[aCircleSegmentsCount];
 
-    c.ArcTolerance = std::abs( aFactor ) * coeff;
+    // The contours are moved by aFactor, in both directions for the holes
+    cInt margin = std::abs( (cInt) aFactor ) + 2;
 
-    c.Execute( solution, aFactor );
+    auto solutions = runClipperJobs( paths, margin, [&]( const std::vector<int>& aSelection )
+    {
+        return new OFFSET_JOB( paths, aSelection, aFactor, std::abs( aFactor ) * coeff );
+    } );
 
-    importTree( &solution );
+    importTrees( solutions );
 }
 
 
 void SHAPE_POLY_SET::importTree( PolyTree* tree )
 {
     m_polys.clear();
+    importTree( tree, m_polys );
+}
+
+
+void SHAPE_POLY_SET::importTrees( const std::vector<std::unique_ptr<PolyTree>>& aTrees )
+{
+    m_polys.clear();
+
+    for( const std::unique_ptr<PolyTree>& tree : aTrees )
+        importTree( tree.get(), m_polys );
+}
 
+
+void SHAPE_POLY_SET::importTree( PolyTree* tree, POLYSET& aPolys )
+{
     for( PolyNode* n = tree->GetFirst(); n; n = n->GetNext() )
     {
         if( !n->IsHole() )
@@ -648,12 +988,46 @@ void SHAPE_POLY_SET::importTree( PolyTree* tree )
             for( unsigned int i = 0; i < n->Childs.size(); i++ )
                 paths.push_back( convertFromClipper( n->Childs[i]->Contour ) );
 
-            m_polys.push_back( paths );
+            aPolys.push_back( paths );
         }
     }
 }
 
 
+static std::atomic<size_t>& booleanThreadSetting()
+{
+    static std::atomic<size_t> count( 1 );
+    return count;
+}
+
+
+void SHAPE_POLY_SET::SetBooleanThreadCount( size_t aCount )
+{
+    booleanThreadSetting().store( aCount, std::memory_order_relaxed );
+}
+
+
+// the count of the calling thread, when it has one (see SetThreadBooleanThreadCount())
+static thread_local bool   t_hasBooleanThreadCount = false;
+static thread_local size_t t_booleanThreadCount = 1;
+
+
+void SHAPE_POLY_SET::SetThreadBooleanThreadCount( size_t aCount )
+{
+    t_hasBooleanThreadCount = true;
+    t_booleanThreadCount = aCount;
+}
+
+
+size_t SHAPE_POLY_SET::BooleanThreadCount()
+{
+    if( t_hasBooleanThreadCount )
+        return t_booleanThreadCount;
+
+    return booleanThreadSetting().load( std::memory_order_relaxed );
+}
+
+
 struct FractureEdge
 {
     FractureEdge( bool connected, SHAPE_LINE_CHAIN* owner, int index ) :
@@ -873,6 +1247,8 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
 void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
+    m_edgeIndex.reset();
+
     Simplify( aFastMode );    // remove overlapping holes/degeneracy
 
     for( POLYGON& paths : m_polys )
@@ -1060,6 +1436,8 @@ bool SHAPE_POLY_SET::HasHoles() const
 
 void SHAPE_POLY_SET::Unfracture( POLYGON_MODE aFastMode )
 {
+    m_edgeIndex.reset();
+
     for( POLYGON& path : m_polys )
     {
         unfractureSingle( path );
@@ -1071,6 +1449,8 @@ void SHAPE_POLY_SET::Unfracture( POLYGON_MODE aFastMode )
 
 void SHAPE_POLY_SET::Simplify( POLYGON_MODE aFastMode )
 {
+    m_edgeIndex.reset();
+
     SHAPE_POLY_SET empty;
 
     booleanOp( ctUnion, empty, aFastMode );
@@ -1079,6 +1459,8 @@ void SHAPE_POLY_SET::Simplify( POLYGON_MODE aFastMode )
 
 int SHAPE_POLY_SET::NormalizeAreaOutlines()
 {
+    m_edgeIndex.reset();
+
     // We are expecting only one main outline, but this main outline can have holes
     // if holes: combine holes and remove them from the main outline.
     // Note also we are using SHAPE_POLY_SET::PM_STRICTLY_SIMPLE in polygon
@@ -1137,6 +1519,8 @@ const std::string SHAPE_POLY_SET::Format() const
 
 bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
 {
+    m_edgeIndex.reset();
+
     std::string tmp;
 
     aStream >> tmp;
@@ -1246,12 +1630,16 @@ bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance ) const
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    m_edgeIndex.reset();
+
     m_polys.clear();
 }
 
 
 void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 {
+    m_edgeIndex.reset();
+
     // Default polygon is the last one
     if( aPolygonIdx < 0 )
         aPolygonIdx += m_polys.size();
@@ -1315,12 +1703,16 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    m_edgeIndex.reset();
+
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    m_edgeIndex.reset();
+
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -1344,7 +1736,7 @@ bool SHAPE_POLY_SET::CollideVertex( const VECTOR2I& aPoint,
     // Convert clearance to double for precission when comparing distances
     clearance = aClearance;
 
-    for( ITERATOR iterator = IterateWithHoles(); iterator; iterator++ )
+    for( CONST_ITERATOR iterator = CIterateWithHoles(); iterator; iterator++ )
     {
         // Get the difference vector between current vertex and aPoint
         delta = *iterator - aPoint;
@@ -1375,23 +1767,64 @@ bool SHAPE_POLY_SET::CollideEdge( const VECTOR2I& aPoint,
     // Shows whether there was a collision
     bool collision = false;
 
-    SEGMENT_ITERATOR iterator;
-
-    for( iterator = IterateSegmentsWithHoles(); iterator; iterator++ )
+    if( std::shared_ptr<const POLY_EDGE_INDEX> index = edgeIndex() )
     {
-        SEG currentSegment = *iterator;
-        int distance = currentSegment.Distance( aPoint );
+        std::vector<VERTEX_INDEX> edges;
 
-        // Check for collisions
-        if( distance <= aClearance )
+        // Same as below, the candidate edges being given by the index
+        index->EdgesNear( aPoint, aClearance, edges );
+
+        for( const VERTEX_INDEX& edge : edges )
         {
-            collision = true;
+            const SHAPE_LINE_CHAIN& contour = m_polys[edge.m_polygon][edge.m_contour];
+            int distance = contour.CSegment( edge.m_vertex ).Distance( aPoint );
+
+            if( distance <= aClearance )
+            {
+                collision = true;
+                aClearance = distance;
+                aClosestVertex = edge;
+            }
+        }
 
-            // Update aClearance to look for closer edges
-            aClearance = distance;
+        return collision;
+    }
 
-            // Store the indices that identify the vertex
-            aClosestVertex = iterator.GetIndex();
+    std::vector<int> edges;
+
+    for( int polygonIdx = 0; polygonIdx < OutlineCount(); polygonIdx++ )
+    {
+        for( int contourIdx = 0; contourIdx < (int) m_polys[polygonIdx].size(); contourIdx++ )
+        {
+            const SHAPE_LINE_CHAIN& contour = m_polys[polygonIdx][contourIdx];
+
+            if( contour.SegmentCount() == 0 )
+                continue;
+
+            // The kernel only discards the edges too far away; the others are checked
+            // exactly, in the order of the segment iterator
+            edges.clear();
+            POLY_KERNELS::EdgesNear( &contour.CPoint( 0 ), contour.PointCount(),
+                                     contour.SegmentCount(), aPoint, aClearance, edges );
+
+            for( int edge : edges )
+            {
+                int distance = contour.CSegment( edge ).Distance( aPoint );
+
+                // Check for collisions
+                if( distance <= aClearance )
+                {
+                    collision = true;
+
+                    // Update aClearance to look for closer edges
+                    aClearance = distance;
+
+                    // Store the indices that identify the vertex
+                    aClosestVertex.m_polygon = polygonIdx;
+                    aClosestVertex.m_contour = contourIdx;
+                    aClosestVertex.m_vertex = edge;
+                }
+            }
         }
     }
 
@@ -1433,12 +1866,17 @@ void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 
 void SHAPE_POLY_SET::RemoveVertex( VERTEX_INDEX aIndex )
 {
+    m_edgeIndex.reset();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].Remove( aIndex.m_vertex );
 }
 
 
 bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool aIgnoreHoles ) const
 {
+    if( std::shared_ptr<const POLY_EDGE_INDEX> index = edgeIndex() )
+        return index->Contains( aP, aSubpolyIndex, aIgnoreHoles );
+
     // Check that the point is inside the outline
     if( pointInPolygon( aP, m_polys[aSubpolyIndex][0] ) )
     {
@@ -1447,7 +1885,7 @@ bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool
             // Check that the point is not in any of the holes
             for( int holeIdx = 0; holeIdx < HoleCount( aSubpolyIndex ); holeIdx++ )
             {
-                const SHAPE_LINE_CHAIN hole = CHole( aSubpolyIndex, holeIdx );
+                const SHAPE_LINE_CHAIN& hole = CHole( aSubpolyIndex, holeIdx );
 
                 // If the point is inside a hole (and not on its edge),
                 // it is outside of the polygon
@@ -1465,71 +1903,20 @@ bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool
 
 bool SHAPE_POLY_SET::pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath ) const
 {
-    int result = 0;
     int cnt = aPath.PointCount();
 
-    if( !aPath.BBox().Contains( aP ) ) // test with bounding box first
-        return false;
-
     if( cnt < 3 )
         return false;
 
-    VECTOR2I ip = aPath.CPoint( 0 );
-
-    for( int i = 1; i <= cnt; ++i )
-    {
-        VECTOR2I ipNext = ( i == cnt ? aPath.CPoint( 0 ) : aPath.CPoint( i ) );
-
-        if( ipNext.y == aP.y )
-        {
-            if( ( ipNext.x == aP.x ) || ( ip.y == aP.y
-                                          && ( ( ipNext.x > aP.x ) == ( ip.x < aP.x ) ) ) )
-                return true;
-        }
-
-        if( ( ip.y < aP.y ) != ( ipNext.y < aP.y ) )
-        {
-            if( ip.x >= aP.x )
-            {
-                if( ipNext.x > aP.x )
-                    result = 1 - result;
-                else
-                {
-                    int64_t d = (int64_t) ( ip.x - aP.x ) * (int64_t) ( ipNext.y - aP.y ) -
-                                (int64_t) ( ipNext.x - aP.x ) * (int64_t) ( ip.y - aP.y );
-
-                    if( !d )
-                        return true;
-
-                    if( ( d > 0 ) == ( ipNext.y > ip.y ) )
-                        result = 1 - result;
-                }
-            }
-            else
-            {
-                if( ipNext.x > aP.x )
-                {
-                    int64_t d = (int64_t) ( ip.x - aP.x ) * (int64_t) ( ipNext.y - aP.y ) -
-                                (int64_t) ( ipNext.x - aP.x ) * (int64_t) ( ip.y - aP.y );
-
-                    if( !d )
-                        return true;
-
-                    if( ( d > 0 ) == ( ipNext.y > ip.y ) )
-                        result = 1 - result;
-                }
-            }
-        }
-
-        ip = ipNext;
-    }
-
-    return result ? true : false;
+    // No bounding box test first: computing the box costs as much as the test itself
+    return POLY_KERNELS::PointInPolygon( &aPath.CPoint( 0 ), cnt, aP );
 }
 
 
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    m_edgeIndex.reset();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1542,6 +1929,8 @@ void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 
 void SHAPE_POLY_SET::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    m_edgeIndex.reset();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1883,6 +2272,9 @@ SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
     static_cast<SHAPE&>(*this) = aOther;
     m_polys = aOther.m_polys;
 
+    // the edge index does not change once built, so it can be shared
+    m_edgeIndex = std::atomic_load( &aOther.m_edgeIndex );
+
     // reset poly cache:
     m_hash = MD5_HASH{};
     m_triangulationValid = false;
@@ -2051,6 +2443,28 @@ void SHAPE_POLY_SET::triangulateSingle( const POLYGON& aPoly,
 }
 
 
+void SHAPE_POLY_SET::CacheEdgeIndex()
+{
+    if( !m_edgeIndex )
+        m_edgeIndex = std::make_shared<POLY_EDGE_INDEX>( *this );
+}
+
+
+std::shared_ptr<const POLY_EDGE_INDEX> SHAPE_POLY_SET::edgeIndex() const
+{
+    std::shared_ptr<const POLY_EDGE_INDEX> index = std::atomic_load( &m_edgeIndex );
+
+    // Concurrent queries may all build the index: they get the same results with any copy
+    if( !index && m_edgeIndexEnabled && !m_polys.empty() )
+    {
+        index = std::make_shared<POLY_EDGE_INDEX>( *this );
+        std::atomic_store( &m_edgeIndex, index );
+    }
+
+    return index;
+}
+
+
 bool SHAPE_POLY_SET::IsTriangulationUpToDate() const
 {
     if( !m_triangulationValid )
@@ -2112,6 +2526,19 @@ void SHAPE_POLY_SET::CacheTriangulation()
 }
 
 
+bool SHAPE_POLY_SET::SetTriangulation( TRIANGULATION& aTriangulation, const MD5_HASH& aHash )
+{
+    if( !aHash.IsValid() || aHash != checksum() )
+        return false;
+
+    m_triangulatedPolys.swap( aTriangulation );
+    m_triangulationValid = true;
+    m_hash = aHash;
+
+    return true;
+}
+
+
 MD5_HASH SHAPE_POLY_SET::checksum() const
 {
     MD5_HASH hash;
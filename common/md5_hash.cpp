@@ -81,6 +81,17 @@ void MD5_HASH::Finalize()
 
 }
 
+void MD5_HASH::GetDigest( uint8_t aDigest[DIGEST_SIZE] ) const
+{
+    memcpy( aDigest, m_hash, DIGEST_SIZE );
+}
+
+void MD5_HASH::SetDigest( const uint8_t aDigest[DIGEST_SIZE] )
+{
+    memcpy( m_hash, aDigest, DIGEST_SIZE );
+    m_valid = true;
+}
+
 bool MD5_HASH::operator==( const MD5_HASH& aOther ) const
 {
     return ( memcmp( m_hash, aOther.m_hash, 16 ) == 0 );
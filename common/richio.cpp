@@ -23,11 +23,25 @@
  */
 
 
+#include <algorithm>
 #include <cstdarg>
 #include <config.h> // HAVE_FGETC_NOLOCK
 
 #include <richio.h>
 
+#ifndef __WINDOWS__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined( __linux__ )
+#include <sys/vfs.h>
+#elif defined( __APPLE__ ) || defined( __FreeBSD__ )
+#include <sys/param.h>
+#include <sys/mount.h>
+#endif
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -225,6 +239,157 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
+#ifndef __WINDOWS__
+/**
+ * Function isOnLocalDisk
+ * tells if the open file @a aFd is on a local file system.  A mapped file that shrinks
+ * under the mapping raises SIGBUS when its lost pages are read, which is much more likely
+ * on network shares (another machine saving the file) than on local disks, so the files
+ * of network and user space file systems are never mapped.
+ */
+static bool isOnLocalDisk( int aFd )
+{
+#if defined( __linux__ )
+    struct statfs fs;
+
+    if( fstatfs( aFd, &fs ) != 0 )
+        return false;
+
+    switch( (unsigned long) fs.f_type )
+    {
+    case 0x6969:        // NFS
+    case 0x517B:        // SMB
+    case 0xFE534D42:    // SMB2
+    case 0xFF534D42:    // CIFS
+    case 0x65735546:    // FUSE (sshfs, ...)
+    case 0x01021997:    // 9P (WSL, virtual machine shares)
+    case 0x5346414F:    // AFS
+    case 0x00C36400:    // Ceph
+    case 0x73757245:    // Coda
+    case 0x47504653:    // GPFS
+    case 0x0BD00BD0:    // Lustre
+        return false;
+
+    default:
+        return true;
+    }
+#elif defined( __APPLE__ ) || defined( __FreeBSD__ )
+    struct statfs fs;
+
+    return fstatfs( aFd, &fs ) == 0 && ( fs.f_flags & MNT_LOCAL );
+#else
+    (void) aFd;
+    return false;
+#endif
+}
+#endif
+
+
+MMAP_LINE_READER::MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber, unsigned aMaxLineLength ):
+    LINE_READER( 0 ),   // lines are not copied, so no line buffer
+    m_data( NULL ), m_size( 0 ), m_ndx( 0 ), m_mapSize( 0 )
+{
+    FILE* fp = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !fp )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename \"%s\" for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_source  = aFileName;
+    m_lineNum = aStartingLineNumber;
+    m_maxLineLength = aMaxLineLength;
+
+#ifndef __WINDOWS__
+    struct stat st;
+    long        pageSize = sysconf( _SC_PAGESIZE );
+
+    // The end of the last mapped page is filled with zeros, which gives the nul after the
+    // file content, unless the file ends exactly on a page boundary.
+    if( fstat( fileno( fp ), &st ) == 0 && st.st_size > 0 && pageSize > 0
+        && st.st_size % pageSize != 0 && isOnLocalDisk( fileno( fp ) ) )
+    {
+        void* map = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno( fp ), 0 );
+
+        if( map != MAP_FAILED )
+        {
+            madvise( map, st.st_size, MADV_SEQUENTIAL );
+
+            m_data    = (const char*) map;
+            m_size    = st.st_size;
+            m_mapSize = st.st_size;
+        }
+    }
+#endif
+
+    if( !m_data )
+    {
+        // Read the whole file at once
+        long size = -1;
+
+        if( fseek( fp, 0, SEEK_END ) == 0 )
+            size = ftell( fp );
+
+        rewind( fp );
+
+        if( size < 0 )
+        {
+            fclose( fp );
+
+            wxString msg = wxString::Format(
+                _( "Unable to read file \"%s\"" ), aFileName.GetData() );
+            THROW_IO_ERROR( msg );
+        }
+
+        m_buffer.resize( size + 1 );
+        m_size = fread( &m_buffer[0], 1, size, fp );
+        m_buffer[m_size] = 0;
+        m_data = &m_buffer[0];
+    }
+
+    fclose( fp );
+
+    m_line = const_cast<char*>( m_data );
+}
+
+
+MMAP_LINE_READER::~MMAP_LINE_READER()
+{
+    // m_line points in m_data, do not let ~LINE_READER() free it
+    m_line = NULL;
+
+#ifndef __WINDOWS__
+    if( m_mapSize )
+        munmap( const_cast<char*>( m_data ), m_mapSize );
+#endif
+}
+
+
+char* MMAP_LINE_READER::ReadLine()
+{
+    const char* line = m_data + m_ndx;
+    size_t      left = m_size - m_ndx;
+    const char* eol  = (const char*) memchr( line, '\n', left );
+    size_t      len  = eol ? eol - line + 1 : left;
+
+    if( len >= m_maxLineLength )
+        THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+    m_line   = const_cast<char*>( line );
+    m_length = len;
+    m_ndx   += len;
+
+    // m_lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++m_lineNum;
+
+    return m_length ? m_line : NULL;
+}
+
+
 STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_lines( aString ), m_ndx( 0 )
@@ -401,27 +566,38 @@ int OUTPUTFORMATTER::sprint( const char* fmt, ... )
 }
 
 
-int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
-{
 #define NESTWIDTH           2   ///< how many spaces per nestLevel
 
-    va_list     args;
-
-    va_start( args, fmt );
+int OUTPUTFORMATTER::indent( int nestLevel )
+{
+    static const char spaces[] = "                                                                ";
+    const int         maxCount = sizeof( spaces ) - 1;
 
-    int result = 0;
-    int total  = 0;
+    int total = 0;
 
-    for( int i=0; i<nestLevel;  ++i )
+    for( int count = nestLevel * NESTWIDTH; count > 0; count -= maxCount )
     {
-        // no error checking needed, an exception indicates an error.
-        result = sprint( "%*c", NESTWIDTH, ' ' );
+        int len = std::min( count, maxCount );
 
-        total += result;
+        // no error checking needed, an exception indicates an error.
+        write( spaces, len );
+        total += len;
     }
 
+    return total;
+}
+
+
+int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
+{
+    va_list     args;
+
+    va_start( args, fmt );
+
+    int total = indent( nestLevel );
+
     // no error checking needed, an exception indicates an error.
-    result = vprint( fmt, args );
+    int result = vprint( fmt, args );
 
     va_end( args );
 
@@ -430,6 +606,21 @@ int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
 }
 
 
+int OUTPUTFORMATTER::PrintRaw( int nestLevel, const char* aText, int aCount )
+{
+    int total = indent( nestLevel );
+
+    if( aCount > 0 )
+    {
+        // no error checking needed, an exception indicates an error.
+        write( aText, aCount );
+        total += aCount;
+    }
+
+    return total;
+}
+
+
 std::string OUTPUTFORMATTER::Quotes( const std::string& aWrapee )
 {
     static const char quoteThese[] = "\t ()\n\r";
@@ -528,6 +719,9 @@ FILE_OUTPUTFORMATTER::FILE_OUTPUTFORMATTER( const wxString& aFileName,
                             m_filename.GetData() );
         THROW_IO_ERROR( msg );
     }
+
+    // Boards can be tens of megabytes: write them in large chunks
+    setvbuf( m_fp, NULL, _IOFBF, FILE_OUTPUTFMTBUFZ );
 }
 
 
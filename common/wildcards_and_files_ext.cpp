@@ -84,6 +84,7 @@ const wxString HtmlFileExtension( wxT( "html" ) );
 
 const wxString LegacyPcbFileExtension( "brd" );
 const wxString KiCadPcbFileExtension( "kicad_pcb" );
+const wxString ZoneTriangulationCacheFileExtension( "kicad_tri" );
 const wxString PageLayoutDescrFileExtension( "kicad_wks" );
 
 const wxString PdfFileExtension( "pdf" );
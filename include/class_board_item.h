@@ -318,6 +318,21 @@ public:
      */
     static std::string FormatInternalUnits( int aValue );
 
+    ///> Size of the buffer needed by FormatInternalUnits( int, char* ), including the nul.
+    static const int FMT_IU_BUFFER_SIZE = 16;
+
+    /**
+     * Function FormatInternalUnits
+     * is the fast version of FormatInternalUnits( int ), which writes the text in
+     * \a aBuffer instead of allocating a string.
+     *
+     * @param aValue A coordinate value to convert.
+     * @param aBuffer receives the nul terminated text, and must hold at least
+     *                FMT_IU_BUFFER_SIZE bytes.
+     * @return int - the length of the text.
+     */
+    static int FormatInternalUnits( int aValue, char* aBuffer );
+
     /**
      * Function FormatAngle
      * converts \a aAngle from board units to a string appropriate for writing to file.
@@ -389,6 +389,19 @@ public:
      */
     wxArrayString* ReadCommentLines();
 
+    /**
+     * Function ReadRawList
+     * copies the raw text following the current token, up to the ')' which closes the
+     * current list, into @a aText without tokenizing it.  This is meant for large blocks
+     * of data which are parsed later, or elsewhere.  Upon return the closing ')' is the
+     * current token, as if it had been read by NextTok().
+     *
+     * @param aText receives the text, excluding the closing ')'.
+     * @return int - DSN_RIGHT.
+     * @throw IO_ERROR, if the end of the input is reached before the end of the list.
+     */
+    int ReadRawList( std::string& aText );
+
     /**
      * Function IsSymbol
      * tests a token to see if it is a symbol.  This means it cannot be a
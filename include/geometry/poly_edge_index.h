@@ -0,0 +1,115 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __POLY_EDGE_INDEX_H
+#define __POLY_EDGE_INDEX_H
+
+#include <cstdint>
+#include <vector>
+
+#include <math/vector2d.h>
+#include <geometry/shape_poly_set.h>
+
+/**
+ * Class POLY_EDGE_INDEX
+ * Spatial index of the edges of the polygons of a SHAPE_POLY_SET, answering the point
+ * containment and edge proximity queries of the set without testing all its edges.
+ *
+ * The bounding box of each polygon is cut into horizontal bands of equal height, and
+ * each band lists the edges (of the outline and of the holes) overlapping it.  The
+ * crossing number test of a point only needs the edges of its band, since the other
+ * edges cannot cross the horizontal half line from the point.  The number of bands
+ * grows with the number of edges, so a band holds a few edges of each contour crossing
+ * it, instead of all the vertices of the polygon.
+ *
+ * The index is a snapshot of the polygons: it is built by SHAPE_POLY_SET::CacheEdgeIndex(),
+ * or by the first query of a set with SHAPE_POLY_SET::EnableEdgeIndex(), and dropped by
+ * the set when it is modified.  The results are exactly those
+ * of the unindexed tests.
+ */
+class POLY_EDGE_INDEX
+{
+public:
+    POLY_EDGE_INDEX( const SHAPE_POLY_SET& aSet );
+
+    /**
+     * Function Contains()
+     * Tests if aP is inside the aPolygon-th polygon of the set, or on its edge, as
+     * SHAPE_POLY_SET::Contains() does for a single polygon.
+     * @param aIgnoreHoles can be set to true to ignore the holes of the polygon
+     */
+    bool Contains( const VECTOR2I& aP, int aPolygon, bool aIgnoreHoles ) const;
+
+    /**
+     * Function EdgesNear()
+     * Finds the segments of the contours which can be at aDistance or less from aP, as
+     * POLY_KERNELS::EdgesNear() does for a single contour: the segments found have to be
+     * checked with SEG::Distance(), but no closer segment is missed.
+     * @param aEdges receives the index of the first vertex of each segment, in the order of
+     *               the polygons, then of the contours, then of the vertices
+     */
+    void EdgesNear( const VECTOR2I& aP, int aDistance,
+                    std::vector<SHAPE_POLY_SET::VERTEX_INDEX>& aEdges ) const;
+
+    ///> Returns the number of polygons indexed
+    int PolygonCount() const
+    {
+        return m_polygons.size();
+    }
+
+private:
+    struct EDGE
+    {
+        VECTOR2I m_a;
+        VECTOR2I m_b;
+        int      m_contour;
+        int      m_vertex;
+        bool     m_crossing;    ///< used by the crossing number test (contours of 3 points or more)
+        bool     m_segment;     ///< one of the SHAPE_LINE_CHAIN::CSegment() of the contour
+    };
+
+    struct POLYGON_BANDS
+    {
+        bool              m_valid;      ///< false if the outline has less than 3 points
+        int               m_minX, m_minY, m_maxX, m_maxY;  ///< bounding box of all the edges
+        int               m_outlineMinX, m_outlineMinY, m_outlineMaxX, m_outlineMaxY;
+        int64_t           m_bandHeight;
+        int               m_bandCount;
+        std::vector<EDGE> m_edges;      ///< by contour, then by vertex
+        std::vector<int>  m_bandStart;  ///< first entry of each band in m_bandEdges
+        std::vector<int>  m_bandEdges;  ///< edges of each band, in increasing order
+    };
+
+    void buildPolygon( const SHAPE_POLY_SET::POLYGON& aPolygon, POLYGON_BANDS& aBands );
+
+    ///> Returns the band containing aY, clamped to the bands of the polygon
+    static int band( const POLYGON_BANDS& aBands, int64_t aY );
+
+    ///> Returns true if aP is within one unit of a segment of the aContour-th contour, as
+    ///> SHAPE_LINE_CHAIN::PointOnEdge() for contours of 3 points or more
+    static bool onEdge( const POLYGON_BANDS& aBands, const VECTOR2I& aP, int aContour );
+
+    std::vector<POLYGON_BANDS> m_polygons;
+};
+
+#endif  // __POLY_EDGE_INDEX_H
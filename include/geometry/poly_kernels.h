@@ -0,0 +1,99 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __POLY_KERNELS_H
+#define __POLY_KERNELS_H
+
+#include <vector>
+
+#include <math/vector2d.h>
+
+/**
+ * Class POLY_KERNELS
+ * Vectorized point in polygon and point to edge distance tests, working on the points
+ * of a SHAPE_LINE_CHAIN as stored (x and y interleaved).  The points are loaded a block
+ * at a time and split in registers into one vector of x and one vector of y coordinates,
+ * so the edges of a block are tested at once without copying the outline.
+ *
+ * The instruction set is chosen at run time: AVX2 (8 edges at a time) or SSE2 (4 edges
+ * at a time) on x86 processors supporting them, plain C++ otherwise.  All the variants
+ * give exactly the same results.
+ */
+class POLY_KERNELS
+{
+public:
+    enum ISA
+    {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    ///> Contribution of an edge to the crossing number test
+    enum EDGE_CROSSING
+    {
+        EC_NONE,
+        EC_TOGGLE,      ///< the edge crosses the half line from the point to +x
+        EC_BOUNDARY     ///< the point is on the edge
+    };
+
+    ///> Returns the best instruction set supported by both the build and the processor
+    static ISA BestIsa();
+
+    ///> Returns the instruction set in use
+    static ISA Isa();
+
+    /**
+     * Function SetIsa()
+     * Selects the instruction set to use, for tests and benchmarks.  An instruction set
+     * not supported by the processor is replaced by the best supported one.
+     */
+    static void SetIsa( ISA aIsa );
+
+    /**
+     * Function PointInPolygon()
+     * Tests if aP is inside the closed polygon of aCount points aPoints, or on its edge.
+     * This is the crossing number test of SHAPE_POLY_SET::pointInPolygon().
+     */
+    static bool PointInPolygon( const VECTOR2I* aPoints, int aCount, const VECTOR2I& aP );
+
+    /**
+     * Function CrossEdge()
+     * Classifies the edge aA-aB for the crossing number test of aP, as PointInPolygon()
+     * does for each edge of the polygon.
+     */
+    static EDGE_CROSSING CrossEdge( const VECTOR2I& aA, const VECTOR2I& aB, const VECTOR2I& aP );
+
+    /**
+     * Function EdgesNear()
+     * Finds the edges of a line chain which can be at aDistance or less from aP.  Edge i
+     * goes from aPoints[i] to aPoints[(i + 1) % aCount], for i < aEdgeCount.  Distances are
+     * estimated in floating point with a small margin: the edges found have to be checked
+     * with SEG::Distance(), but no edge closer than aDistance is missed.
+     * @param aEdges receives the edge indices, in increasing order
+     */
+    static void EdgesNear( const VECTOR2I* aPoints, int aCount, int aEdgeCount,
+                           const VECTOR2I& aP, int aDistance, std::vector<int>& aEdges );
+};
+
+#endif  // __POLY_KERNELS_H
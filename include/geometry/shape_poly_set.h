@@ -34,6 +34,8 @@
 
 #include "clipper.hpp"
 
+class POLY_EDGE_INDEX;
+
 #include <md5_hash.h>
 
 
@@ -51,7 +53,10 @@
  *      outline or a hole.
  *      - Vertex (or corner): each one of the points that define a contour.
  *
- * TODO: add convex partitioning & spatial index
+ * Point containment and edge collision tests can use a spatial index of the edges, see
+ * CacheEdgeIndex() and EnableEdgeIndex().
+ *
+ * TODO: add convex partitioning
  */
 class SHAPE_POLY_SET : public SHAPE
 {
@@ -100,6 +105,16 @@ class SHAPE_POLY_SET : public SHAPE
                 return (m_vertexCount++);
             }
 
+            const TRI& GetTriangleIndices( int aIndex ) const
+            {
+                return m_triangles[aIndex];
+            }
+
+            const VECTOR2I& GetVertex( int aIndex ) const
+            {
+                return m_vertices[aIndex];
+            }
+
             int GetTriangleCount() const
             {
                 return m_triangleCount;
@@ -609,6 +624,12 @@ class SHAPE_POLY_SET : public SHAPE
             return m_triangulatedPolys[aIndex].get();
         }
 
+        ///> Returns the number of polygons of the cached triangulation
+        unsigned int TriangulatedPolyCount() const
+        {
+            return m_triangulatedPolys.size();
+        }
+
 
         const SHAPE_LINE_CHAIN& COutline( int aIndex ) const
         {
@@ -828,6 +849,29 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Performs outline inflation/deflation, using round corners.
         void Inflate( int aFactor, int aCircleSegmentsCount );
 
+        /**
+         * Function SetBooleanThreadCount
+         * sets the number of threads of the boolean operations, Simplify() and Inflate(), for
+         * all the sets: 1 (the default) gives the whole input to a single Clipper run, and 0
+         * uses all the cores.  With several threads, the contours are split in clusters whose
+         * bounding boxes do not overlap, which cannot interact, and the clusters are given
+         * to concurrent Clipper runs.  The polygons are exactly the same, only their order in
+         * the set changes.  There is no gain when one contour overlaps all the others.
+         */
+        static void SetBooleanThreadCount( size_t aCount );
+
+        /**
+         * Function SetThreadBooleanThreadCount
+         * sets the number of threads of the boolean operations run by the calling thread,
+         * instead of the one of SetBooleanThreadCount(), until the thread ends.  The zone
+         * filler gives each of its zone threads its share of the cores this way, without
+         * changing the count of the other threads.
+         */
+        static void SetThreadBooleanThreadCount( size_t aCount );
+
+        ///> Returns the number of threads of the boolean operations of the calling thread
+        static size_t BooleanThreadCount();
+
         ///> Converts a set of polygons with holes to a singe outline with "slits"/"fractures" connecting the outer ring
         ///> to the inner holes
         ///> For aFastMode meaning, see function booleanOp
@@ -1159,6 +1203,12 @@ class SHAPE_POLY_SET : public SHAPE
 
         typedef std::vector<POLYGON> POLYSET;
 
+        ///> Appends the polygons of a Clipper solution to aPolys
+        void importTree( ClipperLib::PolyTree* tree, POLYSET& aPolys );
+
+        ///> Replaces the polygons of the set by those of the solutions of the Clipper jobs
+        void importTrees( const std::vector<std::unique_ptr<ClipperLib::PolyTree>>& aTrees );
+
         POLYSET m_polys;
 
     public:
@@ -1168,15 +1218,78 @@ class SHAPE_POLY_SET : public SHAPE
         void CacheTriangulation();
         bool IsTriangulationUpToDate() const;
 
+        /**
+         * Function CacheEdgeIndex
+         * builds the spatial index of the edges used by Contains(), Collide() and
+         * CollideEdge(), so that they only test the edges near the point instead of all the
+         * vertices.  This is worth it for large polygons tested many times, like the filled
+         * areas of zones.  The index is dropped by the methods modifying the set.  The
+         * accessors returning a contour, a vertex or an iterator do not drop it: a set
+         * modified through them must call DropEdgeIndex().
+         */
+        void CacheEdgeIndex();
+
+        /**
+         * Function EnableEdgeIndex
+         * makes the first query which can use the edge index build it, and build it again
+         * after each change of the set, instead of building it at once with
+         * CacheEdgeIndex().  The queries are const, and may run in parallel: the index is
+         * built by one of them.  This setting belongs to the set and is not copied.
+         */
+        void EnableEdgeIndex()
+        {
+            m_edgeIndexEnabled = true;
+        }
+
+        ///> Drops the edge index, after the set was modified through a reference or an
+        ///> iterator.  @see CacheEdgeIndex()
+        void DropEdgeIndex()
+        {
+            m_edgeIndex.reset();
+        }
+
+        ///> Returns true if the edge index is built and up to date
+        bool IsEdgeIndexCached() const
+        {
+            return std::atomic_load( &m_edgeIndex ) != nullptr;
+        }
+
+        typedef std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> TRIANGULATION;
+
+        /**
+         * Function SetTriangulation
+         * sets the cached triangulation to one computed earlier, for instance read back
+         * from a file, so CacheTriangulation() does not have to compute it again.
+         * @param aTriangulation is the triangulation, taken over if it is used.
+         * @param aHash is the GetHash() of the polygons it was computed for: the
+         *              triangulation is only used if it matches the current polygons.
+         * @return bool - true if the triangulation was used.
+         */
+        bool SetTriangulation( TRIANGULATION& aTriangulation, const MD5_HASH& aHash );
+
+        ///> Returns the checksum of the polygons, which identifies their triangulation
+        MD5_HASH GetHash() const
+        {
+            return checksum();
+        }
+
     private:
         void triangulateSingle( const POLYGON& aPoly, SHAPE_POLY_SET::TRIANGULATED_POLYGON& aResult );
 
         MD5_HASH checksum() const;
 
-        std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> m_triangulatedPolys;
+        TRIANGULATION m_triangulatedPolys;
         bool m_triangulationValid = false;
         MD5_HASH m_hash;
 
+        ///> Returns the edge index, built if it is enabled and missing, or null
+        std::shared_ptr<const POLY_EDGE_INDEX> edgeIndex() const;
+
+        ///> edge index, immutable and shared by the copies of the set.  The const methods
+        ///> may set it, so they access it with std::atomic_load() and std::atomic_store().
+        mutable std::shared_ptr<const POLY_EDGE_INDEX> m_edgeIndex;
+        bool m_edgeIndexEnabled = false;
+
 };
 
 #endif
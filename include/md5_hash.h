@@ -24,6 +24,15 @@ public:
 
     void SetValid( bool aValid ) { m_valid = aValid; }
 
+    ///> Size of the digest, in bytes
+    static const int DIGEST_SIZE = 16;
+
+    ///> Copies the digest of a finalized hash to aDigest
+    void GetDigest( uint8_t aDigest[DIGEST_SIZE] ) const;
+
+    ///> Sets the digest, for instance read back from a file, and makes the hash valid
+    void SetDigest( const uint8_t aDigest[DIGEST_SIZE] );
+
     MD5_HASH& operator=( const MD5_HASH& aOther );
 
     bool operator==( const MD5_HASH& aOther ) const;
@@ -33,6 +33,8 @@
 #include "plugins/3dapi/sg_base.h"
 #include "plugins/3dapi/c3dmodel.h"
 
+#include <string>
+
 class SGNODE;
 class SCENEGRAPH;
 struct S3D_POINT;
@@ -76,11 +78,40 @@ namespace S3D
      * reads a binary cache file and creates an SGNODE tree
      *
      * @param aFileName is the name of the binary cache file to be read
+     * @param aPluginInfo is optional and receives the tag of the plugin which
+     * loaded the model
      * @return NULL on failure, on success a pointer to the top level SCENEGRAPH node;
      * if desired this node can be associated with an IFSG_TRANSFORM wrapper via
      * the IFSG_TRANSFORM::Attach() function.
      */
     SGLIB_API SGNODE* ReadCache( const char* aFileName, void* aPluginMgr,
+        bool (*aTagCheck)( const char*, void* ), std::string* aPluginInfo = NULL );
+
+    /**
+     * Function WriteModelCache
+     * writes the render data of a model to a flat binary cache file: a versioned
+     * header, then the materials, the meshes and their arrays, each array contiguous
+     * and aligned, so the file is read back (or mapped) without a scene graph
+     *
+     * @param aFileName is the name of the file to write; an existing file is replaced
+     * @param aModel is the model to be written
+     * @param aPluginInfo is the tag of the plugin which loaded the model; it may not
+     * be empty
+     * @return true on success
+     */
+    SGLIB_API bool WriteModelCache( const char* aFileName, const S3DMODEL* aModel,
+        const char* aPluginInfo );
+
+    /**
+     * Function ReadModelCache
+     * reads a file written by WriteModelCache()
+     *
+     * @param aFileName is the name of the file to be read
+     * @return NULL on failure (including a file written in another format version,
+     * or with another version of the plugin), on success a model to be freed with
+     * Destroy3DModel()
+     */
+    SGLIB_API S3DMODEL* ReadModelCache( const char* aFileName, void* aPluginMgr,
         bool (*aTagCheck)( const char*, void* ) );
 
     /**
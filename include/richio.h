@@ -247,6 +247,68 @@ public:
 };
 
 
+/**
+ * Class MMAP_LINE_READER
+ * is a LINE_READER that maps a whole file in memory and returns lines pointing
+ * directly into it, without copying them.  This is the fast path for loading large
+ * files with a DSNLEXER, which only uses the line start and Length().  Unlike the
+ * other LINE_READERs:
+ * <ul>
+ * <li> the returned lines are read only,
+ * <li> the returned lines are not nul terminated: a line ends after Length() bytes,
+ *      usually on its '\n'.  The file content itself is always followed by a nul, so
+ *      C string functions stop at the end of the file at worst.
+ * </ul>
+ * If the file cannot be mapped, is not on a local disk (network shares, FUSE) or on
+ * Windows, it is read at once in memory instead.
+ *
+ * The file is mapped, not copied: if it is truncated by another process while the reader
+ * exists, reading the lost pages raises SIGBUS and the program crashes.  Only use it for
+ * files that are read right after being opened, like a board being loaded, and use a
+ * FILE_LINE_READER for files that can be rewritten while they are read.
+ */
+class MMAP_LINE_READER : public LINE_READER
+{
+protected:
+    const char*         m_data;         ///< the file content, followed by a nul
+    size_t              m_size;         ///< size of the file content
+    size_t              m_ndx;          ///< offset of the next line in m_data
+    size_t              m_mapSize;      ///< size of the mapping, 0 if m_data is not mapped
+    std::vector<char>   m_buffer;       ///< the file content, when it is not mapped
+
+public:
+
+    /**
+     * Constructor MMAP_LINE_READER
+     * maps the file @a aFileName in memory.  The file is not kept open.
+     *
+     * @param aFileName is the name of the file to open and to use for error reporting purposes.
+     * @param aStartingLineNumber is the initial line number to report on error.
+     * @param aMaxLineLength is the maximum allowed line length.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened.
+     */
+    MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber = 0,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    ~MMAP_LINE_READER();
+
+    char* ReadLine() override;
+
+    /**
+     * Function Rewind
+     * goes back to the first line and resets the line number back to zero.  Line number
+     * will go to 1 on first ReadLine().
+     */
+    void Rewind()
+    {
+        m_ndx = 0;
+        m_lineNum = 0;
+    }
+};
+
+
 /**
  * Class STRING_LINE_READER
  * is a LINE_READER that reads from a multiline 8 bit wide std::string
@@ -307,6 +369,7 @@ public:
 
 
 #define OUTPUTFMTBUFZ    500        ///< default buffer size for any OUTPUT_FORMATTER
+#define FILE_OUTPUTFMTBUFZ  ( 256 * 1024 )    ///< file buffer size for FILE_OUTPUTFORMATTER
 
 /**
  * Class OUTPUTFORMATTER
@@ -331,6 +394,7 @@ class OUTPUTFORMATTER
 
     int sprint( const char* fmt, ... );
     int vprint( const char* fmt,  va_list ap );
+    int indent( int nestLevel );
 
 
 protected:
@@ -396,6 +460,21 @@ public:
      */
     int PRINTF_FUNC Print( int nestLevel, const char* fmt, ... );
 
+    /**
+     * Function PrintRaw
+     * writes already formatted text to the output stream, preceded by the
+     * indentation of @a nestLevel.  This is the fast path for large blocks of
+     * text, such as lists of coordinates built by the caller: the text does not
+     * go through a printf() style format, and is not copied.
+     *
+     * @param nestLevel The multiple of spaces to precede the output with.
+     * @param aText is the text to write, it does not need to be nul terminated.
+     * @param aCount is the number of bytes of @a aText to write.
+     * @return int - the number of characters output.
+     * @throw IO_ERROR, if there is a problem outputting, such as a full disk.
+     */
+    int PrintRaw( int nestLevel, const char* aText, int aCount );
+
     /**
      * Function GetQuoteChar
      * performs quote character need determination.
@@ -356,8 +356,19 @@ public:
     /// Destructor
     ~TRIANGULATION();
 
-    /// Creates a Delaunay triangulation from a set of points
-    void CreateDelaunay( NODES_CONTAINER::iterator aFirst, NODES_CONTAINER::iterator aLast );
+    /// Creates a Delaunay triangulation from a set of points.
+    /// If aRemoveBoundary is false, the two enclosing triangles are kept, so nodes can be
+    /// inserted and removed later with InsertNode() and RemoveNode().
+    void CreateDelaunay( NODES_CONTAINER::iterator aFirst, NODES_CONTAINER::iterator aLast,
+                         bool aRemoveBoundary = true );
+
+    /// Inserts a node in a triangulation created without removing the enclosing triangles,
+    /// keeping it Delaunay. Returns false if the node is outside the enclosing triangles.
+    bool InsertNode( const NODE_PTR& aNode );
+
+    /// Removes a node from a triangulation created without removing the enclosing triangles,
+    /// keeping it Delaunay. Returns false if the node could not be found.
+    bool RemoveNode( const NODE_PTR& aNode );
 
     /// Creates an initial Delaunay triangulation from two enclosing triangles
     //  When using rectangular boundary - loop through all points and expand.
@@ -63,6 +63,7 @@ extern const wxString HtmlFileExtension;
 extern const wxString LegacyPcbFileExtension;
 extern const wxString KiCadPcbFileExtension;
 #define PcbFileExtension    KiCadPcbFileExtension       // symlink choice
+extern const wxString ZoneTriangulationCacheFileExtension;
 extern const wxString PageLayoutDescrFileExtension;
 
 extern const wxString LegacyFootprintLibPathExtension;
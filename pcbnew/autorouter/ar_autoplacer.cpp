@@ -0,0 +1,752 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <tuple>
+
+#include <trigo.h>
+#include <convert_to_biu.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+
+#include "ar_autoplacer.h"
+
+
+///> Keep out margin around a footprint, in grid steps per GAIN pads
+static const int GAIN = 16;
+
+///> Keep out cost of a cell next to a footprint
+static const int KEEP_OUT_MARGIN = 500;
+
+///> Size of the buckets of the pad positions of a net, in grid steps
+static const int ANCHOR_BUCKET_STEPS = 8;
+
+///> Nets with up to this many pad positions are searched without the buckets
+static const size_t ANCHOR_LINEAR_SEARCH = 16;
+
+/* Penalty (cost) for CntRot90 and CntRot180:
+ * CntRot90 and CntRot180 are from 0 (rotation allowed) to 10 (rotation not allowed)
+ */
+static const double OrientPenality[11] =
+{
+    2.0,        // CntRot = 0 rotation prohibited
+    1.9,        // CntRot = 1
+    1.8,        // CntRot = 2
+    1.7,        // CntRot = 3
+    1.6,        // CntRot = 4
+    1.5,        // CntRot = 5
+    1.4,        // CntRot = 5
+    1.3,        // CntRot = 7
+    1.2,        // CntRot = 8
+    1.1,        // CntRot = 9
+    1.0         // CntRot = 10 rotation authorized, no penalty
+};
+
+
+static BOX2I toBox( const EDA_RECT& aRect )
+{
+    EDA_RECT rect = aRect;
+    rect.Normalize();
+
+    return BOX2I( VECTOR2I( rect.GetX(), rect.GetY() ),
+                  VECTOR2I( rect.GetWidth(), rect.GetHeight() ) );
+}
+
+
+static SHAPE_POLY_SET rectPoly( const BOX2I& aRect )
+{
+    SHAPE_POLY_SET poly;
+
+    poly.NewOutline();
+    poly.Append( aRect.GetX(), aRect.GetY() );
+    poly.Append( aRect.GetRight(), aRect.GetY() );
+    poly.Append( aRect.GetRight(), aRect.GetBottom() );
+    poly.Append( aRect.GetX(), aRect.GetBottom() );
+
+    return poly;
+}
+
+
+static int boardSide( const MODULE* aModule )
+{
+    return aModule->GetLayer() == B_Cu ? 1 : 0;
+}
+
+
+AR_ANCHOR_INDEX::AR_ANCHOR_INDEX( int aBucketSize ) :
+    m_bucketSize( std::max( aBucketSize, 1 ) ),
+    m_count( 0 ),
+    m_x0( 0 ), m_y0( 0 ), m_x1( -1 ), m_y1( -1 )
+{
+}
+
+
+int AR_ANCHOR_INDEX::bucket( int aCoord ) const
+{
+    // Rounds towards minus infinity, so the buckets around 0 have the same size
+    return aCoord >= 0 ? aCoord / m_bucketSize : -( ( -aCoord - 1 ) / m_bucketSize ) - 1;
+}
+
+
+double AR_ANCHOR_INDEX::Cost( const VECTOR2I& aA, const VECTOR2I& aB )
+{
+    int dx = std::abs( aA.x - aB.x );
+    int dy = std::abs( aA.y - aB.y );
+
+    if( dx < dy )
+        std::swap( dx, dy );
+
+    return hypot( dx, dy * 2.0 );
+}
+
+
+void AR_ANCHOR_INDEX::Add( const VECTOR2I& aPos )
+{
+    int bx = bucket( aPos.x );
+    int by = bucket( aPos.y );
+
+    if( m_count == 0 )
+    {
+        m_x0 = m_x1 = bx;
+        m_y0 = m_y1 = by;
+    }
+    else
+    {
+        m_x0 = std::min( m_x0, bx );
+        m_y0 = std::min( m_y0, by );
+        m_x1 = std::max( m_x1, bx );
+        m_y1 = std::max( m_y1, by );
+    }
+
+    m_anchors.push_back( aPos );
+    m_buckets[ key( bx, by ) ].push_back( aPos );
+    m_count++;
+}
+
+
+double AR_ANCHOR_INDEX::NearestCost( const VECTOR2I& aPos ) const
+{
+    double best = std::numeric_limits<double>::max();
+
+    if( m_count <= ANCHOR_LINEAR_SEARCH )
+    {
+        for( const VECTOR2I& anchor : m_anchors )
+            best = std::min( best, Cost( aPos, anchor ) );
+
+        return best;
+    }
+
+    const int bx = bucket( aPos.x );
+    const int by = bucket( aPos.y );
+    const int lastRing = std::max( { bx - m_x0, m_x1 - bx, by - m_y0, m_y1 - by, 0 } );
+
+    auto visit = [&]( int aX, int aY )
+    {
+        if( aX < m_x0 || aX > m_x1 || aY < m_y0 || aY > m_y1 )
+            return;
+
+        auto it = m_buckets.find( key( aX, aY ) );
+
+        if( it == m_buckets.end() )
+            return;
+
+        for( const VECTOR2I& anchor : it->second )
+            best = std::min( best, Cost( aPos, anchor ) );
+    };
+
+    // Search the rings of buckets around aPos.  The anchors of the ring r are at least
+    // ( r - 1 ) buckets away along x or y, and the cost is never lower than the distance.
+    for( int ring = 0; ring <= lastRing; ring++ )
+    {
+        if( (double) ( ring - 1 ) * m_bucketSize >= best )
+            break;
+
+        for( int y = by - ring; y <= by + ring; y++ )
+        {
+            if( y == by - ring || y == by + ring )
+            {
+                for( int x = bx - ring; x <= bx + ring; x++ )
+                    visit( x, y );
+            }
+            else
+            {
+                visit( bx - ring, y );
+                visit( bx + ring, y );
+            }
+        }
+    }
+
+    return best;
+}
+
+
+AR_AUTOPLACER::AR_AUTOPLACER( BOARD* aBoard ) :
+    m_board( aBoard ),
+    m_pitch( Millimeter2iu( 1.0 ) ),
+    m_threadCount( 0 )
+{
+    m_stats = STATS();
+}
+
+
+AR_AUTOPLACER::~AR_AUTOPLACER()
+{
+}
+
+
+bool AR_AUTOPLACER::initMatrix()
+{
+    m_outline.RemoveAllContours();
+
+    if( !m_board->GetBoardPolygonOutlines( m_outline ) || m_outline.OutlineCount() == 0 )
+        return false;
+
+    m_area = m_outline.BBox();
+
+    if( m_area.GetWidth() == 0 || m_area.GetHeight() == 0 )
+        return false;
+
+    m_matrix.reset( new AR_GRID_MATRIX( m_area, m_pitch, 2 ) );
+    m_matrix->BlockOutside( m_outline, m_outline );
+
+    size_t cellCount = (size_t) m_matrix->Width() * m_matrix->Height();
+
+    for( int side = 0; side < 2; side++ )
+        m_keepOut[side].assign( cellCount, 0 );
+
+    return true;
+}
+
+
+bool AR_AUTOPLACER::cellRange( const BOX2I& aRect, int& aX0, int& aY0,
+                               int& aX1, int& aY1 ) const
+{
+    const VECTOR2I origin = m_area.GetOrigin();
+
+    aX0 = (int) std::ceil( (double) ( aRect.GetX() - origin.x ) / m_pitch );
+    aY0 = (int) std::ceil( (double) ( aRect.GetY() - origin.y ) / m_pitch );
+    aX1 = (int) std::floor( (double) ( aRect.GetRight() - origin.x ) / m_pitch );
+    aY1 = (int) std::floor( (double) ( aRect.GetBottom() - origin.y ) / m_pitch );
+
+    return aX0 >= 0 && aY0 >= 0 && aX1 < m_matrix->Width() && aY1 < m_matrix->Height();
+}
+
+
+void AR_AUTOPLACER::addKeepOut( const BOX2I& aRect, int aMargin, int aSide )
+{
+    int x0, y0, x1, y1;
+    int margin = std::max( aMargin / m_pitch, 1 );
+
+    cellRange( aRect, x0, y0, x1, y1 );
+
+    const int width = m_matrix->Width();
+    std::vector<uint32_t>& keepOut = m_keepOut[aSide];
+
+    // The cost is the highest over the footprint, and decreases linearly in its margin
+    for( int y = std::max( y0 - margin, 0 ); y <= std::min( y1 + margin, m_matrix->Height() - 1 ); y++ )
+    {
+        int dy = std::max( { y0 - y, y - y1, 0 } );
+
+        for( int x = std::max( x0 - margin, 0 ); x <= std::min( x1 + margin, width - 1 ); x++ )
+        {
+            int dx = std::max( { x0 - x, x - x1, 0 } );
+            int d = std::max( dx, dy );
+
+            if( d < margin )
+                keepOut[ (size_t) y * width + x ] += KEEP_OUT_MARGIN * ( margin - d ) / margin;
+        }
+    }
+}
+
+
+void AR_AUTOPLACER::addToMatrix( MODULE* aModule )
+{
+    const int side = boardSide( aModule );
+
+    BOX2I rect = toBox( aModule->GetFootprintRect() );
+    rect.Inflate( m_pitch / 2 );
+
+    m_matrix->BlockTracks( rectPoly( rect ), 1 << side );
+
+    // Through hole pads are in the way of the footprints of the other side
+    LSET otherSide( side ? F_Cu : B_Cu );
+
+    for( D_PAD* pad : aModule->Pads() )
+    {
+        if( !( pad->GetLayerSet() & otherSide ).any() )
+            continue;
+
+        BOX2I padRect = toBox( pad->GetBoundingBox() );
+        padRect.Inflate( pad->GetClearance() + m_pitch / 2 );
+
+        m_matrix->BlockTracks( rectPoly( padRect ), 1 << ( 1 - side ) );
+    }
+
+    int margin = ( m_pitch * aModule->GetPadCount() ) / GAIN;
+
+    addKeepOut( rect, margin, side );
+}
+
+
+void AR_AUTOPLACER::buildSummedAreas()
+{
+    const int width = m_matrix->Width();
+    const int height = m_matrix->Height();
+
+    for( int side = 0; side < 2; side++ )
+    {
+        const std::vector<uint32_t>& keepOut = m_keepOut[side];
+
+        m_blockedArea[side].Build( width, height,
+                [&]( int aX, int aY ) -> uint32_t
+                {
+                    return m_matrix->IsTrackBlocked( aX, aY, side ) ? 1 : 0;
+                } );
+
+        m_keepOutArea[side].Build( width, height,
+                [&]( int aX, int aY ) -> uint64_t
+                {
+                    return keepOut[ (size_t) aY * width + aX ];
+                } );
+    }
+}
+
+
+bool AR_AUTOPLACER::isFree( const BOX2I& aRect, int aSide ) const
+{
+    int x0, y0, x1, y1;
+
+    if( !cellRange( aRect, x0, y0, x1, y1 ) )
+        return false;
+
+    return m_blockedArea[aSide].Sum( x0, y0, x1, y1 ) == 0;
+}
+
+
+uint64_t AR_AUTOPLACER::keepOutCost( const BOX2I& aRect, int aSide ) const
+{
+    int x0, y0, x1, y1;
+
+    cellRange( aRect, x0, y0, x1, y1 );
+
+    x0 = std::max( x0, 0 );
+    y0 = std::max( y0, 0 );
+    x1 = std::min( x1, m_matrix->Width() - 1 );
+    y1 = std::min( y1, m_matrix->Height() - 1 );
+
+    return m_keepOutArea[aSide].Sum( x0, y0, x1, y1 );
+}
+
+
+void AR_AUTOPLACER::addAnchors( MODULE* aModule )
+{
+    // As for the ratsnest cost, footprints outside of the board do not count
+    if( !m_area.Contains( VECTOR2I( aModule->GetPosition().x, aModule->GetPosition().y ) ) )
+        return;
+
+    for( D_PAD* pad : aModule->Pads() )
+    {
+        int net = pad->GetNetCode();
+
+        if( net <= 0 )
+            continue;
+
+        auto anchors = m_anchors.find( net );
+
+        if( anchors == m_anchors.end() )
+        {
+            anchors = m_anchors.emplace( net,
+                    AR_ANCHOR_INDEX( m_pitch * ANCHOR_BUCKET_STEPS ) ).first;
+        }
+
+        anchors->second.Add( VECTOR2I( pad->GetPosition().x, pad->GetPosition().y ) );
+
+        auto footprints = m_netFootprints.find( net );
+
+        if( footprints == m_netFootprints.end() )
+            continue;
+
+        for( MODULE* module : footprints->second )
+        {
+            if( module != aModule )
+                m_connections[module]++;
+        }
+    }
+}
+
+
+void AR_AUTOPLACER::buildOrientations( MODULE* aModule,
+                                       std::vector<ORIENTATION>& aOrientations ) const
+{
+    const wxPoint pos = aModule->GetPosition();
+    const EDA_RECT rect = aModule->GetFootprintRect();
+
+    std::vector<std::pair<double, double>> angles;
+
+    angles.push_back( std::make_pair( 0.0, 1.0 ) );
+
+    if( aModule->GetPlacementCost180() )
+        angles.push_back( std::make_pair( 1800.0, OrientPenality[aModule->GetPlacementCost180()] ) );
+
+    if( aModule->GetPlacementCost90() )
+    {
+        angles.push_back( std::make_pair( 900.0, OrientPenality[aModule->GetPlacementCost90()] ) );
+        angles.push_back( std::make_pair( 2700.0, OrientPenality[aModule->GetPlacementCost90()] ) );
+    }
+
+    for( const auto& angle : angles )
+    {
+        ORIENTATION orient;
+
+        orient.m_angle = angle.first;
+        orient.m_penalty = angle.second;
+
+        // The footprint rotates around its position
+        VECTOR2I corners[4] =
+        {
+            VECTOR2I( rect.GetX() - pos.x, rect.GetY() - pos.y ),
+            VECTOR2I( rect.GetRight() - pos.x, rect.GetY() - pos.y ),
+            VECTOR2I( rect.GetRight() - pos.x, rect.GetBottom() - pos.y ),
+            VECTOR2I( rect.GetX() - pos.x, rect.GetBottom() - pos.y )
+        };
+
+        for( int i = 0; i < 4; i++ )
+        {
+            RotatePoint( corners[i], orient.m_angle );
+
+            if( i == 0 )
+                orient.m_rect = BOX2I( corners[i], VECTOR2I( 0, 0 ) );
+            else
+                orient.m_rect.Merge( corners[i] );
+        }
+
+        for( D_PAD* pad : aModule->Pads() )
+        {
+            if( pad->GetNetCode() <= 0 )
+                continue;
+
+            PAD_REF ref;
+
+            ref.m_offset = VECTOR2I( pad->GetPosition().x - pos.x, pad->GetPosition().y - pos.y );
+            ref.m_net = pad->GetNetCode();
+            RotatePoint( ref.m_offset, orient.m_angle );
+
+            orient.m_pads.push_back( ref );
+        }
+
+        aOrientations.push_back( orient );
+    }
+}
+
+
+double AR_AUTOPLACER::ratsnestCost( const ORIENTATION& aOrient, const VECTOR2I& aPos ) const
+{
+    double cost = 0.0;
+
+    for( const PAD_REF& pad : aOrient.m_pads )
+    {
+        auto anchors = m_anchors.find( pad.m_net );
+
+        if( anchors == m_anchors.end() )
+            continue;
+
+        cost += anchors->second.NearestCost( aPos + pad.m_offset );
+    }
+
+    return cost;
+}
+
+
+AR_AUTOPLACER::CANDIDATE AR_AUTOPLACER::findBestPosition( const ORIENTATION& aOrient,
+                                                          int aSide, bool aBothSides )
+{
+    const VECTOR2I origin = m_area.GetOrigin();
+
+    // Range of the grid positions keeping the footprint rectangle on the board area
+    int kx0 = (int) std::ceil( (double) ( m_area.GetX() - aOrient.m_rect.GetX() - origin.x ) / m_pitch );
+    int ky0 = (int) std::ceil( (double) ( m_area.GetY() - aOrient.m_rect.GetY() - origin.y ) / m_pitch );
+    int kx1 = (int) std::floor( (double) ( m_area.GetRight() - aOrient.m_rect.GetRight() - origin.x ) / m_pitch );
+    int ky1 = (int) std::floor( (double) ( m_area.GetBottom() - aOrient.m_rect.GetBottom() - origin.y ) / m_pitch );
+
+    CANDIDATE best;
+    best.m_found = false;
+    best.m_score = 0.0;
+
+    if( kx0 > kx1 || ky0 > ky1 )
+        return best;
+
+    const int padCount = (int) aOrient.m_pads.size();
+    const int margin = ( m_pitch * std::max( padCount, 1 ) ) / GAIN;
+    const int rowCount = ky1 - ky0 + 1;
+
+    struct THREAD_BEST
+    {
+        bool   m_found = false;
+        double m_score = 0.0;
+        int    m_kx = 0;
+        int    m_ky = 0;
+    };
+
+    size_t threadCount = m_threadCount ? m_threadCount : std::thread::hardware_concurrency();
+    threadCount = std::max<size_t>( std::min<size_t>( threadCount, rowCount ), 1 );
+
+    std::vector<THREAD_BEST> threadBest( threadCount );
+    std::atomic<int> nextRow( 0 );
+    std::atomic<int64_t> candidates( 0 );
+    std::vector<std::thread> workers;
+
+    // Each thread takes whole rows of positions, and keeps its own best one
+    for( size_t ii = 0; ii < threadCount; ++ii )
+    {
+        workers.push_back( std::thread( [&, ii]()
+        {
+            THREAD_BEST& mine = threadBest[ii];
+            int64_t count = 0;
+
+            for( int row = nextRow.fetch_add( 1 ); row < rowCount; row = nextRow.fetch_add( 1 ) )
+            {
+                int ky = ky0 + row;
+
+                for( int kx = kx0; kx <= kx1; kx++ )
+                {
+                    VECTOR2I pos( origin.x + kx * m_pitch, origin.y + ky * m_pitch );
+                    BOX2I rect( aOrient.m_rect.GetOrigin() + pos, aOrient.m_rect.GetSize() );
+
+                    BOX2I body = rect;
+                    body.Inflate( m_pitch / 2 );
+
+                    if( !isFree( body, aSide ) || ( aBothSides && !isFree( body, 1 - aSide ) ) )
+                        continue;
+
+                    count++;
+
+                    BOX2I keepOut = rect;
+                    keepOut.Inflate( margin );
+
+                    double score = ( ratsnestCost( aOrient, pos )
+                                     + (double) keepOutCost( keepOut, aSide ) ) * aOrient.m_penalty;
+
+                    // Equal scores are broken by the position, so the result does not
+                    // depend on the way rows were shared between threads
+                    if( !mine.m_found || score < mine.m_score
+                            || ( score == mine.m_score
+                                 && std::tie( ky, kx ) < std::tie( mine.m_ky, mine.m_kx ) ) )
+                    {
+                        mine.m_found = true;
+                        mine.m_score = score;
+                        mine.m_kx = kx;
+                        mine.m_ky = ky;
+                    }
+                }
+            }
+
+            candidates.fetch_add( count );
+        } ) );
+    }
+
+    for( std::thread& worker : workers )
+        worker.join();
+
+    m_stats.m_candidates += candidates.load();
+
+    const THREAD_BEST* winner = nullptr;
+
+    for( const THREAD_BEST& tb : threadBest )
+    {
+        if( !tb.m_found )
+            continue;
+
+        if( !winner || tb.m_score < winner->m_score
+                || ( tb.m_score == winner->m_score
+                     && std::tie( tb.m_ky, tb.m_kx ) < std::tie( winner->m_ky, winner->m_kx ) ) )
+        {
+            winner = &tb;
+        }
+    }
+
+    if( winner )
+    {
+        best.m_found = true;
+        best.m_score = winner->m_score;
+        best.m_pos = VECTOR2I( origin.x + winner->m_kx * m_pitch, origin.y + winner->m_ky * m_pitch );
+    }
+
+    return best;
+}
+
+
+MODULE* AR_AUTOPLACER::pickFootprint()
+{
+    // Footprints connected to the placed ones first, the biggest and most connected
+    // of them first; then the biggest footprints with the most pads
+    MODULE* best = nullptr;
+    double  bestConnected = 0.0;
+    double  bestSize = 0.0;
+
+    for( MODULE* module : m_toPlace )
+    {
+        if( !module->NeedsPlaced() )
+            continue;
+
+        double connected = module->GetArea() * m_connections[module];
+        double size = module->GetArea() * module->GetPadCount();
+
+        if( !best || connected > bestConnected
+                || ( connected == bestConnected && size > bestSize ) )
+        {
+            best = module;
+            bestConnected = connected;
+            bestSize = size;
+        }
+    }
+
+    return best;
+}
+
+
+int AR_AUTOPLACER::AutoplaceFootprints( AR_PLACE_MODE aMode )
+{
+    m_stats = STATS();
+    m_anchors.clear();
+    m_toPlace.clear();
+    m_netFootprints.clear();
+    m_connections.clear();
+
+    if( !initMatrix() )
+        return -1;
+
+    std::vector<MODULE*> fixed;
+
+    for( MODULE* module : m_board->Modules() )
+    {
+        module->CalculateBoundingBox();
+
+        bool place = false;
+
+        switch( aMode )
+        {
+        case AR_PLACE_ALL:
+            place = !module->IsLocked();
+            break;
+
+        case AR_PLACE_OFF_BOARD:
+            place = !module->IsLocked()
+                    && !m_area.Contains( VECTOR2I( module->GetPosition().x,
+                                                   module->GetPosition().y ) );
+            break;
+
+        case AR_PLACE_SELECTED:
+            place = module->NeedsPlaced();
+            break;
+        }
+
+        module->SetNeedsPlaced( place );
+        module->SetIsPlaced( false );
+
+        if( place )
+            m_toPlace.push_back( module );
+        else
+            fixed.push_back( module );
+    }
+
+    m_stats.m_footprints = m_toPlace.size();
+
+    for( MODULE* module : m_toPlace )
+    {
+        m_connections[module] = 0;
+
+        for( D_PAD* pad : module->Pads() )
+        {
+            if( pad->GetNetCode() <= 0 )
+                continue;
+
+            std::vector<MODULE*>& footprints = m_netFootprints[pad->GetNetCode()];
+
+            if( footprints.empty() || footprints.back() != module )
+                footprints.push_back( module );
+        }
+    }
+
+    for( MODULE* module : fixed )
+    {
+        addToMatrix( module );
+        addAnchors( module );
+    }
+
+    buildSummedAreas();
+
+    while( MODULE* module = pickFootprint() )
+    {
+        std::vector<ORIENTATION> orientations;
+
+        buildOrientations( module, orientations );
+
+        // Test the other side too when the footprint has through hole pads
+        const int side = boardSide( module );
+        bool bothSides = false;
+        LSET otherSide( side ? F_Cu : B_Cu );
+
+        for( D_PAD* pad : module->Pads() )
+            bothSides |= ( pad->GetLayerSet() & otherSide ).any();
+
+        CANDIDATE best;
+        best.m_found = false;
+        double bestAngle = 0.0;
+
+        for( const ORIENTATION& orient : orientations )
+        {
+            CANDIDATE candidate = findBestPosition( orient, side, bothSides );
+
+            if( candidate.m_found && ( !best.m_found || candidate.m_score < best.m_score ) )
+            {
+                best = candidate;
+                bestAngle = orient.m_angle;
+            }
+        }
+
+        module->SetNeedsPlaced( false );
+
+        if( !best.m_found )
+            continue;
+
+        if( bestAngle != 0.0 )
+            module->SetOrientation( module->GetOrientation() + bestAngle );
+
+        module->SetPosition( wxPoint( best.m_pos.x, best.m_pos.y ) );
+        module->CalculateBoundingBox();
+        module->SetIsPlaced( true );
+
+        addToMatrix( module );
+        addAnchors( module );
+        buildSummedAreas();
+
+        m_stats.m_placed++;
+    }
+
+    return m_stats.m_placed;
+}
@@ -0,0 +1,297 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef AR_AUTOPLACER_H
+#define AR_AUTOPLACER_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <math/box2.h>
+#include <math/vector2d.h>
+#include <geometry/shape_poly_set.h>
+
+#include "ar_grid_matrix.h"
+
+class BOARD;
+class MODULE;
+
+/**
+ * Class AR_SUMMED_AREA
+ * Summed area table of a grid of values: the sum of the values of any rectangle of cells
+ * is given by four lookups.
+ */
+template <typename T>
+class AR_SUMMED_AREA
+{
+public:
+    AR_SUMMED_AREA() :
+        m_stride( 0 )
+    {}
+
+    /**
+     * Function Build()
+     * Builds the table of a grid of aWidth by aHeight cells, the value of the cell (x, y)
+     * being aValue( x, y ).
+     */
+    template <typename FUNC>
+    void Build( int aWidth, int aHeight, FUNC aValue )
+    {
+        m_stride = aWidth + 1;
+        m_sums.assign( m_stride * ( aHeight + 1 ), 0 );
+
+        for( int y = 0; y < aHeight; y++ )
+        {
+            T rowSum = 0;
+
+            for( int x = 0; x < aWidth; x++ )
+            {
+                rowSum += aValue( x, y );
+                m_sums[ ( y + 1 ) * m_stride + x + 1 ] = m_sums[ y * m_stride + x + 1 ] + rowSum;
+            }
+        }
+    }
+
+    /**
+     * Function Sum()
+     * Returns the sum of the cells aX0 to aX1 of the rows aY0 to aY1 (inclusive), which
+     * have to be inside the grid.  An empty range sums to 0.
+     */
+    T Sum( int aX0, int aY0, int aX1, int aY1 ) const
+    {
+        if( aX0 > aX1 || aY0 > aY1 )
+            return 0;
+
+        return m_sums[ ( aY1 + 1 ) * m_stride + aX1 + 1 ] - m_sums[ aY0 * m_stride + aX1 + 1 ]
+               - m_sums[ ( aY1 + 1 ) * m_stride + aX0 ] + m_sums[ aY0 * m_stride + aX0 ];
+    }
+
+private:
+    size_t         m_stride;
+    std::vector<T> m_sums;
+};
+
+
+/**
+ * Class AR_ANCHOR_INDEX
+ * The pad positions of a net, bucketed on a coarse square grid, so the one nearest to a
+ * point is found by looking at the buckets around the point only.
+ */
+class AR_ANCHOR_INDEX
+{
+public:
+    AR_ANCHOR_INDEX( int aBucketSize );
+
+    void Add( const VECTOR2I& aPos );
+
+    size_t Size() const
+    {
+        return m_count;
+    }
+
+    /**
+     * Function NearestCost()
+     * Returns the lowest ratsnest cost from aPos to one of the anchors, or the largest
+     * double value if there is no anchor.
+     */
+    double NearestCost( const VECTOR2I& aPos ) const;
+
+    /**
+     * Function Cost()
+     * Returns the ratsnest cost of a connection: its length, plus a penalty due to the
+     * slope, the highest for 45 degrees and 0 for horizontal or vertical connections.
+     * It is never lower than the length.
+     */
+    static double Cost( const VECTOR2I& aA, const VECTOR2I& aB );
+
+private:
+    int bucket( int aCoord ) const;
+
+    static uint64_t key( int aX, int aY )
+    {
+        return ( uint64_t( uint32_t( aX ) ) << 32 ) | uint32_t( aY );
+    }
+
+    int    m_bucketSize;
+    size_t m_count;
+
+    ///> range of the buckets holding anchors
+    int    m_x0, m_y0, m_x1, m_y1;
+
+    std::vector<VECTOR2I>                                m_anchors;
+    std::unordered_map<uint64_t, std::vector<VECTOR2I>> m_buckets;
+};
+
+
+/**
+ * Class AR_AUTOPLACER
+ * Places footprints on the board, one at a time, at the grid position minimizing the
+ * length of their ratsnest to the footprints already placed plus a keep out cost near
+ * the other footprints.
+ *
+ * The placement matrix, telling the free cells of each board side, is shared by the
+ * threads evaluating the candidate positions of a footprint; it is only modified between
+ * two footprints.  Its summed area tables make the test of a footprint rectangle a
+ * constant time operation.  The pad positions of each net are cached in a spatial index,
+ * and updated as each footprint is placed, so the ratsnest is never rebuilt.
+ *
+ * The placement does not depend on the number of threads.  There is no user interface
+ * and no undo: the footprints of the board are moved directly.
+ */
+class AR_AUTOPLACER
+{
+public:
+    enum AR_PLACE_MODE
+    {
+        AR_PLACE_ALL,           ///< all the unlocked footprints
+        AR_PLACE_OFF_BOARD,     ///< the unlocked footprints outside of the board
+        AR_PLACE_SELECTED       ///< the footprints flagged with MODULE::SetNeedsPlaced()
+    };
+
+    struct STATS
+    {
+        int     m_footprints;   ///< footprints to place
+        int     m_placed;       ///< footprints placed
+        int64_t m_candidates;   ///< candidate positions evaluated
+    };
+
+    AR_AUTOPLACER( BOARD* aBoard );
+    ~AR_AUTOPLACER();
+
+    /**
+     * Function SetGridPitch()
+     * Sets the pitch of the candidate positions (1 mm by default).
+     */
+    void SetGridPitch( int aPitch )
+    {
+        m_pitch = aPitch;
+    }
+
+    /**
+     * Function SetThreadCount()
+     * Sets the number of threads (0, the default, uses all the cores).
+     */
+    void SetThreadCount( size_t aCount )
+    {
+        m_threadCount = aCount;
+    }
+
+    /**
+     * Function AutoplaceFootprints()
+     * Places the footprints selected by aMode.
+     * @return the number of footprints placed, or -1 if the board has no outline
+     */
+    int AutoplaceFootprints( AR_PLACE_MODE aMode );
+
+    const STATS& Stats() const
+    {
+        return m_stats;
+    }
+
+private:
+    ///> A footprint pad, relative to the footprint position
+    struct PAD_REF
+    {
+        VECTOR2I m_offset;
+        int      m_net;
+    };
+
+    ///> A footprint in a given orientation
+    struct ORIENTATION
+    {
+        double               m_angle;       ///< relative to the current orientation
+        double               m_penalty;     ///< score multiplier
+        BOX2I                m_rect;        ///< footprint rectangle, relative to the position
+        std::vector<PAD_REF> m_pads;
+    };
+
+    ///> The best position found for a footprint in a given orientation
+    struct CANDIDATE
+    {
+        bool     m_found;
+        double   m_score;
+        VECTOR2I m_pos;
+    };
+
+    bool initMatrix();
+    void addToMatrix( MODULE* aModule );
+    void addKeepOut( const BOX2I& aRect, int aMargin, int aSide );
+    void buildSummedAreas();
+
+    ///> Records the pads of a footprint placed (or fixed) on the board as ratsnest anchors
+    void addAnchors( MODULE* aModule );
+
+    void buildOrientations( MODULE* aModule, std::vector<ORIENTATION>& aOrientations ) const;
+
+    ///> Evaluates all the positions of a footprint orientation, in parallel
+    CANDIDATE findBestPosition( const ORIENTATION& aOrient, int aSide, bool aBothSides );
+
+    ///> Returns the ratsnest cost of aOrient placed at aPos
+    double ratsnestCost( const ORIENTATION& aOrient, const VECTOR2I& aPos ) const;
+
+    ///> Finds the cells whose center is inside aRect.  Returns false if some of them are
+    ///> outside of the matrix.
+    bool cellRange( const BOX2I& aRect, int& aX0, int& aY0, int& aX1, int& aY1 ) const;
+
+    ///> Returns true if aRect is inside the board, and free of footprints on aSide
+    bool isFree( const BOX2I& aRect, int aSide ) const;
+
+    ///> Returns the sum of the keep out costs of the cells inside aRect on aSide
+    uint64_t keepOutCost( const BOX2I& aRect, int aSide ) const;
+
+    MODULE* pickFootprint();
+
+    BOARD*                          m_board;
+    int                             m_pitch;
+    size_t                          m_threadCount;
+
+    SHAPE_POLY_SET                  m_outline;
+    BOX2I                           m_area;
+
+    ///> free cells of the two board sides, as the track planes of layers 0 (top) and 1
+    std::unique_ptr<AR_GRID_MATRIX> m_matrix;
+
+    ///> keep out costs of the cells of the two board sides
+    std::vector<uint32_t>           m_keepOut[2];
+
+    ///> summed areas of the blocked cells and keep out costs of the two board sides
+    AR_SUMMED_AREA<uint32_t>        m_blockedArea[2];
+    AR_SUMMED_AREA<uint64_t>        m_keepOutArea[2];
+
+    ///> pad positions of the placed footprints, by net
+    std::unordered_map<int, AR_ANCHOR_INDEX> m_anchors;
+
+    std::vector<MODULE*>            m_toPlace;
+
+    ///> footprints to place having pads on each net
+    std::unordered_map<int, std::vector<MODULE*>> m_netFootprints;
+
+    ///> number of pads of placed footprints connected to each footprint to place
+    std::unordered_map<MODULE*, int> m_connections;
+
+    STATS                           m_stats;
+};
+
+#endif  // AR_AUTOPLACER_H
@@ -0,0 +1,201 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <geometry/seg.h>
+#include <geometry/shape_poly_set.h>
+
+#include "ar_grid_matrix.h"
+
+
+void AR_BITPLANE::SetSpan( int aY, int aX0, int aX1 )
+{
+    uint64_t* row = &m_bits[ (size_t) aY * m_stride ];
+    int firstWord = aX0 >> 6;
+    int lastWord = aX1 >> 6;
+
+    uint64_t firstMask = ~uint64_t( 0 ) << ( aX0 & 63 );
+    uint64_t lastMask = ~uint64_t( 0 ) >> ( 63 - ( aX1 & 63 ) );
+
+    if( firstWord == lastWord )
+    {
+        row[firstWord] |= firstMask & lastMask;
+        return;
+    }
+
+    row[firstWord] |= firstMask;
+
+    for( int word = firstWord + 1; word < lastWord; word++ )
+        row[word] = ~uint64_t( 0 );
+
+    row[lastWord] |= lastMask;
+}
+
+
+void AR_BITPLANE::SetComplement( const AR_BITPLANE& aOther )
+{
+    for( size_t i = 0; i < m_bits.size(); i++ )
+        m_bits[i] |= ~aOther.m_bits[i];
+
+    // Clear the padding bits at the end of each row, so they stay unused
+    if( m_width & 63 )
+    {
+        uint64_t lastMask = ~uint64_t( 0 ) >> ( 64 - ( m_width & 63 ) );
+
+        for( int y = 0; y < m_height; y++ )
+            m_bits[ (size_t) y * m_stride + m_stride - 1 ] &= lastMask;
+    }
+}
+
+
+AR_GRID_MATRIX::AR_GRID_MATRIX( const BOX2I& aArea, int aPitch, int aLayerCount )
+{
+    m_origin = aArea.GetOrigin();
+    m_pitch = aPitch;
+    m_width = std::max( 1, aArea.GetWidth() / aPitch + 1 );
+    m_height = std::max( 1, aArea.GetHeight() / aPitch + 1 );
+
+    m_trackPlanes.resize( aLayerCount );
+
+    for( AR_BITPLANE& plane : m_trackPlanes )
+        plane.Resize( m_width, m_height );
+
+    m_viaPlane.Resize( m_width, m_height );
+}
+
+
+bool AR_GRID_MATRIX::PosToCell( const VECTOR2I& aPos, int& aX, int& aY ) const
+{
+    aX = (int) std::lround( (double) ( aPos.x - m_origin.x ) / m_pitch );
+    aY = (int) std::lround( (double) ( aPos.y - m_origin.y ) / m_pitch );
+
+    return aX >= 0 && aY >= 0 && aX < m_width && aY < m_height;
+}
+
+
+void AR_GRID_MATRIX::fillPolygon( AR_BITPLANE& aPlane, const SHAPE_POLY_SET& aPoly ) const
+{
+    std::vector<SEG> edges;
+
+    auto addEdges = [&edges]( const SHAPE_LINE_CHAIN& aChain )
+    {
+        for( int i = 0; i < aChain.PointCount(); i++ )
+            edges.push_back( SEG( aChain.CPoint( i ), aChain.CPoint( ( i + 1 ) % aChain.PointCount() ) ) );
+    };
+
+    for( int outline = 0; outline < aPoly.OutlineCount(); outline++ )
+    {
+        addEdges( aPoly.COutline( outline ) );
+
+        for( int hole = 0; hole < aPoly.HoleCount( outline ); hole++ )
+            addEdges( aPoly.CHole( outline, hole ) );
+    }
+
+    if( edges.empty() )
+        return;
+
+    const BOX2I bbox = aPoly.BBox();
+
+    int y0 = std::max( 0, (int) std::ceil( (double) ( bbox.GetY() - m_origin.y ) / m_pitch ) );
+    int y1 = std::min( m_height - 1,
+                       (int) std::floor( (double) ( bbox.GetBottom() - m_origin.y ) / m_pitch ) );
+
+    std::vector<double> crossings;
+
+    // Even-odd scanline fill through the cell centers: holes are handled the same way
+    // as outlines.
+    for( int y = y0; y <= y1; y++ )
+    {
+        double py = m_origin.y + (double) y * m_pitch;
+
+        crossings.clear();
+
+        for( const SEG& edge : edges )
+        {
+            if( ( edge.A.y <= py && py < edge.B.y ) || ( edge.B.y <= py && py < edge.A.y ) )
+            {
+                double t = ( py - edge.A.y ) / ( edge.B.y - edge.A.y );
+                crossings.push_back( edge.A.x + t * ( edge.B.x - edge.A.x ) );
+            }
+        }
+
+        std::sort( crossings.begin(), crossings.end() );
+
+        for( size_t i = 0; i + 1 < crossings.size(); i += 2 )
+        {
+            int x0 = std::max( 0, (int) std::ceil( ( crossings[i] - m_origin.x ) / m_pitch ) );
+            int x1 = std::min( m_width - 1,
+                               (int) std::floor( ( crossings[i + 1] - m_origin.x ) / m_pitch ) );
+
+            if( x0 <= x1 )
+                aPlane.SetSpan( y, x0, x1 );
+        }
+    }
+}
+
+
+void AR_GRID_MATRIX::BlockTracks( const SHAPE_POLY_SET& aPoly, uint32_t aLayerMask )
+{
+    for( int layer = 0; layer < LayerCount(); layer++ )
+    {
+        if( aLayerMask & ( 1 << layer ) )
+            fillPolygon( m_trackPlanes[layer], aPoly );
+    }
+}
+
+
+void AR_GRID_MATRIX::BlockVias( const SHAPE_POLY_SET& aPoly )
+{
+    fillPolygon( m_viaPlane, aPoly );
+}
+
+
+void AR_GRID_MATRIX::BlockOutside( const SHAPE_POLY_SET& aTrackArea,
+                                   const SHAPE_POLY_SET& aViaArea )
+{
+    AR_BITPLANE inside;
+
+    inside.Resize( m_width, m_height );
+    fillPolygon( inside, aTrackArea );
+
+    for( AR_BITPLANE& plane : m_trackPlanes )
+        plane.SetComplement( inside );
+
+    inside.Resize( m_width, m_height );
+    fillPolygon( inside, aViaArea );
+
+    m_viaPlane.SetComplement( inside );
+}
+
+
+size_t AR_GRID_MATRIX::MemoryUsage() const
+{
+    size_t usage = m_viaPlane.MemoryUsage();
+
+    for( const AR_BITPLANE& plane : m_trackPlanes )
+        usage += plane.MemoryUsage();
+
+    return usage;
+}
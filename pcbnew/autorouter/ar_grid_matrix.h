@@ -0,0 +1,172 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef AR_GRID_MATRIX_H
+#define AR_GRID_MATRIX_H
+
+#include <cstdint>
+#include <vector>
+
+#include <math/box2.h>
+#include <math/vector2d.h>
+
+class SHAPE_POLY_SET;
+
+/**
+ * Class AR_BITPLANE
+ * A two dimensional array of bits, one per grid cell, packed in 64 bit words.
+ */
+class AR_BITPLANE
+{
+public:
+    AR_BITPLANE() :
+        m_width( 0 ), m_height( 0 ), m_stride( 0 )
+    {}
+
+    /**
+     * Function Resize()
+     * Sets the size of the plane and clears all its bits.
+     */
+    void Resize( int aWidth, int aHeight )
+    {
+        m_width = aWidth;
+        m_height = aHeight;
+        m_stride = ( aWidth + 63 ) / 64;
+        m_bits.assign( (size_t) m_stride * aHeight, 0 );
+    }
+
+    bool Get( int aX, int aY ) const
+    {
+        return ( m_bits[ (size_t) aY * m_stride + ( aX >> 6 ) ] >> ( aX & 63 ) ) & 1;
+    }
+
+    void Set( int aX, int aY )
+    {
+        m_bits[ (size_t) aY * m_stride + ( aX >> 6 ) ] |= uint64_t( 1 ) << ( aX & 63 );
+    }
+
+    /**
+     * Function SetSpan()
+     * Sets the bits of the cells aX0 to aX1 (inclusive) of the row aY.
+     */
+    void SetSpan( int aY, int aX0, int aX1 );
+
+    /**
+     * Function SetComplement()
+     * Sets the bits of all the cells whose bit is not set in aOther, a plane of the
+     * same size.
+     */
+    void SetComplement( const AR_BITPLANE& aOther );
+
+    size_t MemoryUsage() const
+    {
+        return m_bits.size() * sizeof( uint64_t );
+    }
+
+private:
+    int m_width;
+    int m_height;
+    int m_stride;       ///< number of words per row
+
+    std::vector<uint64_t> m_bits;
+};
+
+
+/**
+ * Class AR_GRID_MATRIX
+ * The routing grid of a rectangular area of the board, for a given number of copper
+ * layers.  Each layer has a plane telling the cells where a track center cannot go, and
+ * a single plane tells where a (through) via center cannot go.  Obstacles are added as
+ * polygons already inflated by the clearance and the half width of the track or via.
+ *
+ * Cells are squares of aPitch size; the cell (0, 0) is centered on the top left
+ * corner of the area.
+ */
+class AR_GRID_MATRIX
+{
+public:
+    AR_GRID_MATRIX( const BOX2I& aArea, int aPitch, int aLayerCount );
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+    int LayerCount() const { return (int) m_trackPlanes.size(); }
+    int Pitch() const { return m_pitch; }
+
+    ///> Returns the board position of the center of a cell
+    VECTOR2I CellPos( int aX, int aY ) const
+    {
+        return VECTOR2I( m_origin.x + aX * m_pitch, m_origin.y + aY * m_pitch );
+    }
+
+    /**
+     * Function PosToCell()
+     * Finds the cell nearest to aPos.
+     * @return false if aPos is outside of the grid
+     */
+    bool PosToCell( const VECTOR2I& aPos, int& aX, int& aY ) const;
+
+    bool IsTrackBlocked( int aX, int aY, int aLayer ) const
+    {
+        return m_trackPlanes[aLayer].Get( aX, aY );
+    }
+
+    bool IsViaBlocked( int aX, int aY ) const
+    {
+        return m_viaPlane.Get( aX, aY );
+    }
+
+    /**
+     * Function BlockTracks()
+     * Forbids track centers inside aPoly, on the layers whose bit is set in aLayerMask.
+     */
+    void BlockTracks( const SHAPE_POLY_SET& aPoly, uint32_t aLayerMask );
+
+    /**
+     * Function BlockVias()
+     * Forbids via centers inside aPoly.
+     */
+    void BlockVias( const SHAPE_POLY_SET& aPoly );
+
+    /**
+     * Function BlockOutside()
+     * Forbids track centers outside of aTrackArea and via centers outside of aViaArea.
+     */
+    void BlockOutside( const SHAPE_POLY_SET& aTrackArea, const SHAPE_POLY_SET& aViaArea );
+
+    ///> Returns the memory used by the planes, in bytes
+    size_t MemoryUsage() const;
+
+private:
+    ///> Sets in aPlane the bits of the cells whose center is inside aPoly
+    void fillPolygon( AR_BITPLANE& aPlane, const SHAPE_POLY_SET& aPoly ) const;
+
+    VECTOR2I m_origin;
+    int      m_pitch;
+    int      m_width;
+    int      m_height;
+
+    std::vector<AR_BITPLANE> m_trackPlanes;
+    AR_BITPLANE              m_viaPlane;
+};
+
+#endif  // AR_GRID_MATRIX_H
@@ -0,0 +1,690 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <queue>
+#include <thread>
+#include <tuple>
+
+#include <pcbnew.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <connectivity_data.h>
+#include <connectivity_algo.h>
+
+#include "ar_grid_router.h"
+
+
+///> Costs of the moves of the A* search.  A via costs m_viaCost straight steps.
+static const int STRAIGHT_COST = 10;
+static const int DIAGONAL_COST = 14;
+static const int BEND_COST = 5;
+
+///> Minimum distance between a connection and the border of its search window, in
+///> grid steps
+static const int WINDOW_MARGIN = 40;
+
+///> Codes of the way a cell was reached in the A* search: 0 for a cell not reached yet,
+///> 1 to 8 for a step in one of the 8 directions, VIA_FROM + n for a via from the layer n.
+static const uint8_t VIA_FROM = 9;
+static const uint8_t FROM_START = 255;
+
+static const int STEP_DX[8] = { 1, 1, 0, -1, -1, -1,  0,  1 };
+static const int STEP_DY[8] = { 0, 1, 1,  1,  0, -1, -1, -1 };
+
+
+AR_GRID_ROUTER::AR_GRID_ROUTER( BOARD* aBoard ) :
+    m_board( aBoard ),
+    m_pitch( 0 ),
+    m_viaCost( 10 ),
+    m_threadCount( 0 ),
+    m_trackHalo( 0 ),
+    m_viaHalo( 0 ),
+    m_obstacleIndex( new RTree<int, int, 2, double>() )
+{
+    m_layerCount = aBoard->GetCopperLayerCount();
+    m_stats = STATS();
+}
+
+
+AR_GRID_ROUTER::~AR_GRID_ROUTER()
+{
+}
+
+
+uint32_t AR_GRID_ROUTER::gridLayers( LSET aLayers ) const
+{
+    uint32_t mask = 0;
+
+    for( int layer = 0; layer < m_layerCount; layer++ )
+    {
+        if( aLayers[ boardLayer( layer ) ] )
+            mask |= 1 << layer;
+    }
+
+    return mask;
+}
+
+
+PCB_LAYER_ID AR_GRID_ROUTER::boardLayer( int aGridLayer ) const
+{
+    return aGridLayer == m_layerCount - 1 ? B_Cu : ToLAYER_ID( aGridLayer );
+}
+
+
+BOX2I AR_GRID_ROUTER::snapToGrid( const BOX2I& aBox ) const
+{
+    BOX2I box = aBox;
+    box.Normalize();
+
+    int x0 = std::max( box.GetX(), m_area.GetX() );
+    int y0 = std::max( box.GetY(), m_area.GetY() );
+    int x1 = std::min( box.GetRight(), m_area.GetRight() );
+    int y1 = std::min( box.GetBottom(), m_area.GetBottom() );
+
+    // the cells of all the windows have to be the cells of the board area
+    x0 = m_area.GetX() + ( x0 - m_area.GetX() ) / m_pitch * m_pitch;
+    y0 = m_area.GetY() + ( y0 - m_area.GetY() ) / m_pitch * m_pitch;
+
+    return BOX2I( VECTOR2I( x0, y0 ), VECTOR2I( std::max( x1 - x0, 0 ), std::max( y1 - y0, 0 ) ) );
+}
+
+
+void AR_GRID_ROUTER::insertObstacle( std::unique_ptr<OBSTACLE> aObstacle )
+{
+    aObstacle->m_bbox = aObstacle->m_trackHalo.BBox();
+    aObstacle->m_bbox.Merge( aObstacle->m_viaHalo.BBox() );
+
+    const int mmin[2] = { aObstacle->m_bbox.GetX(), aObstacle->m_bbox.GetY() };
+    const int mmax[2] = { aObstacle->m_bbox.GetRight(), aObstacle->m_bbox.GetBottom() };
+
+    m_obstacleIndex->Insert( mmin, mmax, (int) m_obstacles.size() );
+    m_obstacles.push_back( std::move( aObstacle ) );
+}
+
+
+void AR_GRID_ROUTER::addObstacle( const BOARD_CONNECTED_ITEM* aItem, uint32_t aLayers )
+{
+    const int    segsPerCircle = ARC_APPROX_SEGMENTS_COUNT_LOW_DEF;
+    const double correctionFactor = 1.0 / cos( M_PI / (double) segsPerCircle );
+
+    std::unique_ptr<OBSTACLE> obstacle( new OBSTACLE );
+
+    // The polygons are filled with the even-odd rule, so overlapping outlines (as found in
+    // some custom pads) have to be merged
+    aItem->TransformShapeWithClearanceToPolygon( obstacle->m_trackHalo, m_trackHalo,
+                                                 segsPerCircle, correctionFactor );
+    obstacle->m_trackHalo.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+    aItem->TransformShapeWithClearanceToPolygon( obstacle->m_viaHalo, m_viaHalo,
+                                                 segsPerCircle, correctionFactor );
+    obstacle->m_viaHalo.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+    obstacle->m_layers = aLayers;
+    obstacle->m_blocksVias = true;
+    obstacle->m_net = aItem->GetNetCode();
+
+    insertObstacle( std::move( obstacle ) );
+}
+
+
+void AR_GRID_ROUTER::buildObstacles()
+{
+    const uint32_t allLayers = (uint32_t) ( ( uint64_t( 1 ) << m_layerCount ) - 1 );
+
+    for( MODULE* module : m_board->Modules() )
+    {
+        for( D_PAD* pad : module->Pads() )
+        {
+            // A hole is in the way on all layers, even without copper around
+            if( pad->GetAttribute() == PAD_ATTRIB_HOLE_NOT_PLATED )
+                addObstacle( pad, allLayers );
+            else
+                addObstacle( pad, gridLayers( pad->GetLayerSet() ) );
+        }
+    }
+
+    for( TRACK* track : m_board->Tracks() )
+        addObstacle( track, gridLayers( track->GetLayerSet() ) );
+
+    // Copper zones are expected to be filled after routing: only keepouts are obstacles
+    const int segsPerCircle = ARC_APPROX_SEGMENTS_COUNT_LOW_DEF;
+
+    for( ZONE_CONTAINER* zone : m_board->Zones() )
+    {
+        if( !zone->GetIsKeepout() )
+            continue;
+
+        std::unique_ptr<OBSTACLE> obstacle( new OBSTACLE );
+
+        obstacle->m_trackHalo = *zone->Outline();
+        obstacle->m_trackHalo.Inflate( m_trackHalo, segsPerCircle );
+        obstacle->m_viaHalo = *zone->Outline();
+        obstacle->m_viaHalo.Inflate( m_viaHalo, segsPerCircle );
+        obstacle->m_layers = zone->GetDoNotAllowTracks() ? gridLayers( zone->GetLayerSet() ) : 0;
+        obstacle->m_blocksVias = zone->GetDoNotAllowVias();
+        obstacle->m_net = -1;
+
+        insertObstacle( std::move( obstacle ) );
+    }
+}
+
+
+void AR_GRID_ROUTER::buildConnections( std::vector<CONNECTION>& aConnections )
+{
+    std::vector<CN_EDGE> edges;
+
+    m_board->GetConnectivity()->GetUnconnectedEdges( edges );
+
+    for( const CN_EDGE& edge : edges )
+    {
+        const BOARD_CONNECTED_ITEM* source = edge.GetSourceNode()->Parent();
+        const BOARD_CONNECTED_ITEM* target = edge.GetTargetNode()->Parent();
+
+        CONNECTION conn;
+
+        conn.m_net = source->GetNetCode();
+        conn.m_source = edge.GetSourcePos();
+        conn.m_target = edge.GetTargetPos();
+        conn.m_sourceLayers = gridLayers( source->GetLayerSet() );
+        conn.m_targetLayers = gridLayers( target->GetLayerSet() );
+
+        if( !conn.m_sourceLayers || !conn.m_targetLayers )
+            continue;
+
+        BOX2I window( conn.m_source, conn.m_target - conn.m_source );
+        window.Normalize();
+
+        int length = ( conn.m_target - conn.m_source ).EuclideanNorm();
+        window.Inflate( std::max( WINDOW_MARGIN * m_pitch, length / 2 ) );
+
+        conn.m_window = snapToGrid( window );
+
+        aConnections.push_back( conn );
+    }
+
+    // Short connections first, in an order not depending on the ratsnest computation
+    auto key = []( const CONNECTION& aConn )
+    {
+        VECTOR2I d = aConn.m_target - aConn.m_source;
+
+        return std::make_tuple( std::abs( d.x ) + std::abs( d.y ), aConn.m_net,
+                                aConn.m_source.x, aConn.m_source.y,
+                                aConn.m_target.x, aConn.m_target.y );
+    };
+
+    std::sort( aConnections.begin(), aConnections.end(),
+               [&key]( const CONNECTION& aA, const CONNECTION& aB )
+               {
+                   return key( aA ) < key( aB );
+               } );
+}
+
+
+bool AR_GRID_ROUTER::findPath( const AR_GRID_MATRIX& aMatrix, const CONNECTION& aConn,
+                               std::vector<PATH_POINT>& aPath, size_t& aMemory ) const
+{
+    const int    width = aMatrix.Width();
+    const int    height = aMatrix.Height();
+    const int    layers = aMatrix.LayerCount();
+    const size_t planeSize = (size_t) width * height;
+
+    int sx, sy, tx, ty;
+
+    aMemory = 0;
+
+    if( !aMatrix.PosToCell( aConn.m_source, sx, sy )
+            || !aMatrix.PosToCell( aConn.m_target, tx, ty ) )
+    {
+        return false;
+    }
+
+    struct OPEN_ENTRY
+    {
+        int      m_f;           ///< cost so far plus estimated remaining cost
+        int      m_g;           ///< cost so far
+        uint32_t m_cell;
+        uint8_t  m_from;
+
+        bool operator<( const OPEN_ENTRY& aOther ) const
+        {
+            // std::priority_queue pops the largest entry: the one of lowest cost, and for
+            // equal costs the one nearest to the target
+            if( m_f != aOther.m_f )
+                return m_f > aOther.m_f;
+
+            return m_g < aOther.m_g;
+        }
+    };
+
+    // How each cell was reached, which also tells the cells already reached
+    std::vector<uint8_t>  from( planeSize * layers, 0 );
+    std::priority_queue<OPEN_ENTRY> open;
+    size_t peakOpen = 0;
+
+    auto cellIndex = [&]( int aX, int aY, int aLayer )
+    {
+        return (uint32_t) ( aLayer * planeSize + (size_t) aY * width + aX );
+    };
+
+    // Octile distance: admissible, as a diagonal step is the cheapest way to move in
+    // both directions at once
+    auto estimate = [&]( int aX, int aY )
+    {
+        int dx = std::abs( aX - tx );
+        int dy = std::abs( aY - ty );
+
+        return STRAIGHT_COST * std::max( dx, dy )
+                + ( DIAGONAL_COST - STRAIGHT_COST ) * std::min( dx, dy );
+    };
+
+    auto push = [&]( int aG, int aX, int aY, int aLayer, uint8_t aFrom )
+    {
+        open.push( OPEN_ENTRY{ aG + estimate( aX, aY ), aG, cellIndex( aX, aY, aLayer ), aFrom } );
+        peakOpen = std::max( peakOpen, open.size() );
+    };
+
+    for( int layer = 0; layer < layers; layer++ )
+    {
+        if( aConn.m_sourceLayers & ( 1 << layer ) )
+            push( 0, sx, sy, layer, FROM_START );
+    }
+
+    bool found = false;
+    uint32_t last = 0;
+
+    while( !open.empty() )
+    {
+        OPEN_ENTRY entry = open.top();
+        open.pop();
+
+        if( from[entry.m_cell] )
+            continue;
+
+        from[entry.m_cell] = entry.m_from;
+
+        const int layer = entry.m_cell / planeSize;
+        const int y = ( entry.m_cell % planeSize ) / width;
+        const int x = ( entry.m_cell % planeSize ) % width;
+
+        if( x == tx && y == ty && ( aConn.m_targetLayers & ( 1 << layer ) ) )
+        {
+            found = true;
+            last = entry.m_cell;
+            break;
+        }
+
+        for( int dir = 0; dir < 8; dir++ )
+        {
+            const int nx = x + STEP_DX[dir];
+            const int ny = y + STEP_DY[dir];
+
+            if( nx < 0 || ny < 0 || nx >= width || ny >= height )
+                continue;
+
+            if( from[ cellIndex( nx, ny, layer ) ] )
+                continue;
+
+            // The target pad may be inside the halo of a nearby item; get in anyway
+            if( aMatrix.IsTrackBlocked( nx, ny, layer ) && !( nx == tx && ny == ty ) )
+                continue;
+
+            bool diagonal = STEP_DX[dir] && STEP_DY[dir];
+
+            // Do not cut corners between two obstacles
+            if( diagonal && ( aMatrix.IsTrackBlocked( nx, y, layer )
+                              || aMatrix.IsTrackBlocked( x, ny, layer ) ) )
+            {
+                continue;
+            }
+
+            int g = entry.m_g + ( diagonal ? DIAGONAL_COST : STRAIGHT_COST );
+
+            if( entry.m_from != dir + 1 && entry.m_from != FROM_START )
+                g += BEND_COST;
+
+            push( g, nx, ny, layer, dir + 1 );
+        }
+
+        // Vias: not on the pads to connect, and never two in a row
+        if( layers < 2 || entry.m_from >= VIA_FROM || aMatrix.IsViaBlocked( x, y )
+                || ( x == sx && y == sy ) || ( x == tx && y == ty ) )
+        {
+            continue;
+        }
+
+        for( int other = 0; other < layers; other++ )
+        {
+            if( other == layer || from[ cellIndex( x, y, other ) ]
+                    || aMatrix.IsTrackBlocked( x, y, other ) )
+            {
+                continue;
+            }
+
+            push( entry.m_g + m_viaCost * STRAIGHT_COST, x, y, other, VIA_FROM + layer );
+        }
+    }
+
+    aMemory = from.size() * sizeof( uint8_t ) + peakOpen * sizeof( OPEN_ENTRY );
+
+    if( !found )
+        return false;
+
+    aPath.clear();
+
+    for( uint32_t cell = last; ; )
+    {
+        int layer = cell / planeSize;
+        int y = ( cell % planeSize ) / width;
+        int x = ( cell % planeSize ) % width;
+        uint8_t code = from[cell];
+
+        aPath.push_back( PATH_POINT{ x, y, layer } );
+
+        if( code == FROM_START )
+            break;
+
+        if( code >= VIA_FROM )
+        {
+            layer = code - VIA_FROM;
+        }
+        else
+        {
+            x -= STEP_DX[code - 1];
+            y -= STEP_DY[code - 1];
+        }
+
+        cell = cellIndex( x, y, layer );
+    }
+
+    std::reverse( aPath.begin(), aPath.end() );
+
+    return true;
+}
+
+
+void AR_GRID_ROUTER::search( const CONNECTION& aConn, const BOX2I& aWindow,
+                             SEARCH_RESULT& aResult ) const
+{
+    AR_GRID_MATRIX matrix( aWindow, m_pitch, m_layerCount );
+
+    matrix.BlockOutside( m_trackArea, m_viaArea );
+
+    std::vector<int> found;
+    auto collect = [&found]( int aIndex )
+    {
+        found.push_back( aIndex );
+        return true;
+    };
+
+    const int mmin[2] = { aWindow.GetX(), aWindow.GetY() };
+    const int mmax[2] = { aWindow.GetRight(), aWindow.GetBottom() };
+
+    m_obstacleIndex->Search( mmin, mmax, collect );
+
+    for( int index : found )
+    {
+        const OBSTACLE& obstacle = *m_obstacles[index];
+
+        // the items of the routed net are its own way
+        if( obstacle.m_net > 0 && obstacle.m_net == aConn.m_net )
+            continue;
+
+        if( obstacle.m_layers )
+            matrix.BlockTracks( obstacle.m_trackHalo, obstacle.m_layers );
+
+        if( obstacle.m_blocksVias )
+            matrix.BlockVias( obstacle.m_viaHalo );
+    }
+
+    std::vector<PATH_POINT> path;
+
+    aResult.m_found = findPath( matrix, aConn, path, aResult.m_memory );
+    aResult.m_memory += matrix.MemoryUsage();
+    aResult.m_points.clear();
+    aResult.m_layers.clear();
+
+    if( !aResult.m_found )
+        return;
+
+    const PATH_POINT& first = path.front();
+    const PATH_POINT& last = path.back();
+
+    // Keep the corners and the layer changes only.  The cells of the pads to connect
+    // are moved to the exact pad positions.
+    for( size_t i = 0; i < path.size(); i++ )
+    {
+        const PATH_POINT& p = path[i];
+
+        if( i > 0 && i + 1 < path.size() )
+        {
+            const PATH_POINT& prev = path[i - 1];
+            const PATH_POINT& next = path[i + 1];
+
+            bool sameLayer = prev.m_layer == p.m_layer && p.m_layer == next.m_layer;
+            bool straight = p.m_x - prev.m_x == next.m_x - p.m_x
+                            && p.m_y - prev.m_y == next.m_y - p.m_y;
+
+            if( sameLayer && straight )
+                continue;
+        }
+
+        VECTOR2I pos = matrix.CellPos( p.m_x, p.m_y );
+
+        if( p.m_x == first.m_x && p.m_y == first.m_y )
+            pos = aConn.m_source;
+        else if( p.m_x == last.m_x && p.m_y == last.m_y )
+            pos = aConn.m_target;
+
+        aResult.m_points.push_back( pos );
+        aResult.m_layers.push_back( p.m_layer );
+    }
+}
+
+
+void AR_GRID_ROUTER::commitPath( const CONNECTION& aConn, const SEARCH_RESULT& aResult,
+                                 std::vector<BOARD_CONNECTED_ITEM*>& aNewItems )
+{
+    NETCLASSPTR netclass = m_board->FindNet( aConn.m_net )->GetNetClass();
+    const uint32_t allLayers = (uint32_t) ( ( uint64_t( 1 ) << m_layerCount ) - 1 );
+
+    for( size_t i = 1; i < aResult.m_points.size(); i++ )
+    {
+        const VECTOR2I& a = aResult.m_points[i - 1];
+        const VECTOR2I& b = aResult.m_points[i];
+
+        if( aResult.m_layers[i] != aResult.m_layers[i - 1] )
+        {
+            VIA* via = new VIA( m_board );
+
+            via->SetPosition( wxPoint( b.x, b.y ) );
+            via->SetViaType( VIA_THROUGH );
+            via->SetLayerPair( F_Cu, B_Cu );
+            via->SetWidth( netclass->GetViaDiameter() );
+            via->SetDrill( netclass->GetViaDrill() );
+            via->SetNetCode( aConn.m_net );
+
+            aNewItems.push_back( via );
+            addObstacle( via, allLayers );
+            m_stats.m_vias++;
+        }
+        else if( a != b )
+        {
+            TRACK* track = new TRACK( m_board );
+
+            track->SetStart( wxPoint( a.x, a.y ) );
+            track->SetEnd( wxPoint( b.x, b.y ) );
+            track->SetWidth( netclass->GetTrackWidth() );
+            track->SetLayer( boardLayer( aResult.m_layers[i] ) );
+            track->SetNetCode( aConn.m_net );
+
+            aNewItems.push_back( track );
+            addObstacle( track, 1 << aResult.m_layers[i] );
+        }
+    }
+
+    m_stats.m_routed++;
+}
+
+
+bool AR_GRID_ROUTER::Route( std::vector<BOARD_CONNECTED_ITEM*>& aNewItems )
+{
+    BOARD_DESIGN_SETTINGS& bds = m_board->GetDesignSettings();
+    NETCLASSPTR defaultClass = bds.GetDefault();
+
+    int clearance = bds.GetBiggestClearanceValue();
+    int trackWidth = defaultClass->GetTrackWidth();
+    int viaDiameter = defaultClass->GetViaDiameter();
+
+    for( const auto& netclass : bds.m_NetClasses )
+    {
+        trackWidth = std::max( trackWidth, netclass.second->GetTrackWidth() );
+        viaDiameter = std::max( viaDiameter, netclass.second->GetViaDiameter() );
+    }
+
+    if( m_pitch <= 0 )
+        m_pitch = std::max( ( defaultClass->GetTrackWidth() + defaultClass->GetClearance() ) / 2, 1 );
+
+    // Obstacles are only tested at the cell centers.  A point of a diagonal step is up to
+    // half a grid diagonal away from the four cells around it, which all have to be free:
+    // the track halo includes this distance, so a track between free cells keeps its
+    // clearance.
+    const int stepMargin = (int) std::ceil( m_pitch * M_SQRT1_2 );
+
+    m_trackHalo = clearance + trackWidth / 2 + stepMargin;
+    m_viaHalo = clearance + viaDiameter / 2 + m_pitch / 2;
+
+    SHAPE_POLY_SET outline;
+
+    if( !m_board->GetBoardPolygonOutlines( outline ) || outline.OutlineCount() == 0 )
+    {
+        EDA_RECT bbox = m_board->GetBoundingBox();
+
+        outline.RemoveAllContours();
+        outline.NewOutline();
+        outline.Append( bbox.GetX(), bbox.GetY() );
+        outline.Append( bbox.GetRight(), bbox.GetY() );
+        outline.Append( bbox.GetRight(), bbox.GetBottom() );
+        outline.Append( bbox.GetX(), bbox.GetBottom() );
+    }
+
+    m_area = outline.BBox();
+    m_trackArea = outline;
+    m_trackArea.Inflate( -m_trackHalo, ARC_APPROX_SEGMENTS_COUNT_LOW_DEF );
+    m_viaArea = outline;
+    m_viaArea.Inflate( -m_viaHalo, ARC_APPROX_SEGMENTS_COUNT_LOW_DEF );
+
+    buildObstacles();
+
+    std::vector<CONNECTION> pending;
+    std::vector<CONNECTION> failed;
+
+    buildConnections( pending );
+
+    m_stats.m_connections = pending.size();
+
+    // Two windows this far apart cannot get items too close to each other
+    const int separation = m_trackHalo + m_viaHalo;
+
+    while( !pending.empty() )
+    {
+        std::vector<CONNECTION> batch;
+        std::vector<CONNECTION> later;
+
+        for( const CONNECTION& conn : pending )
+        {
+            BOX2I reach = conn.m_window;
+            reach.Inflate( separation );
+
+            bool independent = std::none_of( batch.begin(), batch.end(),
+                    [&reach]( const CONNECTION& aOther )
+                    {
+                        return reach.Intersects( aOther.m_window );
+                    } );
+
+            if( independent )
+                batch.push_back( conn );
+            else
+                later.push_back( conn );
+        }
+
+        std::vector<SEARCH_RESULT> results( batch.size() );
+
+        size_t threadCount = m_threadCount ? m_threadCount : std::thread::hardware_concurrency();
+        threadCount = std::max<size_t>( std::min( threadCount, batch.size() ), 1 );
+
+        std::atomic_size_t nextConn( 0 );
+        std::vector<std::thread> workers;
+
+        for( size_t ii = 0; ii < threadCount; ++ii )
+        {
+            workers.push_back( std::thread( [ this, &batch, &results, &nextConn ]()
+            {
+                for( size_t i = nextConn.fetch_add( 1 ); i < batch.size();
+                     i = nextConn.fetch_add( 1 ) )
+                {
+                    search( batch[i], batch[i].m_window, results[i] );
+                }
+            } ) );
+        }
+
+        for( std::thread& worker : workers )
+            worker.join();
+
+        for( size_t i = 0; i < batch.size(); i++ )
+        {
+            m_stats.m_peakMemory = std::max( m_stats.m_peakMemory, results[i].m_memory );
+
+            if( results[i].m_found )
+                commitPath( batch[i], results[i], aNewItems );
+            else
+                failed.push_back( batch[i] );
+        }
+
+        m_stats.m_batches++;
+        pending.swap( later );
+    }
+
+    // Retry the connections blocked in their window on the whole board, now that all
+    // the others are routed
+    for( const CONNECTION& conn : failed )
+    {
+        SEARCH_RESULT result;
+
+        search( conn, m_area, result );
+
+        m_stats.m_peakMemory = std::max( m_stats.m_peakMemory, result.m_memory );
+        m_stats.m_retries++;
+
+        if( result.m_found )
+            commitPath( conn, result, aNewItems );
+    }
+
+    return m_stats.m_routed == m_stats.m_connections;
+}
@@ -0,0 +1,199 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef AR_GRID_ROUTER_H
+#define AR_GRID_ROUTER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/shape_poly_set.h>
+#include <geometry/rtree.h>
+
+#include "ar_grid_matrix.h"
+
+class BOARD;
+class BOARD_ITEM;
+class BOARD_CONNECTED_ITEM;
+
+/**
+ * Class AR_GRID_ROUTER
+ * Grid based autorouter, routing the unconnected ratsnest edges of a board.
+ *
+ * Each connection is routed by an A* search on an AR_GRID_MATRIX covering only a window
+ * around the connection, whose obstacles are the items of the other nets.  Connections
+ * whose windows are far enough apart cannot interfere, so they are routed in parallel,
+ * in batches; the results are then committed in a fixed order, which makes the outcome
+ * independent of the number of threads.  Connections that cannot be routed in their
+ * window are retried afterwards on the whole board, one at a time.
+ *
+ * Routing uses the track width, via size and clearance of the net class of each net,
+ * and through vias.  The board is not modified: the new tracks and vias are returned
+ * to the caller.
+ */
+class AR_GRID_ROUTER
+{
+public:
+    struct STATS
+    {
+        int    m_connections;       ///< number of connections to route
+        int    m_routed;            ///< connections routed
+        int    m_vias;              ///< vias created
+        int    m_batches;           ///< number of parallel batches
+        int    m_retries;           ///< connections retried on the whole board
+        size_t m_peakMemory;        ///< largest working set of a single search, in bytes
+    };
+
+    AR_GRID_ROUTER( BOARD* aBoard );
+    ~AR_GRID_ROUTER();
+
+    /**
+     * Function SetGridPitch()
+     * Sets the routing grid pitch.  By default, the pitch is half the sum of the track
+     * width and clearance of the default net class.
+     */
+    void SetGridPitch( int aPitch )
+    {
+        m_pitch = aPitch;
+    }
+
+    /**
+     * Function SetThreadCount()
+     * Sets the number of routing threads (0, the default, uses all the cores).
+     */
+    void SetThreadCount( size_t aCount )
+    {
+        m_threadCount = aCount;
+    }
+
+    /**
+     * Function SetViaCost()
+     * Sets the cost of a via, as a length of track in grid steps.
+     */
+    void SetViaCost( int aCost )
+    {
+        m_viaCost = aCost;
+    }
+
+    /**
+     * Function Route()
+     * Routes all the unconnected edges of the board ratsnest.  The connectivity of the
+     * board has to be built beforehand.
+     * @param aNewItems receives the new tracks and vias, which are not added to the board
+     * @return true if all the connections have been routed
+     */
+    bool Route( std::vector<BOARD_CONNECTED_ITEM*>& aNewItems );
+
+    const STATS& Stats() const
+    {
+        return m_stats;
+    }
+
+private:
+    ///> An item the routed nets have to keep away from
+    struct OBSTACLE
+    {
+        SHAPE_POLY_SET m_trackHalo;     ///< area forbidden to track centers
+        SHAPE_POLY_SET m_viaHalo;       ///< area forbidden to via centers
+        BOX2I          m_bbox;
+        uint32_t       m_layers;        ///< grid layers blocked for tracks
+        bool           m_blocksVias;
+        int            m_net;           ///< net of the item, 0 for items of no net
+    };
+
+    ///> A ratsnest edge to route
+    struct CONNECTION
+    {
+        int      m_net;
+        VECTOR2I m_source;
+        VECTOR2I m_target;
+        uint32_t m_sourceLayers;
+        uint32_t m_targetLayers;
+        BOX2I    m_window;              ///< the part of the board the search is limited to
+    };
+
+    ///> A point of a routed path: a grid cell on a layer
+    struct PATH_POINT
+    {
+        int m_x;
+        int m_y;
+        int m_layer;
+    };
+
+    ///> The outcome of the search of one connection
+    struct SEARCH_RESULT
+    {
+        bool                    m_found;
+        std::vector<VECTOR2I>   m_points;
+        std::vector<int>        m_layers;
+        size_t                  m_memory;
+    };
+
+    void buildObstacles();
+    void addObstacle( const BOARD_CONNECTED_ITEM* aItem, uint32_t aLayers );
+    void insertObstacle( std::unique_ptr<OBSTACLE> aObstacle );
+    void buildConnections( std::vector<CONNECTION>& aConnections );
+
+    ///> Searches a path for aConn in its window
+    void search( const CONNECTION& aConn, const BOX2I& aWindow, SEARCH_RESULT& aResult ) const;
+
+    ///> The A* search proper, on a matrix holding the obstacles of the window
+    bool findPath( const AR_GRID_MATRIX& aMatrix, const CONNECTION& aConn,
+                   std::vector<PATH_POINT>& aPath, size_t& aMemory ) const;
+
+    ///> Creates the tracks and vias of a path, and adds them to the obstacles
+    void commitPath( const CONNECTION& aConn, const SEARCH_RESULT& aResult,
+                     std::vector<BOARD_CONNECTED_ITEM*>& aNewItems );
+
+    ///> Aligns aBox on the routing grid, and clips it to the board area
+    BOX2I snapToGrid( const BOX2I& aBox ) const;
+
+    uint32_t gridLayers( LSET aLayers ) const;
+    PCB_LAYER_ID boardLayer( int aGridLayer ) const;
+
+    BOARD*                      m_board;
+    int                         m_layerCount;
+    int                         m_pitch;
+    int                         m_viaCost;
+    size_t                      m_threadCount;
+
+    ///> halos of the obstacles: largest clearance plus half track width or via diameter
+    int                         m_trackHalo;
+    int                         m_viaHalo;
+
+    BOX2I                       m_area;             ///< routing area, aligned on the grid
+    SHAPE_POLY_SET              m_trackArea;        ///< allowed area for track centers
+    SHAPE_POLY_SET              m_viaArea;          ///< allowed area for via centers
+
+    std::vector<std::unique_ptr<OBSTACLE>> m_obstacles;
+
+    ///> obstacle index by bounding box.  RTree::Search() is not declared const, but it
+    ///> only reads the tree, so the searches can run concurrently.
+    std::unique_ptr<RTree<int, int, 2, double>> m_obstacleIndex;
+
+    STATS                       m_stats;
+};
+
+#endif  // AR_GRID_ROUTER_H
@@ -107,6 +107,12 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry )
             }
         }
 
+        // The zones around both the old and the new state of the item may need a refill
+        board->MarkZonesForRefill( boardItem );
+
+        if( changeType == CHT_MODIFY && ent.m_copy )
+            board->MarkZonesForRefill( static_cast<BOARD_ITEM*>( ent.m_copy ) );
+
         switch( changeType )
         {
             case CHT_ADD:
@@ -278,10 +284,21 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry )
     if ( !m_editModules )
     {
         auto panel = static_cast<PCB_DRAW_PANEL_GAL*>( frame->GetGalCanvas() );
-        connectivity->RecalculateRatsnest();
+
+        // With the GAL canvas, big nets are not allowed to stall the editor: the nets
+        // not updated in time are finished by PCB_EDITOR_CONTROL, on the model change event
+        int timeBudget = 0;
+
+        if( frame->IsGalCanvasActive() )
+            timeBudget = CONNECTIVITY_DATA::RATSNEST_UPDATE_BUDGET;
+
+        connectivity->RecalculateRatsnest( timeBudget );
         panel->RedrawRatsnest();
     }
 
+    // The zones around the changed items have been flagged above
+    board->SetZoneRefillTracked();
+
     frame->OnModify();
     frame->UpdateMsgPanel();
 
@@ -79,6 +79,7 @@ BOARD::BOARD() :
 {
     // we have not loaded a board yet, assume latest until then.
     m_fileFormatVersionAtLoad = LEGACY_BOARD_FILE_VERSION;
+    m_zoneRefillTracked = false;
 
     m_colorsSettings = &dummyColorsSettings;
     m_Status_Pcb    = 0;                    // Status word: bit 1 = calculate.
@@ -1535,6 +1536,59 @@ int BOARD::SetAreasNetCodesFromNetNames()
 }
 
 
+void BOARD::MarkZonesForRefill( const BOARD_ITEM* aItem )
+{
+    if( aItem->Type() == PCB_MARKER_T || aItem->Type() == PCB_NETINFO_T )
+        return;
+
+    LSET layers = aItem->GetLayerSet();
+
+    // Board outlines are knockouts for all the zones, and footprints can have items
+    // on any layer
+    if( aItem->Type() == PCB_MODULE_T || layers.test( Edge_Cuts ) )
+        layers = LSET::AllCuMask();
+
+    layers &= LSET::AllCuMask();
+
+    if( layers.none() )
+        return;
+
+    const EDA_RECT itemBox = aItem->GetBoundingBox();
+    int biggest_clearance = GetDesignSettings().GetBiggestClearanceValue();
+
+    for( ZONE_CONTAINER* zone : m_ZoneDescriptorList )
+    {
+        if( zone == aItem )
+        {
+            zone->SetNeedRefill( true );
+            continue;
+        }
+
+        if( !( zone->GetLayerSet() & layers ).any() )
+            continue;
+
+        EDA_RECT zoneBox = zone->GetBoundingBox();
+        zoneBox.Inflate( std::max( biggest_clearance, zone->GetZoneClearance() )
+                         + zone->GetMinThickness() );
+
+        if( zoneBox.Intersects( itemBox ) )
+            zone->SetNeedRefill( true );
+    }
+}
+
+
+void BOARD::MarkUntrackedZonesForRefill()
+{
+    if( !m_zoneRefillTracked )
+    {
+        for( ZONE_CONTAINER* zone : m_ZoneDescriptorList )
+            zone->SetNeedRefill( true );
+    }
+
+    m_zoneRefillTracked = false;
+}
+
+
 VIA* BOARD::GetViaByPosition( const wxPoint& aPosition, PCB_LAYER_ID aLayer) const
 {
     for( VIA *via = GetFirstVia( m_Track); via; via = GetFirstVia( via->Next() ) )
@@ -188,6 +188,9 @@ private:
 
     int                     m_fileFormatVersionAtLoad;  ///< the version loaded from the file
 
+    /// True when the current change has flagged the zones it can affect for refill
+    bool                    m_zoneRefillTracked;
+
     std::shared_ptr<CONNECTIVITY_DATA>      m_connectivity;
 
     BOARD_DESIGN_SETTINGS   m_designSettings;
@@ -973,6 +976,31 @@ public:
      */
     int SetAreasNetCodesFromNetNames( void );
 
+    /**
+     * Function MarkZonesForRefill
+     * Flags the zones whose filled areas can be changed by aItem (zones sharing a copper
+     * layer with the item, closer than the clearance) as needing a refill.
+     * Must be called for both the old and the new state of a changed item.
+     * @param aItem is the added, removed or changed item
+     */
+    void MarkZonesForRefill( const BOARD_ITEM* aItem );
+
+    /**
+     * Function SetZoneRefillTracked
+     * Tells that the current change of the board has flagged the zones it can affect with
+     * MarkZonesForRefill(), as BOARD_COMMIT and undo/redo do.
+     * Must be called right before the frame is notified of the change.
+     */
+    void SetZoneRefillTracked() { m_zoneRefillTracked = true; }
+
+    /**
+     * Function MarkUntrackedZonesForRefill
+     * Called after each change of the board.  Unless the change was tracked (see
+     * SetZoneRefillTracked()), flags all the zones as needing a refill: the legacy tools
+     * edit the items directly, so their changes can affect any zone.
+     */
+    void MarkUntrackedZonesForRefill();
+
     /**
      * Function GetArea
      * returns the Area (Zone Container) at a given index.
@@ -87,84 +87,70 @@ wxString BOARD_ITEM::GetLayerName() const
 }
 
 
-std::string BOARD_ITEM::FormatInternalUnits( int aValue )
+///> Number of decimals needed to write a value in internal units as millimeters.
+static constexpr int iuDecimals( double aIuPerMm )
 {
-#if 1
+    return aIuPerMm > 1.0 ? 1 + iuDecimals( aIuPerMm / 10.0 ) : 0;
+}
 
-    char    buf[50];
-    int     len;
-    double  mm = aValue / IU_PER_MM;
 
-    if( mm != 0.0 && fabs( mm ) <= 0.0001 )
-    {
-        len = sprintf( buf, "%.10f", mm );
+int BOARD_ITEM::FormatInternalUnits( int aValue, char* aBuffer )
+{
+    // Internal units are an integer number of nanometers (or of 10 nanometers), so the
+    // value in millimeters is written by inserting the decimal point in the integer digits,
+    // and dropping the trailing zeros.  This gives the same text as "%.10g" (or "%.10f"
+    // for the small values "%g" would write with an exponent), without going through
+    // printf() and a double.
+    const int decimals = iuDecimals( IU_PER_MM );
 
-        while( --len > 0 && buf[len] == '0' )
-            buf[len] = '\0';
+    static_assert( iuDecimals( IU_PER_MM ) < 10, "internal units are too small" );
 
-        if( buf[len] == '.' )
-            buf[len] = '\0';
-        else
-            ++len;
-    }
-    else
+    char        digits[24];     // the digits, least significant first
+    int         count = 0;
+    char*       out = aBuffer;
+    unsigned    value = aValue < 0 ? 0U - (unsigned) aValue : (unsigned) aValue;
+
+    do
     {
-        len = sprintf( buf, "%.10g", mm );
-    }
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while( value );
 
-    return std::string( buf, len );
+    // at least one digit before the decimal point
+    while( count <= decimals )
+        digits[count++] = '0';
+
+    if( aValue < 0 )
+        *out++ = '-';
 
-#else
+    for( int ii = count - 1; ii >= decimals; --ii )
+        *out++ = digits[ii];
 
-    // Assume aValue is in nanometers, and that we want the result in millimeters,
-    // and that int is 32 bits wide.  Then perform an alternative algorithm.
-    // Can be used to verify that the above algorithm is correctly generating text.
-    // Convert aValue into an integer string, then insert a decimal point manually.
-    // Results are the same as above general purpose algorithm.
+    int last = 0;       // least significant decimal to write
 
-    wxASSERT( sizeof(int) == 4 );
+    while( last < decimals && digits[last] == '0' )
+        ++last;
 
-    if( aValue == 0 )
-        return std::string( 1, '0' );
-    else
+    if( last < decimals )
     {
-        char    buf[50];
-        int     len = sprintf( buf, aValue > 0 ? "%06d" : "%07d", aValue );     // optionally pad w/leading zeros
+        *out++ = '.';
 
-        std::string ret( buf, len );
+        for( int ii = decimals - 1; ii >= last; --ii )
+            *out++ = digits[ii];
+    }
 
-        std::string::iterator it = ret.end() - 1;           // last byte
+    *out = '\0';
 
-        // insert '.' at 6 positions from end, dividing by 10e6 (a million), nm => mm
-        std::string::iterator decpoint = ret.end() - 6;
+    return out - aBuffer;
+}
 
-        // truncate trailing zeros, up to decimal point position
-        for(  ; *it=='0' && it >= decpoint;  --it )
-            ret.erase( it );    // does not invalidate iterators it or decpoint
 
-        if( it >= decpoint )
-        {
-            ret.insert( decpoint, '.' );
-
-            // decpoint is invalidated here, after insert()
-
-#if 1       // want a leading zero when decimal point is in first position?
-            if( ret[0] == '.' )
-            {
-                // insert leading zero ahead of decimal point.
-                ret.insert( ret.begin(), '0' );
-            }
-            else if( ret[0]=='-' && ret[1]=='.' )
-            {
-                ret.insert( ret.begin() + 1, '0' );
-            }
-#endif
-        }
-
-        return ret;
-    }
+std::string BOARD_ITEM::FormatInternalUnits( int aValue )
+{
+    char buf[FMT_IU_BUFFER_SIZE];
+    int  len = FormatInternalUnits( aValue, buf );
 
-#endif
+    return std::string( buf, len );
 }
 
 
@@ -178,21 +164,34 @@ std::string BOARD_ITEM::FormatAngle( double aAngle )
 }
 
 
+///> Formats a pair of values in internal units, separated by a space
+static std::string formatPair( int aX, int aY )
+{
+    char buf[2 * BOARD_ITEM::FMT_IU_BUFFER_SIZE];
+    int  len = BOARD_ITEM::FormatInternalUnits( aX, buf );
+
+    buf[len++] = ' ';
+    len += BOARD_ITEM::FormatInternalUnits( aY, buf + len );
+
+    return std::string( buf, len );
+}
+
+
 std::string BOARD_ITEM::FormatInternalUnits( const wxPoint& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    return formatPair( aPoint.x, aPoint.y );
 }
 
 
 std::string BOARD_ITEM::FormatInternalUnits( const VECTOR2I& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    return formatPair( aPoint.x, aPoint.y );
 }
 
 
 std::string BOARD_ITEM::FormatInternalUnits( const wxSize& aSize )
 {
-    return FormatInternalUnits( aSize.GetWidth() ) + " " + FormatInternalUnits( aSize.GetHeight() );
+    return formatPair( aSize.GetWidth(), aSize.GetHeight() );
 }
 
 
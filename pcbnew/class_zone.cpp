@@ -54,6 +54,7 @@ ZONE_CONTAINER::ZONE_CONTAINER( BOARD* aBoard ) :
 {
     m_CornerSelection = nullptr;                // no corner is selected
     m_IsFilled = false;                         // fill status : true when the zone is filled
+    m_needRefill = true;                        // the fill (if any) is not known to be up to date
     m_FillMode = ZFM_POLYGONS;
     m_priority = 0;
     m_cornerSmoothingType = ZONE_SETTINGS::SMOOTHING_NONE;
@@ -64,6 +65,7 @@ ZONE_CONTAINER::ZONE_CONTAINER( BOARD* aBoard ) :
     m_cornerRadius = 0;
     SetLocalFlags( 0 );                         // flags tempoarry used in zone calculations
     m_Poly = new SHAPE_POLY_SET();              // Outlines
+    m_FilledPolysList.EnableEdgeIndex();        // built by the first hit test of the fill
     aBoard->GetZoneSettings().ExportSetting( *this );
 }
 
@@ -74,10 +76,12 @@ ZONE_CONTAINER::ZONE_CONTAINER( const ZONE_CONTAINER& aZone ) :
     // Should the copy be on the same net?
     SetNetCode( aZone.GetNetCode() );
     m_Poly = new SHAPE_POLY_SET( *aZone.m_Poly );
+    m_FilledPolysList.EnableEdgeIndex();
 
     // For corner moving, corner index to drag, or nullptr if no selection
     m_CornerSelection = nullptr;
     m_IsFilled = aZone.m_IsFilled;
+    m_needRefill = aZone.m_needRefill;
     m_ZoneClearance = aZone.m_ZoneClearance;     // clearance value
     m_ZoneMinThickness = aZone.m_ZoneMinThickness;
     m_FillMode = aZone.m_FillMode;               // Filling mode (segments/polygons)
@@ -938,6 +942,8 @@ void ZONE_CONTAINER::Rotate( const wxPoint& centre, double angle )
     for( auto ic = m_FilledPolysList.Iterate(); ic; ++ic )
         RotatePoint( &ic->x, &ic->y, centre.x, centre.y, angle );
 
+    m_FilledPolysList.DropEdgeIndex();
+
     for( unsigned ic = 0; ic < m_FillSegmList.size(); ic++ )
     {
         wxPoint a ( m_FillSegmList[ic].A );
@@ -982,6 +988,8 @@ void ZONE_CONTAINER::Mirror( const wxPoint& mirror_ref )
         ic->y = py + mirror_ref.y;
     }
 
+    m_FilledPolysList.DropEdgeIndex();
+
     for( unsigned ic = 0; ic < m_FillSegmList.size(); ic++ )
     {
         MIRROR( m_FillSegmList[ic].A.y, mirror_ref.y );
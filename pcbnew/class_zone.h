@@ -189,6 +189,9 @@ public:
     bool IsFilled() const { return m_IsFilled; }
     void SetIsFilled( bool isFilled ) { m_IsFilled = isFilled; }
 
+    bool NeedRefill() const { return m_needRefill; }
+    void SetNeedRefill( bool aNeedRefill ) { m_needRefill = aNeedRefill; }
+
     int GetZoneClearance() const { return m_ZoneClearance; }
     void SetZoneClearance( int aZoneClearance ) { m_ZoneClearance = aZoneClearance; }
 
@@ -538,6 +541,18 @@ public:
 
     void CacheTriangulation();
 
+    /**
+     * Function SetFillTriangulation
+     * sets the triangulation of the filled polygons to one computed earlier.
+     * @see SHAPE_POLY_SET::SetTriangulation()
+     * @return bool - true if the triangulation matches the filled polygons, and was used.
+     */
+    bool SetFillTriangulation( SHAPE_POLY_SET::TRIANGULATION& aTriangulation,
+                               const MD5_HASH& aHash )
+    {
+        return m_FilledPolysList.SetTriangulation( aTriangulation, aHash );
+    }
+
    /**
      * Function SetFilledPolysList
      * sets the list of filled polygons.
@@ -704,6 +719,11 @@ private:
     /** True when a zone was filled, false after deleting the filled areas. */
     bool                  m_IsFilled;
 
+    /** False when the filled areas are known to match the items around the zone.
+        Set when items overlapping the zone are changed by a commit or an undo, and
+        by any other change of the board, which is not known to leave the zone alone. */
+    bool                  m_needRefill;
+
     ///< Width of the gap in thermal reliefs.
     int                   m_ThermalReliefGap;
 
@@ -549,9 +549,11 @@ void CN_CONNECTIVITY_ALGO::searchConnections( bool aIncludeZones )
                 if( zoneItem->Dirty() || m_padList.IsDirty() || m_trackList.IsDirty() || m_viaList.IsDirty() )
                 {
                     totalDirtyCount++;
-                    m_viaList.FindNearby( zoneItem->BBox(), searchZones );
-                    m_trackList.FindNearby( zoneItem->BBox(), searchZones );
-                    m_padList.FindNearby( zoneItem->BBox(), searchZones );
+                    LSET zoneLayers = zoneItem->Parent()->GetLayerSet();
+
+                    m_viaList.FindNearby( zoneItem->BBox(), searchZones, false, zoneLayers );
+                    m_trackList.FindNearby( zoneItem->BBox(), searchZones, false, zoneLayers );
+                    m_padList.FindNearby( zoneItem->BBox(), searchZones, false, zoneLayers );
                     m_zoneList.FindNearbyZones( zoneItem->BBox(), std::bind( checkInterZoneConnection, _1, zoneItem ) );
                 }
 
@@ -596,12 +598,32 @@ void CN_ITEM::RemoveInvalidRefs()
 
 void CN_LIST::RemoveInvalidItems( std::vector<CN_ITEM*>& aGarbage )
 {
-    auto lastAnchor = std::remove_if(m_anchors.begin(), m_anchors.end(),
-        [] ( const CN_ANCHOR_PTR anchor ) {
-            return !anchor->Valid();
+    // Keep the removed anchors at the end of the list, to remove them from the index
+    auto lastAnchor = std::stable_partition( m_anchors.begin(), m_anchors.end(),
+        [] ( const CN_ANCHOR_PTR& anchor ) {
+            return anchor->Valid();
         } );
 
-    m_anchors.resize( lastAnchor - m_anchors.begin() );
+    size_t removedCount = m_anchors.end() - lastAnchor;
+
+    // Removing items one by one from the index is only worth it for small changes
+    // (e.g. a moved track), rebuild it when a large part of the anchors is gone
+    // (e.g. refilled zones)
+    if( removedCount > m_anchors.size() / 4 )
+    {
+        m_anchors.resize( lastAnchor - m_anchors.begin() );
+        m_index.RemoveAll();
+
+        for( const auto& anchor : m_anchors )
+            m_index.Insert( anchor, anchor->Pos(), anchor->Item()->Parent()->GetLayerSet() );
+    }
+    else
+    {
+        for( auto it = lastAnchor; it != m_anchors.end(); ++it )
+            m_index.Remove( *it, (*it)->Pos() );
+
+        m_anchors.resize( lastAnchor - m_anchors.begin() );
+    }
 
     auto lastItem = std::remove_if(m_items.begin(), m_items.end(), [&aGarbage] ( CN_ITEM* item ) {
         if( !item->Valid() )
@@ -44,6 +44,7 @@
 #include <intrusive_list.h>
 
 #include <connectivity_data.h>
+#include <connectivity_rtree.h>
 
 class CN_ITEM;
 class CN_CONNECTIVITY_ALGO_IMPL;
@@ -409,25 +410,39 @@ private:
     bool m_dirty;
     std::vector<CN_ANCHOR_PTR> m_anchors;
 
+    ///> Spatial index of m_anchors, updated when anchors are added or removed
+    CN_RTREE<CN_ANCHOR_PTR> m_index;
+
 protected:
     std::vector<CN_ITEM*> m_items;
 
     void addAnchor( VECTOR2I pos, CN_ITEM* item )
     {
         m_anchors.push_back( item->AddAnchor( pos ) );
+        m_index.Insert( m_anchors.back(), pos, item->Parent()->GetLayerSet() );
     }
 
 private:
 
-    void sort()
+    ///> Visitor calling aFunc for the valid anchors found in the index
+    template <class T>
+    struct ANCHOR_VISITOR
     {
-        if( m_dirty )
+        ANCHOR_VISITOR( T& aFunc, bool aDirtyOnly ) :
+            m_func( aFunc ), m_dirtyOnly( aDirtyOnly )
+        {}
+
+        bool operator()( const CN_ANCHOR_PTR& aAnchor )
         {
-            std::sort( m_anchors.begin(), m_anchors.end() );
+            if( aAnchor->Valid() && ( !m_dirtyOnly || aAnchor->IsDirty() ) )
+                m_func( aAnchor );
 
-            m_dirty = false;
+            return true;
         }
-    }
+
+        T&   m_func;
+        bool m_dirtyOnly;
+    };
 
 public:
     CN_LIST()
@@ -441,6 +456,8 @@ public:
             delete item;
 
         m_items.clear();
+        m_anchors.clear();
+        m_index.RemoveAll();
     }
 
     using ITER = decltype(m_items)::iterator;
@@ -452,11 +469,21 @@ public:
 
     std::vector<CN_ANCHOR_PTR>& Anchors() { return m_anchors; }
 
+    /**
+     * Calls aFunc for each valid anchor closer than aDistMax (rectilinear distance)
+     * to aPosition.
+     */
     template <class T>
     void FindNearby( VECTOR2I aPosition, int aDistMax, T aFunc, bool aDirtyOnly = false );
 
+    /**
+     * Calls aFunc for each valid anchor inside aBBox.  When aLayers is given, the anchors
+     * of items not sharing a copper layer with aLayers may be skipped (the exact layer
+     * test is still up to aFunc).
+     */
     template <class T>
-    void FindNearby( BOX2I aBBox, T aFunc, bool aDirtyOnly = false );
+    void FindNearby( BOX2I aBBox, T aFunc, bool aDirtyOnly = false,
+                     LSET aLayers = LSET::AllLayersMask() );
 
     void SetDirty( bool aDirty = true )
     {
@@ -628,16 +655,12 @@ public:
 
 
 template <class T>
-void CN_LIST::FindNearby( BOX2I aBBox, T aFunc, bool aDirtyOnly )
+void CN_LIST::FindNearby( BOX2I aBBox, T aFunc, bool aDirtyOnly, LSET aLayers )
 {
-    for( auto p : m_anchors )
-    {
-        if( p->Valid() && aBBox.Contains( p->Pos() ) )
-        {
-            if( !aDirtyOnly || p->IsDirty() )
-                aFunc( p );
-        }
-    }
+    ANCHOR_VISITOR<T> visitor( aFunc, aDirtyOnly );
+
+    aBBox.Normalize();
+    m_index.Query( aBBox, aLayers, visitor );
 }
 
 
@@ -662,99 +685,11 @@ void CN_ZONE_LIST::FindNearbyZones( BOX2I aBBox, T aFunc, bool aDirtyOnly )
 template <class T>
 void CN_LIST::FindNearby( VECTOR2I aPosition, int aDistMax, T aFunc, bool aDirtyOnly )
 {
-    /* Search items in m_Candidates that position is <= aDistMax from aPosition
-     * (Rectilinear distance)
-     * m_Candidates is sorted by X then Y values, so a fast binary search is used
-     * to locate the "best" entry point in list
-     * The best entry is a pad having its m_Pos.x == (or near) aPosition.x
-     * All candidates are near this candidate in list
-     * So from this entry point, a linear search is made to find all candidates
-     */
-
-    sort();
-
-    int idxmax = m_anchors.size() - 1;
-
-    int delta = idxmax + 1;
-    int idx = 0;        // Starting index is the beginning of list
+    ANCHOR_VISITOR<T> visitor( aFunc, aDirtyOnly );
+    BOX2I bbox( aPosition - VECTOR2I( aDistMax, aDistMax ),
+                VECTOR2I( 2 * aDistMax, 2 * aDistMax ) );
 
-    while( delta )
-    {
-        // Calculate half size of remaining interval to test.
-        // Ensure the computed value is not truncated (too small)
-        if( ( delta & 1 ) && ( delta > 1 ) )
-            delta++;
-
-        delta /= 2;
-
-        auto p = m_anchors[idx];
-
-        int dist = p->Pos().x - aPosition.x;
-
-        if( std::abs( dist ) <= aDistMax )
-        {
-            break;                              // A good entry point is found. The list can be scanned from this point.
-        }
-        else if( p->Pos().x < aPosition.x )     // We should search after this point
-        {
-            idx += delta;
-
-            if( idx > idxmax )
-                idx = idxmax;
-        }
-        else    // We should search before this p
-        {
-            idx -= delta;
-
-            if( idx < 0 )
-                idx = 0;
-        }
-    }
-
-    /* Now explore the candidate list from the "best" entry point found
-     * (candidate "near" aPosition.x)
-     * We exp the list until abs(candidate->m_Point.x - aPosition.x) > aDistMashar* Currently a linear search is made because the number of candidates
-     * having the right X position is usually small
-     */
-    // search next candidates in list
-    VECTOR2I diff;
-
-    for( int ii = idx; ii <= idxmax; ii++ )
-    {
-        auto& p = m_anchors[ii];
-        diff = p->Pos() - aPosition;;
-
-        if( std::abs( diff.x ) > aDistMax )
-            break; // Exit: the distance is to long, we cannot find other candidates
-
-        if( std::abs( diff.y ) > aDistMax )
-            continue; // the y distance is to long, but we can find other candidates
-
-        // We have here a good candidate: add it
-        if( p->Valid() )
-            if( !aDirtyOnly || p->IsDirty() )
-                aFunc( p );
-    }
-
-    // search previous candidates in list
-    for( int ii = idx - 1; ii >=0; ii-- )
-    {
-        auto& p = m_anchors[ii];
-        diff = p->Pos() - aPosition;
-
-        if( abs( diff.x ) > aDistMax )
-            break;
-
-        if( abs( diff.y ) > aDistMax )
-            continue;
-
-        // We have here a good candidate:add it
-        if( p->Valid() )
-        {
-            if( !aDirtyOnly || p->IsDirty() )
-                aFunc( p );
-        }
-    }
+    m_index.Query( bbox, LSET::AllLayersMask(), visitor );
 }
 
 
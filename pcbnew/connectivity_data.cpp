@@ -29,9 +29,10 @@
 #include <connectivity_algo.h>
 #include <ratsnest_data.h>
 
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif /* USE_OPENMP */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 CONNECTIVITY_DATA::CONNECTIVITY_DATA()
 {
@@ -85,40 +86,82 @@ void CONNECTIVITY_DATA::Build( const std::vector<BOARD_ITEM*>& aItems )
 }
 
 
-void CONNECTIVITY_DATA::updateRatsnest()
+bool CONNECTIVITY_DATA::updateRatsnest( int aTimeBudget )
 {
-    int lastNet = m_connAlgo->NetCount();
+    int lastNet = std::min<int>( m_connAlgo->NetCount(), m_nets.size() );
 
     #ifdef PROFILE
     PROF_COUNTER rnUpdate( "update-ratsnest" );
     #endif
 
-    int nDirty = 0;
-
-    int i;
+    std::vector<RN_NET*> dirty_nets;
 
-    #ifdef USE_OPENMP
-        #pragma omp parallel shared(lastNet) private(i)
+    // Start with net number 1, as 0 stands for not connected
+    for( int i = 1; i < lastNet; ++i )
     {
-        #pragma omp for schedule(guided, 1)
-    #else /* USE_OPENMP */
-    {
-    #endif
+        if( m_nets[i]->IsDirty() )
+            dirty_nets.push_back( m_nets[i] );
+    }
+
+    // Start with the biggest nets, so the threads finish at about the same time
+    std::sort( dirty_nets.begin(), dirty_nets.end(), [] ( const RN_NET* a, const RN_NET* b ) {
+        return a->GetNodeCount() > b->GetNodeCount();
+    } );
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( aTimeBudget );
+    std::atomic<size_t> nextNet( 0 );
 
-        // Start with net number 1, as 0 stands for not connected
-        for( i = 1; i < lastNet; ++i )
+    // Nets are not split between threads: a net that has been started is always finished,
+    // the time budget only stops the threads from starting new ones
+    auto update_lambda = [&] ()
+    {
+        for( size_t i = nextNet++; i < dirty_nets.size(); i = nextNet++ )
         {
-            if( m_nets[i]->IsDirty() )
-            {
-                m_nets[i]->Update();
-                nDirty++;
-            }
+            if( aTimeBudget > 0 && std::chrono::steady_clock::now() > deadline )
+                break;
+
+            dirty_nets[i]->Update();
         }
-    }          /* end of parallel section */
+    };
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   dirty_nets.size() );
+    std::vector<std::thread> threads;
+
+    for( size_t ii = 1; ii < parallelThreadCount; ++ii )
+        threads.push_back( std::thread( update_lambda ) );
+
+    update_lambda();
+
+    for( auto& thread : threads )
+        thread.join();
 
     #ifdef PROFILE
     rnUpdate.Show();
     #endif /* PROFILE */
+
+    return std::none_of( dirty_nets.begin(), dirty_nets.end(),
+                         [] ( const RN_NET* net ) { return net->IsDirty(); } );
+}
+
+
+bool CONNECTIVITY_DATA::UpdatePendingRatsnest( int aTimeBudget )
+{
+    return updateRatsnest( aTimeBudget );
+}
+
+
+bool CONNECTIVITY_DATA::HasPendingRatsnest() const
+{
+    int lastNet = std::min<int>( m_connAlgo->NetCount(), m_nets.size() );
+
+    for( int i = 1; i < lastNet; ++i )
+    {
+        if( m_nets[i]->IsDirty() )
+            return true;
+    }
+
+    return false;
 }
 
 
@@ -130,7 +173,7 @@ void CONNECTIVITY_DATA::addRatsnestCluster( const std::shared_ptr<CN_CLUSTER>& a
 }
 
 
-void CONNECTIVITY_DATA::RecalculateRatsnest()
+void CONNECTIVITY_DATA::RecalculateRatsnest( int aTimeBudget )
 {
     m_connAlgo->PropagateNets();
 
@@ -170,7 +213,7 @@ void CONNECTIVITY_DATA::RecalculateRatsnest()
 
     m_connAlgo->ClearDirtyFlags();
 
-    updateRatsnest();
+    updateRatsnest( aTimeBudget );
 }
 
 
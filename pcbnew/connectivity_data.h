@@ -146,11 +146,33 @@ public:
     void FindIsolatedCopperIslands( ZONE_CONTAINER* aZone, std::vector<int>& aIslands );
     void FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLATED_ISLAND_LIST>& aZones );
 
+    ///> Time (in milliseconds) spent on updating the ratsnest after an interactive change,
+    ///> before the remaining nets are left pending
+    static const int RATSNEST_UPDATE_BUDGET = 20;
+
     /**
      * Function RecalculateRatsnest()
      * Updates the ratsnest for the board.
+     * @param aTimeBudget is the time (in milliseconds) after which no more nets are updated,
+     * or 0 to update all nets.  Nets not updated in time are left pending, see
+     * UpdatePendingRatsnest().
+     */
+    void RecalculateRatsnest( int aTimeBudget = 0 );
+
+    /**
+     * Function UpdatePendingRatsnest()
+     * Updates the ratsnest of the nets left pending by a time limited RecalculateRatsnest().
+     * @param aTimeBudget is the time (in milliseconds) after which no more nets are updated,
+     * or 0 to update all nets.
+     * @return true if the ratsnest of all nets is up to date.
+     */
+    bool UpdatePendingRatsnest( int aTimeBudget = 0 );
+
+    /**
+     * Function HasPendingRatsnest()
+     * Returns true if the ratsnest of some nets still has to be updated.
      */
-    void RecalculateRatsnest();
+    bool HasPendingRatsnest() const;
 
     /**
      * Function GetUnconnectedCount()
@@ -229,7 +251,7 @@ public:
 
 private:
 
-    void    updateRatsnest();
+    bool    updateRatsnest( int aTimeBudget = 0 );
     void    addRatsnestCluster( const std::shared_ptr<CN_CLUSTER>& aCluster );
 
     std::unique_ptr<CONNECTIVITY_DATA> m_dynamicConnectivity;
@@ -0,0 +1,166 @@
+/*
+ * This program source code file is part of KICAD, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __CONNECTIVITY_RTREE_H
+#define __CONNECTIVITY_RTREE_H
+
+#include <math/box2.h>
+#include <math/vector2d.h>
+#include <layers_id_colors_and_visibility.h>
+
+#include <geometry/rtree.h>
+
+/**
+ * Class CN_RTREE -
+ * Implements an R-tree for fast spatial and layer indexing of connectivity items.
+ * The third dimension of the tree is the copper layer range spanned by the item, so
+ * a through-hole item is stored only once, and a search on an inner layer does not
+ * visit the items of the other layers.
+ *
+ * The layer range is a superset of the real layers: the results have to be checked
+ * against the exact layer sets.  Searches do not modify the tree and can be run
+ * concurrently.
+ * Non-owning.
+ */
+template< class T >
+class CN_RTREE
+{
+public:
+    CN_RTREE()
+    {
+        m_tree = new RTree<T, int, 3, double>();
+    }
+
+    ~CN_RTREE()
+    {
+        delete m_tree;
+    }
+
+    /**
+     * Function Insert()
+     * Inserts an item into the tree, at a given position and on a given layer set.
+     */
+    void Insert( const T& aItem, const VECTOR2I& aPos, LSET aLayers )
+    {
+        int layerMin, layerMax;
+        itemLayerRange( aLayers, layerMin, layerMax );
+
+        const int mmin[3] = { aPos.x, aPos.y, layerMin };
+        const int mmax[3] = { aPos.x, aPos.y, layerMax };
+
+        m_tree->Insert( mmin, mmax, aItem );
+    }
+
+    /**
+     * Function Remove()
+     * Removes an item from the tree.  Removal is done by comparing items, so the item
+     * position is enough to find it: its layers (which may no longer be known, if the
+     * parent board item was deleted) are not needed.
+     */
+    void Remove( const T& aItem, const VECTOR2I& aPos )
+    {
+        const int mmin[3] = { aPos.x, aPos.y, 0 };
+        const int mmax[3] = { aPos.x, aPos.y, PCB_LAYER_ID_COUNT - 1 };
+
+        m_tree->Remove( mmin, mmax, aItem );
+    }
+
+    /**
+     * Function RemoveAll()
+     * Removes all items from the tree.
+     */
+    void RemoveAll()
+    {
+        m_tree->RemoveAll();
+    }
+
+    /**
+     * Function Query()
+     * Executes a function object aVisitor for each item whose position is inside aBounds
+     * and which may be on one of aLayers.
+     */
+    template <class Visitor>
+    void Query( const BOX2I& aBounds, LSET aLayers, Visitor& aVisitor )
+    {
+        int layerMin, layerMax;
+        queryLayerRange( aLayers, layerMin, layerMax );
+
+        const int mmin[3] = { aBounds.GetX(), aBounds.GetY(), layerMin };
+        const int mmax[3] = { aBounds.GetRight(), aBounds.GetBottom(), layerMax };
+
+        m_tree->Search( mmin, mmax, aVisitor );
+    }
+
+private:
+    CN_RTREE( const CN_RTREE& ) = delete;
+    CN_RTREE& operator=( const CN_RTREE& ) = delete;
+
+    ///> Range of copper layers spanned by aLayers.  Items without copper layers
+    ///> get the full range, so they can be found by any search.
+    static void itemLayerRange( LSET aLayers, int& aMin, int& aMax )
+    {
+        aMin = 0;
+        aMax = PCB_LAYER_ID_COUNT - 1;
+
+        copperRange( aLayers, aMin, aMax );
+    }
+
+    ///> Range of layers to search.  Items sharing only non copper layers are stored
+    ///> with their copper range, so such a search has to look at all layers.
+    static void queryLayerRange( LSET aLayers, int& aMin, int& aMax )
+    {
+        aMin = 0;
+        aMax = PCB_LAYER_ID_COUNT - 1;
+
+        if( ( aLayers & ~LSET::AllCuMask() ).any() )
+            return;
+
+        copperRange( aLayers, aMin, aMax );
+    }
+
+    ///> Sets aMin and aMax to the first and last copper layer of aLayers, and returns
+    ///> true, if aLayers has copper layers.  Otherwise leaves them untouched.
+    static bool copperRange( LSET aLayers, int& aMin, int& aMax )
+    {
+        bool found = false;
+
+        for( int layer = F_Cu; layer <= B_Cu; ++layer )
+        {
+            if( !aLayers[layer] )
+                continue;
+
+            if( !found )
+                aMin = layer;
+
+            aMax = layer;
+            found = true;
+        }
+
+        return found;
+    }
+
+    RTree<T, int, 3, double>* m_tree;
+};
+
+
+#endif
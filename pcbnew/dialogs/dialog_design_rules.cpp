@@ -40,6 +40,7 @@
 
 #include <pcbnew_id.h>
 #include <class_track.h>
+#include <class_zone.h>
 #include <macros.h>
 #include <html_messagebox.h>
 
@@ -715,6 +716,10 @@ bool DIALOG_DESIGN_RULES::TransferDataFromWindow()
     CopyDimensionsListsToBoard();
     m_BrdSettings->SetCurrentNetClass( NETCLASS::Default );
 
+    // Clearances may have changed: no zone fill can be considered up to date
+    for( auto zone : m_Pcb->Zones() )
+        zone->SetNeedRefill( true );
+
     //this event causes the routing tool to reload its design rules information
     TOOL_MANAGER* toolManager = m_Parent->GetToolManager();
     TOOL_EVENT event( TC_COMMAND, TA_MODEL_CHANGE, AS_ACTIVE );
@@ -29,14 +29,13 @@
 DIALOG_PNS_SETTINGS::DIALOG_PNS_SETTINGS( wxWindow* aParent, PNS::ROUTING_SETTINGS& aSettings ) :
     DIALOG_PNS_SETTINGS_BASE( aParent ), m_settings( aSettings )
 {
-    // "Figure out what's best" is not available yet
-    m_mode->Enable( PNS::RM_Smart, false );
-
     // Add tool tip to the mode radio box, one by option
     // (cannot be made with wxFormBuilder for each item )
     m_mode->SetItemToolTip( 0, _( "DRC violation: highlight obstacles" ) );
     m_mode->SetItemToolTip( 1, _( "DRC violation: shove tracks and vias" ) );
     m_mode->SetItemToolTip( 2, _( "DRC violation: walk around obstacles" ) );
+    m_mode->SetItemToolTip( 3, _( "DRC violation: walk around obstacles, or shove them "
+                                  "when the way around is much longer" ) );
 
     // Load widgets' values from settings
     m_mode->SetSelection( m_settings.Mode() );
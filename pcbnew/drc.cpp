@@ -52,9 +52,15 @@
 #include <pcbnew.h>
 #include <drc.h>
 
+#include <drc_rtree.h>
+
 #include <dialog_drc.h>
 #include <wx/progdlg.h>
 #include <board_commit.h>
+#include <zone_filler.h>
+
+#include <atomic>
+#include <thread>
 
 void DRC::ShowDRCDialog( wxWindow* aParent )
 {
@@ -93,8 +99,28 @@ void DRC::ShowDRCDialog( wxWindow* aParent )
 
 void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
 {
+    addMarkersToPcb( { aMarker } );
+}
+
+
+void DRC::addMarkersToPcb( const std::vector<MARKER_PCB*>& aMarkers )
+{
+    if( aMarkers.empty() )
+        return;
+
+    if( !m_pcbEditorFrame )
+    {
+        for( MARKER_PCB* marker : aMarkers )
+            m_pcb->Add( marker );
+
+        return;
+    }
+
     BOARD_COMMIT commit( m_pcbEditorFrame );
-    commit.Add( aMarker );
+
+    for( MARKER_PCB* marker : aMarkers )
+        commit.Add( marker );
+
     commit.Push( wxEmptyString, false );
 }
 
@@ -115,10 +141,17 @@ void DRC::DestroyDRCDialog( int aReason )
 }
 
 
-DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
+DRC::DRC( PCB_EDIT_FRAME* aPcbWindow ) :
+    DRC( aPcbWindow->GetBoard() )
 {
     m_pcbEditorFrame = aPcbWindow;
-    m_pcb = aPcbWindow->GetBoard();
+}
+
+
+DRC::DRC( BOARD* aBoard )
+{
+    m_pcbEditorFrame = NULL;
+    m_pcb = aBoard;
     m_drcDialog  = NULL;
 
     // establish initial values for everything:
@@ -181,8 +214,8 @@ int DRC::Drc( TRACK* aRefSegm, TRACK* aList )
 
 int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
 {
-    BOARD* board = m_pcbEditorFrame->GetBoard();
-    BOARD_COMMIT commit( m_pcbEditorFrame );
+    BOARD* board = m_pcbEditorFrame ? m_pcbEditorFrame->GetBoard() : m_pcb;
+    std::vector<MARKER_PCB*> markers;
     int nerrors = 0;
 
     // iterate through all areas
@@ -253,7 +286,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                         wxString msg2 = zoneToTest->GetSelectMenuText();
                         MARKER_PCB* marker = new MARKER_PCB( COPPERAREA_INSIDE_COPPERAREA,
                                                              pt, msg1, pt, msg2, pt );
-                        commit.Add( marker );
+                        markers.push_back( marker );
                     }
 
                     nerrors++;
@@ -275,7 +308,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                         wxString msg2 = zoneRef->GetSelectMenuText();
                         MARKER_PCB* marker = new MARKER_PCB( COPPERAREA_INSIDE_COPPERAREA,
                                                               pt, msg1, pt, msg2, pt );
-                        commit.Add( marker );
+                        markers.push_back( marker );
                     }
 
                     nerrors++;
@@ -323,7 +356,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                             wxString msg2 = zoneToTest->GetSelectMenuText();
                             MARKER_PCB* marker = new MARKER_PCB( COPPERAREA_CLOSE_TO_COPPERAREA,
                                                                  pt, msg1, pt, msg2, pt );
-                            commit.Add( marker );
+                            markers.push_back( marker );
                         }
 
                         nerrors++;
@@ -334,7 +367,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
     }
 
     if( aCreateMarkers )
-        commit.Push( wxEmptyString, false );
+        addMarkersToPcb( markers );
 
     return nerrors;
 }
@@ -359,7 +392,8 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 {
     // be sure m_pcb is the current board, not a old one
     // ( the board can be reloaded )
-    m_pcb = m_pcbEditorFrame->GetBoard();
+    if( m_pcbEditorFrame )
+        m_pcb = m_pcbEditorFrame->GetBoard();
 
     // someone should have cleared the two lists before calling this.
 
@@ -397,7 +431,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testTracks( aMessages ? aMessages->GetParent() : m_pcbEditorFrame, true );
+    testTracks( aMessages ? aMessages->GetParent() : m_pcbEditorFrame, m_pcbEditorFrame != NULL );
 
     // Before testing segments and unconnected, refill all zones:
     // this is a good caution, because filled areas can be outdated.
@@ -412,8 +446,23 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 
     if( m_refillZones )
     {
-        aMessages->AppendText( _( "Refilling all zones...\n" ) );
-        m_pcbEditorFrame->Fill_All_Zones( caller );
+        if( aMessages )
+            aMessages->AppendText( _( "Refilling all zones...\n" ) );
+
+        if( m_pcbEditorFrame )
+        {
+            m_pcbEditorFrame->Fill_All_Zones( caller );
+        }
+        else
+        {
+            std::vector<ZONE_CONTAINER*> zones;
+
+            for( int ii = 0; ii < m_pcb->GetAreaCount(); ii++ )
+                zones.push_back( m_pcb->GetArea( ii ) );
+
+            ZONE_FILLER filler( m_pcb );
+            filler.Fill( zones );
+        }
     }
 
     // test zone clearances to other zones
@@ -494,7 +543,8 @@ void DRC::ListUnconnectedPads()
 void DRC::updatePointers()
 {
     // update my pointers, m_pcbEditorFrame is the only unchangeable one
-    m_pcb = m_pcbEditorFrame->GetBoard();
+    if( m_pcbEditorFrame )
+        m_pcb = m_pcbEditorFrame->GetBoard();
 
     if( m_drcDialog )  // Use diag list boxes only in DRC dialog
     {
@@ -661,17 +711,25 @@ void DRC::testPad2Pad()
 }
 
 
-void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
+void DRC::TestTracks( int aThreadCount )
+{
+    testTracks( NULL, false, aThreadCount );
+}
+
+
+void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar, int aThreadCount )
 {
     wxProgressDialog * progressDialog = NULL;
     const int delta = 500;  // This is the number of tests between 2 calls to the
                             // progress bar
-    int count = 0;
 
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
-        count++;
+    std::vector<TRACK*> tracks;
+    std::vector<D_PAD*> pads = m_pcb->GetPads();
+
+    for( TRACK* segm = m_pcb->m_Track; segm; segm = segm->Next() )
+        tracks.push_back( segm );
 
-    int deltamax = count/delta;
+    int deltamax = tracks.size() / delta;
 
     if( aShowProgressBar && deltamax > 3 )
     {
@@ -683,36 +741,121 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
         progressDialog->Update( 0, wxEmptyString );
     }
 
-    int ii = 0;
-    count = 0;
+    // Index the copper items once, so each segment is only compared to the items
+    // closer than the worst case clearance instead of the whole track list.
+    // Tracks and vias bounding boxes already include their own clearance.
+    DRC_RTREE trackIndex;
+    DRC_RTREE padIndex;
+    int       biggestClearance = m_pcb->GetDesignSettings().GetBiggestClearanceValue();
 
-    for( TRACK* segm = m_pcb->m_Track; segm; segm = segm->Next() )
+    for( unsigned ii = 0; ii < tracks.size(); ++ii )
+        trackIndex.Insert( ii, tracks[ii]->GetBoundingBox(), tracks[ii]->GetLayerSet() );
+
+    for( unsigned ii = 0; ii < pads.size(); ++ii )
+    {
+        D_PAD*   pad = pads[ii];
+        EDA_RECT bbox = pad->GetBoundingBox();
+        LSET     layers = pad->GetLayerSet();
+
+        // A pad hole is tested on all layers, even if the pad itself is not
+        if( pad->GetDrillSize().x )
+        {
+            int holeRadius = std::max( pad->GetDrillSize().x, pad->GetDrillSize().y ) / 2;
+            bbox.Merge( EDA_RECT( pad->GetPosition(), wxSize( 0, 0 ) ).Inflate( holeRadius ) );
+            layers |= LSET::AllCuMask();
+        }
+
+        bbox.Inflate( pad->GetClearance() + 1 );
+        padIndex.Insert( ii, bbox, layers );
+    }
+
+    // Segments are tested by a pool of workers.  The reference segment is only compared
+    // to the items after it in the track list, like the serial scan does, and each
+    // segment stores its marker in its own slot, so the result does not depend on the
+    // thread count or the scheduling.
+    std::vector<MARKER_PCB*> markers( tracks.size(), nullptr );
+    std::atomic<size_t>      nextSegment( 0 );
+    std::atomic<size_t>      segmentsDone( 0 );
+    std::atomic<bool>        abortTest( false );
+
+    auto worker = [&]()
     {
-        if( ii++ > delta )
+        // The single item tests keep their scratch data in members: each thread has its
+        // own DRC on the board, which only needs the board to test the tracks
+        DRC              drc( m_pcb );
+        std::vector<int> padCandidates;
+        std::vector<int> trackCandidates;
+        std::vector<D_PAD*> padList;
+        std::vector<TRACK*> trackList;
+
+        for( size_t ii = nextSegment.fetch_add( 1 ); ii < tracks.size() && !abortTest.load();
+             ii = nextSegment.fetch_add( 1 ) )
         {
-            ii = 0;
-            count++;
+            TRACK*   refSeg = tracks[ii];
+            EDA_RECT bbox = refSeg->GetBoundingBox();
 
-            if( progressDialog )
+            bbox.Inflate( biggestClearance );
+
+            padIndex.Query( bbox, refSeg->GetLayerSet(), 0, padCandidates );
+            trackIndex.Query( bbox, refSeg->GetLayerSet(), (int) ii + 1, trackCandidates );
+
+            padList.clear();
+            trackList.clear();
+
+            for( int idx : padCandidates )
+                padList.push_back( pads[idx] );
+
+            for( int idx : trackCandidates )
+                trackList.push_back( tracks[idx] );
+
+            if( !drc.doTrackDrc( refSeg, padList, trackList ) )
             {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
-#ifdef __WXMAC__
-                // Work around a dialog z-order issue on OS X
-                if( count == deltamax )
-                    aActiveWindow->Raise();
-#endif
+                wxASSERT( drc.m_currentMarker );
+                markers[ii] = drc.m_currentMarker;
+                drc.m_currentMarker = nullptr;
             }
-        }
 
-        if( !doTrackDrc( segm, segm->Next(), true ) )
-        {
-            wxASSERT( m_currentMarker );
-            addMarkerToPcb ( m_currentMarker );
-            m_currentMarker = nullptr;
+            segmentsDone.fetch_add( 1 );
         }
+    };
+
+    size_t parallelThreadCount = aThreadCount > 0 ? aThreadCount
+                                 : std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+    std::vector<std::thread> threads;
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        threads.push_back( std::thread( worker ) );
+
+    // Without a progress bar, there is nothing to do but wait for the workers
+    while( progressDialog && segmentsDone.load() < tracks.size() && !abortTest.load() )
+    {
+        int count = segmentsDone.load() / delta;
+
+        if( !progressDialog->Update( std::min( count, deltamax ), wxEmptyString ) )
+            abortTest.store( true );    // Aborted by user
+#ifdef __WXMAC__
+        // Work around a dialog z-order issue on OS X
+        if( count == deltamax )
+            aActiveWindow->Raise();
+#endif
+
+        wxMilliSleep( 20 );
+    }
+
+    for( auto& thread : threads )
+        thread.join();
+
+    // Markers are added at once, in the track list order
+    std::vector<MARKER_PCB*> foundMarkers;
+
+    for( MARKER_PCB* marker : markers )
+    {
+        if( marker )
+            foundMarkers.push_back( marker );
     }
 
+    addMarkersToPcb( foundMarkers );
+
     if( progressDialog )
         progressDialog->Destroy();
 }
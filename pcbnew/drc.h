@@ -205,7 +205,8 @@ private:
     int                 m_xcliphi;
     int                 m_ycliphi;
 
-    PCB_EDIT_FRAME*     m_pcbEditorFrame;   ///< The pcb frame editor which owns the board
+    PCB_EDIT_FRAME*     m_pcbEditorFrame;   ///< The pcb frame editor which owns the board,
+                                            ///< NULL when running without user interface
     BOARD*              m_pcb;
     DIALOG_DRC_CONTROL* m_drcDialog;
 
@@ -268,6 +269,12 @@ private:
      */
     void addMarkerToPcb( MARKER_PCB* aMarker );
 
+    /**
+     * Adds a list of DRC markers to the PCB in a single COMMIT.  Without an editor frame
+     * the markers are added directly to the board.
+     */
+    void addMarkersToPcb( const std::vector<MARKER_PCB*>& aMarkers );
+
     //-----<categorical group tests>-----------------------------------------
 
     /**
@@ -288,8 +295,9 @@ private:
      * @param aActiveWindow = the active window ued as parent for the progress bar
      * @param aShowProgressBar = true to show a progress bar
      * (Note: it is shown only if there are many tracks)
+     * @param aThreadCount = the number of threads testing the tracks, 0 for one per core
      */
-    void testTracks( wxWindow * aActiveWindow, bool aShowProgressBar );
+    void testTracks( wxWindow * aActiveWindow, bool aShowProgressBar, int aThreadCount = 0 );
 
     void testPad2Pad();
 
@@ -328,6 +336,21 @@ private:
      */
     bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool doPads = true );
 
+    /**
+     * Test the current segment against a preselected list of candidates.
+     *
+     * Candidates are tested in the order of the lists, so the reported problem is the same
+     * one the full list scan would find first.
+     *
+     * @param aRefSeg The segment to test
+     * @param aPads The pads to test against
+     * @param aTracks The tracks and vias to test against
+     * @return bool - true if no problems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doTrackDrc( TRACK* aRefSeg, const std::vector<D_PAD*>& aPads,
+                     const std::vector<TRACK*>& aTracks );
+
     /**
      * Test the current segment or via.
      *
@@ -413,8 +436,24 @@ private:
 public:
     DRC( PCB_EDIT_FRAME* aPcbWindow );
 
+    /**
+     * Create a DRC working on \a aBoard without user interface, for scripts and
+     * benchmarks.  Only RunTests() is available: markers are added directly to the
+     * board, and zones are refilled without a progress dialog.
+     */
+    DRC( BOARD* aBoard );
+
     ~DRC();
 
+    /**
+     * Function TestTracks
+     * tests the clearances of all the tracks and vias, without user interface, and adds
+     * the markers to the board.  The markers and their order do not depend on the
+     * thread count.
+     * @param aThreadCount The number of threads testing the tracks, 0 for one per core
+     */
+    void TestTracks( int aThreadCount = 0 );
+
     /**
      * Function Drc
      * tests the current segment and returns the result and displays the error
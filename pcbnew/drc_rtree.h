@@ -0,0 +1,135 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DRC_RTREE_H
+#define DRC_RTREE_H
+
+#include <vector>
+#include <algorithm>
+
+#include <eda_rect.h>
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/rtree.h>
+
+/**
+ * Class DRC_RTREE
+ * Implements a set of R-trees (one per copper layer) indexing board items by their
+ * bounding box.  Items are not stored directly: the tree holds the index of the item
+ * in a caller-owned list, so the results of a query can be sorted back into the list
+ * order and the DRC stays deterministic regardless of the tree layout.
+ *
+ * The trees are built once, on a single thread.  Queries do not modify the trees and can
+ * be run concurrently.
+ */
+class DRC_RTREE
+{
+public:
+    typedef RTree<int, int, 2, float> LAYER_TREE;
+
+    DRC_RTREE()
+    {
+        for( int layer = 0; layer < MAX_CU_LAYERS; ++layer )
+            m_tree[layer] = new LAYER_TREE();
+    }
+
+    ~DRC_RTREE()
+    {
+        for( int layer = 0; layer < MAX_CU_LAYERS; ++layer )
+            delete m_tree[layer];
+    }
+
+    /**
+     * Function Insert()
+     * Adds the item with index aIndex to the trees of all copper layers in aLayers.
+     * @param aIndex is the index of the item in the caller list
+     * @param aBBox is the area covered by the item, including its clearance
+     * @param aLayers are the layers the item has to be found on
+     */
+    void Insert( int aIndex, const EDA_RECT& aBBox, LSET aLayers )
+    {
+        EDA_RECT  bbox = aBBox;
+        bbox.Normalize();
+
+        const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+        for( LSEQ cu_stack = aLayers.CuStack(); cu_stack; ++cu_stack )
+            m_tree[*cu_stack]->Insert( mmin, mmax, aIndex );
+    }
+
+    /**
+     * Function Query()
+     * Collects the indices of items found on any copper layer of aLayers whose bounding
+     * box intersects aBBox.
+     * @param aBBox is the area to search
+     * @param aLayers are the layers to search
+     * @param aMinIndex is the smallest index to report (items already tested are skipped)
+     * @param aResult receives the indices, sorted and without duplicates
+     */
+    void Query( const EDA_RECT& aBBox, LSET aLayers, int aMinIndex,
+                std::vector<int>& aResult ) const
+    {
+        EDA_RECT  bbox = aBBox;
+        bbox.Normalize();
+
+        const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+        COLLECTOR collector( aResult, aMinIndex );
+
+        aResult.clear();
+
+        for( LSEQ cu_stack = aLayers.CuStack(); cu_stack; ++cu_stack )
+            m_tree[*cu_stack]->Search( mmin, mmax, collector );
+
+        std::sort( aResult.begin(), aResult.end() );
+        aResult.erase( std::unique( aResult.begin(), aResult.end() ), aResult.end() );
+    }
+
+private:
+    DRC_RTREE( const DRC_RTREE& ) = delete;
+    DRC_RTREE& operator=( const DRC_RTREE& ) = delete;
+
+    struct COLLECTOR
+    {
+        COLLECTOR( std::vector<int>& aResult, int aMinIndex ) :
+            m_result( aResult ), m_minIndex( aMinIndex )
+        {}
+
+        bool operator()( int aIndex )
+        {
+            if( aIndex >= m_minIndex )
+                m_result.push_back( aIndex );
+
+            return true;
+        }
+
+        std::vector<int>& m_result;
+        int               m_minIndex;
+    };
+
+    // RTree::Search() is not declared const, but it only reads the tree
+    LAYER_TREE* m_tree[MAX_CU_LAYERS];
+};
+
+#endif // DRC_RTREE_H
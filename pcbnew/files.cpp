@@ -48,6 +48,8 @@
 #include <pcbnew.h>
 #include <pcbnew_id.h>
 #include <io_mgr.h>
+#include <kicad_plugin.h>
+#include <properties.h>
 #include <wildcards_and_files_ext.h>
 
 #include <class_board.h>
@@ -507,6 +509,9 @@ bool PCB_EDIT_FRAME::OpenProjectFiles( const std::vector<wxString>& aFileSet, in
             props["page_width"]  = xbuf;
             props["page_height"] = ybuf;
 
+            if( Settings().m_zoneTriangulationCache )
+                props[ PCB_IO_TRIANGULATION_CACHE ] = "";
+
 #if USE_INSTRUMENTATION
             // measure the time to load a BOARD.
             unsigned startTime = GetRunningMicroSecs();
@@ -640,7 +645,8 @@ static wxString create_backup_file( const wxString& aFileName )
 }
 
 
-bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool aCreateBackupFile )
+bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool aCreateBackupFile,
+                                  const PROPERTIES* aProperties )
 {
     // please, keep it simple.  prompting goes elsewhere.
 
@@ -686,7 +692,16 @@ bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool aCreateBackupF
 
         wxASSERT( pcbFileName.IsAbsolute() );
 
-        pi->Save( pcbFileName.GetFullPath(), GetBoard(), NULL );
+        // Callers giving their own properties (such as the auto save, which has no use for
+        // a triangulation cache) replace the default ones
+        PROPERTIES props;
+
+        if( aProperties )
+            props = *aProperties;
+        else if( Settings().m_zoneTriangulationCache )
+            props[ PCB_IO_TRIANGULATION_CACHE ] = "";
+
+        pi->Save( pcbFileName.GetFullPath(), GetBoard(), &props );
     }
     catch( const IO_ERROR& ioe )
     {
@@ -821,7 +836,12 @@ bool PCB_EDIT_FRAME::doAutoSave()
 
     wxLogTrace( traceAutoSave, "Creating auto save file <" + autoSaveFileName.GetFullPath() + ">" );
 
-    if( SavePcbFile( autoSaveFileName.GetFullPath(), NO_BACKUP_FILE ) )
+    // The auto save file is only read back after a crash: favor the save time over the
+    // readability of the zone fills.
+    PROPERTIES props;
+    props[ PCB_IO_COMPACT_FILLS ] = "";
+
+    if( SavePcbFile( autoSaveFileName.GetFullPath(), NO_BACKUP_FILE, &props ) )
     {
         GetScreen()->SetModify();
         GetBoard()->SetFileName( tmpFileName.GetFullPath() );
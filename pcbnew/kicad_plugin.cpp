@@ -50,12 +50,16 @@
 #include <boost/ptr_container/ptr_map.hpp>
 #include <memory.h>
 #include <connectivity_data.h>
+#include <zone_triangulation_cache.h>
 
 using namespace PCB_KEYS_T;
 
 #define FMT_IU     BOARD_ITEM::FormatInternalUnits
 #define FMT_ANGLE  BOARD_ITEM::FormatAngle
 
+///> Size of the blocks in which the zone filled polygons are written
+static const size_t FILL_BUFFER_SIZE = 64 * 1024;
+
 /**
  * @ingroup trace_env_vars
  *
@@ -389,6 +393,11 @@ void PCB_IO::Save( const wxString& aFileName, BOARD* aBoard, const PROPERTIES* a
 
     m_board = aBoard;       // after init()
 
+    if( aProperties && aProperties->Exists( PCB_IO_COMPACT_FILLS ) )
+        m_ctl |= CTL_COMPACT_FILLS;
+    else
+        m_ctl &= ~CTL_COMPACT_FILLS;
+
     // Prepare net mapping that assures that net codes saved in a file are consecutive integers
     m_mapping->SetBoard( aBoard );
 
@@ -402,6 +411,10 @@ void PCB_IO::Save( const wxString& aFileName, BOARD* aBoard, const PROPERTIES* a
     Format( aBoard, 1 );
 
     m_out->Print( 0, ")\n" );
+
+    // The cache only saves time when loading: failing to write it is not an error
+    if( aProperties && aProperties->Exists( PCB_IO_TRIANGULATION_CACHE ) )
+        ZONE_TRIANGULATION_CACHE::Save( aBoard, ZONE_TRIANGULATION_CACHE::FileName( aFileName ) );
 }
 
 
@@ -1797,58 +1810,76 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 
     }
 
-    // Save the PolysList (filled areas)
+    // Save the PolysList (filled areas).  They are most of the board file, so the points are
+    // formatted in a buffer written in large blocks, rather than Print()ed one by one.
     const SHAPE_POLY_SET& fv = aZone->GetFilledPolysList();
-    newLine = 0;
+    bool compact = m_ctl & CTL_COMPACT_FILLS;
+
+    std::string buf;
+    char        x[BOARD_ITEM::FMT_IU_BUFFER_SIZE];
+    char        y[BOARD_ITEM::FMT_IU_BUFFER_SIZE];
 
     if( !fv.IsEmpty() )
+        buf.reserve( FILL_BUFFER_SIZE + 1000 );
+
+    for( int ii = 0; ii < fv.OutlineCount(); ++ii )
     {
-        bool new_polygon = true;
-        bool is_closed = false;
+        const SHAPE_LINE_CHAIN& outline = fv.COutline( ii );
+
+        if( outline.PointCount() == 0 )
+            continue;
 
-        for( auto it = fv.CIterate(); it; ++it )
+        if( compact )
+            m_out->Print( aNestLevel+1, "(filled_polygon (pts\n" );
+        else
         {
-            if( new_polygon )
-            {
-                newLine = 0;
-                m_out->Print( aNestLevel+1, "(filled_polygon\n" );
-                m_out->Print( aNestLevel+2, "(pts\n" );
-                new_polygon = false;
-                is_closed = false;
-            }
+            m_out->Print( aNestLevel+1, "(filled_polygon\n" );
+            m_out->Print( aNestLevel+2, "(pts\n" );
+        }
 
-            if( newLine == 0 )
-                m_out->Print( aNestLevel+3, "(xy %s %s)",
-                              FMT_IU( it->x ).c_str(), FMT_IU( it->y ).c_str() );
-            else
-                m_out->Print( 0, " (xy %s %s)",
-                              FMT_IU( it->x ) .c_str(), FMT_IU( it->y ).c_str() );
+        // compact fills are not indented, and have more points per line
+        int indent = compact ? 0 : aNestLevel+3;
+        int pointsPerLine = compact ? 100 : 5;
 
-            if( newLine < 4 )
-            {
-                newLine += 1;
-            }
+        for( int jj = 0; jj < outline.PointCount(); ++jj )
+        {
+            const VECTOR2I& pt = outline.CPoint( jj );
+            int             xlen = BOARD_ITEM::FormatInternalUnits( pt.x, x );
+            int             ylen = BOARD_ITEM::FormatInternalUnits( pt.y, y );
+
+            if( jj % pointsPerLine == 0 )
+                buf.append( indent * 2, ' ' );
             else
-            {
-                newLine = 0;
-                m_out->Print( 0, "\n" );
-            }
+                buf += ' ';
 
-            if( it.IsEndContour() )
-            {
-                is_closed = true;
+            buf.append( "(xy ", 4 );
+            buf.append( x, xlen );
+            buf += ' ';
+            buf.append( y, ylen );
+            buf += ')';
 
-                if( newLine != 0 )
-                    m_out->Print( 0, "\n" );
+            if( jj % pointsPerLine == pointsPerLine - 1 || jj == outline.PointCount() - 1 )
+            {
+                buf += '\n';
 
-                m_out->Print( aNestLevel+2, ")\n" );
-                m_out->Print( aNestLevel+1, ")\n" );
-                new_polygon = true;
+                if( buf.size() >= FILL_BUFFER_SIZE )
+                {
+                    m_out->PrintRaw( 0, buf.data(), (int) buf.size() );
+                    buf.clear();
+                }
             }
         }
 
-        if( !is_closed )    // Should not happen, but...
+        m_out->PrintRaw( 0, buf.data(), (int) buf.size() );
+        buf.clear();
+
+        if( compact )
+            m_out->Print( aNestLevel+1, "))\n" );
+        else
+        {
+            m_out->Print( aNestLevel+2, ")\n" );
             m_out->Print( aNestLevel+1, ")\n" );
+        }
     }
 
     // Save the filling segments list
@@ -1893,7 +1924,7 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER    reader( aFileName );
+    MMAP_LINE_READER    reader( aFileName );
 
     init( aProperties );
 
@@ -1931,6 +1962,9 @@ BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPER
     if( !aAppendToMe )
         board->SetFileName( aFileName );
 
+    if( aProperties && aProperties->Exists( PCB_IO_TRIANGULATION_CACHE ) )
+        ZONE_TRIANGULATION_CACHE::Restore( board, ZONE_TRIANGULATION_CACHE::FileName( aFileName ) );
+
     return board;
 }
 
@@ -57,6 +57,7 @@ class NETINFO_MAPPING;
 #define CTL_OMIT_AT                 (1 << 5)    ///< Omit position and rotation
                                                 // (always saved with potion 0,0 and rotation = 0 in library)
 //#define CTL_OMIT_HIDE             (1 << 6)    // found and defined in eda_text.h
+#define CTL_COMPACT_FILLS           (1 << 7)    ///< Write zone fills with less whitespace
 
 
 // common combinations of the above:
@@ -71,6 +72,14 @@ class NETINFO_MAPPING;
 /// a BOARD file underneath IO_MGR.
 #define CTL_FOR_BOARD               (CTL_OMIT_INITIAL_COMMENTS)
 
+/// PCB_IO::Save() property to write the zone fills in a compact form, which is still a
+/// valid board file but less readable: meant for transient files, such as autosave files.
+#define PCB_IO_COMPACT_FILLS        "compact_fills"
+
+/// PCB_IO::Save() and Load() property to write and read the zone fill triangulations in a
+/// cache file next to the board file.  @see ZONE_TRIANGULATION_CACHE.
+#define PCB_IO_TRIANGULATION_CACHE  "triangulation_cache"
+
 
 class DIMENSION;
 class EDGE_MODULE;
@@ -298,6 +298,11 @@ void prepareRouteMenu( wxMenu* aParentMenu )
                  _( "Tune skew/phase of a differential pair" ),
                  KiBitmap( ps_diff_pair_tune_phase_xpm ) );
 
+    AddMenuItem( aParentMenu, ID_MENU_TUNE_SELECTED_NETS,
+                 _( "Tune Length of Selected &Nets..." ),
+                 _( "Tune the nets of the selected tracks to a matched length" ),
+                 KiBitmap( ps_tune_length_xpm ) );
+
     aParentMenu->AppendSeparator();
 
     AddMenuItem( aParentMenu, ID_MENU_INTERACTIVE_ROUTER_SETTINGS,
@@ -64,6 +64,7 @@
 #include <worksheet_viewitem.h>
 #include <connectivity_data.h>
 #include <ratsnest_viewitem.h>
+#include <zone_filler.h>
 
 #include <tool/tool_manager.h>
 #include <tool/tool_dispatcher.h>
@@ -803,6 +804,7 @@ void PCB_EDIT_FRAME::enableGALSpecificMenus()
             ID_TUNE_SINGLE_TRACK_LEN_BUTT,
             ID_TUNE_DIFF_PAIR_LEN_BUTT,
             ID_TUNE_DIFF_PAIR_SKEW_BUTT,
+            ID_MENU_TUNE_SELECTED_NETS,
             ID_MENU_DIFF_PAIR_DIMENSIONS,
             ID_MENU_PCB_FLIP_VIEW
         };
@@ -844,6 +846,7 @@ void PCB_EDIT_FRAME::LoadSettings( wxConfigBase* aCfg )
     wxConfigLoadSetups( aCfg, GetConfigurationSettings() );
 
     m_configSettings.Load( aCfg );
+    ZONE_FILLER::SetThreadCount( m_configSettings.m_zoneFillThreads );
 
     double dtmp;
     aCfg->Read( PlotLineWidthEntry, &dtmp, 0.1 ); // stored in mm
@@ -1079,6 +1082,8 @@ void PCB_EDIT_FRAME::OnModify( )
 {
     PCB_BASE_FRAME::OnModify();
 
+    GetBoard()->MarkUntrackedZonesForRefill();
+
     EDA_3D_VIEWER* draw3DFrame = Get3DViewerFrame();
 
     if( draw3DFrame )
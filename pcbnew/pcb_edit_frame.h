@@ -62,6 +62,7 @@ struct PARSE_ERROR;
 class IO_ERROR;
 class FP_LIB_TABLE;
 struct AUTOROUTER_CONTEXT;
+class PROPERTIES;
 
 namespace PCB { struct IFACE; }     // KIFACE_I is in pcbnew.cpp
 
@@ -600,7 +601,8 @@ public:
      * must be called after a board change to set the modified flag.
      * <p>
      * Reloads the 3D view if required and calls the base PCB_BASE_FRAME::OnModify function
-     * to update auxiliary information.
+     * to update auxiliary information.  Flags all the zones for refill if the change did
+     * not flag the zones it affects, see BOARD::MarkUntrackedZonesForRefill().
      * </p>
      */
     virtual void OnModify() override;
@@ -887,9 +889,11 @@ public:
      * @param aCreateBackupFile Creates a back of \a aFileName if true.  Helper
      *                          definitions #CREATE_BACKUP_FILE and #NO_BACKUP_FILE
      *                          are defined for improved code readability.
+     * @param aProperties are passed to the plugin Save() function, may be NULL.
      * @return True if file was saved successfully.
      */
-    bool SavePcbFile( const wxString& aFileName, bool aCreateBackupFile = CREATE_BACKUP_FILE );
+    bool SavePcbFile( const wxString& aFileName, bool aCreateBackupFile = CREATE_BACKUP_FILE,
+                      const PROPERTIES* aProperties = NULL );
 
     /**
      * Function SavePcbCopy
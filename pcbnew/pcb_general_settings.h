@@ -65,6 +65,11 @@ public:
     MAGNETIC_PAD_OPTION_VALUES  m_magneticPads  = CAPTURE_CURSOR_IN_TRACK_TOOL;
     MAGNETIC_PAD_OPTION_VALUES  m_magneticTracks = CAPTURE_CURSOR_IN_TRACK_TOOL;
 
+    bool    m_zoneTriangulationCache = false;   // True to save the zone fill triangulations
+                                                // next to the board file, for faster loading
+    int     m_zoneFillThreads = 0;              // Threads used to fill the zones, 0 for all
+                                                // the cores (see ZONE_FILLER::SetThreadCount())
+
 protected:
     const FRAME_T m_frameType;
     COLORS_DESIGN_SETTINGS m_colorsSettings;
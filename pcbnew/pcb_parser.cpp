@@ -28,6 +28,11 @@
  */
 
 #include <errno.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
 #include <common.h>
 #include <confirm.h>
 #include <macros.h>
@@ -498,6 +503,8 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 {
     T token;
 
+    m_filledPolygons.clear();
+
     parseHeader();
 
     for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
@@ -580,6 +587,8 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
         }
     }
 
+    parseFilledPolygons();
+
     return m_board;
 }
 
@@ -2831,9 +2840,6 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER()
     int     tmp;
     wxString    netnameFromfile;    // the zone net name find in file
 
-    // bigger scope since each filled_polygon is concatenated in here
-    SHAPE_POLY_SET pts;
-
     std::unique_ptr< ZONE_CONTAINER > zone( new ZONE_CONTAINER( m_board ) );
 
     zone->SetPriority( 0 );
@@ -3094,12 +3100,16 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER()
                 if( token != T_pts )
                     Expecting( T_pts );
 
-                pts.NewOutline();
+                // The points are most of the board file: they are kept as raw text here
+                // and parsed by parseFilledPolygons() once the whole board is read.
+                FILLED_POLYGON_BLOCK block;
 
-                for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
-                {
-                    pts.Append( parseXY() );
-                }
+                block.m_zone        = zone.get();
+                block.m_lineNumber  = CurLineNumber();
+                block.m_errorOffset = std::string::npos;
+
+                ReadRawList( block.m_text );
+                m_filledPolygons.push_back( std::move( block ) );
 
                 NeedRIGHT();
             }
@@ -3146,9 +3156,6 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER()
         zone->SetHatch( hatchStyle, hatchPitch, true );
     }
 
-    if( !pts.IsEmpty() )
-        zone->SetFilledPolysList( pts );
-
     // Ensure keepout and non copper zones do not have a net
     // (which have no sense for these zones)
     // the netcode 0 is used for these zones
@@ -3194,6 +3201,199 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER()
 }
 
 
+/**
+ * Function parseMillimeters
+ * parses the decimal number at \a aCur in \a aText and advances \a aCur past it.
+ * Plain decimals, which are all what Format() writes, are converted without strtod(),
+ * with the same result: the digits are exact in a double, and so is the power of ten
+ * they are divided by, so the division is correctly rounded.
+ * @return bool - false if there is no number at \a aCur.
+ */
+static bool parseMillimeters( const std::string& aText, size_t& aCur, double& aValue )
+{
+    static const double pow10[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15
+    };
+
+    const char* text     = aText.c_str();
+    size_t      cur      = aCur;
+    bool        negative = false;
+    uint64_t    mantissa = 0;
+    int         digits   = 0;
+    int         decimals = 0;
+
+    if( text[cur] == '-' || text[cur] == '+' )
+        negative = text[cur++] == '-';
+
+    for( ; text[cur] >= '0' && text[cur] <= '9'; ++cur, ++digits )
+        mantissa = mantissa * 10 + ( text[cur] - '0' );
+
+    if( text[cur] == '.' )
+    {
+        for( ++cur; text[cur] >= '0' && text[cur] <= '9'; ++cur, ++digits, ++decimals )
+            mantissa = mantissa * 10 + ( text[cur] - '0' );
+    }
+
+    if( digits == 0 )
+        return false;
+
+    if( digits > 15 || text[cur] == 'e' || text[cur] == 'E' )
+    {
+        // Not a plain decimal, or too long to be exact: let strtod() handle it
+        char* end;
+
+        aValue = strtod( text + aCur, &end );
+        aCur = end - text;
+        return true;
+    }
+
+    aValue = mantissa / pow10[decimals];
+
+    if( negative )
+        aValue = -aValue;
+
+    aCur = cur;
+    return true;
+}
+
+
+bool PCB_PARSER::parseFilledPolygonPoints( FILLED_POLYGON_BLOCK& aBlock )
+{
+    const std::string& text = aBlock.m_text;
+    const char*        c    = text.c_str();
+    size_t             cur  = 0;
+
+    auto skipSpaces = [&]()
+    {
+        while( c[cur] == ' ' || c[cur] == '\t' || c[cur] == '\n' || c[cur] == '\r' )
+            ++cur;
+    };
+
+    auto fail = [&]()
+    {
+        aBlock.m_errorOffset = cur;
+        return false;
+    };
+
+    // A point is 20 to 30 characters
+    aBlock.m_points.reserve( text.size() / 20 );
+
+    for( skipSpaces(); cur < text.size(); skipSpaces() )
+    {
+        if( c[cur++] != '(' )
+            return fail();
+
+        skipSpaces();
+
+        if( c[cur] != 'x' || c[cur + 1] != 'y' )
+            return fail();
+
+        cur += 2;
+
+        double x, y;
+
+        skipSpaces();
+
+        if( !parseMillimeters( text, cur, x ) )
+            return fail();
+
+        skipSpaces();
+
+        if( !parseMillimeters( text, cur, y ) )
+            return fail();
+
+        skipSpaces();
+
+        if( c[cur++] != ')' )
+            return fail();
+
+        aBlock.m_points.push_back( VECTOR2I( KiROUND( x * IU_PER_MM ),
+                                             KiROUND( y * IU_PER_MM ) ) );
+    }
+
+    return true;
+}
+
+
+void PCB_PARSER::parseFilledPolygons()
+{
+    std::vector<FILLED_POLYGON_BLOCK> blocks;
+
+    blocks.swap( m_filledPolygons );
+
+    // Parse the biggest outlines first, so the threads finish at about the same time
+    std::vector<FILLED_POLYGON_BLOCK*> queue;
+
+    for( FILLED_POLYGON_BLOCK& block : blocks )
+        queue.push_back( &block );
+
+    std::sort( queue.begin(), queue.end(),
+               []( const FILLED_POLYGON_BLOCK* a, const FILLED_POLYGON_BLOCK* b )
+               {
+                   return a->m_text.size() > b->m_text.size();
+               } );
+
+    size_t threadCount = std::thread::hardware_concurrency();
+    threadCount = std::max<size_t>( std::min( threadCount, queue.size() ), 1 );
+
+    std::atomic_size_t nextBlock( 0 );
+    std::vector<std::thread> workers;
+
+    auto worker = [&queue, &nextBlock]()
+    {
+        for( size_t ii = nextBlock++; ii < queue.size(); ii = nextBlock++ )
+        {
+            // The text is no longer needed, release it early
+            if( parseFilledPolygonPoints( *queue[ii] ) )
+                std::string().swap( queue[ii]->m_text );
+        }
+    };
+
+    for( size_t ii = 1; ii < threadCount; ++ii )
+        workers.push_back( std::thread( worker ) );
+
+    worker();
+
+    for( std::thread& thread : workers )
+        thread.join();
+
+    // Report the first error of the file, and give the outlines to their zones, in order
+    SHAPE_POLY_SET polys;
+
+    for( size_t ii = 0; ii < blocks.size(); ++ii )
+    {
+        FILLED_POLYGON_BLOCK& block = blocks[ii];
+
+        if( block.m_errorOffset != std::string::npos )
+        {
+            const std::string& text = block.m_text;
+            size_t offset    = std::min( block.m_errorOffset, text.size() );
+            size_t lineStart = offset ? text.rfind( '\n', offset - 1 ) : std::string::npos;
+            int    lineNum   = block.m_lineNumber + std::count( text.begin(),
+                                                                text.begin() + offset, '\n' );
+
+            lineStart = ( lineStart == std::string::npos ) ? 0 : lineStart + 1;
+
+            THROW_PARSE_ERROR( _( "Expecting \"(xy X Y)\"" ), CurSource(),
+                               text.c_str() + lineStart, lineNum, offset - lineStart );
+        }
+
+        polys.NewOutline();
+
+        for( const VECTOR2I& point : block.m_points )
+            polys.Append( point );
+
+        if( ii + 1 == blocks.size() || blocks[ii + 1].m_zone != block.m_zone )
+        {
+            block.m_zone->SetFilledPolysList( polys );
+            polys.RemoveAllContours();
+        }
+    }
+}
+
+
 PCB_TARGET* PCB_PARSER::parsePCB_TARGET()
 {
     wxCHECK_MSG( CurTok() == T_target, NULL,
@@ -35,8 +35,10 @@
 #include <layers_id_colors_and_visibility.h>    // PCB_LAYER_ID
 #include <common.h>                             // KiROUND
 #include <convert_to_biu.h>                     // IU_PER_MM
+#include <math/vector2d.h>
 
 #include <unordered_map>
+#include <vector>
 
 
 class BOARD;
@@ -74,6 +76,19 @@ class PCB_PARSER : public PCB_LEXER
     bool                m_tooRecent;        ///< true if version parses as later than supported
     int                 m_requiredVersion;  ///< set to the KiCad format version this board requires
 
+    ///> The points list of a zone filled polygon outline, read as raw text while loading a
+    ///> board and parsed afterwards, concurrently with the other outlines.
+    struct FILLED_POLYGON_BLOCK
+    {
+        ZONE_CONTAINER*         m_zone;
+        std::string             m_text;         ///< the "(xy X Y) ..." list
+        int                     m_lineNumber;   ///< the line where m_text starts
+        std::vector<VECTOR2I>   m_points;
+        size_t                  m_errorOffset;  ///< offset of a syntax error in m_text, or npos
+    };
+
+    std::vector<FILLED_POLYGON_BLOCK> m_filledPolygons;  ///< pending filled polygon outlines
+
     ///> Converts net code using the mapping table if available,
     ///> otherwise returns unchanged net code if < 0 or if is is out of range
     inline int getNetCode( int aNetCode )
@@ -130,6 +145,23 @@ class PCB_PARSER : public PCB_LEXER
     TRACK*          parseTRACK();
     VIA*            parseVIA();
     ZONE_CONTAINER* parseZONE_CONTAINER();
+
+    /**
+     * Function parseFilledPolygons
+     * parses the points of the pending filled polygon outlines on worker threads, and
+     * gives the resulting polygon sets to their zones, in file order.
+     * @throw PARSE_ERROR if an outline contains something else than xy points.
+     */
+    void parseFilledPolygons();
+
+    /**
+     * Function parseFilledPolygonPoints
+     * parses the "(xy X Y) (xy X Y) ..." list of @a aBlock into its points.  Only uses
+     * @a aBlock, so it can be run on any thread.
+     * @return bool - false on a syntax error, whose offset is stored in aBlock.m_errorOffset.
+     */
+    static bool parseFilledPolygonPoints( FILLED_POLYGON_BLOCK& aBlock );
+
     PCB_TARGET*     parsePCB_TARGET();
     BOARD*          parseBOARD();
 
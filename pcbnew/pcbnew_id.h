@@ -48,6 +48,7 @@ enum pcbnew_ids
     ID_TUNE_SINGLE_TRACK_LEN_BUTT,
     ID_TUNE_DIFF_PAIR_LEN_BUTT,
     ID_TUNE_DIFF_PAIR_SKEW_BUTT,
+    ID_MENU_TUNE_SELECTED_NETS,
     ID_MENU_REMOVE_MEANDERS,
     ID_MENU_MITER_TRACES,
     ID_MENU_ADD_TEARDROPS,
@@ -43,6 +43,8 @@ using namespace std::placeholders;
 #include <cassert>
 #include <algorithm>
 #include <limits>
+#include <map>
+#include <memory>
 
 #include <connectivity_algo.h>
 
@@ -61,7 +63,7 @@ static bool sortWeight( const CN_EDGE& aEdge1, const CN_EDGE& aEdge2 )
 }
 
 
-static const std::vector<CN_EDGE> kruskalMST( std::list<CN_EDGE>& aEdges,
+static const std::vector<CN_EDGE> kruskalMST( std::vector<CN_EDGE>& aEdges,
         std::vector<CN_ANCHOR_PTR>& aNodes )
 {
     unsigned int    nodeNumber = aNodes.size();
@@ -69,89 +71,88 @@ static const std::vector<CN_EDGE> kruskalMST( std::list<CN_EDGE>& aEdges,
     unsigned int    mstSize = 0;
     bool ratsnestLines = false;
 
-    //printf("mst nodes : %d edges : %d\n", aNodes.size(), aEdges.size () );
     // The output
     std::vector<CN_EDGE> mst;
 
-    // Set tags for marking cycles
-    std::unordered_map<CN_ANCHOR_PTR, int> tags;
-    unsigned int tag = 0;
+    // Subtrees of nodes connected together, to detect cycles in the graph. Each node
+    // points to its parent in the subtree, the root of the subtree points to itself.
+    // Nodes are identified by their tag, i.e. by their index in aNodes.
+    std::vector<int> parents( nodeNumber );
+    std::vector<int> connectedTags;
 
-    for( auto& node : aNodes )
+    for( unsigned int i = 0; i < nodeNumber; ++i )
     {
-        node->SetTag( tag );
-        tags[node] = tag++;
+        aNodes[i]->SetTag( i );
+        parents[i] = i;
     }
 
-    // Lists of nodes connected together (subtrees) to detect cycles in the graph
-    std::vector<std::list<int> > cycles( nodeNumber );
+    auto findRoot = [&parents] ( int aNode )
+    {
+        while( parents[aNode] != aNode )
+        {
+            parents[aNode] = parents[parents[aNode]];
+            aNode = parents[aNode];
+        }
+
+        return aNode;
+    };
 
-    for( unsigned int i = 0; i < nodeNumber; ++i )
-        cycles[i].push_back( i );
+    // Nodes with the same tag are connected by copper
+    auto tagConnectedNodes = [&] ()
+    {
+        connectedTags.resize( nodeNumber );
+
+        for( unsigned int i = 0; i < nodeNumber; ++i )
+            connectedTags[i] = findRoot( i );
+    };
 
     // Kruskal algorithm requires edges to be sorted by their weight
-    aEdges.sort( sortWeight );
+    std::stable_sort( aEdges.begin(), aEdges.end(), sortWeight );
 
-    while( mstSize < mstExpectedSize && !aEdges.empty() )
+    for( const auto& dt : aEdges )
     {
-        //printf("mstSize %d %d\n", mstSize, mstExpectedSize);
-        auto& dt = aEdges.front();
+        if( mstSize >= mstExpectedSize )
+            break;
 
-        int srcTag  = tags[dt.GetSourceNode()];
-        int trgTag  = tags[dt.GetTargetNode()];
+        int srcRoot = findRoot( dt.GetSourceNode()->GetTag() );
+        int trgRoot = findRoot( dt.GetTargetNode()->GetTag() );
 
         // Check if by adding this edge we are going to join two different forests
-        if( srcTag != trgTag )
-        {
-            // Because edges are sorted by their weight, first we always process connected
-            // items (weight == 0). Once we stumble upon an edge with non-zero weight,
-            // it means that the rest of the lines are ratsnest.
-            if( !ratsnestLines && dt.GetWeight() != 0 )
-                ratsnestLines = true;
-
-            // Update tags
-            if( ratsnestLines )
-            {
-                for( auto it = cycles[trgTag].begin(); it != cycles[trgTag].end(); ++it )
-                {
-                    tags[aNodes[*it]] = srcTag;
-                }
+        if( srcRoot == trgRoot )
+            continue;
 
-                // Do a copy of edge, but make it RN_EDGE_MST. In contrary to RN_EDGE,
-                // RN_EDGE_MST saves both source and target node and does not require any other
-                // edges to exist for getting source/target nodes
-                CN_EDGE newEdge ( dt.GetSourceNode(), dt.GetTargetNode(), dt.GetWeight() );
-
-                assert( newEdge.GetSourceNode()->GetTag() != newEdge.GetTargetNode()->GetTag() );
-                assert( newEdge.GetWeight() > 0 );
+        // Because edges are sorted by their weight, first we always process connected
+        // items (weight == 0). Once we stumble upon an edge with non-zero weight,
+        // it means that the rest of the lines are ratsnest.
+        if( !ratsnestLines && dt.GetWeight() != 0 )
+        {
+            ratsnestLines = true;
+            tagConnectedNodes();
+        }
 
-                mst.push_back( newEdge );
-                ++mstSize;
-            }
-            else
-            {
-                // for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it )
-                // for( auto it : cycles[trgTag] )
-                for( auto it = cycles[trgTag].begin(); it != cycles[trgTag].end(); ++it )
-                {
-                    tags[aNodes[*it]] = srcTag;
-                    aNodes[*it]->SetTag( srcTag );
-                }
+        // Join the subtrees
+        parents[trgRoot] = srcRoot;
 
-                // Processing a connection, decrease the expected size of the ratsnest MST
-                --mstExpectedSize;
-            }
+        if( ratsnestLines )
+        {
+            assert( dt.GetWeight() > 0 );
 
-            // Move nodes that were marked with old tag to the list marked with the new tag
-            cycles[srcTag].splice( cycles[srcTag].end(), cycles[trgTag] );
+            // Do a copy of edge, saving both source and target node
+            mst.emplace_back( dt.GetSourceNode(), dt.GetTargetNode(), dt.GetWeight() );
+            ++mstSize;
+        }
+        else
+        {
+            // Processing a connection, decrease the expected size of the ratsnest MST
+            --mstExpectedSize;
         }
-
-        // Remove the edge that was just processed
-        aEdges.erase( aEdges.begin() );
     }
 
-    // Probably we have discarded some of edges, so reduce the size
-    mst.resize( mstSize );
+    if( !ratsnestLines )
+        tagConnectedNodes();
+
+    for( unsigned int i = 0; i < nodeNumber; ++i )
+        aNodes[i]->SetTag( connectedTags[i] );
 
     return mst;
 }
@@ -161,18 +162,16 @@ class RN_NET::TRIANGULATOR_STATE
 {
 private:
     std::vector<CN_ANCHOR_PTR>  m_allNodes;
-    std::vector<VECTOR2I>  m_prevNodes;
-    std::vector<std::pair<int, int> > m_prevEdges;
 
-    std::list<hed::EDGE_PTR> hedTriangulation( std::vector<hed::NODE_PTR>& aNodes )
-    {
-        hed::TRIANGULATION triangulator;
-        triangulator.CreateDelaunay( aNodes.begin(), aNodes.end() );
-        std::list<hed::EDGE_PTR> edges;
-        triangulator.GetEdges( edges );
+    ///> Delaunay triangulation of the node positions, kept between updates so only the
+    ///> positions that changed have to be removed from or inserted into it.  The enclosing
+    ///> triangles are never removed: they span the whole coordinate range, so nodes can be
+    ///> inserted anywhere and are never on the boundary.  qa/geometry/test_delaunay_update
+    ///> checks that the updated triangulation gives the same spanning tree as a new one.
+    std::unique_ptr<hed::TRIANGULATION> m_triangulation;
 
-        return edges;
-    }
+    ///> Nodes of m_triangulation, by (y, x) position
+    std::map<std::pair<int, int>, hed::NODE_PTR> m_triNodes;
 
 
     // Checks if all nodes in aNodes lie on a single line. Requires the nodes to
@@ -198,9 +197,37 @@ private:
         return true;
     }
 
-    const std::list<hed::EDGE_PTR> computeTriangulation( std::vector<hed::NODE_PTR>& aNodes )
+    void resetTriangulation()
     {
-        return hedTriangulation( aNodes );
+        m_triangulation.reset();
+        m_triNodes.clear();
+    }
+
+    // Removes and inserts the nodes that changed since the last update. Returns false if
+    // the triangulation has to be recreated from scratch.
+    bool updateTriangulation( const std::vector<hed::NODE_PTR>& aRemoved,
+                              const std::vector<hed::NODE_PTR>& aAdded, size_t aNodeCount )
+    {
+        if( !m_triangulation )
+            return false;
+
+        // Big changes (e.g. a net that was just loaded) are faster to triangulate at once
+        if( 4 * ( aRemoved.size() + aAdded.size() ) > aNodeCount )
+            return false;
+
+        for( const auto& node : aRemoved )
+        {
+            if( !m_triangulation->RemoveNode( node ) )
+                return false;
+        }
+
+        for( const auto& node : aAdded )
+        {
+            if( !m_triangulation->InsertNode( node ) )
+                return false;
+        }
+
+        return true;
     }
 
 public:
@@ -215,11 +242,14 @@ public:
         m_allNodes.push_back( aNode );
     }
 
-    const std::list<CN_EDGE> Triangulate()
+    const std::vector<CN_EDGE> Triangulate()
     {
-        std::list<CN_EDGE> mstEdges;
+        std::vector<CN_EDGE> mstEdges;
         std::list<hed::EDGE_PTR> triangEdges;
         std::vector<hed::NODE_PTR> triNodes;
+        std::vector<hed::NODE_PTR> addedNodes;
+        std::vector<hed::NODE_PTR> removedNodes;
+        std::map<std::pair<int, int>, hed::NODE_PTR> triNodesByPos;
 
         using ANCHOR_LIST = std::vector<CN_ANCHOR_PTR>;
         std::vector<ANCHOR_LIST> anchorChains;
@@ -253,16 +283,38 @@ public:
         {
             if( !prev || prev->Pos() != n->Pos() )
             {
-                auto tn = std::make_shared<hed::NODE> ( n->Pos().x, n->Pos().y );
+                // Reuse the triangulation node of positions that did not change
+                auto pos = std::make_pair( n->Pos().y, n->Pos().x );
+                auto it = m_triNodes.find( pos );
+                hed::NODE_PTR tn;
+
+                if( it != m_triNodes.end() )
+                {
+                    tn = it->second;
+                }
+                else
+                {
+                    tn = std::make_shared<hed::NODE> ( n->Pos().x, n->Pos().y );
+                    addedNodes.push_back( tn );
+                }
 
+                // Flag the nodes of the net, to tell them from the enclosing triangles
                 tn->SetId( id );
+                tn->SetFlag( true );
                 triNodes.push_back( tn );
+                triNodesByPos.emplace_hint( triNodesByPos.end(), pos, tn );
             }
 
             id++;
             prev = n;
         }
 
+        for( const auto& entry : m_triNodes )
+        {
+            if( !triNodesByPos.count( entry.first ) )
+                removedNodes.push_back( entry.second );
+        }
+
         int prevId = 0;
 
         for( auto n : triNodes )
@@ -278,10 +330,13 @@ public:
 
         if( triNodes.size() == 1 )
         {
+            resetTriangulation();
             return mstEdges;
         }
         else if( areNodesColinear( triNodes ) )
         {
+            resetTriangulation();
+
             // special case: all nodes are on the same line - there's no
             // triangulation for such set. In this case, we sort along any coordinate
             // and chain the nodes together.
@@ -294,14 +349,26 @@ public:
         }
         else
         {
-            hed::TRIANGULATION triangulator;
-            triangulator.CreateDelaunay( triNodes.begin(), triNodes.end() );
-            triangulator.GetEdges( triangEdges );
+            if( !updateTriangulation( removedNodes, addedNodes, triNodes.size() ) )
+            {
+                m_triangulation.reset( new hed::TRIANGULATION );
+                m_triangulation->CreateDelaunay( triNodes.begin(), triNodes.end(), false );
+            }
+
+            m_triNodes.swap( triNodesByPos );
+            m_triangulation->GetEdges( triangEdges );
 
             for( auto e : triangEdges )
             {
-                auto    src = m_allNodes[ e->GetSourceNode()->Id() ];
-                auto    dst = m_allNodes[ e->GetTargetNode()->Id() ];
+                const auto& srcNode = e->GetSourceNode();
+                const auto& dstNode = e->GetTargetNode();
+
+                // Skip the edges of the enclosing triangles
+                if( !srcNode->GetFlag() || !dstNode->GetFlag() )
+                    continue;
+
+                auto    src = m_allNodes[ srcNode->Id() ];
+                auto    dst = m_allNodes[ dstNode->Id() ];
 
                 mstEdges.emplace_back( src, dst, getDistance( src, dst ) );
             }
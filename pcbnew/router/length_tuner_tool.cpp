@@ -30,14 +30,19 @@
 #include <pcb_painter.h>
 #include <dialogs/dialog_pns_settings.h>
 #include <dialogs/dialog_pns_length_tuning_settings.h>
+#include <base_units.h>
+#include <confirm.h>
+#include <html_messagebox.h>
 
 #include <tool/context_menu.h>
 #include <tool/tool_manager.h>
 #include <tools/pcb_actions.h>
+#include <tools/selection_tool.h>
 
 #include "pns_segment.h"
 #include "pns_router.h"
 #include "pns_meander_placer.h" // fixme: move settings to separate header
+#include "pns_meander_batch.h"
 #include "pns_tune_status_popup.h"
 
 #include "length_tuner_tool.h"
@@ -235,11 +240,93 @@ int LENGTH_TUNER_TOOL::TuneDiffPairSkew( const TOOL_EVENT& aEvent )
 }
 
 
+int LENGTH_TUNER_TOOL::TuneSelectedNets( const TOOL_EVENT& aEvent )
+{
+    if( m_router->RoutingInProgress() )
+        return 0;
+
+    const auto& selection = m_toolMgr->GetTool<SELECTION_TOOL>()->GetSelection();
+    std::vector<int> nets;
+
+    for( auto item : selection )
+    {
+        if( item->Type() != PCB_TRACE_T )
+            continue;
+
+        int net = static_cast<TRACK*>( item )->GetNetCode();
+
+        if( net > 0 && std::find( nets.begin(), nets.end(), net ) == nets.end() )
+            nets.push_back( net );
+    }
+
+    if( nets.empty() )
+    {
+        DisplayError( frame(), _( "Please select tracks of the nets you want to tune." ) );
+        return 0;
+    }
+
+    PNS::MEANDER_SETTINGS settings = m_savedMeanderSettings;
+    DIALOG_PNS_LENGTH_TUNING_SETTINGS settingsDlg( frame(), settings, PNS::PNS_MODE_TUNE_SINGLE );
+
+    if( settingsDlg.ShowModal() != wxID_OK )
+        return 0;
+
+    m_savedMeanderSettings = settings;
+
+    m_toolMgr->RunAction( PCB_ACTIONS::selectionClear, true );
+    m_router->SyncWorld();
+
+    PNS::MEANDER_BATCH batch( m_router );
+    batch.SetSettings( settings );
+
+    {
+        wxBusyCursor busy;
+
+        if( batch.Run( nets ) )
+            batch.Commit();
+    }
+
+    wxArrayString report;
+
+    for( const PNS::MEANDER_BATCH::RESULT& result : batch.Results() )
+    {
+        wxString status;
+
+        if( result.m_originalLength == 0 )
+            status = _( "no track to tune" );
+        else if( result.m_status == PNS::MEANDER_PLACER_BASE::TUNED )
+            status = _( "tuned" );
+        else if( result.m_status == PNS::MEANDER_PLACER_BASE::TOO_LONG )
+            status = _( "too long" );
+        else
+            status = _( "too short" );
+
+        if( result.m_retuned )
+            status += _( " (meanders moved away from another net)" );
+
+        report.Add( wxString::Format( wxT( "%s: %s -> %s, %s" ),
+                                      board()->FindNet( result.m_net )->GetNetname(),
+                                      LengthDoubleToString( (double) result.m_originalLength, false ),
+                                      LengthDoubleToString( (double) result.m_length, false ),
+                                      status ) );
+    }
+
+    HTML_MESSAGE_BOX dlg( frame(), _( "Length Tuning" ) );
+    dlg.MessageSet( wxString::Format( _( "Target length: %s" ),
+                                      LengthDoubleToString( (double) batch.TargetLength(), false ) ) );
+    dlg.ListSet( report );
+    dlg.ShowModal();
+
+    return 0;
+}
+
+
 void LENGTH_TUNER_TOOL::setTransitions()
 {
     Go( &LENGTH_TUNER_TOOL::TuneSingleTrace, PCB_ACTIONS::routerActivateTuneSingleTrace.MakeEvent() );
     Go( &LENGTH_TUNER_TOOL::TuneDiffPair, PCB_ACTIONS::routerActivateTuneDiffPair.MakeEvent() );
     Go( &LENGTH_TUNER_TOOL::TuneDiffPairSkew, PCB_ACTIONS::routerActivateTuneDiffPairSkew.MakeEvent() );
+    Go( &LENGTH_TUNER_TOOL::TuneSelectedNets, PCB_ACTIONS::routerTuneSelectedNets.MakeEvent() );
 
     Go( &LENGTH_TUNER_TOOL::meanderSettingsDialog, ACT_Settings.MakeEvent() );
 }
@@ -40,6 +40,9 @@ public:
     int TuneDiffPair( const TOOL_EVENT& aEvent );
     int TuneDiffPairSkew( const TOOL_EVENT& aEvent );
 
+    ///> Tunes the nets of the selected tracks to a matched length, all at once
+    int TuneSelectedNets( const TOOL_EVENT& aEvent );
+
     void setTransitions() override;
 
 private:
@@ -304,6 +304,7 @@ bool DIFF_PAIR_PLACER::route( const VECTOR2I& aP )
     case RM_Walkaround:
         return rhWalkOnly( aP );
     case RM_Shove:
+    case RM_Smart:
         return rhShoveOnly( aP );
     default:
         break;
@@ -24,10 +24,10 @@
 
 #include <layers_id_colors_and_visibility.h>
 #include <map>
+#include <memory>
+#include <iterator>
 #include <unordered_set>
 
-#include <boost/range/adaptor/map.hpp>
-
 #include <list>
 #include <geometry/shape_index.h>
 
@@ -42,6 +42,10 @@ namespace PNS {
  * Custom spatial index, holding our board items and allowing for very fast searches. Items
  * are assigned to separate R-Tree subindices depending on their type and spanned layers, reducing
  * overlap and improving search time.
+ *
+ * Copies of an index share their subindices and net lists: a part is copied only when
+ * one of the indices sharing it modifies it (copy-on-write).  Copying an index is therefore
+ * cheap, and a copy modified on a single layer only duplicates the subindices of that layer.
  **/
 class INDEX
 {
@@ -50,7 +54,94 @@ public:
     typedef SHAPE_INDEX<ITEM*>          ITEM_SHAPE_INDEX;
     typedef std::unordered_set<ITEM*>   ITEM_SET;
 
+private:
+    static const int    MaxSubIndices   = 128;
+    static const int    SI_Multilayer   = 2;
+    static const int    SI_SegDiagonal  = 0;
+    static const int    SI_SegStraight  = 1;
+    static const int    SI_Traces       = 3;
+    static const int    SI_PadsTop      = 0;
+    static const int    SI_PadsBottom   = 1;
+
+    ///> A spatial subindex and the items it holds
+    struct SUBINDEX
+    {
+        ITEM_SHAPE_INDEX    m_shapes;
+        ITEM_SET            m_items;
+    };
+
+    typedef std::shared_ptr<SUBINDEX>           SUBINDEX_PTR;
+    typedef std::shared_ptr<NET_ITEMS_LIST>     NET_ITEMS_PTR;
+
+public:
+    /**
+     * Class ITERATOR
+     *
+     * Iterates over all the items of the index, subindex by subindex.
+     */
+    class ITERATOR : public std::iterator<std::forward_iterator_tag, ITEM*>
+    {
+    public:
+        ITERATOR( const INDEX* aIndex, bool aEnd ) :
+            m_index( aIndex ),
+            m_slot( aEnd ? MaxSubIndices : -1 )
+        {
+            if( !aEnd )
+                nextSlot();
+        }
+
+        ITEM* operator*() const
+        {
+            return *m_item;
+        }
+
+        ITERATOR& operator++()
+        {
+            if( ++m_item == m_index->m_subIndices[m_slot]->m_items.end() )
+                nextSlot();
+
+            return *this;
+        }
+
+        bool operator==( const ITERATOR& aOther ) const
+        {
+            return m_slot == aOther.m_slot && ( m_slot == MaxSubIndices || m_item == aOther.m_item );
+        }
+
+        bool operator!=( const ITERATOR& aOther ) const
+        {
+            return !( *this == aOther );
+        }
+
+    private:
+        ///> moves to the first item of the next non-empty subindex
+        void nextSlot()
+        {
+            while( ++m_slot < MaxSubIndices )
+            {
+                const SUBINDEX_PTR& sub = m_index->m_subIndices[m_slot];
+
+                if( sub && !sub->m_items.empty() )
+                {
+                    m_item = sub->m_items.begin();
+                    return;
+                }
+            }
+        }
+
+        const INDEX*                m_index;
+        int                         m_slot;
+        ITEM_SET::const_iterator    m_item;
+    };
+
     INDEX();
+
+    /**
+     * Creates a copy of aOther, sharing its storage until one of the two indices is
+     * modified.
+     */
+    INDEX( const INDEX& aOther );
+
     ~INDEX();
 
     /**
@@ -118,7 +209,7 @@ public:
      *
      * Returns list of all items in a given net.
      */
-    NET_ITEMS_LIST* GetItemsForNet( int aNet );
+    const NET_ITEMS_LIST* GetItemsForNet( int aNet ) const;
 
     /**
      * Function Contains()
@@ -127,7 +218,12 @@ public:
      */
     bool Contains( ITEM* aItem ) const
     {
-        return m_allItems.find( aItem ) != m_allItems.end();
+        int idx_n = subindexNumber( aItem );
+
+        if( idx_n < 0 || !m_subIndices[idx_n] )
+            return false;
+
+        return m_subIndices[idx_n]->m_items.count( aItem ) != 0;
     }
 
     /**
@@ -135,36 +231,43 @@ public:
      *
      * Returns number of items stored in the index.
      */
-    int Size() const { return m_allItems.size(); }
+    int Size() const { return m_itemCount; }
 
-    ITEM_SET::iterator begin() { return m_allItems.begin(); }
-    ITEM_SET::iterator end() { return m_allItems.end(); }
+    ITERATOR begin() const { return ITERATOR( this, false ); }
+    ITERATOR end() const { return ITERATOR( this, true ); }
 
 private:
-    static const int    MaxSubIndices   = 128;
-    static const int    SI_Multilayer   = 2;
-    static const int    SI_SegDiagonal  = 0;
-    static const int    SI_SegStraight  = 1;
-    static const int    SI_Traces       = 3;
-    static const int    SI_PadsTop      = 0;
-    static const int    SI_PadsBottom   = 1;
+    INDEX& operator=( const INDEX& ) = delete;
 
     template <class Visitor>
     int querySingle( int index, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor );
 
-    ITEM_SHAPE_INDEX* getSubindex( const ITEM* aItem );
+    ///> Returns the number of the subindex holding aItem, or -1 for unindexed items.
+    int subindexNumber( const ITEM* aItem ) const;
+
+    ///> Returns subindex aIndex, ready for modification: it is created if it does not
+    ///> exist yet, and copied if it is shared with another index.
+    SUBINDEX* writableSubindex( int aIndex );
 
-    ITEM_SHAPE_INDEX* m_subIndices[MaxSubIndices];
-    std::map<int, NET_ITEMS_LIST> m_netMap;
-    ITEM_SET m_allItems;
+    SUBINDEX_PTR m_subIndices[MaxSubIndices];
+    std::map<int, NET_ITEMS_PTR> m_netMap;
+    int m_itemCount;
 };
 
-INDEX::INDEX()
+INDEX::INDEX() :
+    m_itemCount( 0 )
 {
-    memset( m_subIndices, 0, sizeof( m_subIndices ) );
 }
 
-INDEX::ITEM_SHAPE_INDEX* INDEX::getSubindex( const ITEM* aItem )
+INDEX::INDEX( const INDEX& aOther ) :
+    m_netMap( aOther.m_netMap ),
+    m_itemCount( aOther.m_itemCount )
+{
+    for( int i = 0; i < MaxSubIndices; ++i )
+        m_subIndices[i] = aOther.m_subIndices[i];
+}
+
+int INDEX::subindexNumber( const ITEM* aItem ) const
 {
     int idx_n = -1;
 
@@ -202,45 +305,88 @@ INDEX::ITEM_SHAPE_INDEX* INDEX::getSubindex( const ITEM* aItem )
     {
         wxASSERT( idx_n >= 0 );
         wxASSERT( idx_n < MaxSubIndices );
-        return nullptr;
+        return -1;
+    }
+
+    return idx_n;
+}
+
+INDEX::SUBINDEX* INDEX::writableSubindex( int aIndex )
+{
+    SUBINDEX_PTR& sub = m_subIndices[aIndex];
+
+    if( !sub )
+    {
+        sub = std::make_shared<SUBINDEX>();
     }
+    else if( sub.use_count() > 1 )
+    {
+        SUBINDEX_PTR copy = std::make_shared<SUBINDEX>();
+
+        for( ITEM* item : sub->m_items )
+            copy->m_shapes.Add( item );
 
-    if( !m_subIndices[idx_n] )
-        m_subIndices[idx_n] = new ITEM_SHAPE_INDEX;
+        copy->m_items = sub->m_items;
+        sub = copy;
+    }
 
-    return m_subIndices[idx_n];
+    return sub.get();
 }
 
 void INDEX::Add( ITEM* aItem )
 {
-    ITEM_SHAPE_INDEX* idx = getSubindex( aItem );
+    int idx_n = subindexNumber( aItem );
 
-    if( !idx )
+    if( idx_n < 0 )
         return;
 
-    idx->Add( aItem );
-    m_allItems.insert( aItem );
+    SUBINDEX* sub = writableSubindex( idx_n );
+
+    if( !sub->m_items.insert( aItem ).second )
+        return;
+
+    sub->m_shapes.Add( aItem );
+    m_itemCount++;
+
     int net = aItem->Net();
 
     if( net >= 0 )
     {
-        m_netMap[net].push_back( aItem );
+        NET_ITEMS_PTR& list = m_netMap[net];
+
+        if( !list )
+            list = std::make_shared<NET_ITEMS_LIST>();
+        else if( list.use_count() > 1 )
+            list = std::make_shared<NET_ITEMS_LIST>( *list );
+
+        list->push_back( aItem );
     }
 }
 
 void INDEX::Remove( ITEM* aItem )
 {
-    ITEM_SHAPE_INDEX* idx = getSubindex( aItem );
-
-    if( !idx )
+    // Do not copy shared parts for an item that is not here
+    if( !Contains( aItem ) )
         return;
 
-    idx->Remove( aItem );
-    m_allItems.erase( aItem );
+    SUBINDEX* sub = writableSubindex( subindexNumber( aItem ) );
+
+    sub->m_shapes.Remove( aItem );
+    sub->m_items.erase( aItem );
+    m_itemCount--;
+
     int net = aItem->Net();
+    auto f = m_netMap.find( net );
+
+    if( net >= 0 && f != m_netMap.end() )
+    {
+        NET_ITEMS_PTR& list = f->second;
+
+        if( list.use_count() > 1 )
+            list = std::make_shared<NET_ITEMS_LIST>( *list );
 
-    if( net >= 0 && m_netMap.find( net ) != m_netMap.end() )
-        m_netMap[net].remove( aItem );
+        list->remove( aItem );
+    }
 }
 
 void INDEX::Replace( ITEM* aOldItem, ITEM* aNewItem )
@@ -255,7 +401,7 @@ int INDEX::querySingle( int index, const SHAPE* aShape, int aMinDistance, Visito
     if( !m_subIndices[index] )
         return 0;
 
-    return m_subIndices[index]->Query( aShape, aMinDistance, aVisitor, false );
+    return m_subIndices[index]->m_shapes.Query( aShape, aMinDistance, aVisitor, false );
 }
 
 template<class Visitor>
@@ -305,14 +451,10 @@ int INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
 void INDEX::Clear()
 {
     for( int i = 0; i < MaxSubIndices; ++i )
-    {
-        ITEM_SHAPE_INDEX* idx = m_subIndices[i];
-
-        if( idx )
-            delete idx;
+        m_subIndices[i].reset();
 
-        m_subIndices[i] = NULL;
-    }
+    m_netMap.clear();
+    m_itemCount = 0;
 }
 
 INDEX::~INDEX()
@@ -320,12 +462,14 @@ INDEX::~INDEX()
     Clear();
 }
 
-INDEX::NET_ITEMS_LIST* INDEX::GetItemsForNet( int aNet )
+const INDEX::NET_ITEMS_LIST* INDEX::GetItemsForNet( int aNet ) const
 {
-    if( m_netMap.find( aNet ) == m_netMap.end() )
+    auto f = m_netMap.find( aNet );
+
+    if( f == m_netMap.end() )
         return NULL;
 
-    return &m_netMap[aNet];
+    return f->second.get();
 }
 
 }
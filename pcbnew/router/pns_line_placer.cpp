@@ -352,21 +352,18 @@ bool LINE_PLACER::mergeHead()
 }
 
 
-bool LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, LINE& aNewHead )
+bool LINE_PLACER::walkaroundHead( NODE* aNode, const LINE& aInitialTrack, bool aViaOk,
+                                  LINE& aWalkPath )
 {
-    LINE initTrack( m_head );
     LINE walkFull;
     int effort = 0;
-    bool rv = true, viaOk;
-
-    viaOk = buildInitialLine( aP, initTrack );
 
-    WALKAROUND walkaround( m_currentNode, Router() );
+    WALKAROUND walkaround( aNode, Router() );
 
     walkaround.SetSolidsOnly( false );
     walkaround.SetIterationLimit( Settings().WalkaroundIterationLimit() );
 
-    WALKAROUND::WALKAROUND_STATUS wf = walkaround.Route( initTrack, walkFull, false );
+    WALKAROUND::WALKAROUND_STATUS wf = walkaround.Route( aInitialTrack, walkFull, false );
 
     switch( Settings().OptimizerEffort() )
     {
@@ -385,17 +382,31 @@ bool LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, LINE& aNewHead )
 
     if( wf == WALKAROUND::STUCK )
     {
-        walkFull = walkFull.ClipToNearestObstacle( m_currentNode );
-        rv = true;
+        walkFull = walkFull.ClipToNearestObstacle( aNode );
     }
-    else if( m_placingVia && viaOk )
+    else if( m_placingVia && aViaOk )
     {
         walkFull.AppendVia( makeVia( walkFull.CPoint( -1 ) ) );
     }
 
-    OPTIMIZER::Optimize( &walkFull, effort, m_currentNode );
+    OPTIMIZER::Optimize( &walkFull, effort, aNode );
+
+    if( aNode->CheckColliding( &walkFull ) )
+        return false;
+
+    aWalkPath = walkFull;
+    return true;
+}
+
 
-    if( m_currentNode->CheckColliding( &walkFull ) )
+bool LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, LINE& aNewHead )
+{
+    LINE initTrack( m_head );
+    LINE walkFull;
+
+    bool viaOk = buildInitialLine( aP, initTrack );
+
+    if( !walkaroundHead( m_currentNode, initTrack, viaOk, walkFull ) )
     {
         aNewHead = m_head;
         return false;
@@ -404,7 +415,7 @@ bool LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, LINE& aNewHead )
     m_head = walkFull;
     aNewHead = walkFull;
 
-    return rv;
+    return true;
 }
 
 
@@ -417,7 +428,7 @@ bool LINE_PLACER::rhMarkObstacles( const VECTOR2I& aP, LINE& aNewHead )
     if( obs )
     {
         int cl = m_currentNode->GetClearance( obs->m_item, &m_head );
-        auto hull = obs->m_item->Hull( cl, m_head.Width() );
+        auto hull = m_currentNode->GetHull( obs->m_item, cl, m_head.Width() );
 
         auto nearest = hull.NearestPoint( aP );
         Dbg()->AddLine( hull, 2, 10000 );
@@ -623,6 +634,63 @@ bool LINE_PLACER::rhShoveOnly( const VECTOR2I& aP, LINE& aNewHead )
 }
 
 
+bool LINE_PLACER::rhSmart( const VECTOR2I& aP, LINE& aNewHead )
+{
+    // A walkaround is preferred, as it leaves the other tracks alone, unless its path is
+    // this much longer than the shoved one
+    const double maxWalkaroundLengthRatio = 1.5;
+
+    NODE* base = m_shove->CurrentNode();
+    LINE initTrack( m_head );
+    LINE walkHead, shoveHead;
+    bool walkOk = false;
+
+    bool viaOk = buildInitialLine( aP, initTrack );
+
+    // The shove leaves the nodes it releases alive until the speculation ends, so the
+    // walkaround can read the base node while the shove runs
+    m_shove->BeginSpeculation();
+
+    auto walk = [&]() {
+        walkOk = walkaroundHead( base, initTrack, viaOk, walkHead );
+    };
+
+    bool shoveOk = false;
+
+    auto shove = [&]() {
+        shoveOk = rhShoveOnly( aP, shoveHead );
+    };
+
+    Router()->Worker().Run( walk, shove );
+
+    bool walkDone = walkOk && walkHead.PointCount() > 0
+                    && walkHead.CPoint( -1 ) == initTrack.CPoint( -1 );
+
+    bool useWalk;
+
+    if( walkDone && shoveOk )
+        useWalk = walkHead.CLine().Length()
+                  <= shoveHead.CLine().Length() * maxWalkaroundLengthRatio;
+    else
+        useWalk = walkOk && !shoveOk;
+
+    if( !useWalk )
+    {
+        m_shove->AcceptSpeculation();
+        aNewHead = shoveHead;
+        return shoveOk;
+    }
+
+    m_shove->RollbackSpeculation();
+    m_currentNode = m_shove->CurrentNode();
+
+    m_head = walkHead;
+    aNewHead = walkHead;
+
+    return true;
+}
+
+
 bool LINE_PLACER::routeHead( const VECTOR2I& aP, LINE& aNewHead )
 {
     switch( m_currentMode )
@@ -633,6 +701,8 @@ bool LINE_PLACER::routeHead( const VECTOR2I& aP, LINE& aNewHead )
         return rhWalkOnly( aP, aNewHead );
     case RM_Shove:
         return rhShoveOnly( aP, aNewHead );
+    case RM_Smart:
+        return rhSmart( aP, aNewHead );
     default:
         break;
     }
@@ -346,6 +346,20 @@ private:
     ///> route step, shove mode
     bool rhShoveOnly( const VECTOR2I& aP, LINE& aNewHead);
 
+    ///> route step, smart mode: tries shoving and walking around at the same time and
+    ///> keeps the walkaround unless it is much longer than the shoved head
+    bool rhSmart( const VECTOR2I& aP, LINE& aNewHead );
+
+    /**
+     * Function walkaroundHead()
+     *
+     * Walks aInitialTrack around the obstacles of aNode and optimizes the result.  Does not
+     * change the placer state, so it can run in a thread while the placer shoves.
+     * @return false if the walked line still collides.
+     */
+    bool walkaroundHead( NODE* aNode, const LINE& aInitialTrack, bool aViaOk,
+                         LINE& aWalkPath );
+
     ///> route step, mark obstacles mode
     bool rhMarkObstacles( const VECTOR2I& aP, LINE& aNewHead );
 
@@ -32,6 +32,8 @@
 #include <geometry/shape_circle.h>
 #include <geometry/shape_convex.h>
 
+#include <fstream>
+
 namespace PNS {
 
 LOGGER::LOGGER( )
@@ -49,6 +51,7 @@ void LOGGER::Clear()
 {
     m_theLog.str( std::string() );
     m_groupOpened = false;
+    m_events.clear();
 }
 
 
@@ -205,4 +208,97 @@ void LOGGER::Save( const std::string& aFilename )
     fclose( f );
 }
 
+
+
+void LOGGER::LogEvent( EVENT_TYPE aType, const VECTOR2I& aP, const ITEM* aItem,
+                       int aArg0, int aArg1, int aArg2 )
+{
+    EVENT_ENTRY ent;
+
+    ent.type = aType;
+    ent.p = aP;
+    ent.args[0] = aArg0;
+    ent.args[1] = aArg1;
+    ent.args[2] = aArg2;
+    ent.itemKind = 0;
+    ent.itemNet = 0;
+    ent.itemLayerStart = 0;
+    ent.itemLayerEnd = 0;
+
+    if( aItem )
+    {
+        ent.itemKind = aItem->Kind();
+        ent.itemNet = aItem->Net();
+        ent.itemLayerStart = aItem->Layers().Start();
+        ent.itemLayerEnd = aItem->Layers().End();
+
+        for( int i = 0; i < 2; i++ )
+            ent.itemAnchors[i] = aItem->AnchorCount() > i ? aItem->Anchor( i )
+                                                          : aItem->Anchor( 0 );
+    }
+
+    m_events.push_back( ent );
+}
+
+
+bool LOGGER::SaveEvents( const std::string& aFilename ) const
+{
+    FILE* f = fopen( aFilename.c_str(), "wb" );
+
+    wxLogTrace( "PNS", "Saving events to '%s' [%p]", aFilename.c_str(), f );
+
+    if( !f )
+        return false;
+
+    for( const EVENT_ENTRY& ent : m_events )
+    {
+        fprintf( f, "event %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
+                 (int) ent.type, ent.p.x, ent.p.y, ent.args[0], ent.args[1], ent.args[2],
+                 ent.itemKind, ent.itemNet, ent.itemLayerStart, ent.itemLayerEnd,
+                 ent.itemAnchors[0].x, ent.itemAnchors[0].y,
+                 ent.itemAnchors[1].x, ent.itemAnchors[1].y );
+    }
+
+    fclose( f );
+    return true;
+}
+
+
+bool LOGGER::LoadEvents( const std::string& aFilename, std::vector<EVENT_ENTRY>& aEvents )
+{
+    std::ifstream f( aFilename.c_str() );
+
+    if( !f )
+        return false;
+
+    std::string line;
+
+    while( std::getline( f, line ) )
+    {
+        std::istringstream ss( line );
+        std::string        tag;
+        int                type;
+        EVENT_ENTRY        ent;
+
+        if( !( ss >> tag ) )
+            continue;       // empty line
+
+        if( tag != "event" )
+            return false;
+
+        ss >> type >> ent.p.x >> ent.p.y >> ent.args[0] >> ent.args[1] >> ent.args[2]
+           >> ent.itemKind >> ent.itemNet >> ent.itemLayerStart >> ent.itemLayerEnd
+           >> ent.itemAnchors[0].x >> ent.itemAnchors[0].y
+           >> ent.itemAnchors[1].x >> ent.itemAnchors[1].y;
+
+        if( ss.fail() || type < EVT_START_ROUTE || type > EVT_SIZES )
+            return false;
+
+        ent.type = (EVENT_TYPE) type;
+        aEvents.push_back( ent );
+    }
+
+    return true;
+}
+
 }
@@ -39,6 +39,39 @@ class ITEM;
 class LOGGER
 {
 public:
+    ///> Router events which can be recorded and replayed
+    enum EVENT_TYPE
+    {
+        EVT_START_ROUTE = 0,
+        EVT_START_DRAG,
+        EVT_MOVE,
+        EVT_FIX,
+        EVT_STOP,
+        EVT_SWITCH_LAYER,
+        EVT_FLIP_POSTURE,
+        EVT_TOGGLE_VIA,
+        EVT_SIZES
+    };
+
+    /**
+     * Struct EVENT_ENTRY
+     * A single router call, with the item it was given.  Items are not stored by
+     * address: they are described by their kind, net, layers and anchors, so they can
+     * be found again in a world built from the same board.
+     */
+    struct EVENT_ENTRY
+    {
+        EVENT_TYPE type;
+        VECTOR2I   p;
+        int        args[3];     ///< layer, drag mode, sizes... depending on the type
+
+        int        itemKind;    ///< 0 if the event has no item
+        int        itemNet;
+        int        itemLayerStart;
+        int        itemLayerEnd;
+        VECTOR2I   itemAnchors[2];
+    };
+
     LOGGER();
     ~LOGGER();
 
@@ -53,11 +86,34 @@ public:
     void Log( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aKind = 0,
               const std::string& aName = std::string() );
 
+    /**
+     * Function LogEvent()
+     * Records a router event.  Events are kept apart from the logged shapes and
+     * saved with SaveEvents().
+     */
+    void LogEvent( EVENT_TYPE aType, const VECTOR2I& aP, const ITEM* aItem = nullptr,
+                   int aArg0 = 0, int aArg1 = 0, int aArg2 = 0 );
+
+    const std::vector<EVENT_ENTRY>& Events() const
+    {
+        return m_events;
+    }
+
+    bool SaveEvents( const std::string& aFilename ) const;
+
+    /**
+     * Function LoadEvents()
+     * Reads back the events written by SaveEvents().
+     * @return false if the file cannot be read or is malformed.
+     */
+    static bool LoadEvents( const std::string& aFilename, std::vector<EVENT_ENTRY>& aEvents );
+
 private:
     void dumpShape( const SHAPE* aSh );
 
     bool m_groupOpened;
     std::stringstream m_theLog;
+    std::vector<EVENT_ENTRY> m_events;
 };
 
 }
@@ -0,0 +1,243 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+
+#include "pns_node.h"
+#include "pns_line.h"
+#include "pns_segment.h"
+#include "pns_router.h"
+#include "pns_meander_batch.h"
+
+namespace PNS {
+
+MEANDER_BATCH::MEANDER_BATCH( ROUTER* aRouter ) :
+    ALGO_BASE( aRouter )
+{
+    m_targetLength = 0;
+    m_merged = NULL;
+}
+
+
+MEANDER_BATCH::~MEANDER_BATCH()
+{
+    clear();
+}
+
+
+void MEANDER_BATCH::clear()
+{
+    // the placer branches and the merged node are all children of the world
+    Router()->GetWorld()->KillChildren();
+
+    m_merged = NULL;
+    m_targetLength = 0;
+    m_results.clear();
+}
+
+
+SEGMENT* MEANDER_BATCH::longestTrack( int aNet, VECTOR2I& aStart, VECTOR2I& aEnd ) const
+{
+    NODE* world = Router()->GetWorld();
+    SEGMENT* longest = NULL;
+    int maxLength = 0;
+
+    std::set<ITEM*> netItems;
+    std::set<SEGMENT*> visited;
+
+    world->AllItemsInNet( aNet, netItems );
+
+    for( ITEM* item : netItems )
+    {
+        SEGMENT* seg = dyn_cast<SEGMENT*>( item );
+
+        if( !seg || visited.count( seg ) || seg->IsLocked() )
+            continue;
+
+        LINE line = world->AssembleLine( seg );
+
+        for( SEGMENT* s : line.LinkedSegments() )
+            visited.insert( s );
+
+        if( line.CLine().Length() > maxLength )
+        {
+            maxLength = line.CLine().Length();
+            longest = seg;
+            aStart = line.CPoint( 0 );
+            aEnd = line.CPoint( -1 );
+        }
+    }
+
+    return longest;
+}
+
+
+bool MEANDER_BATCH::startTuner( NET_TUNER& aTuner, NODE* aBase )
+{
+    aTuner.m_placer.reset( new MEANDER_PLACER( Router() ) );
+    aTuner.m_placer->SetBaseNode( aBase );
+    aTuner.m_placer->UpdateSettings( m_settings );
+
+    if( !aTuner.m_placer->Start( aTuner.m_start, aTuner.m_segment ) )
+    {
+        aTuner.m_placer.reset();
+        return false;
+    }
+
+    return true;
+}
+
+
+bool MEANDER_BATCH::Run( const std::vector<int>& aNets )
+{
+    clear();
+
+    NODE* world = Router()->GetWorld();
+    std::vector<NET_TUNER> tuners( aNets.size() );
+
+    // Branching a node is not thread safe: all the placers are started beforehand.
+    int longest = 0;
+
+    for( size_t i = 0; i < aNets.size(); i++ )
+    {
+        NET_TUNER& tuner = tuners[i];
+
+        tuner.m_segment = longestTrack( aNets[i], tuner.m_start, tuner.m_end );
+
+        if( tuner.m_segment && startTuner( tuner, world ) )
+            longest = std::max( longest, tuner.m_placer->OriginalLength() );
+    }
+
+    m_targetLength = std::max( m_settings.m_targetLength, longest );
+    m_settings.m_targetLength = m_targetLength;
+
+    for( NET_TUNER& tuner : tuners )
+    {
+        if( tuner.m_placer )
+            tuner.m_placer->UpdateSettings( m_settings );
+    }
+
+    // Meander the whole track of each net.  The placers only read the world and their
+    // own branches, so they can run concurrently.
+    size_t threadCount = std::thread::hardware_concurrency();
+    threadCount = std::max<size_t>( std::min( threadCount, tuners.size() ), 1 );
+
+    std::atomic_size_t nextTuner( 0 );
+    std::vector<std::thread> workers;
+
+    for( size_t ii = 0; ii < threadCount; ++ii )
+    {
+        workers.push_back( std::thread( [ &tuners, &nextTuner ]()
+        {
+            for( size_t i = nextTuner.fetch_add( 1 ); i < tuners.size();
+                 i = nextTuner.fetch_add( 1 ) )
+            {
+                if( tuners[i].m_placer )
+                    tuners[i].m_placer->Move( tuners[i].m_end, NULL );
+            }
+        } ) );
+    }
+
+    for( std::thread& worker : workers )
+        worker.join();
+
+    // Merge the results, in the order of the nets, so the outcome does not depend on
+    // the thread scheduling.
+    m_merged = world->Branch();
+
+    bool changed = false;
+
+    for( size_t i = 0; i < aNets.size(); i++ )
+    {
+        RESULT result;
+
+        result.m_net = aNets[i];
+        result.m_originalLength = 0;
+        result.m_length = 0;
+        result.m_changed = false;
+        result.m_retuned = false;
+        result.m_status = MEANDER_PLACER_BASE::TOO_SHORT;
+
+        if( tuners[i].m_placer )
+            mergeTuner( tuners[i], result );
+
+        changed |= result.m_changed;
+        m_results.push_back( result );
+    }
+
+    return changed;
+}
+
+
+void MEANDER_BATCH::mergeTuner( NET_TUNER& aTuner, RESULT& aResult )
+{
+    LINE origin = m_merged->AssembleLine( aTuner.m_segment );
+    LINE tuned( *static_cast<LINE*>( aTuner.m_placer->Traces()[0] ) );
+
+    // The meanders were laid out next to the original tracks of the other nets.  If
+    // they hit the meanders of a net merged before, tune the net again on top of them.
+    // Items of the same net never collide, so the original track is not in the way.
+    if( m_merged->CheckColliding( &tuned ) )
+    {
+        aResult.m_retuned = true;
+
+        if( !startTuner( aTuner, m_merged ) )
+            return;
+
+        aTuner.m_placer->Move( aTuner.m_end, NULL );
+        tuned = *static_cast<LINE*>( aTuner.m_placer->Traces()[0] );
+    }
+
+    aResult.m_originalLength = aTuner.m_placer->OriginalLength();
+    aResult.m_length = aTuner.m_placer->TunedLength();
+    aResult.m_status = aTuner.m_placer->TuningStatus();
+
+    if( tuned.CLine().Length() == origin.CLine().Length() )
+    {
+        aResult.m_length = aResult.m_originalLength;
+        return;
+    }
+
+    m_merged->Remove( origin );
+    m_merged->Add( tuned );
+
+    aResult.m_changed = true;
+}
+
+
+void MEANDER_BATCH::Commit()
+{
+    if( !m_merged )
+        return;
+
+    // Committing also frees all the branches of the world
+    Router()->CommitRouting( m_merged );
+    m_merged = NULL;
+
+    for( const RESULT& result : m_results )
+    {
+        if( result.m_changed )
+            Router()->GetInterface()->UpdateNet( result.m_net );
+    }
+}
+
+}
@@ -0,0 +1,142 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_MEANDER_BATCH_H
+#define __PNS_MEANDER_BATCH_H
+
+#include <memory>
+#include <vector>
+
+#include <math/vector2d.h>
+
+#include "pns_algo_base.h"
+#include "pns_meander.h"
+#include "pns_meander_placer.h"
+
+namespace PNS {
+
+class ROUTER;
+class NODE;
+class SEGMENT;
+
+/**
+ * Class MEANDER_BATCH
+ *
+ * Tunes the length of a set of nets at once, for instance the nets of a memory byte
+ * lane that have to be matched.  The longest track of each net is meandered by its own
+ * MEANDER_PLACER, in its own branch of the world, and the nets are processed in parallel.
+ *
+ * The results are then merged into a single node, in the order the nets were given.
+ * A net whose meanders collide with the ones merged before is tuned again on top of
+ * them.  The merged node is committed to the board as a single change.
+ *
+ * The router must be idle while the batch is in use.
+ */
+class MEANDER_BATCH : public ALGO_BASE
+{
+public:
+    ///> Outcome of the tuning of one net
+    struct RESULT
+    {
+        int  m_net;
+        int  m_originalLength;     ///< length of the net path before tuning
+        int  m_length;             ///< length of the net path after tuning
+        bool m_changed;            ///< meanders have been added to the net
+        bool m_retuned;            ///< the net was tuned again because of a collision
+        MEANDER_PLACER_BASE::TUNING_STATUS m_status;
+    };
+
+    MEANDER_BATCH( ROUTER* aRouter );
+    ~MEANDER_BATCH();
+
+    /**
+     * Function SetSettings()
+     *
+     * Sets the meandering configuration used for all nets.
+     */
+    void SetSettings( const MEANDER_SETTINGS& aSettings )
+    {
+        m_settings = aSettings;
+    }
+
+    /**
+     * Function Run()
+     *
+     * Tunes the nets aNets.  Meanders can only make a net longer, so the target length
+     * is raised to the length of the longest net when it is shorter.
+     * @return true if at least one net got meanders
+     */
+    bool Run( const std::vector<int>& aNets );
+
+    /**
+     * Function Commit()
+     *
+     * Commits the tuned tracks of the last Run() to the board, as a single change.
+     */
+    void Commit();
+
+    ///> Returns the per net results of the last Run(), in the order of the nets
+    const std::vector<RESULT>& Results() const
+    {
+        return m_results;
+    }
+
+    ///> Returns the length the nets were tuned to in the last Run()
+    int TargetLength() const
+    {
+        return m_targetLength;
+    }
+
+private:
+    ///> Working state of one net
+    struct NET_TUNER
+    {
+        NET_TUNER() :
+            m_segment( NULL )
+        {}
+
+        SEGMENT* m_segment;        ///< a segment of the track to meander
+        VECTOR2I m_start;          ///< the ends of that track
+        VECTOR2I m_end;
+        std::unique_ptr<MEANDER_PLACER> m_placer;
+    };
+
+    ///> Finds the longest track of aNet in the world, and its ends.
+    SEGMENT* longestTrack( int aNet, VECTOR2I& aStart, VECTOR2I& aEnd ) const;
+
+    ///> Creates the placer of aTuner, working in a branch of aBase.
+    bool startTuner( NET_TUNER& aTuner, NODE* aBase );
+
+    ///> Replaces in the merged node the track of aTuner by its meandered version.
+    void mergeTuner( NET_TUNER& aTuner, RESULT& aResult );
+
+    void clear();
+
+    MEANDER_SETTINGS    m_settings;
+    int                 m_targetLength;
+
+    ///> all the tuned tracks, in a branch of the world
+    NODE*               m_merged;
+
+    std::vector<RESULT> m_results;
+};
+
+}
+
+#endif    // __PNS_MEANDER_BATCH_H
@@ -33,6 +33,7 @@ namespace PNS {
 MEANDER_PLACER::MEANDER_PLACER( ROUTER* aRouter ) :
     MEANDER_PLACER_BASE( aRouter )
 {
+    m_baseNode = NULL;
     m_world = NULL;
     m_currentNode = NULL;
 
@@ -74,7 +75,7 @@ bool MEANDER_PLACER::Start( const VECTOR2I& aP, ITEM* aStartItem )
     m_currentNode = NULL;
     m_currentStart = p;
 
-    m_world = Router()->GetWorld()->Branch();
+    m_world = m_baseNode ? m_baseNode->Branch() : Router()->GetWorld()->Branch();
     m_originLine = m_world->AssembleLine( m_initialSegment );
 
     TOPOLOGY topo( m_world );
@@ -146,11 +147,14 @@ bool MEANDER_PLACER::doMove( const VECTOR2I& aP, ITEM* aEndItem, int aTargetLeng
         tuneLineLength( m_result, aTargetLength - lineLen );
     }
 
-    for( const ITEM* item : m_tunedPath.CItems() )
+    if( Dbg() )
     {
-        if( const LINE* l = dyn_cast<const LINE*>( item ) )
+        for( const ITEM* item : m_tunedPath.CItems() )
         {
-            Dbg()->AddLine( l->CLine(), 5, 30000 );
+            if( const LINE* l = dyn_cast<const LINE*>( item ) )
+            {
+                Dbg()->AddLine( l->CLine(), 5, 30000 );
+            }
         }
     }
 
@@ -88,6 +88,29 @@ public:
     /// @copydoc MEANDER_PLACER_BASE::CheckFit()
     bool CheckFit ( MEANDER_SHAPE* aShape ) override;
 
+    /**
+     * Function SetBaseNode()
+     *
+     * Makes Start() branch off aNode instead of the router world, so the meanders
+     * take into account changes that are not committed yet.
+     */
+    void SetBaseNode( NODE* aNode )
+    {
+        m_baseNode = aNode;
+    }
+
+    ///> Returns the length of the tuned path before meandering
+    int OriginalLength() const
+    {
+        return origPathLength();
+    }
+
+    ///> Returns the length of the tuned path after the last Move()
+    int TunedLength() const
+    {
+        return m_lastLength;
+    }
+
 protected:
 
     bool doMove( const VECTOR2I& aP, ITEM* aEndItem, int aTargetLength );
@@ -96,6 +119,9 @@ protected:
 
     virtual int origPathLength() const;
 
+    ///> node to branch the world off (the router world if NULL)
+    NODE* m_baseNode;
+
     ///> pointer to world to search colliding items
     NODE* m_world;
 
@@ -42,7 +42,9 @@
 namespace PNS {
 
 #ifdef DEBUG
+// Nodes can be queried from several threads (see WALKAROUND::Route())
 static std::unordered_set<NODE*> allocNodes;
+static std::mutex allocNodesLock;
 #endif
 
 NODE::NODE()
@@ -54,8 +56,30 @@ NODE::NODE()
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_ruleResolver = NULL;
     m_index = new INDEX;
+    m_joints = std::make_shared<JOINT_MAP>();
+    m_override = std::make_shared<ITEM_HASH_SET>();
 
 #ifdef DEBUG
+    std::lock_guard<std::mutex> lock( allocNodesLock );
+    allocNodes.insert( this );
+#endif
+}
+
+
+NODE::NODE( const NODE& aParent )
+{
+    wxLogTrace( "PNS", "NODE::create %p (sharing %p)", this, &aParent );
+    m_depth = 0;
+    m_root = this;
+    m_parent = NULL;
+    m_maxClearance = 800000;    // fixme: depends on how thick traces are.
+    m_ruleResolver = NULL;
+    m_index = new INDEX( *aParent.m_index );
+    m_joints = aParent.m_joints;
+    m_override = aParent.m_override;
+
+#ifdef DEBUG
+    std::lock_guard<std::mutex> lock( allocNodesLock );
     allocNodes.insert( this );
 #endif
 }
@@ -72,21 +96,25 @@ NODE::~NODE()
     }
 
 #ifdef DEBUG
-    if( allocNodes.find( this ) == allocNodes.end() )
     {
-        wxLogTrace( "PNS", "attempting to free an already-free'd node." );
-        assert( false );
-    }
+        std::lock_guard<std::mutex> lock( allocNodesLock );
 
-    allocNodes.erase( this );
+        if( allocNodes.find( this ) == allocNodes.end() )
+        {
+            wxLogTrace( "PNS", "attempting to free an already-free'd node." );
+            assert( false );
+        }
+
+        allocNodes.erase( this );
+    }
 #endif
 
-    m_joints.clear();
+    m_joints.reset();
 
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    for( ITEM* item : *m_index )
     {
-        if( (*i)->BelongsTo( this ) )
-            delete *i;
+        if( item->BelongsTo( this ) )
+            delete item;
     }
 
     releaseGarbage();
@@ -106,7 +134,10 @@ int NODE::GetClearance( const ITEM* aA, const ITEM* aB ) const
 
 NODE* NODE::Branch()
 {
-    NODE* child = new NODE;
+    // immmediate offspring of the root branch needs not copy anything.
+    // For the rest, share the index, joints and overridden item set with
+    // this node: they are copied on the first modification.
+    NODE* child = isRoot() ? new NODE : new NODE( *this );
 
     wxLogTrace( "PNS", "NODE::branch %p (parent %p)", child, this );
 
@@ -117,22 +148,8 @@ NODE* NODE::Branch()
     child->m_ruleResolver = m_ruleResolver;
     child->m_root = isRoot() ? this : m_root;
 
-    // immmediate offspring of the root branch needs not copy anything.
-    // For the rest, deep-copy joints, overridden item map and pointers
-    // to stored items.
-    if( !isRoot() )
-    {
-        JOINT_MAP::iterator j;
-
-        for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-            child->m_index->Add( *i );
-
-        child->m_joints = m_joints;
-        child->m_override = m_override;
-    }
-
     wxLogTrace( "PNS", "%d items, %d joints, %d overrides",
-            child->m_index->Size(), (int) child->m_joints.size(), (int) child->m_override.size() );
+            child->m_index->Size(), (int) child->m_joints->size(), (int) child->m_override->size() );
 
     return child;
 }
@@ -279,7 +296,10 @@ int NODE::QueryColliding( const ITEM* aItem,
     DEFAULT_OBSTACLE_VISITOR visitor( aObstacles, aItem, aKindMask, aDifferentNetsOnly );
 
 #ifdef DEBUG
-    assert( allocNodes.find( this ) != allocNodes.end() );
+    {
+        std::lock_guard<std::mutex> lock( allocNodesLock );
+        assert( allocNodes.find( this ) != allocNodes.end() );
+    }
 #endif
 
     visitor.SetCountLimit( aLimitCount );
@@ -341,7 +361,7 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aItem, int aKindMask,
 
         int clearance = GetClearance( obs.m_item, &aLine );
 
-        SHAPE_LINE_CHAIN hull = obs.m_item->Hull( clearance, aItem->Width() );
+        SHAPE_LINE_CHAIN hull = GetHull( obs.m_item, clearance, aItem->Width() );
 
         if( aLine.EndsWithVia() )
         {
@@ -501,6 +521,60 @@ struct HIT_VISITOR : public OBSTACLE_VISITOR
 };
 
 
+const SHAPE_LINE_CHAIN NODE::GetHull( const ITEM* aItem, int aClearance,
+                                      int aWalkaroundThickness )
+{
+    NODE* owner = aItem->Owner();
+
+    // only the items stored in a node keep their geometry for their whole lifetime
+    if( !owner || !aItem->OfKind( ITEM::SEGMENT_T | ITEM::VIA_T | ITEM::SOLID_T ) )
+        return aItem->Hull( aClearance, aWalkaroundThickness );
+
+    return owner->cachedHull( aItem, aClearance, aWalkaroundThickness );
+}
+
+
+const SHAPE_LINE_CHAIN NODE::cachedHull( const ITEM* aItem, int aClearance,
+                                         int aWalkaroundThickness )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_hullCacheLock );
+
+        auto f = m_hullCache.find( aItem );
+
+        if( f != m_hullCache.end() )
+        {
+            for( const HULL_CACHE_ENTRY& entry : f->second )
+            {
+                if( entry.m_clearance == aClearance
+                        && entry.m_walkaroundThickness == aWalkaroundThickness )
+                    return entry.m_hull;
+            }
+        }
+    }
+
+    HULL_CACHE_ENTRY entry;
+
+    entry.m_clearance = aClearance;
+    entry.m_walkaroundThickness = aWalkaroundThickness;
+    entry.m_hull = aItem->Hull( aClearance, aWalkaroundThickness );
+
+    std::lock_guard<std::mutex> lock( m_hullCacheLock );
+
+    m_hullCache[aItem].push_back( entry );
+
+    return entry.m_hull;
+}
+
+
+void NODE::invalidateHull( const ITEM* aItem )
+{
+    std::lock_guard<std::mutex> lock( m_hullCacheLock );
+
+    m_hullCache.erase( aItem );
+}
+
+
 const ITEM_SET NODE::HitTest( const VECTOR2I& aPoint ) const
 {
     ITEM_SET items;
@@ -639,7 +713,7 @@ void NODE::doRemove( ITEM* aItem )
     // case 1: removing an item that is stored in the root node from any branch:
     // mark it as overridden, but do not remove
     if( aItem->BelongsTo( m_root ) && !isRoot() )
-        m_override.insert( aItem );
+        unshare( m_override ).insert( aItem );
 
     // case 2: the item belongs to this branch or a parent, non-root branch,
     // or the root itself and we are the root: remove from the index
@@ -649,6 +723,7 @@ void NODE::doRemove( ITEM* aItem )
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
     {
+        invalidateHull( aItem );
         aItem->SetOwner( NULL );
         m_root->m_garbageItems.insert( aItem );
     }
@@ -678,13 +753,15 @@ void NODE::removeViaIndex( VIA* aVia )
     tag.net = net;
     tag.pos = p;
 
+    JOINT_MAP& joints = unshare( m_joints );
+
     bool split;
     do
     {
         split = false;
-        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range = m_joints.equal_range( tag );
+        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         // find and remove all joints containing the via to be removed
@@ -693,7 +770,7 @@ void NODE::removeViaIndex( VIA* aVia )
         {
             if( aVia->LayersOverlap( &f->second ) )
             {
-                m_joints.erase( f );
+                joints.erase( f );
                 split = true;
                 break;
             }
@@ -972,12 +1049,12 @@ JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
+    JOINT_MAP::iterator f = m_joints->find( tag ), end = m_joints->end();
 
     if( f == end && !isRoot() )
     {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
+        end = m_root->m_joints->end();
+        f = m_root->m_joints->find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
     }
 
     if( f == end )
@@ -1009,18 +1086,20 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     tag.pos = aPos;
     tag.net = aNet;
 
+    JOINT_MAP& joints = unshare( m_joints );
+
     // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
+    JOINT_MAP::iterator f = joints.find( tag );
 
     std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
 
     // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
+    if( f == joints.end() && !isRoot() )
     {
-        range = m_root->m_joints.equal_range( tag );
+        range = m_root->m_joints->equal_range( tag );
 
         for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
+            joints.insert( *f );
     }
 
     // now insert and combine overlapping joints
@@ -1031,9 +1110,9 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     do
     {
         merged  = false;
-        range   = m_joints.equal_range( tag );
+        range   = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         for( f = range.first; f != range.second; ++f )
@@ -1041,7 +1120,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
             if( aLayers.Overlaps( f->second.Layers() ) )
             {
                 jt.Merge( f->second );
-                m_joints.erase( f );
+                joints.erase( f );
                 merged = true;
                 break;
             }
@@ -1049,7 +1128,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     }
     while( merged );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    return joints.insert( TagJointPair( tag, jt ) )->second;
 }
 
 
@@ -1162,17 +1241,17 @@ void NODE::Dump( bool aLong )
 
 void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
 {
-    aRemoved.reserve( m_override.size() );
+    aRemoved.reserve( m_override->size() );
     aAdded.reserve( m_index->Size() );
 
     if( isRoot() )
         return;
 
-    for( ITEM* item : m_override )
+    for( ITEM* item : *m_override )
         aRemoved.push_back( item );
 
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-        aAdded.push_back( *i );
+    for( ITEM* item : *m_index )
+        aAdded.push_back( item );
 }
 
 void NODE::releaseChildren()
@@ -1208,15 +1287,14 @@ void NODE::Commit( NODE* aNode )
     if( aNode->isRoot() )
         return;
 
-    for( ITEM* item : aNode->m_override )
-    Remove( item );
+    for( ITEM* item : *aNode->m_override )
+        Remove( item );
 
-    for( INDEX::ITEM_SET::iterator i = aNode->m_index->begin();
-         i != aNode->m_index->end(); ++i )
+    for( ITEM* item : *aNode->m_index )
     {
-        (*i)->SetRank( -1 );
-        (*i)->Unmark();
-        Add( std::unique_ptr<ITEM>( *i ) );
+        item->SetRank( -1 );
+        item->Unmark();
+        Add( std::unique_ptr<ITEM>( item ) );
     }
 
     releaseChildren();
@@ -1233,7 +1311,7 @@ void NODE::KillChildren()
 
 void NODE::AllItemsInNet( int aNet, std::set<ITEM*>& aItems )
 {
-    INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aNet );
+    const INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aNet );
 
     if( l_cur )
     {
@@ -1243,32 +1321,32 @@ void NODE::AllItemsInNet( int aNet, std::set<ITEM*>& aItems )
 
     if( !isRoot() )
     {
-        INDEX::NET_ITEMS_LIST* l_root = m_root->m_index->GetItemsForNet( aNet );
+        const INDEX::NET_ITEMS_LIST* l_root = m_root->m_index->GetItemsForNet( aNet );
 
         if( l_root )
-            for( INDEX::NET_ITEMS_LIST::iterator i = l_root->begin(); i!= l_root->end(); ++i )
-                if( !Overrides( *i ) )
-                    aItems.insert( *i );
+            for( ITEM* item : *l_root )
+                if( !Overrides( item ) )
+                    aItems.insert( item );
     }
 }
 
 
 void NODE::ClearRanks( int aMarkerMask )
 {
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    for( ITEM* item : *m_index )
     {
-        (*i)->SetRank( -1 );
-        (*i)->Mark( (*i)->Marker() & (~aMarkerMask) );
+        item->SetRank( -1 );
+        item->Mark( item->Marker() & (~aMarkerMask) );
     }
 }
 
 
 int NODE::FindByMarker( int aMarker, ITEM_SET& aItems )
 {
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    for( ITEM* item : *m_index )
     {
-        if( (*i)->Marker() & aMarker )
-            aItems.Add( *i );
+        if( item->Marker() & aMarker )
+            aItems.Add( item );
     }
 
     return 0;
@@ -1279,11 +1357,11 @@ int NODE::RemoveByMarker( int aMarker )
 {
     std::list<ITEM*> garbage;
 
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    for( ITEM* item : *m_index )
     {
-        if( (*i)->Marker() & aMarker )
+        if( item->Marker() & aMarker )
         {
-            garbage.push_back( *i );
+            garbage.push_back( item );
         }
     }
 
@@ -1329,7 +1407,7 @@ SEGMENT* NODE::findRedundantSegment( SEGMENT* aSeg )
 
 ITEM *NODE::FindItemByParent( const BOARD_CONNECTED_ITEM* aParent )
 {
-    INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aParent->GetNetCode() );
+    const INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aParent->GetNetCode() );
 
     for( ITEM*item : *l_cur )
         if( item->Parent() == aParent )
@@ -26,6 +26,8 @@
 #include <list>
 #include <unordered_set>
 #include <unordered_map>
+#include <memory>
+#include <mutex>
 
 #include <core/optional.h>
 
@@ -133,6 +135,9 @@ protected:
  * - assembly of lines connecting joints, finding loops and unique paths
  * - lightweight cloning/branching (for recursive optimization and shove
  * springback)
+ *
+ * A branch shares the index, joints and overrides of the branch it was created from,
+ * and copies them only when it modifies them, so branching costs the same at any depth.
  **/
 class NODE
 {
@@ -173,7 +178,7 @@ public:
     ///> Returns the number of joints
     int JointCount() const
     {
-        return m_joints.size();
+        return m_joints->size();
     }
 
     ///> Returns the number of nodes in the inheritance chain (wrs to the root node)
@@ -257,6 +262,19 @@ public:
                          int            aKindMask = ITEM::ANY_T,
                          int            aForceClearance = -1 );
 
+    /**
+     * Function GetHull()
+     *
+     * Returns the hull of an item, as ITEM::Hull() does. The hulls of items stored in a
+     * node are cached by their owner node until the item is removed from it, so walking
+     * around or shoving the same obstacle again does not rebuild its hull.
+     * @param aItem the item
+     * @param aClearance distance between the item and its hull
+     * @param aWalkaroundThickness width of the line walking around the hull
+     * @return the hull
+     */
+    const SHAPE_LINE_CHAIN GetHull( const ITEM* aItem, int aClearance, int aWalkaroundThickness );
+
     /**
      * Function HitTest()
      *
@@ -320,6 +338,8 @@ public:
      * Creates a lightweight copy (called branch) of self that tracks
      * the changes (added/removed items) wrs to the root. Note that if there are
      * any branches in use, their parents must NOT be deleted.
+     * The branch shares the changes of this node until one of them is modified again,
+     * so branching does not depend on the number of changes already made.
      * @return the new branch
      */
     NODE* Branch();
@@ -416,16 +436,27 @@ public:
     ///> from the root branch.
     bool Overrides( ITEM* aItem ) const
     {
-        return m_override.find( aItem ) != m_override.end();
+        return m_override->find( aItem ) != m_override->end();
     }
 
 private:
     struct DEFAULT_OBSTACLE_VISITOR;
     typedef std::unordered_multimap<JOINT::HASH_TAG, JOINT, JOINT::JOINT_TAG_HASH> JOINT_MAP;
     typedef JOINT_MAP::value_type TagJointPair;
+    typedef std::unordered_set<ITEM*> ITEM_HASH_SET;
+
+    struct HULL_CACHE_ENTRY
+    {
+        int              m_clearance;
+        int              m_walkaroundThickness;
+        SHAPE_LINE_CHAIN m_hull;
+    };
+
+    typedef std::unordered_map<const ITEM*, std::vector<HULL_CACHE_ENTRY> > HULL_CACHE;
 
-    /// nodes are not copyable
-    NODE( const NODE& aB );
+    /// nodes are not copyable: the copy constructor only creates a branch of aParent,
+    /// sharing its storage. Use Branch().
+    NODE( const NODE& aParent );
     NODE& operator=( const NODE& aB );
 
     ///> tries to find matching joint and creates a new one if not found
@@ -450,6 +481,13 @@ private:
     void removeViaIndex( VIA* aVia );
 
     void doRemove( ITEM* aItem );
+
+    ///> returns the hull of aItem, owned by this node, from the hull cache
+    const SHAPE_LINE_CHAIN cachedHull( const ITEM* aItem, int aClearance,
+                                       int aWalkaroundThickness );
+
+    ///> drops the cached hulls of aItem, no longer owned by this node
+    void invalidateHull( const ITEM* aItem );
     void unlinkParent();
     void releaseChildren();
     void releaseGarbage();
@@ -459,6 +497,17 @@ private:
         return m_parent == NULL;
     }
 
+    ///> returns the object pointed by aPtr for modification, after copying it if it is
+    ///> shared with another branch
+    template <class T>
+    static T& unshare( std::shared_ptr<T>& aPtr )
+    {
+        if( aPtr.use_count() > 1 )
+            aPtr = std::make_shared<T>( *aPtr );
+
+        return *aPtr;
+    }
+
     SEGMENT* findRedundantSegment( const VECTOR2I& A, const VECTOR2I& B,
                                    const LAYER_RANGE & lr, int aNet );
     SEGMENT* findRedundantSegment( SEGMENT* aSeg );
@@ -474,8 +523,8 @@ private:
                      bool        aStopAtLockedJoints );
 
     ///> hash table with the joints, linking the items. Joints are hashed by
-    ///> their position, layer set and net.
-    JOINT_MAP m_joints;
+    ///> their position, layer set and net. Shared with the parent branch until modified.
+    std::shared_ptr<JOINT_MAP> m_joints;
 
     ///> node this node was branched from
     NODE* m_parent;
@@ -486,8 +535,9 @@ private:
     ///> list of nodes branched from this one
     std::set<NODE*> m_children;
 
-    ///> hash of root's items that have been changed in this node
-    std::unordered_set<ITEM*> m_override;
+    ///> hash of root's items that have been changed in this node.  Shared with the
+    ///> parent branch until modified.
+    std::shared_ptr<ITEM_HASH_SET> m_override;
 
     ///> worst case item-item clearance
     int m_maxClearance;
@@ -502,6 +552,12 @@ private:
     int m_depth;
 
     std::unordered_set<ITEM*> m_garbageItems;
+
+    ///> hulls of the items owned by this node, for each clearance and walkaround thickness
+    HULL_CACHE m_hullCache;
+
+    ///> the hulls of the root items are requested from all the branches
+    std::mutex m_hullCacheLock;
 };
 
 }
@@ -49,6 +49,7 @@
 #include "pns_meander_placer.h"
 #include "pns_meander_skew_placer.h"
 #include "pns_dp_meander_placer.h"
+#include "pns_logger.h"
 
 #include <router/router_preview_item.h>
 
@@ -72,6 +73,7 @@ ROUTER::ROUTER()
     m_snapshotIter = 0;
     m_violation = false;
     m_iface = nullptr;
+    m_eventLogger = nullptr;
 }
 
 
@@ -126,6 +128,9 @@ const ITEM_SET ROUTER::QueryHoverItems( const VECTOR2I& aP )
 
 bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM* aStartItem, int aDragMode )
 {
+    if( m_eventLogger )
+        m_eventLogger->LogEvent( LOGGER::EVT_START_DRAG, aP, aStartItem, aDragMode,
+                                 m_settings.Mode() );
 
     if( aDragMode & DM_FREE_ANGLE )
         m_forceMarkObstaclesMode = true;
@@ -169,6 +174,9 @@ bool ROUTER::isStartingPointRoutable( const VECTOR2I& aWhere, int aLayer )
 
 bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
 {
+    if( m_eventLogger )
+        m_eventLogger->LogEvent( LOGGER::EVT_START_ROUTE, aP, aStartItem, aLayer, m_mode,
+                                 m_settings.Mode() );
 
     if( ! isStartingPointRoutable( aP, aLayer ) )
     {
@@ -224,6 +232,9 @@ void ROUTER::DisplayItems( const ITEM_SET& aItems )
 
 void ROUTER::Move( const VECTOR2I& aP, ITEM* endItem )
 {
+    if( m_eventLogger )
+        m_eventLogger->LogEvent( LOGGER::EVT_MOVE, aP, endItem );
+
     m_currentEnd = aP;
 
     switch( m_state )
@@ -307,6 +318,10 @@ void ROUTER::updateView( NODE* aNode, ITEM_SET& aCurrent )
 
 void ROUTER::UpdateSizes( const SIZES_SETTINGS& aSizes )
 {
+    if( m_eventLogger )
+        m_eventLogger->LogEvent( LOGGER::EVT_SIZES, VECTOR2I( 0, 0 ), nullptr,
+                                 aSizes.TrackWidth(), aSizes.ViaDiameter(), aSizes.ViaDrill() );
+
     m_sizes = aSizes;
 
     // Change track/via size settings
@@ -363,6 +378,9 @@ void ROUTER::CommitRouting( NODE* aNode )
 
 bool ROUTER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem )
 {
+    if( m_eventLogger )
+        m_eventLogger->LogEvent( LOGGER::EVT_FIX, aP, aEndItem );
+
     bool rv = false;
 
     switch( m_state )
@@ -388,6 +406,9 @@ bool ROUTER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem )
 
 void ROUTER::StopRouting()
 {
+    if( m_eventLogger && RoutingInProgress() )
+        m_eventLogger->LogEvent( LOGGER::EVT_STOP, m_currentEnd );
+
     // Update the ratsnest with new changes
 
     if( m_placer )
@@ -416,6 +437,9 @@ void ROUTER::StopRouting()
 
 void ROUTER::FlipPosture()
 {
+    if( m_eventLogger )
+        m_eventLogger->LogEvent( LOGGER::EVT_FLIP_POSTURE, m_currentEnd );
+
     if( m_state == ROUTE_TRACK )
     {
         m_placer->FlipPosture();
@@ -425,6 +449,9 @@ void ROUTER::FlipPosture()
 
 void ROUTER::SwitchLayer( int aLayer )
 {
+    if( m_eventLogger )
+        m_eventLogger->LogEvent( LOGGER::EVT_SWITCH_LAYER, m_currentEnd, nullptr, aLayer );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -438,6 +465,9 @@ void ROUTER::SwitchLayer( int aLayer )
 
 void ROUTER::ToggleViaPlacement()
 {
+    if( m_eventLogger )
+        m_eventLogger->LogEvent( LOGGER::EVT_TOGGLE_VIA, m_currentEnd );
+
     if( m_state == ROUTE_TRACK )
     {
         bool toggle = !m_placer->IsPlacingVia();
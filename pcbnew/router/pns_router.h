@@ -35,6 +35,7 @@
 #include "pns_item.h"
 #include "pns_itemset.h"
 #include "pns_node.h"
+#include "pns_worker.h"
 
 namespace KIGFX
 {
@@ -58,6 +59,7 @@ class SEGMENT;
 class JOINT;
 class VIA;
 class RULE_RESOLVER;
+class LOGGER;
 class SHOVE;
 class DRAGGER;
 
@@ -160,6 +162,16 @@ public:
 
     void DumpLog();
 
+    /**
+     * Function SetEventLogger()
+     * Records the routing calls (start, move, fix...) made from now on in aLogger, so
+     * the session can be replayed.  Pass nullptr to stop recording.
+     */
+    void SetEventLogger( LOGGER* aLogger )
+    {
+        m_eventLogger = aLogger;
+    }
+
     RULE_RESOLVER* GetRuleResolver() const
     {
         return m_iface->GetRuleResolver();
@@ -220,6 +232,9 @@ public:
         return m_iface;
     }
 
+    ///> The thread the routing algorithms hand their independent halves of work to
+    WORKER& Worker() { return m_worker; }
+
 private:
     void movePlacing( const VECTOR2I& aP, ITEM* aItem );
     void moveDragging( const VECTOR2I& aP, ITEM* aItem );
@@ -258,6 +273,8 @@ private:
     std::unique_ptr< SHOVE >          m_shove;
 
     ROUTER_IFACE* m_iface;
+    LOGGER* m_eventLogger;
+    WORKER m_worker;
 
     int m_iterLimit;
     bool m_showInterSteps;
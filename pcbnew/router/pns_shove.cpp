@@ -96,6 +96,9 @@ SHOVE::SHOVE( NODE* aWorld, ROUTER* aRouter ) :
     m_draggedVia = NULL;
     m_iter = 0;
     m_multiLineMode = false;
+    m_speculationStackSize = 0;
+    m_speculationNode = NULL;
+    m_speculative = false;
 }
 
 
@@ -550,7 +553,11 @@ bool SHOVE::reduceSpringback( const ITEM_SET& aHeadSet )
         {
             rv = true;
 
-            delete spTag.m_node;
+            if( m_speculative )
+                m_releasedStack.push_back( spTag );
+            else
+                delete spTag.m_node;
+
             m_nodeStack.pop_back();
         }
         else
@@ -561,6 +568,54 @@ bool SHOVE::reduceSpringback( const ITEM_SET& aHeadSet )
 }
 
 
+void SHOVE::BeginSpeculation()
+{
+    AcceptSpeculation();
+
+    m_speculative = true;
+    m_speculationStackSize = m_nodeStack.size();
+    m_speculationNode = m_currentNode;
+}
+
+
+void SHOVE::AcceptSpeculation()
+{
+    // The released nodes are stored top first: children are freed before their parents
+    for( SPRINGBACK_TAG& spTag : m_releasedStack )
+        delete spTag.m_node;
+
+    m_releasedStack.clear();
+    m_speculative = false;
+}
+
+
+void SHOVE::RollbackSpeculation()
+{
+    if( !m_speculative )
+        return;
+
+    // Free the nodes pushed during the speculation, they sit on top of the nodes which
+    // were not released
+    size_t kept = m_speculationStackSize - m_releasedStack.size();
+
+    while( m_nodeStack.size() > kept )
+    {
+        delete m_nodeStack.back().m_node;
+        m_nodeStack.pop_back();
+    }
+
+    while( !m_releasedStack.empty() )
+    {
+        m_nodeStack.push_back( m_releasedStack.back() );
+        m_releasedStack.pop_back();
+    }
+
+    m_currentNode = m_speculationNode;
+    m_newHead = OPT_LINE();
+    m_speculative = false;
+}
+
+
 bool SHOVE::pushSpringback( NODE* aNode, const ITEM_SET& aHeadItems,
                                 const COST_ESTIMATOR& aCost, const OPT_BOX2I& aAffectedArea )
 {
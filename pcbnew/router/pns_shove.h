@@ -83,6 +83,19 @@ public:
 
     const LINE NewHead() const;
 
+    /**
+     * Function BeginSpeculation()
+     * Makes the next shoves undoable.  The spring-back nodes released by ShoveLines() are
+     * kept alive until the speculation ends, so the current node can still be read from
+     * other threads while shoving.  AcceptSpeculation() or RollbackSpeculation() ends it.
+     */
+    void BeginSpeculation();
+    void AcceptSpeculation();
+
+    ///> Restores the spring-back stack and the current node as they were at
+    ///> BeginSpeculation()
+    void RollbackSpeculation();
+
     void SetInitialLine( LINE& aInitial );
 
 private:
@@ -142,6 +155,10 @@ private:
     int getClearance( const ITEM* aA, const ITEM* aB ) const;
 
     std::vector<SPRINGBACK_TAG> m_nodeStack;
+    std::vector<SPRINGBACK_TAG> m_releasedStack;    ///< popped during the speculation
+    size_t                      m_speculationStackSize;
+    NODE*                       m_speculationNode;
+    bool                        m_speculative;
     std::vector<LINE>           m_lineStack;
     std::vector<LINE>           m_optimizerQueue;
 
@@ -32,7 +32,6 @@ namespace PNS {
 
 void WALKAROUND::start( const LINE& aInitialPath )
 {
-    m_iteration = 0;
     m_iterationLimit = 50;
 }
 
@@ -52,12 +51,14 @@ NODE::OPT_OBSTACLE WALKAROUND::nearestObstacle( const LINE& aPath )
 
 
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
-                                                              bool aWindingDirection )
+                                                      bool aWindingDirection, int aIteration )
 {
     OPT<OBSTACLE>& current_obs =
         aWindingDirection ? m_currentObstacle[0] : m_currentObstacle[1];
 
     bool& prev_recursive = aWindingDirection ? m_recursiveCollision[0] : m_recursiveCollision[1];
+    int& blockage_count = aWindingDirection ? m_recursiveBlockageCount[0]
+                                            : m_recursiveBlockageCount[1];
 
     if( !current_obs )
         return DONE;
@@ -68,9 +69,9 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 
     if( ( current_obs->m_hull ).PointInside( last ) || ( current_obs->m_hull ).PointOnEdge( last ) )
     {
-        m_recursiveBlockageCount++;
+        blockage_count++;
 
-        if( m_recursiveBlockageCount < 3 )
+        if( blockage_count < 3 )
             aPath.Line().Append( current_obs->m_hull.NearestPoint( last ) );
         else
         {
@@ -85,12 +86,16 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
                       path_post[1], !aWindingDirection );
 
 #ifdef DEBUG
-    m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", m_iteration );
-    m_logger.Log( &path_walk[0], 0, "path-walk" );
-    m_logger.Log( &path_pre[0], 1, "path-pre" );
-    m_logger.Log( &path_post[0], 4, "path-post" );
-    m_logger.Log( &current_obs->m_hull, 2, "hull" );
-    m_logger.Log( current_obs->m_item, 3, "item" );
+    {
+        std::lock_guard<std::mutex> lock( m_loggerLock );
+
+        m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", aIteration );
+        m_logger.Log( &path_walk[0], 0, "path-walk" );
+        m_logger.Log( &path_pre[0], 1, "path-pre" );
+        m_logger.Log( &path_post[0], 4, "path-post" );
+        m_logger.Log( &current_obs->m_hull, 2, "hull" );
+        m_logger.Log( current_obs->m_item, 3, "item" );
+    }
 #endif
 
     int len_pre = path_walk[0].Length();
@@ -141,6 +146,27 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 }
 
 
+void WALKAROUND::walkDirection( LINE& aPath, bool aWindingDirection,
+                                WALKAROUND_STATUS& aStatus, std::atomic<int>* aDoneAt )
+{
+    int self = aWindingDirection ? 0 : 1;
+
+    for( int iter = 0; iter < m_iterationLimit && aStatus != STUCK; iter++ )
+    {
+        if( !m_forceLongerPath && iter > aDoneAt[1 - self] )
+            break;
+
+        aStatus = singleStep( aPath, aWindingDirection, iter );
+
+        if( aStatus == DONE )
+        {
+            aDoneAt[self] = iter;
+            break;
+        }
+    }
+}
+
+
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         LINE& aWalkPath, bool aOptimize )
 {
@@ -161,7 +187,7 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
     start( aInitialPath );
 
     m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
-    m_recursiveBlockageCount = 0;
+    m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
 
     aWalkPath = aInitialPath;
 
@@ -174,51 +200,36 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         m_forceSingleDirection = false;
     }
 
-    while( m_iteration < m_iterationLimit )
-    {
-        if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
-
-        if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
-
-        if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
-        {
-            int len_cw  = path_cw.CLine().Length();
-            int len_ccw = path_ccw.CLine().Length();
+    // Both directions are walked independently, each counting its own blockages, so they
+    // can be walked at the same time.  The first one to get done wins, or the shortest if
+    // they get done at the same iteration.
+    std::atomic<int> doneAt[2];
+    doneAt[0] = doneAt[1] = m_iterationLimit;
 
-            if( m_forceLongerPath )
-                aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-            else
-                aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
-
-            break;
-        }
-        else if( s_cw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_cw;
-            break;
-        }
-        else if( s_ccw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_ccw;
-            break;
-        }
-
-        m_iteration++;
+    if( s_cw == IN_PROGRESS && s_ccw == IN_PROGRESS && m_currentObstacle[0] )
+    {
+        Router()->Worker().Run(
+                [&]() { walkDirection( path_ccw, false, s_ccw, doneAt ); },
+                [&]() { walkDirection( path_cw, true, s_cw, doneAt ); } );
     }
-
-    if( m_iteration == m_iterationLimit )
+    else
     {
-        int len_cw  = path_cw.CLine().Length();
-        int len_ccw = path_ccw.CLine().Length();
-
-        if( m_forceLongerPath )
-            aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-        else
-            aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
+        walkDirection( path_cw, true, s_cw, doneAt );
+        walkDirection( path_ccw, false, s_ccw, doneAt );
     }
 
+    int len_cw  = path_cw.CLine().Length();
+    int len_ccw = path_ccw.CLine().Length();
+
+    if( m_forceLongerPath )
+        aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
+    else if( doneAt[0] < doneAt[1] )
+        aWalkPath = path_cw;
+    else if( doneAt[1] < doneAt[0] )
+        aWalkPath = path_ccw;
+    else
+        aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
+
     if( m_cursorApproachMode )
     {
         // int len_cw = path_cw.GetCLine().Length();
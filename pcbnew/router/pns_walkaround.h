@@ -23,6 +23,8 @@
 #define __PNS_WALKAROUND_H
 
 #include <set>
+#include <atomic>
+#include <mutex>
 
 #include "pns_line.h"
 #include "pns_node.h"
@@ -49,9 +51,8 @@ public:
         m_itemMask = ITEM::ANY_T;
 
         // Initialize other members, to avoid uninitialized variables.
-        m_recursiveBlockageCount = 0;
+        m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
         m_recursiveCollision[0] = m_recursiveCollision[1] = false;
-        m_iteration = 0;
         m_forceCw = false;
     }
 
@@ -129,13 +130,23 @@ public:
 private:
     void start( const LINE& aInitialPath );
 
-    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection );
+    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection, int aIteration );
+
+    /**
+     * Function walkDirection()
+     * Iterates singleStep() in a single winding direction, until the path is done or the
+     * iteration limit is reached.  The iteration at which the path got done is stored in
+     * aDoneAt[direction].  The walk stops early when the other direction got done at an
+     * earlier iteration, as its path would be chosen anyway.
+     */
+    void walkDirection( LINE& aPath, bool aWindingDirection, WALKAROUND_STATUS& aStatus,
+                        std::atomic<int>* aDoneAt );
     NODE::OPT_OBSTACLE nearestObstacle( const LINE& aPath );
 
     NODE* m_world;
 
-    int m_recursiveBlockageCount;
-    int m_iteration;
+    ///> Blockages of the path end met by each winding direction
+    int m_recursiveBlockageCount[2];
     int m_iterationLimit;
     int m_itemMask;
     bool m_forceSingleDirection, m_forceLongerPath;
@@ -146,6 +157,7 @@ private:
     NODE::OPT_OBSTACLE m_currentObstacle[2];
     bool m_recursiveCollision[2];
     LOGGER m_logger;
+    std::mutex m_loggerLock;
     std::set<ITEM*> m_restrictedSet;
 };
 
@@ -0,0 +1,102 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pns_worker.h"
+
+namespace PNS {
+
+WORKER::WORKER() :
+    m_job( nullptr ),
+    m_pending( false ),
+    m_quit( false )
+{
+}
+
+
+WORKER::~WORKER()
+{
+    {
+        std::lock_guard<std::mutex> guard( m_lock );
+        m_quit = true;
+    }
+
+    m_wakeUp.notify_one();
+
+    if( m_thread.joinable() )
+        m_thread.join();
+}
+
+
+void WORKER::Run( const std::function<void()>& aJob, const std::function<void()>& aOther )
+{
+    bool offload = false;
+
+    {
+        std::lock_guard<std::mutex> guard( m_lock );
+
+        if( !m_job && std::thread::hardware_concurrency() > 1 )
+        {
+            if( !m_thread.joinable() )
+                m_thread = std::thread( &WORKER::loop, this );
+
+            m_job = &aJob;
+            m_pending = true;
+            offload = true;
+        }
+    }
+
+    if( !offload )
+    {
+        aJob();
+        aOther();
+        return;
+    }
+
+    m_wakeUp.notify_one();
+    aOther();
+
+    std::unique_lock<std::mutex> lock( m_lock );
+    m_done.wait( lock, [this]() { return m_job == nullptr; } );
+}
+
+
+void WORKER::loop()
+{
+    std::unique_lock<std::mutex> lock( m_lock );
+
+    while( true )
+    {
+        m_wakeUp.wait( lock, [this]() { return m_quit || m_pending; } );
+
+        if( m_quit )
+            return;
+
+        m_pending = false;
+        const std::function<void()>* job = m_job;
+
+        lock.unlock();
+        ( *job )();
+        lock.lock();
+
+        m_job = nullptr;
+        m_done.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,68 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_WORKER_H
+#define __PNS_WORKER_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace PNS {
+
+/**
+ * Class WORKER
+ *
+ * A single background thread, owned by the router, that runs one half of a pair of
+ * independent jobs (the two walkaround directions, the walkaround and shove heads of the
+ * smart mode) while the calling thread runs the other half.  The thread is started on the
+ * first use and lives as long as the router, so no thread is created per mouse move.
+ */
+class WORKER
+{
+public:
+    WORKER();
+    ~WORKER();
+
+    /**
+     * Function Run()
+     * Runs aJob on the worker thread and aOther on the calling thread, and returns when
+     * both are done.  If the worker is already busy (a job running on it asks for another
+     * pair, or two placers share the router) or there is a single core, both jobs run on
+     * the calling thread, aJob first.
+     */
+    void Run( const std::function<void()>& aJob, const std::function<void()>& aOther );
+
+private:
+    void loop();
+
+    std::mutex              m_lock;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_done;
+    std::thread             m_thread;
+
+    const std::function<void()>* m_job;    ///< the job being run, nullptr if idle
+    bool                         m_pending;
+    bool                         m_quit;
+};
+
+}
+
+#endif    // __PNS_WORKER_H
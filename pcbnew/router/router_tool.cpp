@@ -59,6 +59,9 @@ using namespace std::placeholders;
 #include "router_tool.h"
 #include "pns_segment.h"
 #include "pns_router.h"
+#include "pns_logger.h"
+
+#include <io_mgr.h>
 
 using namespace KIGFX;
 
@@ -110,6 +113,10 @@ TOOL_ACTION PCB_ACTIONS::routerActivateTuneDiffPairSkew( "pcbnew.LengthTuner.Tun
         AS_GLOBAL, TOOL_ACTION::LegacyHotKey( HK_ROUTE_TUNE_SKEW ),
         _( "Tune skew of a differential pair" ), "", NULL, AF_ACTIVATE );
 
+TOOL_ACTION PCB_ACTIONS::routerTuneSelectedNets( "pcbnew.LengthTuner.TuneSelectedNets",
+        AS_GLOBAL, 0,
+        _( "Tune length of the selected nets" ), "", NULL, AF_ACTIVATE );
+
 TOOL_ACTION PCB_ACTIONS::routerInlineDrag( "pcbnew.InteractiveRouter.InlineDrag",
         AS_CONTEXT, 0,
         _( "Drag Track/Via" ), _( "Drags tracks and vias without breaking connections" ),
@@ -198,7 +205,8 @@ static const TOOL_ACTION ACT_SetDpDimensions( "pcbnew.InteractiveRouter.SetDpDim
     ps_diff_pair_tune_length_xpm );
 
 ROUTER_TOOL::ROUTER_TOOL() :
-    TOOL_BASE( "pcbnew.InteractiveRouter" )
+    TOOL_BASE( "pcbnew.InteractiveRouter" ),
+    m_recordCount( 0 )
 {
 }
 
@@ -431,6 +439,50 @@ void ROUTER_TOOL::handleCommonEvents( const TOOL_EVENT& aEvent )
 }
 
 
+/**
+ * Starts recording the router events, if the environment variable KICAD_PNS_RECORD
+ * is set to a file name prefix.  The board is saved first as <prefix>-NNN.kicad_pcb,
+ * and the events are written to <prefix>-NNN.events by stopRecording(), so the session
+ * can be replayed by qa/benchmarks/router_replay.
+ */
+void ROUTER_TOOL::startRecording()
+{
+    wxString prefix;
+
+    if( !wxGetEnv( wxT( "KICAD_PNS_RECORD" ), &prefix ) || prefix.IsEmpty() )
+        return;
+
+    stopRecording();
+
+    wxString name = wxString::Format( wxT( "%s-%03d" ), prefix, m_recordCount++ );
+
+    try
+    {
+        IO_MGR::Save( IO_MGR::KICAD_SEXP, name + wxT( ".kicad_pcb" ), board() );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        wxLogTrace( "PNS", "cannot save the recorded board: %s", ioe.What() );
+        return;
+    }
+
+    m_recordName = name;
+    m_eventLog.reset( new PNS::LOGGER );
+    m_router->SetEventLogger( m_eventLog.get() );
+}
+
+
+void ROUTER_TOOL::stopRecording()
+{
+    if( !m_eventLog )
+        return;
+
+    m_router->SetEventLogger( nullptr );
+    m_eventLog->SaveEvents( std::string( ( m_recordName + wxT( ".events" ) ).mb_str() ) );
+    m_eventLog.reset();
+}
+
+
 int ROUTER_TOOL::getStartLayer( const PNS::ITEM* aItem )
 {
     int tl = getView()->GetTopLayer();
@@ -870,6 +922,8 @@ int ROUTER_TOOL::mainLoop( PNS::ROUTER_MODE aMode )
     std::unique_ptr<ROUTER_TOOL_MENU> ctxMenu( new ROUTER_TOOL_MENU( board, *frame, aMode ) );
     SetContextMenu( ctxMenu.get() );
 
+    startRecording();
+
     // Main loop: keep receiving events
     while( OPT_TOOL_EVENT evt = Wait() )
     {
@@ -883,7 +937,10 @@ int ROUTER_TOOL::mainLoop( PNS::ROUTER_MODE aMode )
         }
         else if( evt->Action() == TA_UNDO_REDO_POST || evt->Action() == TA_MODEL_CHANGE )
         {
+            // The board was changed outside of the router: start a new recording
+            stopRecording();
             m_router->SyncWorld();
+            startRecording();
         }
         else if( evt->IsMotion() )
         {
@@ -919,6 +976,8 @@ int ROUTER_TOOL::mainLoop( PNS::ROUTER_MODE aMode )
         }
     }
 
+    stopRecording();
+
     frame->SetNoToolSelected();
     SetContextMenu( nullptr );
 
@@ -1093,10 +1152,15 @@ int ROUTER_TOOL::InlineDrag( const TOOL_EVENT& aEvent )
 
     int dragMode = aEvent.Parameter<int64_t> ();
 
+    startRecording();
+
     bool dragStarted = m_router->StartDragging( p0, m_startItem, dragMode );
 
     if( !dragStarted )
+    {
+        stopRecording();
         return 0;
+    }
 
     controls()->ShowCursor( true );
     controls()->ForceCursorPosition( false );
@@ -1125,6 +1189,8 @@ int ROUTER_TOOL::InlineDrag( const TOOL_EVENT& aEvent )
     if( m_router->RoutingInProgress() )
         m_router->StopRouting();
 
+    stopRecording();
+
     frame()->UndoRedoBlock( false );
 
     return 0;
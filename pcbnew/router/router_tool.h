@@ -25,6 +25,10 @@
 
 #include "pns_tool_base.h"
 
+namespace PNS {
+class LOGGER;
+}
+
 class APIEXPORT ROUTER_TOOL : public PNS::TOOL_BASE
 {
 public:
@@ -71,6 +75,14 @@ private:
 
     bool prepareInteractive();
     bool finishInteractive();
+
+    void startRecording();
+    void stopRecording();
+
+    ///> Events of the routing session being recorded, if KICAD_PNS_RECORD is set
+    std::unique_ptr<PNS::LOGGER> m_eventLog;
+    wxString m_recordName;
+    int m_recordCount;
 };
 
 #endif
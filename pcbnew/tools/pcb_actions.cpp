@@ -49,6 +49,9 @@ OPT<TOOL_EVENT> PCB_ACTIONS::TranslateLegacyId( int aId )
     case ID_TUNE_DIFF_PAIR_SKEW_BUTT:
         return PCB_ACTIONS::routerActivateTuneDiffPairSkew.MakeEvent();
 
+    case ID_MENU_TUNE_SELECTED_NETS:
+        return PCB_ACTIONS::routerTuneSelectedNets.MakeEvent();
+
     case ID_MENU_INTERACTIVE_ROUTER_SETTINGS:
         return PCB_ACTIONS::routerActivateSettingsDialog.MakeEvent();
 
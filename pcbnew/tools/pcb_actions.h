@@ -206,6 +206,9 @@ public:
     /// Activation of the Push and Shove router (skew tuning mode)
     static TOOL_ACTION routerActivateTuneDiffPairSkew;
 
+    /// Length tuning of the nets of the selected tracks, all at once
+    static TOOL_ACTION routerTuneSelectedNets;
+
     /// Activation of the Push and Shove settings dialogs
     static TOOL_ACTION routerActivateSettingsDialog;
     static TOOL_ACTION routerActivateDpDimensionsDialog;
@@ -293,6 +296,7 @@ public:
     // Zone actions
     static TOOL_ACTION zoneFill;
     static TOOL_ACTION zoneFillAll;
+    static TOOL_ACTION zoneRefillAll;
     static TOOL_ACTION zoneUnfill;
     static TOOL_ACTION zoneUnfillAll;
     static TOOL_ACTION zoneMerge;
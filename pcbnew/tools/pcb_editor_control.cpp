@@ -155,6 +155,7 @@ public:
 
         Add( PCB_ACTIONS::zoneFill );
         Add( PCB_ACTIONS::zoneFillAll );
+        Add( PCB_ACTIONS::zoneRefillAll );
         Add( PCB_ACTIONS::zoneUnfill );
         Add( PCB_ACTIONS::zoneUnfillAll );
 
@@ -336,6 +337,10 @@ bool PCB_EDITOR_CONTROL::Init()
     Connect( m_ratsnestTimer.GetId(), wxEVT_TIMER,
             wxTimerEventHandler( PCB_EDITOR_CONTROL::ratsnestTimer ), NULL, this );
 
+    m_pendingRatsnestTimer.SetOwner( this );
+    Connect( m_pendingRatsnestTimer.GetId(), wxEVT_TIMER,
+            wxTimerEventHandler( PCB_EDITOR_CONTROL::pendingRatsnestTimer ), NULL, this );
+
     return true;
 }
 
@@ -1114,6 +1119,31 @@ void PCB_EDITOR_CONTROL::ratsnestTimer( wxTimerEvent& aEvent )
 }
 
 
+int PCB_EDITOR_CONTROL::UpdatePendingRatsnest( const TOOL_EVENT& aEvent )
+{
+    if( board()->GetConnectivity()->HasPendingRatsnest() )
+        m_pendingRatsnestTimer.Start( 20 );
+
+    return 0;
+}
+
+
+void PCB_EDITOR_CONTROL::pendingRatsnestTimer( wxTimerEvent& aEvent )
+{
+    auto connectivity = board()->GetConnectivity();
+
+    // Update a few nets at a time, so the editor stays responsive
+    if( connectivity->UpdatePendingRatsnest( CONNECTIVITY_DATA::RATSNEST_UPDATE_BUDGET ) )
+    {
+        m_pendingRatsnestTimer.Stop();
+        m_frame->UpdateMsgPanel();
+    }
+
+    static_cast<PCB_DRAW_PANEL_GAL*>( m_frame->GetGalCanvas() )->RedrawRatsnest();
+    m_frame->GetGalCanvas()->Refresh();
+}
+
+
 void PCB_EDITOR_CONTROL::calculateSelectionRatsnest()
 {
     auto selectionTool = m_toolMgr->GetTool<SELECTION_TOOL>();
@@ -1158,6 +1188,8 @@ void PCB_EDITOR_CONTROL::setTransitions()
     Go( &PCB_EDITOR_CONTROL::ShowLocalRatsnest,   PCB_ACTIONS::showLocalRatsnest.MakeEvent() );
     Go( &PCB_EDITOR_CONTROL::UpdateSelectionRatsnest, PCB_ACTIONS::selectionModified.MakeEvent() );
     Go( &PCB_EDITOR_CONTROL::HideSelectionRatsnest, SELECTION_TOOL::ClearedEvent );
+    Go( &PCB_EDITOR_CONTROL::UpdatePendingRatsnest,
+        TOOL_EVENT( TC_MESSAGE, TA_MODEL_CHANGE, AS_GLOBAL ) );
 }
 
 
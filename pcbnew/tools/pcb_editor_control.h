@@ -116,10 +116,16 @@ public:
     ///> Shows local ratsnest of a component
     int ShowLocalRatsnest( const TOOL_EVENT& aEvent );
 
+    ///> Finishes updating the ratsnest of the nets left pending after a board change.
+    int UpdatePendingRatsnest( const TOOL_EVENT& aEvent );
+
 private:
     ///> Event handler to recalculate dynamic ratsnest
     void ratsnestTimer( wxTimerEvent& aEvent );
 
+    ///> Event handler to update the ratsnest of pending nets
+    void pendingRatsnestTimer( wxTimerEvent& aEvent );
+
     ///> Recalculates dynamic ratsnest for the current selection
     void calculateSelectionRatsnest();
 
@@ -144,6 +150,9 @@ private:
     ///> Timer that start ratsnest calculation when it is slow to compute.
     wxTimer m_ratsnestTimer;
 
+    ///> Timer that updates the ratsnest of pending nets, a few nets at a time.
+    wxTimer m_pendingRatsnestTimer;
+
     ///> How to modify a property for selected items.
     enum MODIFY_MODE { ON, OFF, TOGGLE };
 
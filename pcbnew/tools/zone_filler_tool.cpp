@@ -50,6 +50,10 @@ TOOL_ACTION PCB_ACTIONS::zoneFillAll( "pcbnew.ZoneFiller.zoneFillAll",
         AS_GLOBAL, TOOL_ACTION::LegacyHotKey( HK_ZONE_FILL_OR_REFILL ),
         _( "Fill All" ), _( "Fill all zones" ) );
 
+TOOL_ACTION PCB_ACTIONS::zoneRefillAll( "pcbnew.ZoneFiller.zoneRefillAll",
+        AS_GLOBAL, 0,
+        _( "Refill All" ), _( "Fill all zones, even the ones not changed since their last fill" ) );
+
 TOOL_ACTION PCB_ACTIONS::zoneUnfill( "pcbnew.ZoneFiller.zoneUnfill",
         AS_GLOBAL, 0,
         _( "Unfill" ), _( "Unfill zone(s)" ), zone_unfill_xpm );
@@ -107,11 +111,20 @@ int ZONE_FILLER_TOOL::ZoneFillAll( const TOOL_EVENT& aEvent )
 
     BOARD_COMMIT commit( this );
 
+    // Every change of the board flags the zones it can affect, so the other zones are
+    // still up to date
     for( auto zone : board()->Zones() )
     {
-        toFill.push_back(zone);
+        if( zone->GetIsKeepout() )
+            continue;
+
+        if( !zone->IsFilled() || zone->NeedRefill() )
+            toFill.push_back(zone);
     }
 
+    if( toFill.empty() )
+        return 0;
+
     std::unique_ptr<WX_PROGRESS_REPORTER> progressReporter(
             new WX_PROGRESS_REPORTER( frame(), _( "Fill All Zones" ), 3 )
             );
@@ -124,6 +137,29 @@ int ZONE_FILLER_TOOL::ZoneFillAll( const TOOL_EVENT& aEvent )
 }
 
 
+int ZONE_FILLER_TOOL::ZoneRefillAll( const TOOL_EVENT& aEvent )
+{
+    std::vector<ZONE_CONTAINER*> toFill;
+
+    BOARD_COMMIT commit( this );
+
+    for( auto zone : board()->Zones() )
+    {
+        toFill.push_back(zone);
+    }
+
+    std::unique_ptr<WX_PROGRESS_REPORTER> progressReporter(
+            new WX_PROGRESS_REPORTER( frame(), _( "Refill All Zones" ), 3 )
+            );
+
+    ZONE_FILLER filler( board(), &commit );
+    filler.SetProgressReporter( progressReporter.get() );
+    filler.Fill( toFill );
+
+    return 0;
+}
+
+
 int ZONE_FILLER_TOOL::ZoneUnfill( const TOOL_EVENT& aEvent )
 {
     BOARD_COMMIT commit( this );
@@ -169,6 +205,7 @@ void ZONE_FILLER_TOOL::setTransitions()
     // Zone actions
     Go( &ZONE_FILLER_TOOL::ZoneFill, PCB_ACTIONS::zoneFill.MakeEvent() );
     Go( &ZONE_FILLER_TOOL::ZoneFillAll, PCB_ACTIONS::zoneFillAll.MakeEvent() );
+    Go( &ZONE_FILLER_TOOL::ZoneRefillAll, PCB_ACTIONS::zoneRefillAll.MakeEvent() );
     Go( &ZONE_FILLER_TOOL::ZoneUnfill, PCB_ACTIONS::zoneUnfill.MakeEvent() );
     Go( &ZONE_FILLER_TOOL::ZoneUnfillAll, PCB_ACTIONS::zoneUnfillAll.MakeEvent() );
 }
@@ -369,6 +369,8 @@ void PCB_BASE_EDIT_FRAME::RestoreCopyFromUndoList( wxCommandEvent& aEvent )
     List->ReversePickersListOrder();
     GetScreen()->PushCommandToRedoList( List );
 
+    // The zones around the restored items have been flagged by PutDataInPreviousState()
+    GetBoard()->SetZoneRefillTracked();
     OnModify();
 
     m_toolManager->ProcessEvent( { TC_MESSAGE, TA_UNDO_REDO_POST, AS_GLOBAL } );
@@ -398,6 +400,7 @@ void PCB_BASE_EDIT_FRAME::RestoreCopyFromRedoList( wxCommandEvent& aEvent )
     List->ReversePickersListOrder();
     GetScreen()->PushCommandToUndoList( List );
 
+    GetBoard()->SetZoneRefillTracked();
     OnModify();
 
     m_toolManager->ProcessEvent( { TC_MESSAGE, TA_UNDO_REDO_POST, AS_GLOBAL } );
@@ -487,6 +490,10 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
         // It is possible that we are going to replace the selected item, so clear it
         SetCurItem( NULL );
 
+        // Zones around the old and the new state of the item may need a refill
+        if( status != UR_DRILLORIGIN && status != UR_GRIDORIGIN )
+            GetBoard()->MarkZonesForRefill( item );
+
         switch( aList->GetPickedItemStatus( ii ) )
         {
         case UR_CHANGED:    /* Exchange old and new data for each item */
@@ -577,6 +584,9 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
         }
         break;
         }
+
+        if( status != UR_DRILLORIGIN && status != UR_GRIDORIGIN )
+            GetBoard()->MarkZonesForRefill( item );
     }
 
     if( not_found )
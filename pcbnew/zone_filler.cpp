@@ -26,6 +26,7 @@
 #include <cstdint>
 #include <thread>
 #include <mutex>
+#include <algorithm>
 
 #include <class_board.h>
 #include <class_zone.h>
@@ -62,9 +63,11 @@ extern void CreateThermalReliefPadPolygon( SHAPE_POLY_SET& aCornerBuffer,
 
 static double s_thermalRot = 450;    // angle of stubs in thermal reliefs for round pads
 static const bool s_DumpZonesWhenFilling = false;
+static std::atomic_int s_threadCount( 0 );
 
 ZONE_FILLER::ZONE_FILLER(  BOARD* aBoard, COMMIT* aCommit ) :
-    m_board( aBoard ), m_commit( aCommit ), m_progressReporter( nullptr ), m_count_done( 0 )
+    m_board( aBoard ), m_commit( aCommit ), m_progressReporter( nullptr ),
+    m_count_done( 0 )
 {
 }
 
@@ -79,6 +82,73 @@ void ZONE_FILLER::SetProgressReporter( PROGRESS_REPORTER* aReporter )
     m_progressReporter = aReporter;
 }
 
+
+void ZONE_FILLER::SetThreadCount( int aCount )
+{
+    s_threadCount = std::max( aCount, 0 );
+}
+
+
+int ZONE_FILLER::ThreadCount()
+{
+    return s_threadCount;
+}
+
+
+///> Returns the number of threads the zone fills may use
+static size_t threadBudget()
+{
+    size_t threadCount = s_threadCount ? s_threadCount : std::thread::hardware_concurrency();
+    return std::max<size_t>( threadCount, 1 );
+}
+
+
+///> Returns the number of threads of runParallel() for aZoneCount zones
+static size_t zoneThreadCount( size_t aZoneCount )
+{
+    return std::max<size_t>( std::min( threadBudget(), aZoneCount ), 1 );
+}
+
+
+void ZONE_FILLER::runParallel( const std::vector<ZONE_CONTAINER*>& aZones,
+        const std::function<void( ZONE_CONTAINER* )>& aJob )
+{
+    size_t threadCount = zoneThreadCount( aZones.size() );
+
+    std::atomic_size_t nextZone( 0 );
+    std::vector<std::thread> workers;
+
+    m_count_done = 0;
+
+    for( size_t ii = 0; ii < threadCount; ++ii )
+    {
+        workers.push_back( std::thread( [ this, &aZones, &aJob, &nextZone ]()
+        {
+            for( size_t i = nextZone.fetch_add( 1 ); i < aZones.size();
+                 i = nextZone.fetch_add( 1 ) )
+            {
+                aJob( aZones[i] );
+
+                if( m_progressReporter )
+                    m_progressReporter->AdvanceProgress();
+
+                m_count_done.fetch_add( 1 );
+            }
+        } ) );
+    }
+
+    while( m_count_done.load() < aZones.size() )
+    {
+        if( m_progressReporter )
+            m_progressReporter->KeepRefreshing();
+
+        wxMilliSleep( 20 );
+    }
+
+    for( auto& worker : workers )
+        worker.join();
+}
+
 void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones )
 {
     std::vector<CN_ZONE_ISOLATED_ISLAND_LIST> toFill;
@@ -115,35 +185,35 @@ void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones )
         m_progressReporter->SetMaxProgress( toFill.size() );
     }
 
-    m_count_done = 0;
-    std::thread fillWorker( [ this, toFill ]()
-    {
-        for( unsigned i = 0; i < toFill.size(); i++ )
-        {
-            SHAPE_POLY_SET rawPolys, finalPolys;
-            ZONE_SEGMENT_FILL segFill;
-            fillSingleZone( toFill[i].m_zone, rawPolys, finalPolys );
+    // Larger zones are the slowest to fill: start them first, so the smaller ones can be
+    // spread over the remaining threads instead of finishing on a single busy thread.
+    std::vector<ZONE_CONTAINER*> fillOrder;
 
-            toFill[i].m_zone->SetRawPolysList( rawPolys );
-            toFill[i].m_zone->SetFilledPolysList( finalPolys );
-            toFill[i].m_zone->SetIsFilled( true );
+    for( auto& zone : toFill )
+        fillOrder.push_back( zone.m_zone );
 
-            if( m_progressReporter )
-                m_progressReporter->AdvanceProgress();
+    std::stable_sort( fillOrder.begin(), fillOrder.end(),
+            []( const ZONE_CONTAINER* a, const ZONE_CONTAINER* b )
+            {
+                return a->GetBoundingBox().GetArea() > b->GetBoundingBox().GetArea();
+            } );
 
-            m_count_done.fetch_add( 1 );
-        }
-    } );
+    // The threads left by the zone threads are given to the boolean operations of each
+    // zone, so a few large zones use all the cores, and many zones do not oversubscribe them.
+    // The count is set in each zone thread only, the other threads keep theirs.
+    size_t booleanThreadCount = threadBudget() / zoneThreadCount( fillOrder.size() );
 
-    while( m_count_done.load() < toFill.size() )
+    runParallel( fillOrder, [ this, booleanThreadCount ]( ZONE_CONTAINER* aZone )
     {
-        if( m_progressReporter )
-            m_progressReporter->KeepRefreshing();
-        else
-            wxMilliSleep( 20 );
-    }
+        SHAPE_POLY_SET::SetThreadBooleanThreadCount( booleanThreadCount );
 
-    fillWorker.join();
+        SHAPE_POLY_SET rawPolys, finalPolys;
+        fillSingleZone( aZone, rawPolys, finalPolys );
+
+        aZone->SetRawPolysList( rawPolys );
+        aZone->SetFilledPolysList( finalPolys );
+        aZone->SetIsFilled( true );
+    } );
 
     // Now remove insulated copper islands
     if( m_progressReporter )
@@ -176,30 +246,11 @@ void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones )
         m_progressReporter->SetMaxProgress( toFill.size() );
     }
 
-    m_count_done = 0;
-    std::thread triangulationWorker( [ this, toFill ]()
+    runParallel( fillOrder, []( ZONE_CONTAINER* aZone )
     {
-        for( unsigned i = 0; i < toFill.size(); i++ )
-        {
-            if( m_progressReporter )
-                m_progressReporter->AdvanceProgress();
-
-            toFill[i].m_zone->CacheTriangulation();
-
-            m_count_done.fetch_add( 1 );
-        }
+        aZone->CacheTriangulation();
     } );
 
-    while( m_count_done.load() < toFill.size() )
-    {
-        if( m_progressReporter )
-            m_progressReporter->KeepRefreshing();
-        else
-            wxMilliSleep( 10 );
-    }
-
-    triangulationWorker.join();
-
     // If some zones must be filled by segments, create the filling segments
     // (note, this is a outdated option, but it exists)
     int zones_to_fill_count = 0;
@@ -247,6 +298,16 @@ void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones )
 
     connectivity->SetProgressReporter( nullptr );
 
+    // Only the filled areas are changed here, so the zones flagged by the commit because
+    // they overlap a filled zone are still up to date
+    std::vector<ZONE_CONTAINER*> upToDate;
+
+    for( auto zone : m_board->Zones() )
+    {
+        if( !zone->NeedRefill() )
+            upToDate.push_back( zone );
+    }
+
     if( m_commit )
     {
         m_commit->Push( _( "Fill Zone(s)" ), false );
@@ -261,6 +322,12 @@ void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones )
         connectivity->RecalculateRatsnest();
     }
 
+    for( auto zone : upToDate )
+        zone->SetNeedRefill( false );
+
+    for( auto& zone : toFill )
+        zone.m_zone->SetNeedRefill( false );
+
     connectivity->Unlock();
 }
 
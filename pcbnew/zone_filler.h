@@ -27,6 +27,8 @@
 #define __ZONE_FILLER_H
 
 #include <vector>
+#include <atomic>
+#include <functional>
 #include <class_zone.h>
 
 class PROGRESS_REPORTER;
@@ -42,11 +44,29 @@ public:
     ~ZONE_FILLER();
 
     void    SetProgressReporter( PROGRESS_REPORTER* aReporter );
+
+    /**
+     * Set the number of threads used by all the zone fillers to fill and triangulate the
+     * zones.  It is the "ZoneFillThreads" setting of the board editor.  When there are less
+     * zones than threads, the boolean operations of each zone use the remaining threads.
+     * @param aCount is the thread count, 0 (the default) to use all the available cores.
+     */
+    static void SetThreadCount( int aCount );
+    static int  ThreadCount();
+
     void    Fill( std::vector<ZONE_CONTAINER*> aZones );
     void    Unfill( std::vector<ZONE_CONTAINER*> aZones );
 
 private:
 
+    /**
+     * Run aJob on each zone of aZones, in the list order, on a pool of worker threads.
+     * The progress reporter is advanced when a zone is done, and kept refreshed from the
+     * calling thread until all the zones are processed.
+     */
+    void runParallel( const std::vector<ZONE_CONTAINER*>& aZones,
+            const std::function<void( ZONE_CONTAINER* )>& aJob );
+
     void buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
             SHAPE_POLY_SET& aFeatures ) const;
 
@@ -0,0 +1,361 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fctsys.h>
+#include <make_unique.h>
+#include <wx/filename.h>
+
+#include <class_board.h>
+#include <class_zone.h>
+#include <wildcards_and_files_ext.h>
+#include <zone_triangulation_cache.h>
+
+/*
+ * File layout, in the byte order of the machine which wrote it:
+ *
+ *   char[8]    "KICADTRI"
+ *   uint32     CACHE_VERSION
+ *   uint32     CACHE_BYTE_ORDER, to detect files written with another byte order
+ *   uint32     number of zones
+ *   for each zone:
+ *     uint8[16]    MD5 digest of the filled polygons
+ *     uint32       number of triangulated polygons
+ *     for each polygon:
+ *       uint32     number of vertices, followed by the int32 X and Y of each vertex
+ *       uint32     number of triangles, followed by the int32 vertex indices of each triangle
+ */
+
+static const char     CACHE_MAGIC[8] = { 'K', 'I', 'C', 'A', 'D', 'T', 'R', 'I' };
+static const uint32_t CACHE_VERSION = 1;
+static const uint32_t CACHE_BYTE_ORDER = 0x01020304;
+
+
+///> Appends the bytes of aValue to aBuffer
+template <class T>
+static void put( std::vector<char>& aBuffer, const T& aValue )
+{
+    const char* bytes = reinterpret_cast<const char*>( &aValue );
+
+    aBuffer.insert( aBuffer.end(), bytes, bytes + sizeof( T ) );
+}
+
+
+///> Reads aValue at aOffset in aBuffer, and advances aOffset.
+///> Returns false if the buffer is too short.
+template <class T>
+static bool get( const std::vector<char>& aBuffer, size_t& aOffset, T& aValue )
+{
+    if( aBuffer.size() - aOffset < sizeof( T ) )
+        return false;
+
+    memcpy( &aValue, &aBuffer[aOffset], sizeof( T ) );
+    aOffset += sizeof( T );
+
+    return true;
+}
+
+
+///> Reads a triangulated polygon at aOffset in aBuffer, and advances aOffset.
+///> Returns false if the data is truncated or inconsistent.
+static bool getPolygon( const std::vector<char>& aBuffer, size_t& aOffset,
+                        SHAPE_POLY_SET::TRIANGULATED_POLYGON& aPolygon )
+{
+    uint32_t vertexCount, triangleCount;
+
+    // Check the counts against the remaining size first, a damaged count must not
+    // lead to a huge allocation
+    if( !get( aBuffer, aOffset, vertexCount )
+        || vertexCount > ( aBuffer.size() - aOffset ) / ( 2 * sizeof( int32_t ) ) )
+        return false;
+
+    aPolygon.AllocateVertices( vertexCount );
+
+    for( uint32_t ii = 0; ii < vertexCount; ++ii )
+    {
+        int32_t x, y;
+
+        get( aBuffer, aOffset, x );
+        get( aBuffer, aOffset, y );
+
+        aPolygon.AddVertex( VECTOR2I( x, y ) );
+    }
+
+    if( !get( aBuffer, aOffset, triangleCount )
+        || triangleCount > ( aBuffer.size() - aOffset ) / ( 3 * sizeof( int32_t ) ) )
+        return false;
+
+    aPolygon.AllocateTriangles( triangleCount );
+
+    for( uint32_t ii = 0; ii < triangleCount; ++ii )
+    {
+        SHAPE_POLY_SET::TRIANGULATED_POLYGON::TRI tri;
+        int32_t a, b, c;
+
+        get( aBuffer, aOffset, a );
+        get( aBuffer, aOffset, b );
+        get( aBuffer, aOffset, c );
+
+        if( a < 0 || b < 0 || c < 0 || (uint32_t) a >= vertexCount
+            || (uint32_t) b >= vertexCount || (uint32_t) c >= vertexCount )
+            return false;
+
+        tri.a = a;
+        tri.b = b;
+        tri.c = c;
+        aPolygon.SetTriangle( ii, tri );
+    }
+
+    return true;
+}
+
+
+///> Appends a copy of the polygons of aSource to aCopy.
+static void copyTriangulation( const SHAPE_POLY_SET::TRIANGULATION& aSource,
+                               SHAPE_POLY_SET::TRIANGULATION& aCopy )
+{
+    for( const auto& source : aSource )
+    {
+        aCopy.push_back( std::make_unique<SHAPE_POLY_SET::TRIANGULATED_POLYGON>() );
+
+        SHAPE_POLY_SET::TRIANGULATED_POLYGON& poly = *aCopy.back();
+
+        poly.AllocateVertices( source->GetVertexCount() );
+
+        for( int ii = 0; ii < source->GetVertexCount(); ++ii )
+            poly.AddVertex( source->GetVertex( ii ) );
+
+        poly.AllocateTriangles( source->GetTriangleCount() );
+
+        for( int ii = 0; ii < source->GetTriangleCount(); ++ii )
+            poly.SetTriangle( ii, source->GetTriangleIndices( ii ) );
+    }
+}
+
+
+wxString ZONE_TRIANGULATION_CACHE::FileName( const wxString& aBoardFileName )
+{
+    wxFileName fn( aBoardFileName );
+
+    fn.SetExt( ZoneTriangulationCacheFileExtension );
+
+    return fn.GetFullPath();
+}
+
+
+bool ZONE_TRIANGULATION_CACHE::Save( BOARD* aBoard, const wxString& aFileName )
+{
+    std::vector<char> buffer;
+    uint32_t          zoneCount = 0;
+
+    buffer.insert( buffer.end(), CACHE_MAGIC, CACHE_MAGIC + sizeof( CACHE_MAGIC ) );
+    put( buffer, CACHE_VERSION );
+    put( buffer, CACHE_BYTE_ORDER );
+
+    size_t zoneCountOffset = buffer.size();
+    put( buffer, zoneCount );
+
+    for( ZONE_CONTAINER* zone : aBoard->Zones() )
+    {
+        const SHAPE_POLY_SET& fill = zone->GetFilledPolysList();
+
+        if( fill.IsEmpty() || !fill.IsTriangulationUpToDate() )
+            continue;
+
+        uint8_t digest[MD5_HASH::DIGEST_SIZE];
+
+        fill.GetHash().GetDigest( digest );
+        buffer.insert( buffer.end(), digest, digest + sizeof( digest ) );
+
+        put<uint32_t>( buffer, fill.TriangulatedPolyCount() );
+
+        for( unsigned int ii = 0; ii < fill.TriangulatedPolyCount(); ++ii )
+        {
+            const SHAPE_POLY_SET::TRIANGULATED_POLYGON* poly = fill.TriangulatedPolygon( ii );
+
+            put<uint32_t>( buffer, poly->GetVertexCount() );
+
+            for( int jj = 0; jj < poly->GetVertexCount(); ++jj )
+            {
+                put<int32_t>( buffer, poly->GetVertex( jj ).x );
+                put<int32_t>( buffer, poly->GetVertex( jj ).y );
+            }
+
+            put<uint32_t>( buffer, poly->GetTriangleCount() );
+
+            for( int jj = 0; jj < poly->GetTriangleCount(); ++jj )
+            {
+                const auto& tri = poly->GetTriangleIndices( jj );
+
+                put<int32_t>( buffer, tri.a );
+                put<int32_t>( buffer, tri.b );
+                put<int32_t>( buffer, tri.c );
+            }
+        }
+
+        zoneCount++;
+    }
+
+    // Do not leave an outdated cache behind a board without filled zones
+    if( zoneCount == 0 )
+    {
+        if( wxFileExists( aFileName ) )
+            return wxRemoveFile( aFileName );
+
+        return true;
+    }
+
+    memcpy( &buffer[zoneCountOffset], &zoneCount, sizeof( zoneCount ) );
+
+    FILE* fp = wxFopen( aFileName, wxT( "wb" ) );
+
+    if( !fp )
+        return false;
+
+    bool ok = fwrite( buffer.data(), 1, buffer.size(), fp ) == buffer.size();
+
+    ok = ( fclose( fp ) == 0 ) && ok;
+
+    // A partial cache would only be rejected when loading
+    if( !ok )
+        wxRemoveFile( aFileName );
+
+    return ok;
+}
+
+
+int ZONE_TRIANGULATION_CACHE::Restore( BOARD* aBoard, const wxString& aFileName )
+{
+    if( aBoard->Zones().empty() || !wxFileExists( aFileName ) )
+        return 0;
+
+    FILE* fp = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !fp )
+        return 0;
+
+    std::vector<char> buffer;
+    char              chunk[65536];
+    size_t            len;
+
+    while( ( len = fread( chunk, 1, sizeof( chunk ), fp ) ) > 0 )
+        buffer.insert( buffer.end(), chunk, chunk + len );
+
+    fclose( fp );
+
+    // Check the header
+    size_t   offset = sizeof( CACHE_MAGIC );
+    uint32_t version, byteOrder, zoneCount;
+
+    if( buffer.size() < sizeof( CACHE_MAGIC )
+        || memcmp( buffer.data(), CACHE_MAGIC, sizeof( CACHE_MAGIC ) ) != 0
+        || !get( buffer, offset, version ) || version != CACHE_VERSION
+        || !get( buffer, offset, byteOrder ) || byteOrder != CACHE_BYTE_ORDER
+        || !get( buffer, offset, zoneCount ) )
+        return 0;
+
+    // Read the triangulations, by digest.  A damaged file is dropped as a whole.
+    std::map<std::string, SHAPE_POLY_SET::TRIANGULATION> triangulations;
+
+    for( uint32_t ii = 0; ii < zoneCount; ++ii )
+    {
+        uint32_t polyCount;
+
+        if( buffer.size() - offset < MD5_HASH::DIGEST_SIZE )
+            return 0;
+
+        std::string digest( &buffer[offset], MD5_HASH::DIGEST_SIZE );
+        offset += MD5_HASH::DIGEST_SIZE;
+
+        if( !get( buffer, offset, polyCount ) )
+            return 0;
+
+        SHAPE_POLY_SET::TRIANGULATION& triangulation = triangulations[digest];
+
+        triangulation.clear();
+
+        for( uint32_t jj = 0; jj < polyCount; ++jj )
+        {
+            triangulation.push_back( std::make_unique<SHAPE_POLY_SET::TRIANGULATED_POLYGON>() );
+
+            if( !getPolygon( buffer, offset, *triangulation.back() ) )
+                return 0;
+        }
+    }
+
+    // Zones with the same fill (e.g. copies of a zone) share a triangulation: count the
+    // zones using each one, to copy it for all of them but the last
+    std::vector<std::pair<ZONE_CONTAINER*, MD5_HASH>> zoneHashes;
+    std::map<std::string, int> users;
+
+    for( ZONE_CONTAINER* zone : aBoard->Zones() )
+    {
+        const SHAPE_POLY_SET& fill = zone->GetFilledPolysList();
+
+        if( fill.IsEmpty() )
+            continue;
+
+        MD5_HASH hash = fill.GetHash();
+        uint8_t  digest[MD5_HASH::DIGEST_SIZE];
+
+        hash.GetDigest( digest );
+
+        std::string key( (char*) digest, sizeof( digest ) );
+
+        if( triangulations.count( key ) )
+        {
+            zoneHashes.emplace_back( zone, hash );
+            users[key]++;
+        }
+    }
+
+    // Give the triangulations to the zones they were computed for
+    int restored = 0;
+
+    for( const auto& zoneHash : zoneHashes )
+    {
+        uint8_t digest[MD5_HASH::DIGEST_SIZE];
+
+        zoneHash.second.GetDigest( digest );
+
+        std::string key( (char*) digest, sizeof( digest ) );
+        SHAPE_POLY_SET::TRIANGULATION copy;
+
+        // the last zone takes the triangulation over, the others get a copy
+        bool last = --users[key] == 0;
+
+        if( !last )
+            copyTriangulation( triangulations[key], copy );
+
+        if( zoneHash.first->SetFillTriangulation( last ? triangulations[key] : copy,
+                                                  zoneHash.second ) )
+            restored++;
+    }
+
+    return restored;
+}
@@ -0,0 +1,66 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __ZONE_TRIANGULATION_CACHE_H
+#define __ZONE_TRIANGULATION_CACHE_H
+
+#include <wx/string.h>
+
+class BOARD;
+
+/**
+ * Class ZONE_TRIANGULATION_CACHE
+ * stores the triangulations of the zone fills in a file next to the board file, so
+ * opening a filled board does not have to triangulate its zones again.
+ *
+ * Each triangulation is stored with the checksum of the filled polygons it was computed
+ * for, and is only restored in a zone whose filled polygons have the same checksum.  An
+ * outdated, missing or damaged cache file is not an error: the zones which get no
+ * triangulation from the cache are triangulated as usual.
+ */
+class ZONE_TRIANGULATION_CACHE
+{
+public:
+    /**
+     * Function FileName
+     * @return the name of the cache file of the board file \a aBoardFileName.
+     */
+    static wxString FileName( const wxString& aBoardFileName );
+
+    /**
+     * Function Save
+     * writes the up to date triangulations of the zones of \a aBoard to \a aFileName.
+     * @return bool - false if the file could not be written.
+     */
+    static bool Save( BOARD* aBoard, const wxString& aFileName );
+
+    /**
+     * Function Restore
+     * reads \a aFileName and gives the triangulations it contains to the zones of
+     * \a aBoard whose filled polygons they match.
+     * @return int - the number of zones which got their triangulation from the cache.
+     */
+    static int Restore( BOARD* aBoard, const wxString& aFileName );
+};
+
+#endif
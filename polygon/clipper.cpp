@@ -1602,11 +1602,41 @@ void ClipperBase::Clear()
     }
 
     m_edges.clear();
+    m_ExtraScanlines.clear();
     m_UseFullRange  = false;
     m_HasOpenPaths  = false;
 }
 
 
+// ------------------------------------------------------------------------------
+
+void ClipperBase::GetScanlines( std::vector<cInt>& scanlines ) const
+{
+    for( MinimaList::const_iterator lm = m_MinimaList.begin(); lm != m_MinimaList.end(); ++lm )
+    {
+        for( TEdge* e = lm->LeftBound; e; e = e->NextInLML )
+        {
+            scanlines.push_back( e->Bot.Y );
+            scanlines.push_back( e->Top.Y );
+        }
+
+        for( TEdge* e = lm->RightBound; e; e = e->NextInLML )
+        {
+            scanlines.push_back( e->Bot.Y );
+            scanlines.push_back( e->Top.Y );
+        }
+    }
+}
+
+
+// ------------------------------------------------------------------------------
+
+void ClipperBase::AddScanlines( const std::vector<cInt>& scanlines )
+{
+    m_ExtraScanlines.insert( m_ExtraScanlines.end(), scanlines.begin(), scanlines.end() );
+}
+
+
 // ------------------------------------------------------------------------------
 
 void ClipperBase::Reset()
@@ -1620,6 +1650,9 @@ void ClipperBase::Reset()
 
     m_Scanbeam = ScanbeamList(); // clears/resets priority_queue
 
+    for( size_t i = 0; i < m_ExtraScanlines.size(); i++ )
+        InsertScanbeam( m_ExtraScanlines[i] );
+
     // reset all edges ...
     for( MinimaList::iterator lm = m_MinimaList.begin(); lm != m_MinimaList.end(); ++lm )
     {
@@ -5065,16 +5098,43 @@ void ClipperOffset::Execute( Paths& solution, double delta )
 
 void ClipperOffset::Execute( PolyTree& solution, double delta )
 {
-    solution.Clear();
     FixOrientations();
     DoOffset( delta );
 
+    // same as PrepareExecute(), without collecting the scanlines
+    m_union.Clear();
+    m_union.AddPaths( m_destPolys, ptSubject, true );
+    FinishExecute( solution, delta, std::vector<cInt>() );
+}
+
+
+// ------------------------------------------------------------------------------
+
+void ClipperOffset::PrepareExecute( double delta, std::vector<cInt>& scanlines )
+{
+    FixOrientations();
+    DoOffset( delta );
+
+    m_union.Clear();
+    m_union.AddPaths( m_destPolys, ptSubject, true );
+    m_union.GetScanlines( scanlines );
+}
+
+
+// ------------------------------------------------------------------------------
+
+void ClipperOffset::FinishExecute( PolyTree& solution, double delta,
+                                   const std::vector<cInt>& scanlines )
+{
+    solution.Clear();
+
     // now clean up 'corners' ...
-    Clipper clpr;
-    clpr.AddPaths( m_destPolys, ptSubject, true );
+    Clipper& clpr = m_union;
+    clpr.AddScanlines( scanlines );
 
     if( delta > 0 )
     {
+        clpr.ReverseSolution( false );
         clpr.Execute( ctUnion, solution, pftPositive, pftPositive );
     }
     else
@@ -5104,6 +5164,8 @@ void ClipperOffset::Execute( PolyTree& solution, double delta )
         else
             solution.Clear();
     }
+
+    m_union.Clear();
 }
 
 
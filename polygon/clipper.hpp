@@ -271,6 +271,12 @@ public:
     bool PreserveCollinear() { return m_PreserveCollinear; };
     void PreserveCollinear( bool value ) { m_PreserveCollinear = value; };
 
+    // KiCad: the scanlines of Execute() are the Y of the vertices of the paths added.
+    // The intersections are rounded to the scanlines, so a run on some of the paths of a
+    // larger run needs the scanlines of the larger run to give the same result.
+    void GetScanlines( std::vector<cInt>& scanlines ) const;
+    void AddScanlines( const std::vector<cInt>& scanlines );
+
 protected:
     void            DisposeLocalMinimaList();
     TEdge*          AddBoundsToLML( TEdge* e, bool IsClosed );
@@ -300,6 +306,7 @@ protected:
 
     typedef std::priority_queue<cInt> ScanbeamList;
     ScanbeamList m_Scanbeam;
+    std::vector<cInt> m_ExtraScanlines;
 };
 // ------------------------------------------------------------------------------
 
@@ -417,6 +424,11 @@ public:
     void    Execute( PolyTree& solution, double delta );
     void    Clear();
 
+    // KiCad: Execute( PolyTree&, delta ) in two steps, to get the scanlines of the union of
+    // the offset paths, and run it with additional scanlines (see ClipperBase::GetScanlines())
+    void    PrepareExecute( double delta, std::vector<cInt>& scanlines );
+    void    FinishExecute( PolyTree& solution, double delta, const std::vector<cInt>& scanlines );
+
     double MiterLimit;
     double ArcTolerance;
 
@@ -429,6 +441,7 @@ private:
     double m_miterLim, m_StepsPerRad;
     IntPoint m_lowest;
     PolyNode m_polyNodes;
+    Clipper m_union;
 
     void    FixOrientations();
     void    DoOffset( double delta );
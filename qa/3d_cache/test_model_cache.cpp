@@ -0,0 +1,421 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <plugins/3dapi/ifsg_api.h>
+
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+// offsets of some fields of the render data cache file, see MODEL_CACHE_HEADER and
+// MODEL_CACHE_MESH in ifsg_api.cpp
+static const size_t HEADER_VERSION = 8;
+static const size_t HEADER_BYTE_ORDER = 12;
+static const size_t HEADER_MATERIALS_OFFSET = 40;
+static const size_t HEADER_MESHES_OFFSET = 48;
+static const size_t MESH_RECORD_SIZE = 56;
+static const size_t MESH_POSITIONS = 16;
+static const size_t MESH_FACE_IDX = 48;
+
+static const char PLUGIN_TAG[] = "PLUGIN_TEST:1.0.0.0";
+
+
+/**
+ * Returns a model with two materials and three meshes: the first has all the optional
+ * arrays, the second only the normals and the third none.
+ */
+static S3DMODEL* makeModel( std::mt19937& aRng )
+{
+    std::uniform_real_distribution<float> value( -10.0f, 10.0f );
+    S3DMODEL* model = S3D::New3DModel();
+
+    model->m_MaterialsSize = 2;
+    model->m_Materials = new SMATERIAL[2];
+
+    for( unsigned int i = 0; i < model->m_MaterialsSize; ++i )
+    {
+        SMATERIAL& mat = model->m_Materials[i];
+
+        S3D::Init3DMaterial( mat );
+        mat.m_Ambient = SFVEC3F( value( aRng ), value( aRng ), value( aRng ) );
+        mat.m_Diffuse = SFVEC3F( value( aRng ), value( aRng ), value( aRng ) );
+        mat.m_Emissive = SFVEC3F( value( aRng ), value( aRng ), value( aRng ) );
+        mat.m_Specular = SFVEC3F( value( aRng ), value( aRng ), value( aRng ) );
+        mat.m_Shininess = value( aRng );
+        mat.m_Transparency = value( aRng );
+    }
+
+    model->m_MeshesSize = 3;
+    model->m_Meshes = new SMESH[3];
+
+    for( unsigned int i = 0; i < model->m_MeshesSize; ++i )
+    {
+        SMESH& mesh = model->m_Meshes[i];
+        unsigned int vs = 5 + 7 * i;
+
+        S3D::Init3DMesh( mesh );
+        mesh.m_VertexSize = vs;
+        mesh.m_MaterialIdx = i % model->m_MaterialsSize;
+        mesh.m_Positions = new SFVEC3F[vs];
+
+        if( i < 2 )
+            mesh.m_Normals = new SFVEC3F[vs];
+
+        if( i == 0 )
+        {
+            mesh.m_Texcoords = new SFVEC2F[vs];
+            mesh.m_Color = new SFVEC3F[vs];
+        }
+
+        for( unsigned int j = 0; j < vs; ++j )
+        {
+            mesh.m_Positions[j] = SFVEC3F( value( aRng ), value( aRng ), value( aRng ) );
+
+            if( mesh.m_Normals )
+                mesh.m_Normals[j] = SFVEC3F( value( aRng ), value( aRng ), value( aRng ) );
+
+            if( mesh.m_Texcoords )
+                mesh.m_Texcoords[j] = SFVEC2F( value( aRng ), value( aRng ) );
+
+            if( mesh.m_Color )
+                mesh.m_Color[j] = SFVEC3F( value( aRng ), value( aRng ), value( aRng ) );
+        }
+
+        mesh.m_FaceIdxSize = 3 * ( 2 + 3 * i );
+        mesh.m_FaceIdx = new unsigned int[mesh.m_FaceIdxSize];
+
+        for( unsigned int j = 0; j < mesh.m_FaceIdxSize; ++j )
+            mesh.m_FaceIdx[j] = aRng() % vs;
+    }
+
+    return model;
+}
+
+
+/**
+ * Returns true if the aCount items of aFirst and aSecond are both missing or are equal.
+ */
+template <typename T>
+static bool sameArray( const T* aFirst, const T* aSecond, unsigned int aCount )
+{
+    if( !aFirst || !aSecond )
+        return !aFirst && !aSecond;
+
+    return memcmp( aFirst, aSecond, aCount * sizeof( T ) ) == 0;
+}
+
+
+/**
+ * Returns true if aFirst and aSecond have the same materials and meshes.
+ */
+static bool sameModel( const S3DMODEL& aFirst, const S3DMODEL& aSecond )
+{
+    if( aFirst.m_MaterialsSize != aSecond.m_MaterialsSize
+        || aFirst.m_MeshesSize != aSecond.m_MeshesSize )
+        return false;
+
+    for( unsigned int i = 0; i < aFirst.m_MaterialsSize; ++i )
+    {
+        const SMATERIAL& a = aFirst.m_Materials[i];
+        const SMATERIAL& b = aSecond.m_Materials[i];
+
+        if( a.m_Ambient != b.m_Ambient || a.m_Diffuse != b.m_Diffuse
+            || a.m_Emissive != b.m_Emissive || a.m_Specular != b.m_Specular
+            || a.m_Shininess != b.m_Shininess || a.m_Transparency != b.m_Transparency )
+            return false;
+    }
+
+    for( unsigned int i = 0; i < aFirst.m_MeshesSize; ++i )
+    {
+        const SMESH& a = aFirst.m_Meshes[i];
+        const SMESH& b = aSecond.m_Meshes[i];
+        unsigned int vs = a.m_VertexSize;
+
+        if( vs != b.m_VertexSize || a.m_FaceIdxSize != b.m_FaceIdxSize
+            || a.m_MaterialIdx != b.m_MaterialIdx
+            || !sameArray( a.m_Positions, b.m_Positions, vs )
+            || !sameArray( a.m_Normals, b.m_Normals, vs )
+            || !sameArray( a.m_Texcoords, b.m_Texcoords, vs )
+            || !sameArray( a.m_Color, b.m_Color, vs )
+            || !sameArray( a.m_FaceIdx, b.m_FaceIdx, a.m_FaceIdxSize ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+static std::vector<char> readFile( const std::string& aFileName )
+{
+    std::ifstream file( aFileName, std::ios::binary );
+
+    return std::vector<char>( std::istreambuf_iterator<char>( file ),
+                              std::istreambuf_iterator<char>() );
+}
+
+
+static void writeFile( const std::string& aFileName, const std::vector<char>& aData )
+{
+    std::ofstream file( aFileName, std::ios::binary | std::ios::trunc );
+
+    file.write( aData.data(), aData.size() );
+}
+
+
+template <typename T>
+static T getField( const std::vector<char>& aData, size_t aOffset )
+{
+    T value;
+    memcpy( &value, &aData[aOffset], sizeof( T ) );
+    return value;
+}
+
+
+template <typename T>
+static void setField( std::vector<char>& aData, size_t aOffset, T aValue )
+{
+    memcpy( &aData[aOffset], &aValue, sizeof( T ) );
+}
+
+
+static bool acceptTag( const char* aTag, void* )
+{
+    return strcmp( aTag, PLUGIN_TAG ) == 0;
+}
+
+
+static bool rejectTag( const char*, void* )
+{
+    return false;
+}
+
+
+/**
+ * Reads aFileName as a render data cache file, and returns true if it gives a model
+ * (which is then destroyed).
+ */
+static bool readable( const std::string& aFileName )
+{
+    int dummyPluginMgr;
+    S3DMODEL* model = S3D::ReadModelCache( aFileName.c_str(), &dummyPluginMgr, acceptTag );
+
+    if( !model )
+        return false;
+
+    S3D::Destroy3DModel( &model );
+    return true;
+}
+
+
+/**
+ * A render data cache file written from a random model, in a temporary file removed at
+ * the end of the test.
+ */
+struct MODEL_CACHE_FIXTURE
+{
+    MODEL_CACHE_FIXTURE() :
+        m_rng( 11 ),
+        m_fileName( wxFileName::CreateTempFileName( "qa_3dr" ).ToStdString() ),
+        m_model( makeModel( m_rng ) )
+    {
+        BOOST_REQUIRE( S3D::WriteModelCache( m_fileName.c_str(), m_model, PLUGIN_TAG ) );
+        m_data = readFile( m_fileName );
+    }
+
+    ~MODEL_CACHE_FIXTURE()
+    {
+        S3D::Destroy3DModel( &m_model );
+        wxRemoveFile( m_fileName );
+    }
+
+    std::mt19937      m_rng;
+    std::string       m_fileName;
+    S3DMODEL*         m_model;
+    std::vector<char> m_data;       ///< the file as written
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ModelCache, MODEL_CACHE_FIXTURE )
+
+/**
+ * Checks that a model read back is the one written, and that the plugin tag check can
+ * reject the file.
+ */
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    int dummyPluginMgr;
+    S3DMODEL* model = S3D::ReadModelCache( m_fileName.c_str(), &dummyPluginMgr, acceptTag );
+
+    BOOST_REQUIRE( model );
+    BOOST_CHECK( sameModel( *m_model, *model ) );
+    S3D::Destroy3DModel( &model );
+
+    BOOST_CHECK( !S3D::ReadModelCache( m_fileName.c_str(), &dummyPluginMgr, rejectTag ) );
+}
+
+
+/**
+ * Checks that a file without a plugin tag is not written, as it could not be invalidated
+ * by another version of the plugin.
+ */
+BOOST_AUTO_TEST_CASE( EmptyTag )
+{
+    BOOST_CHECK( !S3D::WriteModelCache( m_fileName.c_str(), m_model, "" ) );
+    BOOST_CHECK( !S3D::WriteModelCache( m_fileName.c_str(), m_model, NULL ) );
+}
+
+
+/**
+ * Checks that the files cut at any length are rejected.
+ */
+BOOST_AUTO_TEST_CASE( Truncated )
+{
+    int accepted = 0;
+
+    for( size_t size = 0; size < m_data.size(); size += 1 + size / 8 )
+    {
+        writeFile( m_fileName, std::vector<char>( m_data.begin(), m_data.begin() + size ) );
+
+        if( readable( m_fileName ) )
+            accepted++;
+    }
+
+    writeFile( m_fileName, std::vector<char>( m_data.begin(), m_data.end() - 1 ) );
+    BOOST_CHECK( !readable( m_fileName ) );
+    BOOST_CHECK_EQUAL( accepted, 0 );
+}
+
+
+/**
+ * Checks that a file with another magic, format version or byte order is rejected.
+ */
+BOOST_AUTO_TEST_CASE( WrongHeader )
+{
+    std::vector<char> data = m_data;
+
+    data[0] ^= 1;
+    writeFile( m_fileName, data );
+    BOOST_CHECK( !readable( m_fileName ) );
+
+    data = m_data;
+    setField<uint32_t>( data, HEADER_VERSION, getField<uint32_t>( data, HEADER_VERSION ) + 1 );
+    writeFile( m_fileName, data );
+    BOOST_CHECK( !readable( m_fileName ) );
+
+    data = m_data;
+    setField<uint32_t>( data, HEADER_BYTE_ORDER, 0x04030201 );
+    writeFile( m_fileName, data );
+    BOOST_CHECK( !readable( m_fileName ) );
+
+    // the unmodified file is still accepted
+    writeFile( m_fileName, m_data );
+    BOOST_CHECK( readable( m_fileName ) );
+}
+
+
+/**
+ * Checks that a file with a section or an array out of the file, or misaligned, is
+ * rejected.
+ */
+BOOST_AUTO_TEST_CASE( BadOffset )
+{
+    const uint64_t size = m_data.size();
+    const uint64_t meshes = getField<uint64_t>( m_data, HEADER_MESHES_OFFSET );
+    const uint64_t badOffsets[] = { size, size + 16, meshes + 1, UINT64_MAX & ~UINT64_C( 15 ) };
+    int accepted = 0;
+
+    for( uint64_t offset : badOffsets )
+    {
+        std::vector<char> data = m_data;
+        setField<uint64_t>( data, HEADER_MATERIALS_OFFSET, offset );
+        writeFile( m_fileName, data );
+
+        if( readable( m_fileName ) )
+            accepted++;
+
+        data = m_data;
+        setField<uint64_t>( data, HEADER_MESHES_OFFSET, offset );
+        writeFile( m_fileName, data );
+
+        if( readable( m_fileName ) )
+            accepted++;
+
+        // the arrays of the last mesh, the one nearest to the end of the file
+        for( size_t field : { MESH_POSITIONS, MESH_FACE_IDX } )
+        {
+            size_t record = meshes + ( m_model->m_MeshesSize - 1 ) * MESH_RECORD_SIZE + field;
+
+            data = m_data;
+            setField<uint64_t>( data, record, offset );
+            writeFile( m_fileName, data );
+
+            if( readable( m_fileName ) )
+                accepted++;
+        }
+    }
+
+    BOOST_CHECK_EQUAL( accepted, 0 );
+}
+
+
+/**
+ * Checks that a file with a face index out of its mesh is rejected, as the renderers
+ * index the arrays without checking.
+ */
+BOOST_AUTO_TEST_CASE( BadFaceIndex )
+{
+    const uint64_t meshes = getField<uint64_t>( m_data, HEADER_MESHES_OFFSET );
+    int accepted = 0;
+
+    for( unsigned int i = 0; i < m_model->m_MeshesSize; ++i )
+    {
+        const SMESH& mesh = m_model->m_Meshes[i];
+        uint64_t faceIdx = getField<uint64_t>( m_data,
+                                               meshes + i * MESH_RECORD_SIZE + MESH_FACE_IDX );
+
+        for( unsigned int bad : { mesh.m_VertexSize, UINT32_MAX } )
+        {
+            std::vector<char> data = m_data;
+            size_t last = faceIdx + ( mesh.m_FaceIdxSize - 1 ) * sizeof( uint32_t );
+
+            setField<uint32_t>( data, last, bad );
+            writeFile( m_fileName, data );
+
+            if( readable( m_fileName ) )
+                accepted++;
+        }
+    }
+
+    BOOST_CHECK_EQUAL( accepted, 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
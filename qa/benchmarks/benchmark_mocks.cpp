@@ -0,0 +1,121 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Stubs for the editor parts referenced by the DRC and the zone filler.  The benchmarks
+ * run them without a frame, so none of these is ever called.
+ */
+
+#include <fctsys.h>
+#include <pcb_edit_frame.h>
+#include <board_commit.h>
+#include <drc.h>
+#include <dialog_drc.h>
+
+
+int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow* aActiveWindow )
+{
+    return 0;
+}
+
+
+BOARD_COMMIT::BOARD_COMMIT( EDA_DRAW_FRAME* aFrame ) :
+    m_toolMgr( nullptr ), m_editModules( false )
+{
+}
+
+
+BOARD_COMMIT::BOARD_COMMIT( PCB_TOOL* aTool ) :
+    m_toolMgr( nullptr ), m_editModules( false )
+{
+}
+
+
+BOARD_COMMIT::~BOARD_COMMIT()
+{
+}
+
+
+void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry )
+{
+}
+
+
+void BOARD_COMMIT::Revert()
+{
+}
+
+
+EDA_ITEM* BOARD_COMMIT::parentObject( EDA_ITEM* aItem ) const
+{
+    return aItem;
+}
+
+
+DIALOG_DRC_CONTROL::DIALOG_DRC_CONTROL( DRC* aTester, PCB_EDIT_FRAME* aEditorFrame,
+                                        wxWindow* aParent ) :
+    DIALOG_DRC_CONTROL_BASE( aParent )
+{
+    m_tester = aTester;
+    m_brdEditor = aEditorFrame;
+    m_currentBoard = nullptr;
+    m_config = nullptr;
+}
+
+
+DIALOG_DRC_CONTROL::~DIALOG_DRC_CONTROL()
+{
+}
+
+
+void DIALOG_DRC_CONTROL::SetRptSettings( bool aEnable, const wxString& aFileName )
+{
+}
+
+
+void DIALOG_DRC_CONTROL::GetRptSettings( bool* aEnable, wxString& aFileName )
+{
+}
+
+
+void DIALOG_DRC_CONTROL::UpdateDisplayedCounts()
+{
+}
+
+
+void DIALOG_DRC_CONTROL::OnReportCheckBoxClicked( wxCommandEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnButtonBrowseRptFileClick( wxCommandEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnStartdrcClick( wxCommandEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnListUnconnectedClick( wxCommandEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnDeleteAllClick( wxCommandEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnDeleteOneClick( wxCommandEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnLeftDClickClearance( wxMouseEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnRightUpClearance( wxMouseEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnLeftDClickUnconnected( wxMouseEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnRightUpUnconnected( wxMouseEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnCancelClick( wxCommandEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnOkClick( wxCommandEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnActivateDlg( wxActivateEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnMarkerSelectionEvent( wxCommandEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnUnconnectedSelectionEvent( wxCommandEvent& event ) {}
+void DIALOG_DRC_CONTROL::OnChangingMarkerList( wxNotebookEvent& event ) {}
@@ -0,0 +1,250 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "benchmark_utils.h"
+
+#include <io_mgr.h>
+#include <kicad_plugin.h>
+#include <class_board.h>
+
+#include <cstdlib>
+
+
+bool ParseBenchmarkArgs( int argc, char* argv[], const char* aUsage,
+                         const BENCHMARK_OPTION_HANDLER& aHandler,
+                         std::vector<std::string>& aArguments,
+                         size_t aMinArguments, size_t aMaxArguments )
+{
+    bool ok = true;
+
+    for( int ii = 1; ii < argc && ok; ii++ )
+    {
+        std::string arg = argv[ii];
+
+        if( arg.size() == 2 && arg[0] == '-' && ii + 1 < argc )
+            ok = aHandler( arg[1], argv[++ii] );
+        else if( arg[0] == '-' )
+            ok = false;
+        else
+            aArguments.push_back( arg );
+    }
+
+    ok = ok && aArguments.size() >= aMinArguments
+            && ( aMaxArguments == 0 || aArguments.size() <= aMaxArguments );
+
+    if( !ok )
+        fprintf( stderr, "Usage: %s\n", aUsage );
+
+    return ok;
+}
+
+
+BOARD* LoadBenchmarkBoard( const std::string& aFileName )
+{
+    try
+    {
+        return IO_MGR::Load( IO_MGR::KICAD_SEXP, wxString::FromUTF8( aFileName.c_str() ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        fprintf( stderr, "Error loading %s:\n%s\n", aFileName.c_str(),
+                 (const char*) ioe.What().mb_str() );
+    }
+
+    return nullptr;
+}
+
+
+bool SaveBenchmarkBoard( BOARD* aBoard, const std::string& aFileName )
+{
+    try
+    {
+        IO_MGR::Save( IO_MGR::KICAD_SEXP, wxString::FromUTF8( aFileName.c_str() ), aBoard );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        fprintf( stderr, "Error saving %s:\n%s\n", aFileName.c_str(),
+                 (const char*) ioe.What().mb_str() );
+        return false;
+    }
+
+    return true;
+}
+
+
+JSON_RECORD& JSON_RECORD::Add( const std::string& aKey, const std::string& aValue )
+{
+    std::string quoted = "\"";
+
+    for( char c : aValue )
+    {
+        if( c == '"' || c == '\\' )
+            quoted += '\\';
+
+        quoted += c;
+    }
+
+    m_fields.emplace_back( aKey, quoted + "\"" );
+    return *this;
+}
+
+
+JSON_RECORD& JSON_RECORD::Add( const std::string& aKey, const char* aValue )
+{
+    return Add( aKey, std::string( aValue ) );
+}
+
+
+JSON_RECORD& JSON_RECORD::Add( const std::string& aKey, double aValue )
+{
+    char buf[64];
+
+    snprintf( buf, sizeof( buf ), "%.3f", aValue );
+    m_fields.emplace_back( aKey, buf );
+    return *this;
+}
+
+
+JSON_RECORD& JSON_RECORD::Add( const std::string& aKey, int aValue )
+{
+    return Add( aKey, (long long) aValue );
+}
+
+
+JSON_RECORD& JSON_RECORD::Add( const std::string& aKey, long long aValue )
+{
+    m_fields.emplace_back( aKey, std::to_string( aValue ) );
+    return *this;
+}
+
+
+std::string JSON_RECORD::Inline() const
+{
+    std::string text = "{ ";
+
+    for( size_t ii = 0; ii < m_fields.size(); ii++ )
+    {
+        text += ii ? ", \"" : "\"";
+        text += m_fields[ii].first + "\": " + m_fields[ii].second;
+    }
+
+    return text + " }";
+}
+
+
+std::string JSON_RECORD::Fields() const
+{
+    std::string text;
+
+    for( size_t ii = 0; ii < m_fields.size(); ii++ )
+    {
+        text += ii ? ",\n  \"" : "  \"";
+        text += m_fields[ii].first + "\": " + m_fields[ii].second;
+    }
+
+    return text;
+}
+
+
+void WriteJson( FILE* aFile, const JSON_RECORD& aRecord, const char* aListName,
+                const std::vector<JSON_RECORD>& aList )
+{
+    std::string fields = aRecord.Fields();
+
+    fprintf( aFile, "{\n%s", fields.c_str() );
+
+    if( aListName )
+    {
+        fprintf( aFile, "%s  \"%s\": [\n", fields.empty() ? "" : ",\n", aListName );
+
+        for( size_t ii = 0; ii < aList.size(); ii++ )
+        {
+            fprintf( aFile, "%s    %s", ii ? ",\n" : "", aList[ii].Inline().c_str() );
+        }
+
+        fprintf( aFile, "\n  ]" );
+    }
+
+    fprintf( aFile, "\n}\n" );
+}
+
+
+bool WriteJson( const std::string& aFileName, const JSON_RECORD& aRecord,
+                const char* aListName, const std::vector<JSON_RECORD>& aList )
+{
+    if( aFileName.empty() )
+    {
+        WriteJson( stdout, aRecord, aListName, aList );
+        return true;
+    }
+
+    FILE* file = fopen( aFileName.c_str(), "w" );
+
+    if( !file )
+    {
+        fprintf( stderr, "Cannot write %s\n", aFileName.c_str() );
+        return false;
+    }
+
+    WriteJson( file, aRecord, aListName, aList );
+
+    return fclose( file ) == 0;
+}
+
+
+bool ReadJsonField( const std::string& aLine, const std::string& aKey, std::string& aValue )
+{
+    std::string pattern = "\"" + aKey + "\":";
+    size_t      pos = aLine.find( pattern );
+
+    if( pos == std::string::npos )
+        return false;
+
+    pos = aLine.find_first_not_of( ' ', pos + pattern.size() );
+
+    if( pos == std::string::npos )
+        return false;
+
+    if( aLine[pos] == '"' )
+    {
+        aValue.clear();
+
+        for( ++pos; pos < aLine.size() && aLine[pos] != '"'; ++pos )
+        {
+            if( aLine[pos] == '\\' && pos + 1 < aLine.size() )
+                ++pos;
+
+            aValue += aLine[pos];
+        }
+    }
+    else
+    {
+        size_t end = aLine.find_first_of( ",}", pos );
+        aValue = aLine.substr( pos, end - pos );
+
+        // remove the space before a closing brace
+        aValue.erase( aValue.find_last_not_of( ' ' ) + 1 );
+    }
+
+    return true;
+}
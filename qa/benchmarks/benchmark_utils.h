@@ -0,0 +1,142 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file benchmark_utils.h
+ * Command line and output helpers shared by the headless benchmark tools.
+ */
+
+#ifndef BENCHMARK_UTILS_H
+#define BENCHMARK_UTILS_H
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class BOARD;
+
+
+///> Exit codes of the benchmark tools
+enum BENCHMARK_EXIT_CODE
+{
+    BENCHMARK_OK = 0,
+    BENCHMARK_FAILED = 1,       ///< ran, but a regression was found or the job is incomplete
+    BENCHMARK_ERROR = 2         ///< bad command line, unreadable input or unwritable output
+};
+
+
+/**
+ * Handles the option -aOption with the value aValue.
+ * @return false if the option is unknown or its value is invalid.
+ */
+typedef std::function<bool( char aOption, const std::string& aValue )> BENCHMARK_OPTION_HANDLER;
+
+
+/**
+ * Function ParseBenchmarkArgs
+ * parses a command line made of options with a value ("-r 5") and of other arguments.
+ * If the command line is invalid, prints "Usage: " followed by aUsage.
+ *
+ * @param aHandler is called for each option.
+ * @param aArguments receives the arguments which are not options.
+ * @param aMinArguments is the minimum number of such arguments.
+ * @param aMaxArguments is the maximum number of such arguments, 0 for no limit.
+ * @return false if the command line is invalid.
+ */
+bool ParseBenchmarkArgs( int argc, char* argv[], const char* aUsage,
+                         const BENCHMARK_OPTION_HANDLER& aHandler,
+                         std::vector<std::string>& aArguments,
+                         size_t aMinArguments = 1, size_t aMaxArguments = 0 );
+
+
+/**
+ * Function LoadBenchmarkBoard
+ * loads the KiCad board aFileName.
+ * @return the board, or nullptr (after printing the error) if it cannot be loaded.
+ */
+BOARD* LoadBenchmarkBoard( const std::string& aFileName );
+
+
+/**
+ * Function SaveBenchmarkBoard
+ * saves aBoard in the KiCad board file aFileName.
+ * @return false (after printing the error) if it cannot be saved.
+ */
+bool SaveBenchmarkBoard( BOARD* aBoard, const std::string& aFileName );
+
+
+/**
+ * Class JSON_RECORD
+ * is a JSON object with flat fields, in insertion order.  Numbers are written with 3
+ * decimals, strings are escaped.
+ */
+class JSON_RECORD
+{
+public:
+    JSON_RECORD& Add( const std::string& aKey, const std::string& aValue );
+    JSON_RECORD& Add( const std::string& aKey, const char* aValue );
+    JSON_RECORD& Add( const std::string& aKey, double aValue );
+    JSON_RECORD& Add( const std::string& aKey, int aValue );
+    JSON_RECORD& Add( const std::string& aKey, long long aValue );
+
+    ///> Returns the object on a single line
+    std::string Inline() const;
+
+    ///> Returns the fields, one per line and indented, without the braces
+    std::string Fields() const;
+
+private:
+    std::vector<std::pair<std::string, std::string>> m_fields;   ///< key, JSON value
+};
+
+
+/**
+ * Function WriteJson
+ * writes aRecord to aFile.  If aListName is given, aList is added to it as an array of
+ * that name, with each record on its own line, so the output can be read back line by
+ * line with ReadJsonField().
+ */
+void WriteJson( FILE* aFile, const JSON_RECORD& aRecord, const char* aListName = nullptr,
+                const std::vector<JSON_RECORD>& aList = std::vector<JSON_RECORD>() );
+
+
+/**
+ * Function WriteJson
+ * writes the JSON output like above, to the file aFileName or to stdout if it is empty.
+ * @return false (after printing the error) if the file cannot be written.
+ */
+bool WriteJson( const std::string& aFileName, const JSON_RECORD& aRecord,
+                const char* aListName = nullptr,
+                const std::vector<JSON_RECORD>& aList = std::vector<JSON_RECORD>() );
+
+
+/**
+ * Function ReadJsonField
+ * extracts the value of aKey from a line written by WriteJson().
+ * @return false if the key is not found.
+ */
+bool ReadJsonField( const std::string& aLine, const std::string& aKey, std::string& aValue );
+
+#endif  // BENCHMARK_UTILS_H
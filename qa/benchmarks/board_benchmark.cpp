@@ -0,0 +1,351 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Board level benchmarks.
+ *
+ * Loads each board given on the command line without user interface and times
+ * separately the load, save, connectivity build, ratsnest, zone fill and DRC.  Every
+ * stage runs on a freshly loaded board, as many times as requested, and the results
+ * are written as JSON.  When a baseline (the JSON output of a previous run) is given,
+ * the median times are compared to it and the program exits with an error code if a
+ * stage got slower than the allowed tolerance.
+ *
+ * Usage: board_benchmark [-r repeats] [-o output.json] [-b baseline.json]
+ *                        [-t tolerance_percent] [-m min_slack_ms] board.kicad_pcb...
+ */
+
+#include <io_mgr.h>
+#include <kicad_plugin.h>
+
+#include <class_board.h>
+#include <class_zone.h>
+#include <connectivity_data.h>
+#include <connectivity_algo.h>
+#include <zone_filler.h>
+#include <drc.h>
+
+#include "benchmark_utils.h"
+
+#include <wx/filename.h>
+#include <wx/init.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+///> The stages of the board pipeline, in execution order
+static const char* const stageNames[] =
+{
+    "load", "save", "connectivity", "ratsnest", "zone_fill", "drc"
+};
+
+static const int STAGE_COUNT = sizeof( stageNames ) / sizeof( stageNames[0] );
+
+
+struct STAGE_TIMES
+{
+    std::vector<double> m_times;    ///< elapsed time of each repeat, in milliseconds
+
+    double Min() const
+    {
+        return *std::min_element( m_times.begin(), m_times.end() );
+    }
+
+    double Max() const
+    {
+        return *std::max_element( m_times.begin(), m_times.end() );
+    }
+
+    double Mean() const
+    {
+        double sum = 0.0;
+
+        for( double t : m_times )
+            sum += t;
+
+        return sum / m_times.size();
+    }
+
+    double Median() const
+    {
+        std::vector<double> sorted = m_times;
+        std::sort( sorted.begin(), sorted.end() );
+
+        size_t n = sorted.size();
+
+        return ( n % 2 ) ? sorted[n / 2] : ( sorted[n / 2 - 1] + sorted[n / 2] ) / 2.0;
+    }
+};
+
+
+struct BOARD_RESULT
+{
+    std::string  m_board;
+    STAGE_TIMES  m_stages[STAGE_COUNT];
+};
+
+
+/**
+ * Runs aJob and returns its elapsed time, in milliseconds.
+ */
+static double timeIt( const std::function<void()>& aJob )
+{
+    auto start = std::chrono::steady_clock::now();
+
+    aJob();
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+
+/**
+ * Runs the whole pipeline once on aFileName, adding the time of each stage to aResult.
+ */
+static void benchmarkBoard( const std::string& aFileName, const wxString& aSaveName,
+                            BOARD_RESULT& aResult )
+{
+    BOARD* board = nullptr;
+    double times[STAGE_COUNT];
+
+    times[0] = timeIt( [&]() {
+        board = IO_MGR::Load( IO_MGR::KICAD_SEXP, wxString::FromUTF8( aFileName.c_str() ) );
+    } );
+
+    std::unique_ptr<BOARD> owner( board );
+
+    times[1] = timeIt( [&]() {
+        IO_MGR::Save( IO_MGR::KICAD_SEXP, aSaveName, board );
+    } );
+
+    // Building the connectivity also computes the ratsnest of all nets the first time
+    times[2] = timeIt( [&]() {
+        board->BuildConnectivity();
+    } );
+
+    // Time a full ratsnest update on its own, as done after a netlist update
+    auto connAlgo = board->GetConnectivity()->GetConnectivityAlgo();
+
+    for( int net = 0; net < connAlgo->NetCount(); net++ )
+        connAlgo->MarkNetAsDirty( net );
+
+    times[3] = timeIt( [&]() {
+        board->GetConnectivity()->RecalculateRatsnest();
+    } );
+
+    std::vector<ZONE_CONTAINER*> zones;
+
+    for( int ii = 0; ii < board->GetAreaCount(); ii++ )
+        zones.push_back( board->GetArea( ii ) );
+
+    times[4] = timeIt( [&]() {
+        ZONE_FILLER filler( board );
+        filler.Fill( zones );
+    } );
+
+    times[5] = timeIt( [&]() {
+        DRC drc( board );
+        drc.SetSettings( true, true, true, true, false, true, true, wxEmptyString, false );
+        drc.RunTests();
+    } );
+
+    for( int stage = 0; stage < STAGE_COUNT; stage++ )
+        aResult.m_stages[stage].m_times.push_back( times[stage] );
+}
+
+
+/**
+ * Writes the results as JSON.  Each stage result is written on its own line, so the
+ * file can be read back as a baseline without a full JSON parser.
+ */
+static bool writeResults( const std::string& aFileName, const std::vector<BOARD_RESULT>& aResults,
+                          int aRepeats )
+{
+    std::vector<JSON_RECORD> records;
+
+    for( const BOARD_RESULT& result : aResults )
+    {
+        for( int stage = 0; stage < STAGE_COUNT; stage++ )
+        {
+            const STAGE_TIMES& t = result.m_stages[stage];
+
+            records.push_back( JSON_RECORD().Add( "board", result.m_board )
+                                            .Add( "stage", stageNames[stage] )
+                                            .Add( "min_ms", t.Min() )
+                                            .Add( "median_ms", t.Median() )
+                                            .Add( "mean_ms", t.Mean() )
+                                            .Add( "max_ms", t.Max() ) );
+        }
+    }
+
+    return WriteJson( aFileName, JSON_RECORD().Add( "repeats", aRepeats ), "results", records );
+}
+
+
+/**
+ * Reads the median times of a previous run, keyed by "board/stage".
+ */
+static bool readBaseline( const std::string& aFileName, std::map<std::string, double>& aMedians )
+{
+    std::ifstream file( aFileName.c_str() );
+
+    if( !file )
+        return false;
+
+    std::string line;
+
+    while( std::getline( file, line ) )
+    {
+        std::string board, stage, median;
+
+        if( ReadJsonField( line, "board", board ) && ReadJsonField( line, "stage", stage )
+                && ReadJsonField( line, "median_ms", median ) )
+        {
+            aMedians[ board + "/" + stage ] = atof( median.c_str() );
+        }
+    }
+
+    return true;
+}
+
+
+static const char* const usageText =
+        "board_benchmark [-r repeats] [-o output.json] [-b baseline.json]\n"
+        "                       [-t tolerance_percent] [-m min_slack_ms] board.kicad_pcb...";
+
+
+int main( int argc, char *argv[] )
+{
+    int         repeats = 5;
+    double      tolerance = 10.0;    // allowed slowdown, in percent of the baseline
+    double      minSlack = 1.0;      // allowed slowdown in ms, for very short stages
+    std::string outputName;
+    std::string baselineName;
+    std::vector<std::string> boards;
+
+    auto option = [&]( char aOption, const std::string& aValue )
+    {
+        switch( aOption )
+        {
+        case 'r': repeats = std::max( atoi( aValue.c_str() ), 1 ); break;
+        case 'o': outputName = aValue;                             break;
+        case 'b': baselineName = aValue;                           break;
+        case 't': tolerance = atof( aValue.c_str() );              break;
+        case 'm': minSlack = atof( aValue.c_str() );               break;
+        default:  return false;
+        }
+
+        return true;
+    };
+
+    if( !ParseBenchmarkArgs( argc, argv, usageText, option, boards ) )
+        return BENCHMARK_ERROR;
+
+    // The board plugins use wxWidgets (string conversions, file names, locale)
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        fprintf( stderr, "Failed to initialize wxWidgets\n" );
+        return BENCHMARK_ERROR;
+    }
+
+    wxString saveName = wxFileName::CreateTempFileName( wxT( "board_benchmark" ) );
+    std::vector<BOARD_RESULT> results;
+
+    for( const std::string& boardName : boards )
+    {
+        BOARD_RESULT result;
+        result.m_board = wxFileName( wxString::FromUTF8( boardName.c_str() ) )
+                                .GetFullName().ToStdString();
+
+        try
+        {
+            for( int ii = 0; ii < repeats; ii++ )
+            {
+                fprintf( stderr, "%s: run %d/%d\n", result.m_board.c_str(), ii + 1, repeats );
+                benchmarkBoard( boardName, saveName, result );
+            }
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            fprintf( stderr, "Error benchmarking %s:\n%s\n", boardName.c_str(),
+                     (const char*) ioe.What().mb_str() );
+            wxRemoveFile( saveName );
+            return BENCHMARK_ERROR;
+        }
+
+        results.push_back( result );
+    }
+
+    wxRemoveFile( saveName );
+
+    if( !writeResults( outputName, results, repeats ) )
+        return BENCHMARK_ERROR;
+
+    if( baselineName.empty() )
+        return BENCHMARK_OK;
+
+    std::map<std::string, double> baseline;
+
+    if( !readBaseline( baselineName, baseline ) )
+    {
+        fprintf( stderr, "Cannot read baseline %s\n", baselineName.c_str() );
+        return BENCHMARK_ERROR;
+    }
+
+    int regressions = 0;
+
+    for( const BOARD_RESULT& result : results )
+    {
+        for( int stage = 0; stage < STAGE_COUNT; stage++ )
+        {
+            auto it = baseline.find( result.m_board + "/" + stageNames[stage] );
+
+            if( it == baseline.end() )
+                continue;
+
+            double median = result.m_stages[stage].Median();
+            double limit = std::max( it->second * ( 1.0 + tolerance / 100.0 ),
+                                     it->second + minSlack );
+
+            if( median > limit )
+            {
+                fprintf( stderr, "REGRESSION %s %s: %.3f ms, baseline %.3f ms (limit %.3f ms)\n",
+                         result.m_board.c_str(), stageNames[stage], median, it->second, limit );
+                regressions++;
+            }
+        }
+    }
+
+    return regressions ? BENCHMARK_FAILED : BENCHMARK_OK;
+}
@@ -0,0 +1,145 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Headless footprint auto-placement.
+ *
+ * Loads a board, places its footprints with AR_AUTOPLACER and reports the placement
+ * time and the number of candidate positions evaluated, as JSON.  The placed board can
+ * be saved for inspection.
+ *
+ * Usage: footprint_autoplace [-m all|offboard] [-p pitch_mm] [-t threads]
+ *                            [-o placed.kicad_pcb] board.kicad_pcb
+ */
+
+#include <class_board.h>
+#include <convert_to_biu.h>
+
+#include <autorouter/ar_autoplacer.h>
+
+#include "benchmark_utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wx/init.h>
+
+
+static const char* const usageText =
+        "footprint_autoplace [-m all|offboard] [-p pitch_mm] [-t threads]\n"
+        "                           [-o placed.kicad_pcb] board.kicad_pcb";
+
+
+int main( int argc, char *argv[] )
+{
+    AR_AUTOPLACER::AR_PLACE_MODE mode = AR_AUTOPLACER::AR_PLACE_ALL;
+    double      pitch = 0.0;    // default pitch
+    int         threads = 0;    // all the cores
+    std::string outputName;
+    std::vector<std::string> arguments;
+
+    auto option = [&]( char aOption, const std::string& aValue )
+    {
+        switch( aOption )
+        {
+        case 'm':
+            if( aValue == "all" )
+                mode = AR_AUTOPLACER::AR_PLACE_ALL;
+            else if( aValue == "offboard" )
+                mode = AR_AUTOPLACER::AR_PLACE_OFF_BOARD;
+            else
+                return false;
+            break;
+
+        case 'p':
+            pitch = atof( aValue.c_str() );
+            break;
+
+        case 't':
+            threads = std::max( atoi( aValue.c_str() ), 0 );
+            break;
+
+        case 'o':
+            outputName = aValue;
+            break;
+
+        default:
+            return false;
+        }
+
+        return true;
+    };
+
+    if( !ParseBenchmarkArgs( argc, argv, usageText, option, arguments, 1, 1 ) )
+        return BENCHMARK_ERROR;
+
+    std::string boardName = arguments[0];
+
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        fprintf( stderr, "Failed to initialize wxWidgets\n" );
+        return BENCHMARK_ERROR;
+    }
+
+    std::unique_ptr<BOARD> board( LoadBenchmarkBoard( boardName ) );
+
+    if( !board )
+        return BENCHMARK_ERROR;
+
+    AR_AUTOPLACER placer( board.get() );
+
+    if( pitch > 0.0 )
+        placer.SetGridPitch( Millimeter2iu( pitch ) );
+
+    placer.SetThreadCount( threads );
+
+    auto start = std::chrono::steady_clock::now();
+    int placed = placer.AutoplaceFootprints( mode );
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    if( placed < 0 )
+    {
+        fprintf( stderr, "%s has no board outline\n", boardName.c_str() );
+        return BENCHMARK_ERROR;
+    }
+
+    const AR_AUTOPLACER::STATS& stats = placer.Stats();
+
+    WriteJson( stdout, JSON_RECORD().Add( "board", boardName )
+                                    .Add( "time_ms", elapsed.count() )
+                                    .Add( "footprints", stats.m_footprints )
+                                    .Add( "placed", stats.m_placed )
+                                    .Add( "candidates", (long long) stats.m_candidates ) );
+
+    if( !outputName.empty() && !SaveBenchmarkBoard( board.get(), outputName ) )
+        return BENCHMARK_ERROR;
+
+    return stats.m_placed == stats.m_footprints ? BENCHMARK_OK : BENCHMARK_FAILED;
+}
@@ -0,0 +1,147 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Headless grid autorouter.
+ *
+ * Loads a board, routes its unconnected ratsnest edges with AR_GRID_ROUTER and reports
+ * the routing time, the completion rate and the peak working set of a search, as JSON.
+ * The routed board can be saved for inspection.
+ *
+ * Usage: grid_autoroute [-p pitch_mm] [-t threads] [-v via_cost] [-o routed.kicad_pcb]
+ *                       board.kicad_pcb
+ */
+
+#include <class_board.h>
+#include <convert_to_biu.h>
+
+#include <autorouter/ar_grid_router.h>
+
+#include "benchmark_utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wx/init.h>
+
+
+static const char* const usageText =
+        "grid_autoroute [-p pitch_mm] [-t threads] [-v via_cost]\n"
+        "                      [-o routed.kicad_pcb] board.kicad_pcb";
+
+
+int main( int argc, char *argv[] )
+{
+    double      pitch = 0.0;    // from the default net class
+    int         threads = 0;    // all the cores
+    int         viaCost = -1;
+    std::string outputName;
+    std::vector<std::string> arguments;
+
+    auto option = [&]( char aOption, const std::string& aValue )
+    {
+        switch( aOption )
+        {
+        case 'p':
+            pitch = atof( aValue.c_str() );
+            break;
+
+        case 't':
+            threads = std::max( atoi( aValue.c_str() ), 0 );
+            break;
+
+        case 'v':
+            viaCost = atoi( aValue.c_str() );
+            break;
+
+        case 'o':
+            outputName = aValue;
+            break;
+
+        default:
+            return false;
+        }
+
+        return true;
+    };
+
+    if( !ParseBenchmarkArgs( argc, argv, usageText, option, arguments, 1, 1 ) )
+        return BENCHMARK_ERROR;
+
+    std::string boardName = arguments[0];
+
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        fprintf( stderr, "Failed to initialize wxWidgets\n" );
+        return BENCHMARK_ERROR;
+    }
+
+    std::unique_ptr<BOARD> board( LoadBenchmarkBoard( boardName ) );
+
+    if( !board )
+        return BENCHMARK_ERROR;
+
+    board->BuildConnectivity();
+
+    AR_GRID_ROUTER router( board.get() );
+    std::vector<BOARD_CONNECTED_ITEM*> newItems;
+
+    if( pitch > 0.0 )
+        router.SetGridPitch( Millimeter2iu( pitch ) );
+
+    if( viaCost >= 0 )
+        router.SetViaCost( viaCost );
+
+    router.SetThreadCount( threads );
+
+    auto start = std::chrono::steady_clock::now();
+    bool complete = router.Route( newItems );
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    const AR_GRID_ROUTER::STATS& stats = router.Stats();
+
+    WriteJson( stdout, JSON_RECORD().Add( "board", boardName )
+                                    .Add( "time_ms", elapsed.count() )
+                                    .Add( "connections", stats.m_connections )
+                                    .Add( "routed", stats.m_routed )
+                                    .Add( "vias", stats.m_vias )
+                                    .Add( "batches", stats.m_batches )
+                                    .Add( "retries", stats.m_retries )
+                                    .Add( "peak_search_memory",
+                                          (long long) stats.m_peakMemory ) );
+
+    for( BOARD_CONNECTED_ITEM* item : newItems )
+        board->Add( item, ADD_APPEND );
+
+    if( !outputName.empty() && !SaveBenchmarkBoard( board.get(), outputName ) )
+        return BENCHMARK_ERROR;
+
+    return complete ? BENCHMARK_OK : BENCHMARK_FAILED;
+}
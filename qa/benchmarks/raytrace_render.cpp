@@ -0,0 +1,115 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Headless raytraced render of a board.
+ *
+ * Loads a board, renders it with C3D_RENDER_RAYTRACING::RenderToPNG() from the default
+ * camera, without an OpenGL context or a window, and reports the render time as JSON.
+ * The 3D models are not loaded: the board is rendered without them.
+ *
+ * Usage: raytrace_render [-s widthxheight] board.kicad_pcb image.png
+ */
+
+#include <class_board.h>
+
+#include <3d_canvas/cinfo3d_visu.h>
+#include <3d_rendering/3d_render_raytracing/c3d_render_raytracing.h>
+
+#include "benchmark_utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wx/init.h>
+
+
+static const char* const usageText =
+        "raytrace_render [-s widthxheight] board.kicad_pcb image.png";
+
+
+int main( int argc, char *argv[] )
+{
+    wxSize size( 1024, 768 );
+    std::vector<std::string> arguments;
+
+    auto option = [&]( char aOption, const std::string& aValue )
+    {
+        switch( aOption )
+        {
+        case 's':
+            if( sscanf( aValue.c_str(), "%dx%d", &size.x, &size.y ) != 2 )
+                return false;
+
+            return size.x > 0 && size.y > 0;
+
+        default:
+            return false;
+        }
+    };
+
+    if( !ParseBenchmarkArgs( argc, argv, usageText, option, arguments, 2, 2 ) )
+        return BENCHMARK_ERROR;
+
+    std::string boardName = arguments[0];
+    std::string imageName = arguments[1];
+
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        fprintf( stderr, "Failed to initialize wxWidgets\n" );
+        return BENCHMARK_ERROR;
+    }
+
+    std::unique_ptr<BOARD> board( LoadBenchmarkBoard( boardName ) );
+
+    if( !board )
+        return BENCHMARK_ERROR;
+
+    CINFO3D_VISU settings;
+    settings.SetBoard( board.get() );
+
+    C3D_RENDER_RAYTRACING renderer( settings );
+
+    auto start = std::chrono::steady_clock::now();
+    bool rendered = renderer.RenderToPNG( size, wxString::FromUTF8( imageName.c_str() ) );
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    if( !rendered )
+    {
+        fprintf( stderr, "Failed to write %s\n", imageName.c_str() );
+        return BENCHMARK_ERROR;
+    }
+
+    WriteJson( stdout, JSON_RECORD().Add( "board", boardName )
+                                    .Add( "image", imageName )
+                                    .Add( "width", size.x )
+                                    .Add( "height", size.y )
+                                    .Add( "time_ms", elapsed.count() ) );
+
+    return BENCHMARK_OK;
+}
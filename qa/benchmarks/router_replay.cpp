@@ -0,0 +1,438 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Interactive router replay benchmark.
+ *
+ * Replays routing sessions recorded by the router tool (run pcbnew with the environment
+ * variable KICAD_PNS_RECORD set to a file name prefix) against PNS::ROUTER, without user
+ * interface.  Each session is a board, saved when the session started, and the list of
+ * router calls made during the session.  The time taken by each call is measured and
+ * the latency percentiles are reported for each kind of event, as JSON.
+ *
+ * With -s compare, the sessions are replayed in the walkaround, shove and smart modes, and
+ * the number of routes completed in each mode is reported.  The smart mode falls back to
+ * the shove whenever the walkaround does not do better, so the program fails if it
+ * completes fewer routes than the shove alone.
+ *
+ * Usage: router_replay [-r repeats] [-s shove|walkaround|smart|markobstacles|compare]
+ *                      [-o output.json] session_prefix...
+ */
+
+#include <class_board.h>
+
+#include <router/pns_kicad_iface.h>
+#include <router/pns_router.h>
+#include <router/pns_logger.h>
+#include <router/pns_debug_decorator.h>
+#include <router/pns_itemset.h>
+
+#include "benchmark_utils.h"
+
+#include <wx/init.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+///> Names of the recorded events, indexed by PNS::LOGGER::EVENT_TYPE
+static const char* const eventNames[] =
+{
+    "start_route", "start_drag", "move", "fix", "stop",
+    "switch_layer", "flip_posture", "toggle_via", "sizes"
+};
+
+static const int EVENT_TYPE_COUNT = sizeof( eventNames ) / sizeof( eventNames[0] );
+
+
+/**
+ * Router interface with no view and no undo: the routed items are committed to the
+ * router world only, so the board is left as loaded.
+ */
+class REPLAY_IFACE : public PNS_KICAD_IFACE
+{
+public:
+    void EraseView() override {}
+    void HideItem( PNS::ITEM* aItem ) override {}
+    void DisplayItem( const PNS::ITEM* aItem, int aColor, int aClearance ) override {}
+    void AddItem( PNS::ITEM* aItem ) override {}
+    void RemoveItem( PNS::ITEM* aItem ) override {}
+    void Commit() override {}
+
+    PNS::DEBUG_DECORATOR* GetDebugDecorator() override
+    {
+        return &m_debugDecorator;
+    }
+
+private:
+    PNS::DEBUG_DECORATOR m_debugDecorator;
+};
+
+
+struct REPLAY_RESULT
+{
+    std::vector<double> m_latencies[EVENT_TYPE_COUNT];   ///< in milliseconds
+    int                 m_missingItems = 0;
+    int                 m_completedRoutes = 0;             ///< fixes that ended a route
+
+    /**
+     * Returns the aPercent percentile (nearest rank) of the latencies of events of aType.
+     */
+    double Percentile( int aType, double aPercent ) const
+    {
+        std::vector<double> sorted = m_latencies[aType];
+        std::sort( sorted.begin(), sorted.end() );
+
+        size_t rank = (size_t) std::ceil( aPercent / 100.0 * sorted.size() );
+        return sorted[ std::min( std::max( rank, (size_t) 1 ), sorted.size() ) - 1 ];
+    }
+
+    double Total( int aType ) const
+    {
+        double sum = 0.0;
+
+        for( double t : m_latencies[aType] )
+            sum += t;
+
+        return sum;
+    }
+};
+
+
+/**
+ * Finds the item described by an event in the current router state, by its kind, layers
+ * and anchors.  Net codes can be renumbered when the board is saved, so the net is only
+ * used to choose between otherwise identical items.
+ */
+static PNS::ITEM* findItem( PNS::ROUTER& aRouter, const PNS::LOGGER::EVENT_ENTRY& aEvent )
+{
+    if( !aEvent.itemKind )
+        return nullptr;
+
+    PNS::ITEM* found = nullptr;
+
+    for( PNS::ITEM* item : aRouter.QueryHoverItems( aEvent.itemAnchors[0] ).Items() )
+    {
+        if( item->Kind() != aEvent.itemKind
+                || item->Layers().Start() != aEvent.itemLayerStart
+                || item->Layers().End() != aEvent.itemLayerEnd )
+            continue;
+
+        bool match = true;
+
+        for( int i = 0; i < 2; i++ )
+        {
+            VECTOR2I anchor = item->AnchorCount() > i ? item->Anchor( i ) : item->Anchor( 0 );
+
+            if( anchor != aEvent.itemAnchors[i] )
+                match = false;
+        }
+
+        if( !match )
+            continue;
+
+        if( !found || item->Net() == aEvent.itemNet )
+            found = item;
+    }
+
+    return found;
+}
+
+
+/**
+ * Replays the events of a session on aBoard, adding their latencies to aResult.
+ * @param aRoutingMode overrides the recorded shove/walkaround mode, if not negative
+ */
+static void replaySession( BOARD* aBoard, const std::vector<PNS::LOGGER::EVENT_ENTRY>& aEvents,
+                           int aRoutingMode, REPLAY_RESULT& aResult )
+{
+    REPLAY_IFACE iface;
+    iface.SetBoard( aBoard );
+
+    PNS::ROUTER router;
+    router.SetInterface( &iface );
+    router.ClearWorld();
+    router.SyncWorld();
+
+    PNS::SIZES_SETTINGS sizes;
+    sizes.ImportCurrent( aBoard->GetDesignSettings() );
+    router.UpdateSizes( sizes );
+
+    for( const PNS::LOGGER::EVENT_ENTRY& evt : aEvents )
+    {
+        PNS::ITEM* item = findItem( router, evt );
+
+        if( evt.itemKind && !item )
+            aResult.m_missingItems++;
+
+        if( evt.type == PNS::LOGGER::EVT_START_ROUTE || evt.type == PNS::LOGGER::EVT_START_DRAG )
+        {
+            int mode = evt.type == PNS::LOGGER::EVT_START_ROUTE ? evt.args[2] : evt.args[1];
+            router.Settings().SetMode( (PNS::PNS_MODE) ( aRoutingMode >= 0 ? aRoutingMode
+                                                                            : mode ) );
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        switch( evt.type )
+        {
+        case PNS::LOGGER::EVT_START_ROUTE:
+            router.SetMode( (PNS::ROUTER_MODE) evt.args[1] );
+            router.StartRouting( evt.p, item, evt.args[0] );
+            break;
+
+        case PNS::LOGGER::EVT_START_DRAG:
+            router.StartDragging( evt.p, item, evt.args[0] );
+            break;
+
+        case PNS::LOGGER::EVT_MOVE:
+            router.Move( evt.p, item );
+            break;
+
+        case PNS::LOGGER::EVT_FIX:
+            if( router.FixRoute( evt.p, item ) )
+                aResult.m_completedRoutes++;
+
+            break;
+
+        case PNS::LOGGER::EVT_STOP:
+            router.StopRouting();
+            break;
+
+        case PNS::LOGGER::EVT_SWITCH_LAYER:
+            router.SwitchLayer( evt.args[0] );
+            break;
+
+        case PNS::LOGGER::EVT_FLIP_POSTURE:
+            router.FlipPosture();
+            break;
+
+        case PNS::LOGGER::EVT_TOGGLE_VIA:
+            router.ToggleViaPlacement();
+            break;
+
+        case PNS::LOGGER::EVT_SIZES:
+            sizes = router.Sizes();
+            sizes.SetTrackWidth( evt.args[0] );
+            sizes.SetViaDiameter( evt.args[1] );
+            sizes.SetViaDrill( evt.args[2] );
+            router.UpdateSizes( sizes );
+            break;
+        }
+
+        std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+        aResult.m_latencies[evt.type].push_back( elapsed.count() );
+    }
+
+    if( router.RoutingInProgress() )
+        router.StopRouting();
+}
+
+
+static bool writeResults( const std::string& aFileName, const REPLAY_RESULT& aResult,
+                          int aRepeats )
+{
+    std::vector<JSON_RECORD> records;
+
+    for( int type = 0; type < EVENT_TYPE_COUNT; type++ )
+    {
+        if( aResult.m_latencies[type].empty() )
+            continue;
+
+        records.push_back( JSON_RECORD().Add( "event", eventNames[type] )
+                                        .Add( "count", (int) aResult.m_latencies[type].size() )
+                                        .Add( "p50_ms", aResult.Percentile( type, 50.0 ) )
+                                        .Add( "p90_ms", aResult.Percentile( type, 90.0 ) )
+                                        .Add( "p99_ms", aResult.Percentile( type, 99.0 ) )
+                                        .Add( "max_ms", aResult.Percentile( type, 100.0 ) )
+                                        .Add( "total_ms", aResult.Total( type ) ) );
+    }
+
+    JSON_RECORD summary;
+
+    summary.Add( "repeats", aRepeats ).Add( "missing_items", aResult.m_missingItems );
+
+    return WriteJson( aFileName, summary, "events", records );
+}
+
+
+///> A routing mode the sessions are replayed in, -1 for the recorded one
+struct REPLAY_MODE
+{
+    REPLAY_MODE( const char* aName, int aMode ) :
+        m_name( aName ),
+        m_mode( aMode )
+    {
+    }
+
+    const char*   m_name;
+    int           m_mode;
+    REPLAY_RESULT m_result;
+};
+
+
+static bool writeComparison( const std::string& aFileName, const std::vector<REPLAY_MODE>& aModes,
+                             int aRepeats )
+{
+    std::vector<JSON_RECORD> records;
+
+    for( const REPLAY_MODE& mode : aModes )
+    {
+        const REPLAY_RESULT& result = mode.m_result;
+        JSON_RECORD record;
+
+        record.Add( "mode", mode.m_name ).Add( "completed_routes", result.m_completedRoutes );
+
+        if( !result.m_latencies[PNS::LOGGER::EVT_MOVE].empty() )
+        {
+            record.Add( "move_p50_ms", result.Percentile( PNS::LOGGER::EVT_MOVE, 50.0 ) )
+                  .Add( "move_p99_ms", result.Percentile( PNS::LOGGER::EVT_MOVE, 99.0 ) );
+        }
+
+        records.push_back( record );
+    }
+
+    JSON_RECORD summary;
+
+    summary.Add( "repeats", aRepeats )
+           .Add( "missing_items", aModes.front().m_result.m_missingItems );
+
+    return WriteJson( aFileName, summary, "modes", records );
+}
+
+
+static const char* const usageText =
+        "router_replay [-r repeats] [-s shove|walkaround|smart|markobstacles|compare]\n"
+        "                     [-o output.json] session_prefix...";
+
+
+int main( int argc, char *argv[] )
+{
+    int         repeats = 1;
+    std::string outputName;
+    std::vector<REPLAY_MODE> modes = { { "recorded", -1 } };
+    std::vector<std::string> sessions;
+
+    auto option = [&]( char aOption, const std::string& aValue )
+    {
+        switch( aOption )
+        {
+        case 'r':
+            repeats = std::max( atoi( aValue.c_str() ), 1 );
+            break;
+
+        case 'o':
+            outputName = aValue;
+            break;
+
+        case 's':
+            if( aValue == "shove" )
+                modes = { { "shove", PNS::RM_Shove } };
+            else if( aValue == "walkaround" )
+                modes = { { "walkaround", PNS::RM_Walkaround } };
+            else if( aValue == "smart" )
+                modes = { { "smart", PNS::RM_Smart } };
+            else if( aValue == "markobstacles" )
+                modes = { { "markobstacles", PNS::RM_MarkObstacles } };
+            else if( aValue == "compare" )
+                modes = { { "walkaround", PNS::RM_Walkaround }, { "shove", PNS::RM_Shove },
+                          { "smart", PNS::RM_Smart } };
+            else
+                return false;
+            break;
+
+        default:
+            return false;
+        }
+
+        return true;
+    };
+
+    if( !ParseBenchmarkArgs( argc, argv, usageText, option, sessions ) )
+        return BENCHMARK_ERROR;
+
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        fprintf( stderr, "Failed to initialize wxWidgets\n" );
+        return BENCHMARK_ERROR;
+    }
+
+    for( const std::string& session : sessions )
+    {
+        std::vector<PNS::LOGGER::EVENT_ENTRY> events;
+
+        if( !PNS::LOGGER::LoadEvents( session + ".events", events ) )
+        {
+            fprintf( stderr, "Cannot read %s.events\n", session.c_str() );
+            return BENCHMARK_ERROR;
+        }
+
+        std::unique_ptr<BOARD> board( LoadBenchmarkBoard( session + ".kicad_pcb" ) );
+
+        if( !board )
+            return BENCHMARK_ERROR;
+
+        for( REPLAY_MODE& mode : modes )
+        {
+            for( int ii = 0; ii < repeats; ii++ )
+            {
+                fprintf( stderr, "%s: %d events, %s mode, run %d/%d\n", session.c_str(),
+                         (int) events.size(), mode.m_name, ii + 1, repeats );
+                replaySession( board.get(), events, mode.m_mode, mode.m_result );
+            }
+        }
+    }
+
+    const REPLAY_RESULT& first = modes.front().m_result;
+
+    if( first.m_missingItems )
+        fprintf( stderr, "Warning: %d recorded items were not found, the replay may differ "
+                         "from the recorded session\n", first.m_missingItems );
+
+    if( modes.size() == 1 )
+        return writeResults( outputName, first, repeats ) ? BENCHMARK_OK : BENCHMARK_ERROR;
+
+    if( !writeComparison( outputName, modes, repeats ) )
+        return BENCHMARK_ERROR;
+
+    const REPLAY_RESULT& shove = modes[1].m_result;
+    const REPLAY_RESULT& smart = modes[2].m_result;
+
+    if( smart.m_completedRoutes < shove.m_completedRoutes )
+    {
+        fprintf( stderr, "The smart mode completed %d routes, the shove %d\n",
+                 smart.m_completedRoutes, shove.m_completedRoutes );
+        return BENCHMARK_FAILED;
+    }
+
+    return BENCHMARK_OK;
+}
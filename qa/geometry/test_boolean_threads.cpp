@@ -0,0 +1,320 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_line_chain.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+typedef std::vector<std::vector<std::vector<VECTOR2I>>> NORMALIZED_SET;
+
+/**
+ * Returns the polygons of aSet in a canonical form: each contour starts at its lowest
+ * point, the holes of each polygon and the polygons are sorted.  Two sets with the same
+ * polygons, in any order, give the same result.
+ */
+static NORMALIZED_SET normalize( const SHAPE_POLY_SET& aSet )
+{
+    auto less = []( const VECTOR2I& a, const VECTOR2I& b )
+    {
+        return a.x < b.x || ( a.x == b.x && a.y < b.y );
+    };
+
+    auto lessContour = [&]( const std::vector<VECTOR2I>& a, const std::vector<VECTOR2I>& b )
+    {
+        return std::lexicographical_compare( a.begin(), a.end(), b.begin(), b.end(), less );
+    };
+
+    NORMALIZED_SET result;
+
+    for( int i = 0; i < aSet.OutlineCount(); i++ )
+    {
+        std::vector<std::vector<VECTOR2I>> polygon;
+
+        for( const SHAPE_LINE_CHAIN& chain : aSet.CPolygon( i ) )
+        {
+            std::vector<VECTOR2I> contour;
+
+            for( int j = 0; j < chain.PointCount(); j++ )
+                contour.push_back( chain.CPoint( j ) );
+
+            std::rotate( contour.begin(),
+                         std::min_element( contour.begin(), contour.end(), less ),
+                         contour.end() );
+            polygon.push_back( contour );
+        }
+
+        std::sort( polygon.begin() + 1, polygon.end(), lessContour );
+        result.push_back( polygon );
+    }
+
+    std::sort( result.begin(), result.end(),
+               [&]( const std::vector<std::vector<VECTOR2I>>& a,
+                    const std::vector<std::vector<VECTOR2I>>& b )
+               {
+                   return std::lexicographical_compare( a.begin(), a.end(), b.begin(), b.end(),
+                                                        lessContour );
+               } );
+
+    return result;
+}
+
+
+/**
+ * A set of aCount random polygons in a square of aSize: stars, possibly self-intersecting,
+ * some of them with a hole.  With large counts, many of them overlap, forming clusters
+ * of all sizes.
+ */
+static SHAPE_POLY_SET randomPolySet( std::mt19937& aRng, int aCount, int aSize )
+{
+    std::uniform_int_distribution<int> coord( 0, aSize );
+    std::uniform_int_distribution<int> radius( aSize / 400, aSize / 40 );
+    std::uniform_int_distribution<int> corners( 3, 12 );
+    std::uniform_real_distribution<double> jitter( 0.3, 1.0 );
+    SHAPE_POLY_SET set;
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        VECTOR2I center( coord( aRng ), coord( aRng ) );
+        int r = radius( aRng );
+        int n = corners( aRng );
+
+        SHAPE_LINE_CHAIN outline;
+
+        for( int j = 0; j < n; j++ )
+        {
+            double angle = 2 * M_PI * j / n;
+            double rr = r * jitter( aRng );
+            outline.Append( center.x + (int) ( rr * cos( angle ) ),
+                            center.y + (int) ( rr * sin( angle ) ) );
+        }
+
+        outline.SetClosed( true );
+        set.AddOutline( outline );
+
+        if( i % 5 == 0 )
+        {
+            SHAPE_LINE_CHAIN hole;
+
+            hole.Append( center.x - r / 8, center.y - r / 8 );
+            hole.Append( center.x + r / 8, center.y - r / 8 );
+            hole.Append( center.x + r / 8, center.y + r / 8 );
+            hole.Append( center.x - r / 8, center.y + r / 8 );
+            hole.SetClosed( true );
+            set.AddHole( hole );
+        }
+    }
+
+    return set;
+}
+
+
+/**
+ * Runs aOperation on a copy of aSet with one boolean thread, then with several threads,
+ * and checks that the polygons are the same.
+ */
+static void checkThreads( const SHAPE_POLY_SET& aSet,
+                          std::function<void( SHAPE_POLY_SET& aSet )> aOperation )
+{
+    size_t saved = SHAPE_POLY_SET::BooleanThreadCount();
+
+    SHAPE_POLY_SET single = aSet;
+    SHAPE_POLY_SET::SetBooleanThreadCount( 1 );
+    aOperation( single );
+
+    NORMALIZED_SET expected = normalize( single );
+
+    for( size_t threads : { 2, 4, 0 } )
+    {
+        SHAPE_POLY_SET parallel = aSet;
+        SHAPE_POLY_SET::SetBooleanThreadCount( threads );
+        aOperation( parallel );
+
+        BOOST_CHECK_EQUAL( parallel.OutlineCount(), single.OutlineCount() );
+        BOOST_CHECK( normalize( parallel ) == expected );
+    }
+
+    SHAPE_POLY_SET::SetBooleanThreadCount( saved );
+}
+
+
+BOOST_AUTO_TEST_SUITE( BooleanThreads )
+
+
+BOOST_AUTO_TEST_CASE( Simplify )
+{
+    std::mt19937 rng( 1 );
+    SHAPE_POLY_SET set = randomPolySet( rng, 3000, 10000000 );
+
+    checkThreads( set, []( SHAPE_POLY_SET& aSet )
+    {
+        aSet.Simplify( SHAPE_POLY_SET::PM_FAST );
+    } );
+
+    checkThreads( set, []( SHAPE_POLY_SET& aSet )
+    {
+        aSet.Simplify( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+    } );
+}
+
+
+BOOST_AUTO_TEST_CASE( Booleans )
+{
+    std::mt19937 rng( 2 );
+    SHAPE_POLY_SET a = randomPolySet( rng, 2000, 10000000 );
+    SHAPE_POLY_SET b = randomPolySet( rng, 2000, 10000000 );
+
+    checkThreads( a, [&]( SHAPE_POLY_SET& aSet )
+    {
+        aSet.BooleanAdd( b, SHAPE_POLY_SET::PM_FAST );
+    } );
+
+    checkThreads( a, [&]( SHAPE_POLY_SET& aSet )
+    {
+        aSet.BooleanSubtract( b, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+    } );
+
+    checkThreads( a, [&]( SHAPE_POLY_SET& aSet )
+    {
+        aSet.BooleanIntersection( b, SHAPE_POLY_SET::PM_FAST );
+    } );
+}
+
+
+/**
+ * A large polygon overlapping all the others forms a single cluster: the result is the
+ * same, without any gain.
+ */
+BOOST_AUTO_TEST_CASE( SingleCluster )
+{
+    std::mt19937 rng( 3 );
+    SHAPE_POLY_SET holes = randomPolySet( rng, 2000, 10000000 );
+    SHAPE_POLY_SET area;
+
+    area.NewOutline();
+    area.Append( -1000, -1000 );
+    area.Append( 10001000, -1000 );
+    area.Append( 10001000, 10001000 );
+    area.Append( -1000, 10001000 );
+
+    checkThreads( area, [&]( SHAPE_POLY_SET& aSet )
+    {
+        aSet.BooleanSubtract( holes, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+    } );
+}
+
+
+BOOST_AUTO_TEST_CASE( Inflate )
+{
+    std::mt19937 rng( 4 );
+    SHAPE_POLY_SET set = randomPolySet( rng, 3000, 10000000 );
+
+    set.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+    checkThreads( set, []( SHAPE_POLY_SET& aSet )
+    {
+        aSet.Inflate( 20000, 16 );
+    } );
+
+    checkThreads( set, []( SHAPE_POLY_SET& aSet )
+    {
+        aSet.Inflate( -20000, 16 );
+    } );
+}
+
+
+/**
+ * Offsets larger than the gaps between the clusters, which merge them, or than the
+ * polygons, which remove them, and the deflate then inflate sequence of the zone fills,
+ * with coarse and fine arcs.
+ */
+BOOST_AUTO_TEST_CASE( InflateDeflate )
+{
+    std::mt19937 rng( 5 );
+    SHAPE_POLY_SET set = randomPolySet( rng, 1500, 10000000 );
+
+    set.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+    for( int segments : { 8, 32 } )
+    {
+        checkThreads( set, [=]( SHAPE_POLY_SET& aSet )
+        {
+            aSet.Inflate( 150000, segments );
+        } );
+
+        checkThreads( set, [=]( SHAPE_POLY_SET& aSet )
+        {
+            aSet.Inflate( -60000, segments );
+        } );
+
+        checkThreads( set, [=]( SHAPE_POLY_SET& aSet )
+        {
+            aSet.Inflate( -40000, segments );
+            aSet.Inflate( 40000, segments );
+        } );
+    }
+}
+
+
+/**
+ * Checks that the count set for a thread is only used by that thread, while the others
+ * keep the process wide count.
+ */
+BOOST_AUTO_TEST_CASE( ThreadCount )
+{
+    size_t saved = SHAPE_POLY_SET::BooleanThreadCount();
+    size_t inThread = 0;
+    size_t afterThread = 0;
+
+    SHAPE_POLY_SET::SetBooleanThreadCount( 3 );
+
+    std::thread thread( [&]()
+    {
+        SHAPE_POLY_SET::SetThreadBooleanThreadCount( 5 );
+        inThread = SHAPE_POLY_SET::BooleanThreadCount();
+    } );
+
+    thread.join();
+
+    std::thread other( [&]()
+    {
+        afterThread = SHAPE_POLY_SET::BooleanThreadCount();
+    } );
+
+    other.join();
+
+    BOOST_CHECK_EQUAL( inThread, 5 );
+    BOOST_CHECK_EQUAL( afterThread, 3 );
+    BOOST_CHECK_EQUAL( SHAPE_POLY_SET::BooleanThreadCount(), 3 );
+
+    SHAPE_POLY_SET::SetBooleanThreadCount( saved );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
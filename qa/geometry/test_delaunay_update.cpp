@@ -0,0 +1,226 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <ttl/halfedge/hetriang.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
+
+typedef std::map<std::pair<int, int>, hed::NODE_PTR> NODE_MAP;
+
+/**
+ * Returns the total weight and the number of edges of the minimum spanning tree of the
+ * edges of aTriangulation, computed the way the ratsnest does it: the edges of the
+ * enclosing triangles (nodes without the flag) are skipped and the weights are truncated
+ * distances.
+ */
+static std::pair<uint64_t, int> mst( hed::TRIANGULATION& aTriangulation, int aNodeCount,
+                                     bool aSkipUnflagged )
+{
+    struct WEIGHTED_EDGE
+    {
+        uint64_t weight;
+        int      src, dst;
+    };
+
+    std::list<hed::EDGE_PTR> triEdges;
+    std::vector<WEIGHTED_EDGE> edges;
+
+    aTriangulation.GetEdges( triEdges );
+
+    for( const auto& e : triEdges )
+    {
+        const auto& src = e->GetSourceNode();
+        const auto& dst = e->GetTargetNode();
+
+        if( aSkipUnflagged && ( !src->GetFlag() || !dst->GetFlag() ) )
+            continue;
+
+        double dx = src->GetX() - dst->GetX();
+        double dy = src->GetY() - dst->GetY();
+
+        edges.push_back( { (uint64_t) std::sqrt( dx * dx + dy * dy ), src->Id(), dst->Id() } );
+    }
+
+    std::sort( edges.begin(), edges.end(),
+            []( const WEIGHTED_EDGE& a, const WEIGHTED_EDGE& b )
+            {
+                return a.weight < b.weight;
+            } );
+
+    std::vector<int> parent( aNodeCount );
+    std::iota( parent.begin(), parent.end(), 0 );
+
+    auto find = [&]( int aNode )
+    {
+        while( parent[aNode] != aNode )
+            aNode = parent[aNode] = parent[parent[aNode]];
+
+        return aNode;
+    };
+
+    std::pair<uint64_t, int> result( 0, 0 );
+
+    for( const auto& e : edges )
+    {
+        int src = find( e.src );
+        int dst = find( e.dst );
+
+        if( src != dst )
+        {
+            parent[src] = dst;
+            result.first += e.weight;
+            result.second++;
+        }
+    }
+
+    return result;
+}
+
+
+/**
+ * Numbers the nodes of aNodes and returns the minimum spanning tree of a triangulation
+ * created from scratch from copies of them, with the enclosing triangles removed.
+ */
+static std::pair<uint64_t, int> rebuiltMst( const NODE_MAP& aNodes )
+{
+    std::vector<hed::NODE_PTR> copies;
+    int id = 0;
+
+    for( const auto& entry : aNodes )
+    {
+        entry.second->SetId( id++ );
+
+        auto copy = std::make_shared<hed::NODE>( entry.second->GetX(), entry.second->GetY() );
+        copy->SetId( entry.second->Id() );
+        copies.push_back( copy );
+    }
+
+    hed::TRIANGULATION triangulation;
+    triangulation.CreateDelaunay( copies.begin(), copies.end() );
+
+    return mst( triangulation, id, false );
+}
+
+
+BOOST_AUTO_TEST_SUITE( DelaunayUpdate )
+
+/**
+ * Removes and inserts random nodes, on a grid (many cocircular nodes) and anywhere, in a
+ * triangulation that keeps its enclosing triangles, and checks that after each batch of
+ * changes the spanning tree is the same as the one of a triangulation rebuilt from
+ * scratch.  Inserted nodes may lie outside the bounding box of the initial nodes.
+ */
+BOOST_AUTO_TEST_CASE( RandomInsertRemove )
+{
+    std::mt19937 rng( 5 );
+    int mismatches = 0;
+    int failedUpdates = 0;
+
+    for( int iter = 0; iter < 100; iter++ )
+    {
+        bool onGrid = iter % 2;
+
+        auto randomCoord = [&]()
+        {
+            return onGrid ? (int) ( rng() % 40 ) * 250000 : (int) ( rng() % 10000000 );
+        };
+
+        NODE_MAP nodes;
+        int count = 20 + rng() % 200;
+
+        while( (int) nodes.size() < count )
+        {
+            int x = randomCoord();
+            int y = randomCoord();
+            auto node = std::make_shared<hed::NODE>( x, y );
+
+            node->SetFlag( true );
+            nodes.emplace( std::make_pair( y, x ), node );
+        }
+
+        std::vector<hed::NODE_PTR> initial;
+
+        for( const auto& entry : nodes )
+            initial.push_back( entry.second );
+
+        hed::TRIANGULATION triangulation;
+        triangulation.CreateDelaunay( initial.begin(), initial.end(), false );
+
+        for( int step = 0; step < 30; step++ )
+        {
+            int changes = 1 + rng() % 4;
+
+            for( int i = 0; i < changes; i++ )
+            {
+                if( rng() % 2 && nodes.size() > 8 )
+                {
+                    auto it = nodes.begin();
+                    std::advance( it, rng() % nodes.size() );
+
+                    if( !triangulation.RemoveNode( it->second ) )
+                        failedUpdates++;
+
+                    nodes.erase( it );
+                }
+                else
+                {
+                    int x = randomCoord();
+                    int y = randomCoord();
+
+                    if( rng() % 10 == 0 )
+                    {
+                        x = x / 10 * 13 - 1000000;
+                        y = y / 10 * 13 - 1000000;
+                    }
+
+                    if( nodes.count( std::make_pair( y, x ) ) )
+                        continue;
+
+                    auto node = std::make_shared<hed::NODE>( x, y );
+                    node->SetFlag( true );
+                    nodes.emplace( std::make_pair( y, x ), node );
+
+                    if( !triangulation.InsertNode( node ) )
+                        failedUpdates++;
+                }
+            }
+
+            auto expected = rebuiltMst( nodes );
+            auto updated = mst( triangulation, nodes.size(), true );
+
+            if( updated != expected )
+                mismatches++;
+        }
+    }
+
+    BOOST_CHECK_EQUAL( failedUpdates, 0 );
+    BOOST_CHECK_EQUAL( mismatches, 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
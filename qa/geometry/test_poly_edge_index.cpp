@@ -0,0 +1,267 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_line_chain.h>
+
+#include <atomic>
+#include <random>
+#include <thread>
+
+/**
+ * Random polygon sets of up to 4 polygons with up to 3 holes, with coordinates in
+ * [0, aRange].  Small ranges give many collinear edges, duplicated vertices and points
+ * on edges.  Some contours are left open, or have less than 3 points.
+ */
+static SHAPE_POLY_SET randomPolySet( std::mt19937& aRng, int aMaxPoints, int aRange )
+{
+    std::uniform_int_distribution<int> coord( 0, aRange );
+    std::uniform_int_distribution<int> size( 0, aMaxPoints );
+    std::uniform_int_distribution<int> count( 1, 4 );
+    std::uniform_int_distribution<int> closed( 0, 7 );
+    SHAPE_POLY_SET set;
+
+    for( int i = count( aRng ); i > 0; i-- )
+    {
+        int holes = count( aRng ) - 1;
+
+        for( int contour = 0; contour <= holes; contour++ )
+        {
+            SHAPE_LINE_CHAIN chain;
+
+            for( int n = size( aRng ); n > 0; n-- )
+                chain.Append( coord( aRng ), coord( aRng ), true );
+
+            chain.SetClosed( true );
+
+            if( contour == 0 )
+                set.AddOutline( chain );
+            else
+                set.AddHole( chain );
+
+            // Contours are added closed, and opened afterwards
+            if( closed( aRng ) == 0 )
+                set.Polygon( set.OutlineCount() - 1 )[contour].SetClosed( false );
+        }
+    }
+
+    return set;
+}
+
+
+///> Compares the indexed and unindexed Contains() and CollideEdge() at aP
+static int countMismatches( SHAPE_POLY_SET& aPlain, SHAPE_POLY_SET& aIndexed,
+                            const VECTOR2I& aP, int aClearance )
+{
+    int mismatches = 0;
+
+    for( int ignoreHoles = 0; ignoreHoles < 2; ignoreHoles++ )
+    {
+        for( int polygon = -1; polygon < aPlain.OutlineCount(); polygon++ )
+        {
+            mismatches += aPlain.Contains( aP, polygon, ignoreHoles )
+                          != aIndexed.Contains( aP, polygon, ignoreHoles );
+        }
+    }
+
+    SHAPE_POLY_SET::VERTEX_INDEX plainVertex, indexedVertex;
+    bool plainHit = aPlain.CollideEdge( aP, plainVertex, aClearance );
+    bool indexedHit = aIndexed.CollideEdge( aP, indexedVertex, aClearance );
+
+    mismatches += plainHit != indexedHit
+                  || plainVertex.m_polygon != indexedVertex.m_polygon
+                  || plainVertex.m_contour != indexedVertex.m_contour
+                  || plainVertex.m_vertex != indexedVertex.m_vertex;
+
+    return mismatches;
+}
+
+
+BOOST_AUTO_TEST_SUITE( PolyEdgeIndex )
+
+
+/**
+ * The indexed tests give the same answers as the unindexed ones for all the points of a
+ * small grid, so every vertex and edge of the polygons is tested.
+ */
+BOOST_AUTO_TEST_CASE( SmallGrid )
+{
+    std::mt19937 rng( 1 );
+    const int range = 12;
+    int mismatches = 0;
+
+    for( int i = 0; i < 200; i++ )
+    {
+        SHAPE_POLY_SET plain = randomPolySet( rng, 30, range );
+        SHAPE_POLY_SET indexed = plain;
+
+        indexed.CacheEdgeIndex();
+        BOOST_CHECK( indexed.IsEdgeIndexCached() );
+
+        for( int x = -1; x <= range + 1; x++ )
+        {
+            for( int y = -1; y <= range + 1; y++ )
+                mismatches += countMismatches( plain, indexed, VECTOR2I( x, y ), ( x + y ) % 3 );
+        }
+
+        // CollideEdge() does not modify the set, and keeps the index
+        BOOST_CHECK( indexed.IsEdgeIndexCached() );
+    }
+
+    BOOST_CHECK_EQUAL( mismatches, 0 );
+}
+
+
+/**
+ * Same with large coordinates and clearances, and many bands per polygon.
+ */
+BOOST_AUTO_TEST_CASE( LargeCoordinates )
+{
+    std::mt19937 rng( 2 );
+    const int range = 1000000000;
+    std::uniform_int_distribution<int> coord( -range / 10, range + range / 10 );
+    std::uniform_int_distribution<int> clearance( 0, range / 20 );
+    int mismatches = 0;
+
+    for( int i = 0; i < 100; i++ )
+    {
+        SHAPE_POLY_SET plain = randomPolySet( rng, 200, range );
+        SHAPE_POLY_SET indexed = plain;
+
+        indexed.CacheEdgeIndex();
+
+        for( int j = 0; j < 300; j++ )
+        {
+            // Test the vertices too
+            VECTOR2I p = ( j < plain.TotalVertices() ) ? plain.CVertex( j )
+                                                        : VECTOR2I( coord( rng ), coord( rng ) );
+
+            mismatches += countMismatches( plain, indexed, p, clearance( rng ) );
+        }
+    }
+
+    BOOST_CHECK_EQUAL( mismatches, 0 );
+}
+
+
+/**
+ * The index is dropped when the set is modified, and shared by its copies.
+ */
+BOOST_AUTO_TEST_CASE( Invalidation )
+{
+    SHAPE_POLY_SET set;
+
+    set.NewOutline();
+    set.Append( 0, 0 );
+    set.Append( 100, 0 );
+    set.Append( 100, 100 );
+    set.Append( 0, 100 );
+
+    set.CacheEdgeIndex();
+    BOOST_CHECK( set.Contains( VECTOR2I( 50, 50 ) ) );
+
+    SHAPE_POLY_SET copy = set;
+    BOOST_CHECK( copy.IsEdgeIndexCached() );
+
+    set.Move( VECTOR2I( 1000, 0 ) );
+    BOOST_CHECK( !set.IsEdgeIndexCached() );
+    BOOST_CHECK( !set.Contains( VECTOR2I( 50, 50 ) ) );
+    BOOST_CHECK( set.Contains( VECTOR2I( 1050, 50 ) ) );
+
+    // Reading the set through the non-const accessors keeps the index
+    set.CacheEdgeIndex();
+    set.Outline( 0 );
+    BOOST_CHECK( set.IsEdgeIndexCached() );
+
+    set.DropEdgeIndex();
+    BOOST_CHECK( !set.IsEdgeIndexCached() );
+
+    // The copy still has the index of the original polygon
+    BOOST_CHECK( copy.IsEdgeIndexCached() );
+    BOOST_CHECK( copy.Contains( VECTOR2I( 50, 50 ) ) );
+    BOOST_CHECK( !copy.Contains( VECTOR2I( 1050, 50 ) ) );
+}
+
+
+/**
+ * An enabled index is built by the first query, from several threads at once, and again
+ * after each change of the set.  The copies share the index but do not build one.
+ */
+BOOST_AUTO_TEST_CASE( LazyBuild )
+{
+    std::mt19937 rng( 3 );
+    const int range = 1000;
+    SHAPE_POLY_SET plain = randomPolySet( rng, 200, range );
+    SHAPE_POLY_SET indexed = plain;
+
+    indexed.EnableEdgeIndex();
+    BOOST_CHECK( !indexed.IsEdgeIndexCached() );
+
+    std::atomic<int> mismatches( 0 );
+    std::vector<std::thread> threads;
+
+    for( int i = 0; i < 4; i++ )
+    {
+        threads.emplace_back( [&, i]()
+        {
+            for( int x = i; x <= range; x += 20 )
+            {
+                for( int y = 0; y <= range; y += 20 )
+                {
+                    if( indexed.Contains( VECTOR2I( x, y ) ) != plain.Contains( VECTOR2I( x, y ) ) )
+                        mismatches++;
+                }
+            }
+        } );
+    }
+
+    for( std::thread& thread : threads )
+        thread.join();
+
+    BOOST_CHECK_EQUAL( mismatches, 0 );
+    BOOST_CHECK( indexed.IsEdgeIndexCached() );
+
+    SHAPE_POLY_SET copy = indexed;
+    BOOST_CHECK( copy.IsEdgeIndexCached() );
+
+    copy.Move( VECTOR2I( 10, 0 ) );
+    copy.Contains( VECTOR2I( 0, 0 ) );
+    BOOST_CHECK( !copy.IsEdgeIndexCached() );
+
+    indexed.Move( VECTOR2I( 10, 0 ) );
+    plain.Move( VECTOR2I( 10, 0 ) );
+    BOOST_CHECK( !indexed.IsEdgeIndexCached() );
+
+    for( int x = 0; x <= range; x += 10 )
+    {
+        if( indexed.Contains( VECTOR2I( x, range / 2 ) )
+                != plain.Contains( VECTOR2I( x, range / 2 ) ) )
+            mismatches++;
+    }
+
+    BOOST_CHECK_EQUAL( mismatches, 0 );
+    BOOST_CHECK( indexed.IsEdgeIndexCached() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
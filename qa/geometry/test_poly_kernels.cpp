@@ -0,0 +1,267 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <geometry/seg.h>
+#include <geometry/poly_kernels.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+/**
+ * The point in polygon test of SHAPE_POLY_SET before the kernels, as the reference.
+ */
+static bool referencePointInPolygon( const std::vector<VECTOR2I>& aPath, const VECTOR2I& aP )
+{
+    int result = 0;
+    int cnt = aPath.size();
+
+    if( cnt < 3 )
+        return false;
+
+    VECTOR2I ip = aPath[0];
+
+    for( int i = 1; i <= cnt; ++i )
+    {
+        VECTOR2I ipNext = ( i == cnt ? aPath[0] : aPath[i] );
+
+        if( ipNext.y == aP.y )
+        {
+            if( ( ipNext.x == aP.x ) || ( ip.y == aP.y
+                                          && ( ( ipNext.x > aP.x ) == ( ip.x < aP.x ) ) ) )
+                return true;
+        }
+
+        if( ( ip.y < aP.y ) != ( ipNext.y < aP.y ) )
+        {
+            if( ip.x >= aP.x )
+            {
+                if( ipNext.x > aP.x )
+                    result = 1 - result;
+                else
+                {
+                    int64_t d = (int64_t) ( ip.x - aP.x ) * (int64_t) ( ipNext.y - aP.y ) -
+                                (int64_t) ( ipNext.x - aP.x ) * (int64_t) ( ip.y - aP.y );
+
+                    if( !d )
+                        return true;
+
+                    if( ( d > 0 ) == ( ipNext.y > ip.y ) )
+                        result = 1 - result;
+                }
+            }
+            else
+            {
+                if( ipNext.x > aP.x )
+                {
+                    int64_t d = (int64_t) ( ip.x - aP.x ) * (int64_t) ( ipNext.y - aP.y ) -
+                                (int64_t) ( ipNext.x - aP.x ) * (int64_t) ( ip.y - aP.y );
+
+                    if( !d )
+                        return true;
+
+                    if( ( d > 0 ) == ( ipNext.y > ip.y ) )
+                        result = 1 - result;
+                }
+            }
+        }
+
+        ip = ipNext;
+    }
+
+    return result ? true : false;
+}
+
+
+/**
+ * Random polygons of up to aMaxPoints vertices with coordinates in [0, aRange], which for
+ * small ranges gives many collinear edges, duplicated vertices and points on edges.
+ */
+static std::vector<std::vector<VECTOR2I>> randomPolygons( std::mt19937& aRng, int aCount,
+                                                          int aMaxPoints, int aRange )
+{
+    std::uniform_int_distribution<int> coord( 0, aRange );
+    std::uniform_int_distribution<int> size( 0, aMaxPoints );
+    std::vector<std::vector<VECTOR2I>> polys;
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        std::vector<VECTOR2I> poly( size( aRng ) );
+
+        for( VECTOR2I& p : poly )
+            p = VECTOR2I( coord( aRng ), coord( aRng ) );
+
+        polys.push_back( poly );
+    }
+
+    return polys;
+}
+
+
+static const POLY_KERNELS::ISA allIsas[] =
+{
+    POLY_KERNELS::SCALAR, POLY_KERNELS::SSE2, POLY_KERNELS::AVX2
+};
+
+
+BOOST_AUTO_TEST_SUITE( PolyKernels )
+
+
+/**
+ * Every kernel gives the same answer as the reference for all the points of a small grid,
+ * so every vertex and edge of the polygons is tested.
+ */
+BOOST_AUTO_TEST_CASE( PointInPolygonSmallGrid )
+{
+    std::mt19937 rng( 1 );
+    const int range = 12;
+    auto polys = randomPolygons( rng, 300, 40, range );
+    POLY_KERNELS::ISA saved = POLY_KERNELS::Isa();
+
+    for( POLY_KERNELS::ISA isa : allIsas )
+    {
+        POLY_KERNELS::SetIsa( isa );
+
+        int mismatches = 0;
+
+        for( const auto& poly : polys )
+        {
+            for( int x = -1; x <= range + 1; x++ )
+            {
+                for( int y = -1; y <= range + 1; y++ )
+                {
+                    VECTOR2I p( x, y );
+                    bool expected = referencePointInPolygon( poly, p );
+                    bool found = POLY_KERNELS::PointInPolygon( poly.data(), poly.size(), p );
+
+                    mismatches += ( expected != found );
+                }
+            }
+        }
+
+        BOOST_CHECK_EQUAL( mismatches, 0 );
+    }
+
+    POLY_KERNELS::SetIsa( saved );
+}
+
+
+/**
+ * Same with large coordinates, where the cross products need 64 bits.
+ */
+BOOST_AUTO_TEST_CASE( PointInPolygonLargeCoordinates )
+{
+    std::mt19937 rng( 2 );
+    const int range = 1000000000;
+    auto polys = randomPolygons( rng, 200, 100, range );
+    std::uniform_int_distribution<int> coord( -range / 10, range + range / 10 );
+    POLY_KERNELS::ISA saved = POLY_KERNELS::Isa();
+
+    for( POLY_KERNELS::ISA isa : allIsas )
+    {
+        POLY_KERNELS::SetIsa( isa );
+
+        int mismatches = 0;
+
+        for( const auto& poly : polys )
+        {
+            for( int i = 0; i < 500; i++ )
+            {
+                // Test the vertices too
+                VECTOR2I p = ( i < (int) poly.size() ) ? poly[i]
+                                                        : VECTOR2I( coord( rng ), coord( rng ) );
+
+                bool expected = referencePointInPolygon( poly, p );
+                bool found = POLY_KERNELS::PointInPolygon( poly.data(), poly.size(), p );
+
+                mismatches += ( expected != found );
+            }
+        }
+
+        BOOST_CHECK_EQUAL( mismatches, 0 );
+    }
+
+    POLY_KERNELS::SetIsa( saved );
+}
+
+
+/**
+ * The edges found near a point include all the edges within the distance, as measured
+ * by SEG::Distance(), for closed and open chains.
+ */
+BOOST_AUTO_TEST_CASE( EdgesNear )
+{
+    std::mt19937 rng( 3 );
+    const int range = 100000;
+    auto polys = randomPolygons( rng, 200, 60, range );
+    std::uniform_int_distribution<int> coord( 0, range );
+    std::uniform_int_distribution<int> distance( 0, range / 4 );
+    POLY_KERNELS::ISA saved = POLY_KERNELS::Isa();
+
+    for( POLY_KERNELS::ISA isa : allIsas )
+    {
+        POLY_KERNELS::SetIsa( isa );
+
+        int missed = 0;
+
+        for( const auto& poly : polys )
+        {
+            int count = poly.size();
+
+            for( int closed = 0; closed < 2; closed++ )
+            {
+                int edgeCount = std::max( 0, closed ? count : count - 1 );
+
+                for( int i = 0; i < 100; i++ )
+                {
+                    VECTOR2I p( coord( rng ), coord( rng ) );
+                    int dist = distance( rng );
+                    std::vector<int> edges;
+
+                    POLY_KERNELS::EdgesNear( poly.data(), count, edgeCount, p, dist, edges );
+
+                    BOOST_CHECK( std::is_sorted( edges.begin(), edges.end() ) );
+
+                    for( int e = 0; e < edgeCount; e++ )
+                    {
+                        SEG seg( poly[e], poly[( e + 1 ) % count] );
+
+                        if( seg.Distance( p ) <= dist
+                                && !std::binary_search( edges.begin(), edges.end(), e ) )
+                        {
+                            missed++;
+                        }
+                    }
+                }
+            }
+        }
+
+        BOOST_CHECK_EQUAL( missed, 0 );
+    }
+
+    POLY_KERNELS::SetIsa( saved );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,125 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __PNS_TEST_IFACE_H
+#define __PNS_TEST_IFACE_H
+
+#include <layers_id_colors_and_visibility.h>
+
+#include <router/pns_router.h>
+#include <router/pns_node.h>
+#include <router/pns_segment.h>
+#include <router/pns_debug_decorator.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * Rules with the same clearance between all the items, and no differential pairs.
+ */
+class TEST_RULE_RESOLVER : public PNS::RULE_RESOLVER
+{
+public:
+    TEST_RULE_RESOLVER( int aClearance ) :
+        m_clearance( aClearance )
+    {}
+
+    int Clearance( const PNS::ITEM* aA, const PNS::ITEM* aB ) const override
+    {
+        return m_clearance;
+    }
+
+    int Clearance( int aNetCode ) const override
+    {
+        return m_clearance;
+    }
+
+    void OverrideClearance( bool aEnable, int aNetA, int aNetB, int aClearance ) override {}
+    void UseDpGap( bool aUseDpGap ) override {}
+    int DpCoupledNet( int aNet ) override { return -1; }
+    int DpNetPolarity( int aNet ) override { return 0; }
+    bool DpNetPair( PNS::ITEM* aItem, int& aNetP, int& aNetN ) override { return false; }
+
+private:
+    int m_clearance;
+};
+
+
+/**
+ * Router interface with no board and no view: the world is made of the segments given
+ * to the constructor, and the committed changes stay in the world.
+ */
+class TEST_IFACE : public PNS::ROUTER_IFACE
+{
+public:
+    TEST_IFACE( const std::vector<std::pair<SEG, int>>& aSegments, int aWidth,
+                int aClearance ) :
+        m_segments( aSegments ),
+        m_width( aWidth ),
+        m_ruleResolver( aClearance )
+    {}
+
+    void SetRouter( PNS::ROUTER* aRouter ) override {}
+
+    void SyncWorld( PNS::NODE* aWorld ) override
+    {
+        for( const auto& segment : m_segments )
+        {
+            std::unique_ptr<PNS::SEGMENT> item( new PNS::SEGMENT( segment.first,
+                                                                  segment.second ) );
+            item->SetWidth( m_width );
+            item->SetLayers( LAYER_RANGE( F_Cu ) );
+            aWorld->Add( std::move( item ) );
+        }
+
+        aWorld->SetRuleResolver( &m_ruleResolver );
+        aWorld->SetMaxClearance( 4 * m_ruleResolver.Clearance( 0 ) );
+    }
+
+    void AddItem( PNS::ITEM* aItem ) override {}
+    void RemoveItem( PNS::ITEM* aItem ) override {}
+    void DisplayItem( const PNS::ITEM* aItem, int aColor, int aClearance ) override {}
+    void HideItem( PNS::ITEM* aItem ) override {}
+    void Commit() override {}
+    void EraseView() override {}
+    void UpdateNet( int aNetCode ) override {}
+
+    PNS::RULE_RESOLVER* GetRuleResolver() override
+    {
+        return &m_ruleResolver;
+    }
+
+    PNS::DEBUG_DECORATOR* GetDebugDecorator() override
+    {
+        return &m_debugDecorator;
+    }
+
+private:
+    std::vector<std::pair<SEG, int>> m_segments;
+    int                              m_width;
+    TEST_RULE_RESOLVER               m_ruleResolver;
+    PNS::DEBUG_DECORATOR             m_debugDecorator;
+};
+
+#endif
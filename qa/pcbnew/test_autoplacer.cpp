@@ -0,0 +1,261 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fctsys.h>
+#include <convert_to_biu.h>
+
+#include <class_board.h>
+#include <class_drawsegment.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <autorouter/ar_autoplacer.h>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+/**
+ * Adds to aBoard an Edge_Cuts rectangle from ( 0, 0 ) to ( aWidth, aHeight ).
+ */
+static void addOutline( BOARD& aBoard, int aWidth, int aHeight )
+{
+    const wxPoint corners[4] =
+    {
+        wxPoint( 0, 0 ), wxPoint( aWidth, 0 ), wxPoint( aWidth, aHeight ), wxPoint( 0, aHeight )
+    };
+
+    for( int ii = 0; ii < 4; ++ii )
+    {
+        DRAWSEGMENT* edge = new DRAWSEGMENT( &aBoard );
+
+        edge->SetLayer( Edge_Cuts );
+        edge->SetStart( corners[ii] );
+        edge->SetEnd( corners[( ii + 1 ) % 4] );
+        edge->SetWidth( Millimeter2iu( 0.1 ) );
+        aBoard.Add( edge );
+    }
+}
+
+
+/**
+ * Builds a board of aWidth by aHeight with aFootprintCount footprints outside of it.
+ * Each footprint has a row of SMD pads on random nets among aNetCount; the board is
+ * the same for a given seed.
+ */
+static void buildBoard( BOARD& aBoard, int aWidth, int aHeight, int aFootprintCount,
+                        int aNetCount, unsigned int aSeed )
+{
+    std::mt19937 rng( aSeed );
+
+    for( int net = 1; net <= aNetCount; ++net )
+        aBoard.Add( new NETINFO_ITEM( &aBoard, wxString::Format( "N%d", net ), net ) );
+
+    addOutline( aBoard, aWidth, aHeight );
+
+    for( int ii = 0; ii < aFootprintCount; ++ii )
+    {
+        MODULE* module = new MODULE( &aBoard );
+
+        module->SetPosition( wxPoint( -Millimeter2iu( 50 ), Millimeter2iu( 5 ) * ii ) );
+        module->SetPlacementCost90( rng() % 2 ? 10 : 0 );
+
+        int padCount = 2 + rng() % 5;
+
+        for( int jj = 0; jj < padCount; ++jj )
+        {
+            D_PAD* pad = new D_PAD( module );
+
+            pad->SetShape( PAD_SHAPE_RECT );
+            pad->SetAttribute( PAD_ATTRIB_SMD );
+            pad->SetLayerSet( D_PAD::SMDMask() );
+            pad->SetSize( wxSize( Millimeter2iu( 1.0 ), Millimeter2iu( 1.5 ) ) );
+            pad->SetPos0( wxPoint( Millimeter2iu( 2.54 ) * jj, 0 ) );
+            pad->SetDrawCoord();
+            pad->SetNetCode( 1 + rng() % aNetCount );
+            module->Add( pad );
+        }
+
+        module->CalculateBoundingBox();
+        aBoard.Add( module );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( Autoplacer )
+
+/**
+ * The summed area sums of random rectangles, empty ones included, must be the sums of
+ * their cells.
+ */
+BOOST_AUTO_TEST_CASE( SummedArea )
+{
+    std::mt19937 rng( 17 );
+    int mismatches = 0;
+
+    for( int iter = 0; iter < 20; iter++ )
+    {
+        const int width = 1 + rng() % 70;
+        const int height = 1 + rng() % 70;
+        std::vector<uint64_t> values( width * height );
+
+        for( uint64_t& value : values )
+            value = rng() % 3 ? 0 : rng() % 1000;
+
+        AR_SUMMED_AREA<uint64_t> table;
+
+        table.Build( width, height,
+                [&]( int aX, int aY )
+                {
+                    return values[aY * width + aX];
+                } );
+
+        for( int ii = 0; ii < 500; ii++ )
+        {
+            int x0 = rng() % width;
+            int x1 = rng() % width;
+            int y0 = rng() % height;
+            int y1 = rng() % height;
+
+            uint64_t expected = 0;
+
+            for( int y = y0; y <= y1; y++ )
+            {
+                for( int x = x0; x <= x1; x++ )
+                    expected += values[y * width + x];
+            }
+
+            if( table.Sum( x0, y0, x1, y1 ) != expected )
+                mismatches++;
+        }
+    }
+
+    BOOST_CHECK_EQUAL( mismatches, 0 );
+}
+
+
+/**
+ * The cost to the nearest anchor found with the buckets must be the lowest cost to all
+ * the anchors, for anchors spread over the board or clustered, and points anywhere,
+ * negative coordinates included.
+ */
+BOOST_AUTO_TEST_CASE( NearestAnchor )
+{
+    std::mt19937 rng( 23 );
+    int mismatches = 0;
+
+    for( int iter = 0; iter < 50; iter++ )
+    {
+        const int range = Millimeter2iu( 200 );
+        const bool clustered = iter % 2;
+        AR_ANCHOR_INDEX index( Millimeter2iu( 8 ) );
+        std::vector<VECTOR2I> anchors;
+
+        int count = 1 + rng() % 300;
+        VECTOR2I center( rng() % range - range / 2, rng() % range - range / 2 );
+
+        for( int ii = 0; ii < count; ii++ )
+        {
+            VECTOR2I pos( rng() % range - range / 2, rng() % range - range / 2 );
+
+            if( clustered )
+                pos = center + VECTOR2I( pos.x / 20, pos.y / 20 );
+
+            anchors.push_back( pos );
+            index.Add( pos );
+        }
+
+        BOOST_REQUIRE_EQUAL( index.Size(), anchors.size() );
+
+        for( int ii = 0; ii < 200; ii++ )
+        {
+            VECTOR2I pos( rng() % ( 2 * range ) - range, rng() % ( 2 * range ) - range );
+            double expected = std::numeric_limits<double>::max();
+
+            for( const VECTOR2I& anchor : anchors )
+                expected = std::min( expected, AR_ANCHOR_INDEX::Cost( pos, anchor ) );
+
+            if( index.NearestCost( pos ) != expected )
+                mismatches++;
+        }
+    }
+
+    BOOST_CHECK_EQUAL( mismatches, 0 );
+}
+
+
+/**
+ * Footprints placed on a board must be inside of it and must not overlap, and the
+ * placement must not depend on the number of threads.
+ */
+BOOST_AUTO_TEST_CASE( PlaceFootprints )
+{
+    const int width = Millimeter2iu( 60 );
+    const int height = Millimeter2iu( 40 );
+
+    BOARD boards[2];
+    std::vector<MODULE*> placed[2];
+
+    for( int ii = 0; ii < 2; ++ii )
+    {
+        buildBoard( boards[ii], width, height, 15, 12, 31 );
+
+        AR_AUTOPLACER placer( &boards[ii] );
+        placer.SetThreadCount( ii ? 4 : 1 );
+
+        BOOST_CHECK_EQUAL( placer.AutoplaceFootprints( AR_AUTOPLACER::AR_PLACE_ALL ), 15 );
+
+        for( MODULE* module : boards[ii].Modules() )
+            placed[ii].push_back( module );
+    }
+
+    const std::vector<MODULE*>& modules = placed[0];
+    const std::vector<MODULE*>& others = placed[1];
+
+    BOOST_REQUIRE_EQUAL( modules.size(), others.size() );
+
+    for( size_t ii = 0; ii < modules.size(); ++ii )
+    {
+        BOOST_CHECK( modules[ii]->GetPosition() == others[ii]->GetPosition() );
+        BOOST_CHECK_EQUAL( modules[ii]->GetOrientation(), others[ii]->GetOrientation() );
+
+        EDA_RECT rect = modules[ii]->GetFootprintRect();
+
+        BOOST_CHECK( rect.GetX() >= 0 && rect.GetY() >= 0 );
+        BOOST_CHECK( rect.GetRight() <= width && rect.GetBottom() <= height );
+
+        for( size_t jj = 0; jj < ii; ++jj )
+        {
+            EDA_RECT other = modules[jj]->GetFootprintRect();
+
+            bool overlap = rect.GetX() < other.GetRight() && other.GetX() < rect.GetRight()
+                           && rect.GetY() < other.GetBottom() && other.GetY() < rect.GetBottom();
+
+            BOOST_CHECK( !overlap );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
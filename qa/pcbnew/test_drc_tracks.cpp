@@ -0,0 +1,157 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fctsys.h>
+#include <convert_to_biu.h>
+
+#include <class_board.h>
+#include <class_marker_pcb.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <drc.h>
+
+#include <random>
+#include <vector>
+
+/**
+ * Fills aBoard with random tracks and vias of 5 nets, crossing each other, and a module
+ * with through hole pads in the middle of them, so that many clearances are violated.
+ */
+static void fillBoard( BOARD& aBoard, std::mt19937& aRng )
+{
+    const int size = Millimeter2iu( 40 );
+    const int netCount = 5;
+
+    for( int net = 1; net <= netCount; ++net )
+        aBoard.Add( new NETINFO_ITEM( &aBoard, wxString::Format( "N%d", net ), net ) );
+
+    auto coord = [&]()
+    {
+        return (int) ( aRng() % size );
+    };
+
+    for( int ii = 0; ii < 600; ++ii )
+    {
+        TRACK* track = new TRACK( &aBoard );
+        wxPoint start( coord(), coord() );
+
+        track->SetStart( start );
+        track->SetEnd( start + wxPoint( coord() / 8, coord() / 8 ) );
+        track->SetWidth( Millimeter2iu( 0.1 ) + aRng() % Millimeter2iu( 0.4 ) );
+        track->SetLayer( aRng() % 2 ? F_Cu : B_Cu );
+        track->SetNetCode( 1 + aRng() % netCount );
+        aBoard.Add( track );
+    }
+
+    for( int ii = 0; ii < 60; ++ii )
+    {
+        VIA* via = new VIA( &aBoard );
+
+        via->SetPosition( wxPoint( coord(), coord() ) );
+        via->SetEnd( via->GetPosition() );
+        via->SetWidth( Millimeter2iu( 0.6 ) );
+        via->SetDrill( Millimeter2iu( 0.3 ) );
+        via->SetViaType( VIA_THROUGH );
+        via->SetLayerPair( F_Cu, B_Cu );
+        via->SetNetCode( 1 + aRng() % netCount );
+        aBoard.Add( via );
+    }
+
+    MODULE* module = new MODULE( &aBoard );
+
+    for( int ii = 0; ii < 40; ++ii )
+    {
+        D_PAD*  pad = new D_PAD( module );
+        wxPoint pos( coord(), coord() );
+
+        pad->SetShape( ii % 2 ? PAD_SHAPE_CIRCLE : PAD_SHAPE_RECT );
+        pad->SetSize( wxSize( Millimeter2iu( 1.5 ), Millimeter2iu( 1.5 ) ) );
+        pad->SetDrillSize( wxSize( Millimeter2iu( 0.8 ), Millimeter2iu( 0.8 ) ) );
+        pad->SetAttribute( PAD_ATTRIB_STANDARD );
+        pad->SetLayerSet( D_PAD::StandardMask() );
+        pad->SetPosition( pos );
+        pad->SetPos0( pos );
+        pad->SetNetCode( 1 + aRng() % netCount );
+        module->Add( pad );
+    }
+
+    aBoard.Add( module );
+}
+
+
+/**
+ * Returns the reports of the markers of aBoard, in their order.
+ */
+static std::vector<wxString> markerReports( const BOARD& aBoard )
+{
+    std::vector<wxString> reports;
+
+    for( int ii = 0; ii < aBoard.GetMARKERCount(); ++ii )
+        reports.push_back( aBoard.GetMARKER( ii )->GetReporter().ShowReport() );
+
+    return reports;
+}
+
+
+BOOST_AUTO_TEST_SUITE( DrcTracks )
+
+/**
+ * Runs the track DRC of random boards on one thread, then on several, and checks that the
+ * markers are the same, in the same order.
+ */
+BOOST_AUTO_TEST_CASE( ParallelSameAsSerial )
+{
+    std::mt19937 rng( 3 );
+    int mismatches = 0;
+    size_t markers = 0;
+
+    for( int iter = 0; iter < 5; ++iter )
+    {
+        BOARD board;
+
+        fillBoard( board, rng );
+
+        DRC drc( &board );
+
+        drc.TestTracks( 1 );
+        std::vector<wxString> serial = markerReports( board );
+        markers += serial.size();
+
+        for( int threadCount : { 2, 3, 8 } )
+        {
+            board.DeleteMARKERs();
+            drc.TestTracks( threadCount );
+
+            if( markerReports( board ) != serial )
+                mismatches++;
+        }
+    }
+
+    BOOST_CHECK( markers > 0 );
+    BOOST_CHECK_EQUAL( mismatches, 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
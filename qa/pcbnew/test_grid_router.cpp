@@ -0,0 +1,399 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fctsys.h>
+#include <convert_to_biu.h>
+
+#include <class_board.h>
+#include <class_drawsegment.h>
+#include <class_track.h>
+#include <autorouter/ar_grid_matrix.h>
+#include <autorouter/ar_grid_router.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+/**
+ * Returns the distance from aP to the nearest edge of aPoly.
+ */
+static double edgeDistance( const SHAPE_POLY_SET& aPoly, const VECTOR2I& aP )
+{
+    double best = std::numeric_limits<double>::max();
+
+    auto visit = [&]( const SHAPE_LINE_CHAIN& aChain )
+    {
+        for( int ii = 0; ii < aChain.PointCount(); ii++ )
+        {
+            SEG edge( aChain.CPoint( ii ), aChain.CPoint( ( ii + 1 ) % aChain.PointCount() ) );
+            best = std::min( best, std::sqrt( (double) edge.SquaredDistance( aP ) ) );
+        }
+    };
+
+    for( int outline = 0; outline < aPoly.OutlineCount(); outline++ )
+    {
+        visit( aPoly.COutline( outline ) );
+
+        for( int hole = 0; hole < aPoly.HoleCount( outline ); hole++ )
+            visit( aPoly.CHole( outline, hole ) );
+    }
+
+    return best;
+}
+
+
+/**
+ * Returns a random star shaped polygon around aCenter, with a square hole half of the
+ * times.
+ */
+static SHAPE_POLY_SET randomPolygon( std::mt19937& aRng, const VECTOR2I& aCenter, int aRadius )
+{
+    SHAPE_POLY_SET poly;
+    int count = 3 + aRng() % 10;
+
+    poly.NewOutline();
+
+    for( int ii = 0; ii < count; ii++ )
+    {
+        double angle = 2.0 * M_PI * ii / count;
+        double radius = aRadius * ( 0.4 + 0.6 * ( aRng() % 1000 ) / 1000.0 );
+
+        poly.Append( aCenter.x + (int) ( radius * cos( angle ) ),
+                     aCenter.y + (int) ( radius * sin( angle ) ) );
+    }
+
+    if( aRng() % 2 )
+    {
+        int half = aRadius / 8;
+
+        poly.NewHole();
+        poly.Append( aCenter.x - half, aCenter.y - half, -1, 0 );
+        poly.Append( aCenter.x - half, aCenter.y + half, -1, 0 );
+        poly.Append( aCenter.x + half, aCenter.y + half, -1, 0 );
+        poly.Append( aCenter.x + half, aCenter.y - half, -1, 0 );
+    }
+
+    return poly;
+}
+
+
+/**
+ * Adds to aBoard a track from aStart to aEnd.
+ */
+static TRACK* addTrack( BOARD& aBoard, const VECTOR2I& aStart, const VECTOR2I& aEnd,
+                        int aNet, PCB_LAYER_ID aLayer )
+{
+    TRACK* track = new TRACK( &aBoard );
+
+    track->SetStart( wxPoint( aStart.x, aStart.y ) );
+    track->SetEnd( wxPoint( aEnd.x, aEnd.y ) );
+    track->SetWidth( aBoard.GetDesignSettings().GetDefault()->GetTrackWidth() );
+    track->SetLayer( aLayer );
+    track->SetNetCode( aNet );
+    aBoard.Add( track );
+
+    return track;
+}
+
+
+/**
+ * Returns the number of pairs of tracks and vias of different nets of aItems closer than
+ * aClearance.
+ */
+static int countViolations( const std::vector<BOARD_CONNECTED_ITEM*>& aItems, int aClearance )
+{
+    struct SHAPE
+    {
+        SEG  m_seg;
+        int  m_radius;
+        LSET m_layers;
+        int  m_net;
+    };
+
+    std::vector<SHAPE> shapes;
+
+    for( BOARD_CONNECTED_ITEM* item : aItems )
+    {
+        const TRACK* track = static_cast<const TRACK*>( item );
+        VECTOR2I start( track->GetStart().x, track->GetStart().y );
+        VECTOR2I end( track->GetEnd().x, track->GetEnd().y );
+
+        shapes.push_back( { SEG( start, end ), track->GetWidth() / 2, track->GetLayerSet(),
+                            track->GetNetCode() } );
+    }
+
+    int violations = 0;
+
+    for( size_t ii = 0; ii < shapes.size(); ii++ )
+    {
+        for( size_t jj = 0; jj < ii; jj++ )
+        {
+            const SHAPE& a = shapes[ii];
+            const SHAPE& b = shapes[jj];
+
+            if( a.m_net == b.m_net || !( a.m_layers & b.m_layers ).any() )
+                continue;
+
+            double distance = std::sqrt( (double) a.m_seg.SquaredDistance( b.m_seg ) );
+
+            // 1 nm of tolerance for the rounding of the track ends
+            if( distance - a.m_radius - b.m_radius < aClearance - 1 )
+                violations++;
+        }
+    }
+
+    return violations;
+}
+
+
+BOOST_AUTO_TEST_SUITE( GridRouter )
+
+/**
+ * Spans set in bit planes of various widths, across word boundaries or not, and the
+ * complement of a plane, must match a plain array of cells.  The padding bits at the
+ * end of the rows must stay clear.
+ */
+BOOST_AUTO_TEST_CASE( BitPlane )
+{
+    std::mt19937 rng( 3 );
+    int mismatches = 0;
+
+    for( int iter = 0; iter < 100; iter++ )
+    {
+        const int width = 1 + rng() % 200;
+        const int height = 1 + rng() % 20;
+        const int paddedWidth = ( width + 63 ) / 64 * 64;
+
+        AR_BITPLANE plane;
+        std::vector<bool> expected( width * height, false );
+
+        plane.Resize( width, height );
+
+        for( int ii = 0; ii < 30; ii++ )
+        {
+            int y = rng() % height;
+            int x0 = rng() % width;
+            int x1 = x0 + rng() % ( width - x0 );
+
+            plane.SetSpan( y, x0, x1 );
+
+            for( int x = x0; x <= x1; x++ )
+                expected[y * width + x] = true;
+        }
+
+        if( iter % 2 )
+        {
+            AR_BITPLANE complement;
+
+            complement.Resize( width, height );
+            complement.SetComplement( plane );
+            plane = complement;
+            expected.flip();
+        }
+
+        for( int y = 0; y < height; y++ )
+        {
+            for( int x = 0; x < paddedWidth; x++ )
+            {
+                bool set = x < width && expected[y * width + x];
+
+                if( plane.Get( x, y ) != set )
+                    mismatches++;
+            }
+        }
+    }
+
+    BOOST_CHECK_EQUAL( mismatches, 0 );
+}
+
+
+/**
+ * The cells blocked by a polygon must be the cells whose center is inside of it, on the
+ * planes it was added to only.  Centers too close to the outline to tell are skipped.
+ */
+BOOST_AUTO_TEST_CASE( MatrixFill )
+{
+    std::mt19937 rng( 7 );
+    int mismatches = 0;
+    int tested = 0;
+
+    for( int iter = 0; iter < 50; iter++ )
+    {
+        const int pitch = 1000 + rng() % 50000;
+        BOX2I area( VECTOR2I( rng() % 100000 - 50000, rng() % 100000 - 50000 ),
+                    VECTOR2I( pitch * ( 10 + rng() % 100 ), pitch * ( 10 + rng() % 100 ) ) );
+
+        AR_GRID_MATRIX matrix( area, pitch, 3 );
+
+        // Polygons partly outside of the matrix too
+        VECTOR2I center( area.GetX() + rng() % area.GetWidth(),
+                         area.GetY() + rng() % area.GetHeight() );
+        SHAPE_POLY_SET trackPoly = randomPolygon( rng, center, area.GetWidth() / 2 );
+        SHAPE_POLY_SET viaPoly = randomPolygon( rng, area.Centre(), area.GetHeight() / 3 );
+
+        matrix.BlockTracks( trackPoly, 1 << 1 );
+        matrix.BlockVias( viaPoly );
+
+        for( int y = 0; y < matrix.Height(); y++ )
+        {
+            for( int x = 0; x < matrix.Width(); x++ )
+            {
+                VECTOR2I pos = matrix.CellPos( x, y );
+
+                if( matrix.IsTrackBlocked( x, y, 0 ) || matrix.IsTrackBlocked( x, y, 2 ) )
+                    mismatches++;
+
+                if( edgeDistance( trackPoly, pos ) > 2.0 )
+                {
+                    tested++;
+
+                    if( matrix.IsTrackBlocked( x, y, 1 ) != trackPoly.Contains( pos ) )
+                        mismatches++;
+                }
+
+                if( edgeDistance( viaPoly, pos ) > 2.0
+                        && matrix.IsViaBlocked( x, y ) != viaPoly.Contains( pos ) )
+                {
+                    mismatches++;
+                }
+            }
+        }
+    }
+
+    BOOST_CHECK( tested > 0 );
+    BOOST_CHECK_EQUAL( mismatches, 0 );
+}
+
+
+/**
+ * Routes connections on boards crossed by tracks of another net at random angles, which
+ * makes many diagonal steps pass close to them, and checks the clearance between all the
+ * tracks and vias of different nets.
+ */
+BOOST_AUTO_TEST_CASE( Clearance )
+{
+    const int size = Millimeter2iu( 30 );
+    const int pitch = Millimeter2iu( 0.25 );
+    const int netCount = 3;
+    const int obstacleNet = netCount + 1;
+
+    std::mt19937 rng( 11 );
+    int violations = 0;
+    int routed = 0;
+
+    for( int iter = 0; iter < 20; iter++ )
+    {
+        BOARD board;
+
+        for( int net = 1; net <= obstacleNet; ++net )
+            board.Add( new NETINFO_ITEM( &board, wxString::Format( "N%d", net ), net ) );
+
+        const wxPoint corners[4] =
+        {
+            wxPoint( 0, 0 ), wxPoint( size, 0 ), wxPoint( size, size ), wxPoint( 0, size )
+        };
+
+        for( int ii = 0; ii < 4; ++ii )
+        {
+            DRAWSEGMENT* edge = new DRAWSEGMENT( &board );
+
+            edge->SetLayer( Edge_Cuts );
+            edge->SetStart( corners[ii] );
+            edge->SetEnd( corners[( ii + 1 ) % 4] );
+            board.Add( edge );
+        }
+
+        // Two short tracks on the grid for each net to route, a connection between them,
+        // away from each other
+        std::vector<SEG> anchors;
+        const int cells = ( size - Millimeter2iu( 8 ) ) / pitch;
+
+        while( (int) anchors.size() < 2 * netCount )
+        {
+            VECTOR2I start( Millimeter2iu( 4 ) + pitch * (int) ( rng() % cells ),
+                            Millimeter2iu( 4 ) + pitch * (int) ( rng() % cells ) );
+            SEG anchor( start, start + VECTOR2I( 2 * pitch, 0 ) );
+            bool clear = true;
+
+            for( const SEG& other : anchors )
+                clear &= anchor.Distance( other ) > Millimeter2iu( 1.5 );
+
+            if( !clear )
+                continue;
+
+            addTrack( board, anchor.A, anchor.B, 1 + (int) anchors.size() / 2, F_Cu );
+            anchors.push_back( anchor );
+        }
+
+        // Obstacles anywhere but next to the tracks to connect
+        for( int ii = 0; ii < 40; ++ii )
+        {
+            VECTOR2I start( Millimeter2iu( 1 ) + rng() % ( size - Millimeter2iu( 2 ) ),
+                            Millimeter2iu( 1 ) + rng() % ( size - Millimeter2iu( 2 ) ) );
+            double angle = 2.0 * M_PI * ( rng() % 3600 ) / 3600.0;
+            double length = Millimeter2iu( 1 ) + rng() % Millimeter2iu( 5 );
+            VECTOR2I end = start + VECTOR2I( (int) ( length * cos( angle ) ),
+                                             (int) ( length * sin( angle ) ) );
+
+            SEG obstacle( start, end );
+            bool clear = true;
+
+            for( const SEG& anchor : anchors )
+                clear &= obstacle.Distance( anchor ) > Millimeter2iu( 1.5 );
+
+            if( clear )
+                addTrack( board, start, end, obstacleNet, rng() % 2 ? F_Cu : B_Cu );
+        }
+
+        board.BuildConnectivity();
+
+        AR_GRID_ROUTER router( &board );
+        std::vector<BOARD_CONNECTED_ITEM*> newItems;
+
+        router.SetGridPitch( pitch );
+        router.Route( newItems );
+
+        routed += router.Stats().m_routed;
+
+        std::vector<BOARD_CONNECTED_ITEM*> items( newItems );
+
+        for( TRACK* track : board.Tracks() )
+            items.push_back( track );
+
+        violations += countViolations( items,
+                                       board.GetDesignSettings().GetBiggestClearanceValue() );
+
+        for( BOARD_CONNECTED_ITEM* item : newItems )
+            delete item;
+    }
+
+    BOOST_CHECK( routed > 0 );
+    BOOST_CHECK_EQUAL( violations, 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
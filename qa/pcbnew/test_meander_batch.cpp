@@ -0,0 +1,140 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fctsys.h>
+
+#include <router/pns_meander_batch.h>
+
+#include "pns_test_iface.h"
+
+#include <memory>
+#include <set>
+#include <vector>
+
+/**
+ * Returns the total length of the segments of aNet in aNode.
+ */
+static int netLength( PNS::NODE* aNode, int aNet )
+{
+    std::set<PNS::ITEM*> items;
+    int length = 0;
+
+    aNode->AllItemsInNet( aNet, items );
+
+    for( PNS::ITEM* item : items )
+    {
+        if( PNS::SEGMENT* segment = dyn_cast<PNS::SEGMENT*>( item ) )
+            length += segment->Seg().Length();
+    }
+
+    return length;
+}
+
+
+BOOST_AUTO_TEST_SUITE( MeanderBatch )
+
+/**
+ * Tunes parallel tracks laid out so close that the meanders of neighbor nets, made each
+ * in its own branch, collide: the merge has to tune the nets again on top of the ones
+ * merged before.  After the commit, no track may collide with another one, and the
+ * lengths reported must be the lengths of the nets.
+ */
+BOOST_AUTO_TEST_CASE( MergeAndRetune )
+{
+    const int netCount = 4;
+    const int width = 200000;
+    const int clearance = 200000;
+    const int spacing = 1000000;
+
+    std::vector<std::pair<SEG, int>> segments;
+    std::vector<int> nets;
+
+    for( int net = 1; net <= netCount; ++net )
+    {
+        int length = 20000000 - net * 1000000;
+        VECTOR2I start( 0, net * spacing );
+
+        segments.push_back( std::make_pair( SEG( start, start + VECTOR2I( length, 0 ) ), net ) );
+        nets.push_back( net );
+    }
+
+    TEST_IFACE iface( segments, width, clearance );
+    PNS::ROUTER router;
+
+    router.SetInterface( &iface );
+    router.SyncWorld();
+
+    std::vector<int> originalLengths;
+
+    for( int net : nets )
+        originalLengths.push_back( netLength( router.GetWorld(), net ) );
+
+    PNS::MEANDER_SETTINGS settings;
+    settings.m_targetLength = 24000000;
+
+    PNS::MEANDER_BATCH batch( &router );
+    batch.SetSettings( settings );
+
+    BOOST_REQUIRE( batch.Run( nets ) );
+    BOOST_CHECK_EQUAL( batch.TargetLength(), settings.m_targetLength );
+
+    const std::vector<PNS::MEANDER_BATCH::RESULT>& results = batch.Results();
+    int retuned = 0;
+
+    BOOST_REQUIRE_EQUAL( results.size(), nets.size() );
+
+    for( size_t ii = 0; ii < results.size(); ++ii )
+    {
+        BOOST_CHECK_EQUAL( results[ii].m_net, nets[ii] );
+        BOOST_CHECK_EQUAL( results[ii].m_originalLength, originalLengths[ii] );
+        BOOST_CHECK( results[ii].m_length >= results[ii].m_originalLength );
+
+        if( results[ii].m_retuned )
+            retuned++;
+    }
+
+    // The first net is merged first, and never tuned again
+    BOOST_CHECK( !results[0].m_retuned );
+    BOOST_CHECK( retuned > 0 );
+
+    batch.Commit();
+
+    PNS::NODE* world = router.GetWorld();
+
+    for( size_t ii = 0; ii < results.size(); ++ii )
+    {
+        // Each segment length is rounded
+        BOOST_CHECK_CLOSE( (double) netLength( world, nets[ii] ),
+                           (double) results[ii].m_length, 0.01 );
+
+        std::set<PNS::ITEM*> items;
+        world->AllItemsInNet( nets[ii], items );
+
+        for( PNS::ITEM* item : items )
+            BOOST_CHECK( !world->CheckColliding( item ) );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
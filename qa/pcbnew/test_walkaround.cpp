@@ -0,0 +1,151 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fctsys.h>
+
+#include <router/pns_line.h>
+#include <router/pns_walkaround.h>
+
+#include "pns_test_iface.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+/**
+ * Obstacles of net 1 for a track of net 2 going from the origin to aEnd: segments
+ * crossing the track at random, and segments crossing each other next to aEnd, so that
+ * the end of the track is inside the hulls of several obstacles.
+ */
+static std::vector<std::pair<SEG, int>> blockedObstacles( std::mt19937& aRng,
+                                                          const VECTOR2I& aEnd )
+{
+    std::uniform_int_distribution<int> along( aEnd.x / 5, aEnd.x - aEnd.x / 10 );
+    std::uniform_int_distribution<int> offset( -2000000, 2000000 );
+    std::uniform_int_distribution<int> count( 2, 6 );
+    std::vector<std::pair<SEG, int>> obstacles;
+
+    for( int i = count( aRng ); i > 0; i-- )
+    {
+        VECTOR2I a( along( aRng ), offset( aRng ) - 3000000 );
+        VECTOR2I b( along( aRng ), offset( aRng ) + 3000000 );
+
+        obstacles.push_back( std::make_pair( SEG( a, b ), 1 ) );
+    }
+
+    // Crossing segments around the end: the nearest point of the hull of one is inside
+    // the hull of another one
+    std::uniform_real_distribution<double> angle( 0.0, M_PI );
+    std::uniform_int_distribution<int> near( -300000, 300000 );
+
+    for( int i = 0; i < 3; i++ )
+    {
+        VECTOR2I center( aEnd.x + near( aRng ), aEnd.y + near( aRng ) );
+        double a = angle( aRng );
+        VECTOR2I arm( (int) ( 1500000 * cos( a ) ), (int) ( 1500000 * sin( a ) ) );
+
+        obstacles.push_back( std::make_pair( SEG( center - arm, center + arm ), 1 ) );
+    }
+
+    return obstacles;
+}
+
+
+/**
+ * Walks aLine around the obstacles of aRouter's world, in both directions or in the
+ * aCw direction only, and returns the path in aResult.
+ */
+static void walk( PNS::ROUTER& aRouter, const PNS::LINE& aLine, bool aForceWinding, bool aCw,
+                  PNS::LINE& aResult )
+{
+    PNS::WALKAROUND walkaround( aRouter.GetWorld(), &aRouter );
+
+    walkaround.SetForceWinding( aForceWinding, aCw );
+    walkaround.Route( aLine, aResult, false );
+}
+
+
+BOOST_AUTO_TEST_SUITE( Walkaround )
+
+/**
+ * The end of the track is blocked by obstacles, so the walk retries from the nearest
+ * point of their hulls, and clips the path at the third blockage.  Each winding direction
+ * counts its own blockages: walking both directions gives the path of one of them walked
+ * alone, which would not be the case if the blockages of the other one were counted.
+ */
+BOOST_AUTO_TEST_CASE( BlockedEnd )
+{
+    std::mt19937 rng( 7 );
+    const int width = 200000;
+    const int clearance = 200000;
+    int compared = 0;
+    int blocked = 0;
+
+    for( int ii = 0; ii < 50; ii++ )
+    {
+        VECTOR2I end( 20000000, 0 );
+
+        TEST_IFACE iface( blockedObstacles( rng, end ), width, clearance );
+        PNS::ROUTER router;
+
+        router.SetInterface( &iface );
+        router.SyncWorld();
+
+        PNS::LINE line;
+        line.SetShape( SHAPE_LINE_CHAIN( VECTOR2I( 0, 0 ), end ) );
+        line.SetWidth( width );
+        line.SetNet( 2 );
+        line.SetLayer( F_Cu );
+
+        PNS::LINE both, cw, ccw;
+
+        walk( router, line, false, false, both );
+        walk( router, line, true, true, cw );
+        walk( router, line, true, false, ccw );
+
+        // A clipped path does not reach the end
+        if( both.PointCount() && both.CPoint( -1 ) != end )
+            blocked++;
+
+        // A direction which does not get done within the iteration limit gives back the
+        // initial line when walked alone
+        bool cwDone = !cw.CLine().CompareGeometry( line.CLine() );
+        bool ccwDone = !ccw.CLine().CompareGeometry( line.CLine() );
+
+        if( !cwDone && !ccwDone )
+            continue;
+
+        bool sameAsCw = cwDone && both.CLine().CompareGeometry( cw.CLine() );
+        bool sameAsCcw = ccwDone && both.CLine().CompareGeometry( ccw.CLine() );
+
+        BOOST_CHECK( sameAsCw || sameAsCcw );
+        compared++;
+    }
+
+    BOOST_CHECK( compared > 0 );
+    BOOST_CHECK( blocked > 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
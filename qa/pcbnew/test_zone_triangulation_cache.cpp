@@ -0,0 +1,140 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fctsys.h>
+#include <wx/filename.h>
+
+#include <class_board.h>
+#include <class_zone.h>
+#include <zone_triangulation_cache.h>
+
+/**
+ * Returns a filled area: a square with a square hole, and a triangle.
+ */
+static SHAPE_POLY_SET makeFill()
+{
+    SHAPE_POLY_SET fill;
+
+    fill.NewOutline();
+    fill.Append( 0, 0 );
+    fill.Append( 1000000, 0 );
+    fill.Append( 1000000, 1000000 );
+    fill.Append( 0, 1000000 );
+
+    fill.NewHole();
+    fill.Append( 250000, 250000, -1, 0 );
+    fill.Append( 250000, 750000, -1, 0 );
+    fill.Append( 750000, 750000, -1, 0 );
+    fill.Append( 750000, 250000, -1, 0 );
+
+    fill.NewOutline();
+    fill.Append( 2000000, 0 );
+    fill.Append( 3000000, 0 );
+    fill.Append( 2500000, 1000000 );
+
+    return fill;
+}
+
+
+/**
+ * Adds aCount zones with the fill aFill to aBoard, triangulated if aTriangulate is set.
+ */
+static void addZones( BOARD& aBoard, SHAPE_POLY_SET& aFill, int aCount, bool aTriangulate )
+{
+    for( int ii = 0; ii < aCount; ++ii )
+    {
+        ZONE_CONTAINER* zone = new ZONE_CONTAINER( &aBoard );
+
+        zone->SetFilledPolysList( aFill );
+
+        if( aTriangulate )
+            zone->CacheTriangulation();
+
+        aBoard.Add( zone );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( ZoneTriangulationCache )
+
+/**
+ * Two zones with the same fill (e.g. a zone and its copy on another layer) must both get
+ * their triangulation back from the cache.
+ */
+BOOST_AUTO_TEST_CASE( IdenticalZones )
+{
+    SHAPE_POLY_SET fill = makeFill();
+    BOARD saved;
+
+    addZones( saved, fill, 2, true );
+
+    const SHAPE_POLY_SET& reference = saved.Zones()[0]->GetFilledPolysList();
+
+    BOOST_REQUIRE( reference.IsTriangulationUpToDate() );
+
+    wxString fileName = wxFileName::CreateTempFileName( wxT( "qa_pcbnew" ) );
+
+    BOOST_REQUIRE( ZONE_TRIANGULATION_CACHE::Save( &saved, fileName ) );
+
+    BOARD loaded;
+
+    addZones( loaded, fill, 2, false );
+
+    BOOST_CHECK_EQUAL( ZONE_TRIANGULATION_CACHE::Restore( &loaded, fileName ), 2 );
+
+    for( ZONE_CONTAINER* zone : loaded.Zones() )
+    {
+        const SHAPE_POLY_SET& restored = zone->GetFilledPolysList();
+
+        BOOST_CHECK( restored.IsTriangulationUpToDate() );
+        BOOST_REQUIRE_EQUAL( restored.TriangulatedPolyCount(), reference.TriangulatedPolyCount() );
+
+        for( unsigned int ii = 0; ii < reference.TriangulatedPolyCount(); ++ii )
+        {
+            const auto expected = reference.TriangulatedPolygon( ii );
+            const auto poly = restored.TriangulatedPolygon( ii );
+
+            BOOST_REQUIRE_EQUAL( poly->GetTriangleCount(), expected->GetTriangleCount() );
+
+            for( int jj = 0; jj < poly->GetTriangleCount(); ++jj )
+            {
+                VECTOR2I a, b, c, ea, eb, ec;
+
+                poly->GetTriangle( jj, a, b, c );
+                expected->GetTriangle( jj, ea, eb, ec );
+
+                BOOST_CHECK( a == ea && b == eb && c == ec );
+            }
+        }
+    }
+
+    // Each zone owns its triangulation
+    BOOST_CHECK( loaded.Zones()[0]->GetFilledPolysList().TriangulatedPolygon( 0 )
+                 != loaded.Zones()[1]->GetFilledPolysList().TriangulatedPolygon( 0 ) );
+
+    wxRemoveFile( fileName );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
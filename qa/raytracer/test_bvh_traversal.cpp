@@ -0,0 +1,193 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <3d_rendering/3d_render_raytracing/accelerators/cbvh_pbrt.h>
+#include <3d_rendering/3d_render_raytracing/accelerators/ccontainer.h>
+#include <3d_rendering/3d_render_raytracing/shapes3D/ctriangle.h>
+#include <3d_rendering/3d_render_raytracing/raypacket.h>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+/**
+ * Returns a hit record with no hit yet.
+ */
+static HITINFO noHit()
+{
+    HITINFO hit;
+
+    hit.m_tHit = std::numeric_limits<float>::infinity();
+    hit.pHitObject = NULL;
+    hit.m_acc_node_info = 0;
+
+    return hit;
+}
+
+
+/**
+ * Adds aCount random triangles to aContainer, in a box of 20 x 20 x 6 units.  Most are
+ * small, some are long and cross many others.
+ */
+static void addTriangleSoup( std::mt19937& aRng, int aCount, CCONTAINER& aContainer )
+{
+    std::uniform_real_distribution<float> coord( -10.0f, 10.0f );
+    std::uniform_real_distribution<float> small( -0.6f, 0.6f );
+    std::uniform_real_distribution<float> large( -6.0f, 6.0f );
+
+    for( int i = 0; i < aCount; ++i )
+    {
+        std::uniform_real_distribution<float>& edge = ( i % 50 == 0 ) ? large : small;
+        SFVEC3F v1( coord( aRng ), coord( aRng ), coord( aRng ) * 0.3f );
+        SFVEC3F v2 = v1 + SFVEC3F( edge( aRng ), edge( aRng ), edge( aRng ) );
+        SFVEC3F v3 = v1 + SFVEC3F( edge( aRng ), edge( aRng ), edge( aRng ) );
+
+        aContainer.Add( new CTRIANGLE( v1, v2, v3 ) );
+    }
+}
+
+
+/**
+ * Fills aRays with the RAYPACKET_RAYS_PER_PACKET rays of a packet: their origins are on a
+ * grid above the soup, and their directions go down, spread as the rays of a camera.  The
+ * rays of an axis aligned packet have directions with zero components.
+ */
+static void makeRays( std::mt19937& aRng, bool aAxisAligned, RAY* aRays )
+{
+    std::uniform_real_distribution<float> coord( -12.0f, 12.0f );
+    std::uniform_real_distribution<float> tilt( -0.5f, 0.5f );
+
+    const SFVEC3F origin( coord( aRng ), coord( aRng ), 30.0f );
+    const SFVEC3F direction( tilt( aRng ), tilt( aRng ), -1.0f );
+
+    for( unsigned int y = 0, i = 0; y < RAYPACKET_DIM; ++y )
+    {
+        for( unsigned int x = 0; x < RAYPACKET_DIM; ++x, ++i )
+        {
+            SFVEC3F rayOrigin = origin + SFVEC3F( x * 0.2f, y * 0.2f, 0.0f );
+            SFVEC3F rayDir;
+
+            if( aAxisAligned )
+                rayDir = SFVEC3F( 0.0f, 0.0f, -1.0f );
+            else
+                rayDir = direction + SFVEC3F( x * 0.01f, y * 0.01f, 0.0f );
+
+            aRays[i].Init( rayOrigin, glm::normalize( rayDir ) );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( BvhTraversal )
+
+/**
+ * Traces packets of rays through BVHs of random triangle soups, built with all the split
+ * methods, and checks that the single ray and the packet traversals find the same hits as
+ * a brute force test of all the triangles: same hit, distance and triangle.  The single
+ * ray traversal starting at the node reported by a hit finds that hit again, and the
+ * shadow rays agree with the brute force ones.  Built with RAYPACKET_NO_SSE2, the test
+ * checks the scalar versions of the traversals instead of the SSE2 ones.
+ */
+BOOST_AUTO_TEST_CASE( TriangleSoup )
+{
+    std::mt19937 rng( 7 );
+    const SPLITMETHOD methods[] = { SPLIT_MIDDLE, SPLIT_EQUALCOUNTS, SPLIT_SAH, SPLIT_HLBVH };
+    int rayCount = 0;
+    int hits = 0;
+    int mismatches = 0;
+
+    for( int scene = 0; scene < 20; ++scene )
+    {
+        CCONTAINER soup;
+        addTriangleSoup( rng, 1 + scene * scene * 10, soup );
+
+        CBVH_PBRT bvh( soup, 4, methods[scene % 4] );
+
+        for( int packetIdx = 0; packetIdx < 40; ++packetIdx )
+        {
+            RAY rays[RAYPACKET_RAYS_PER_PACKET];
+            makeRays( rng, packetIdx % 5 == 0, rays );
+
+            RAYPACKET packet( rays );
+            HITINFO_PACKET packetHits[RAYPACKET_RAYS_PER_PACKET];
+
+            for( HITINFO_PACKET& packetHit : packetHits )
+            {
+                packetHit.m_hitresult = false;
+                packetHit.m_HitInfo = noHit();
+            }
+
+            bvh.Intersect( packet, packetHits );
+
+            for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+            {
+                const RAY& ray = packet.m_ray[i];
+
+                HITINFO expected = noHit();
+                bool expectedHit = soup.Intersect( ray, expected );
+
+                HITINFO single = noHit();
+                bool singleHit = bvh.Intersect( ray, single );
+
+                const HITINFO& inPacket = packetHits[i].m_HitInfo;
+
+                rayCount++;
+
+                if( expectedHit )
+                    hits++;
+
+                if( singleHit != expectedHit || single.m_tHit != expected.m_tHit
+                        || single.pHitObject != expected.pHitObject )
+                    mismatches++;
+
+                if( packetHits[i].m_hitresult != expectedHit || inPacket.m_tHit != expected.m_tHit
+                        || inPacket.pHitObject != expected.pHitObject )
+                    mismatches++;
+
+                if( singleHit && single.m_acc_node_info != 0 )
+                {
+                    HITINFO again = noHit();
+
+                    if( !bvh.Intersect( ray, again, single.m_acc_node_info )
+                            || again.m_tHit != single.m_tHit )
+                        mismatches++;
+                }
+
+                if( bvh.IntersectP( ray, 1e30f ) != soup.IntersectP( ray, 1e30f ) )
+                    mismatches++;
+
+                if( expectedHit && bvh.IntersectP( ray, expected.m_tHit * 0.999f )
+                                   != soup.IntersectP( ray, expected.m_tHit * 0.999f ) )
+                    mismatches++;
+            }
+        }
+    }
+
+    BOOST_TEST_MESSAGE( rayCount << " rays, " << hits << " hits" );
+    BOOST_CHECK( hits > rayCount / 10 );
+    BOOST_CHECK_EQUAL( mismatches, 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
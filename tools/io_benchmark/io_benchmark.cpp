@@ -23,6 +23,7 @@
 
 #include <wx/wx.h>
 #include <richio.h>
+#include <dsnlexer.h>
 
 #include <chrono>
 #include <ios>
@@ -155,6 +156,28 @@ static void bench_line_reader_reuse( const wxFileName& aFile, int aReps, BENCH_R
 }
 
 
+/**
+ * Benchmark tokenizing the file with a DSNLEXER reading from a given
+ * LINE_READER implementation, as the board file parser does.
+ * Tokens are reported as lines.
+ */
+template<typename LR>
+static void bench_lexer( const wxFileName& aFile, int aReps, BENCH_REPORT& report )
+{
+    for( int i = 0; i < aReps; ++i)
+    {
+        LR fstr( aFile.GetFullName() );
+        DSNLEXER lexer( NULL, 0, &fstr );
+
+        while( lexer.NextTok() != DSN_EOF )
+        {
+            report.linesRead++;
+            report.charAcc += (unsigned char) lexer.CurText()[0];
+        }
+    }
+}
+
+
 /**
  * Benchmark using an INPUTSTREAM_LINE_READER with a given
  * wxInputStream implementation.
@@ -264,6 +287,10 @@ static std::vector<BENCHMARK> benchmarkList =
     { 'F', bench_fstream_reuse, "std::fstream, reused" },
     { 'r', bench_line_reader<FILE_LINE_READER>, "RICHIO" },
     { 'R', bench_line_reader_reuse<FILE_LINE_READER>, "RICHIO, reused" },
+    { 'm', bench_line_reader<MMAP_LINE_READER>, "RICHIO mmap" },
+    { 'M', bench_line_reader_reuse<MMAP_LINE_READER>, "RICHIO mmap, reused" },
+    { 'l', bench_lexer<FILE_LINE_READER>, "DSNLEXER, RICHIO" },
+    { 'L', bench_lexer<MMAP_LINE_READER>, "DSNLEXER, RICHIO mmap" },
     { 'n', bench_line_reader<IFSTREAM_LINE_READER>, "std::ifstream L_R" },
     { 'N', bench_line_reader_reuse<IFSTREAM_LINE_READER>, "std::ifstream L_R, reused" },
     { 'w', bench_wxis<wxFileInputStream>, "wxFileIStream" },